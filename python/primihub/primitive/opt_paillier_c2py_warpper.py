@@ -1,76 +1,17 @@
+import numpy as np
 import opt_paillier_c2py
 
-class Opt_paillier_public_key(object):
-    """
-    Attributes:
-        nbits            int    <-> ui
-        lbits            int    <-> ui
-        n                string <-> mpz_t
-        half_n           string <-> mpz_t
-        n_squared        string <-> mpz_t
-        h_s              string <-> mpz_t
-        fb_mod_P_sqaured dict   <-> fb_instance
-        fb_mod_Q_sqaured dict   <-> fb_instance
-
-        fb_instance
-            m_mod        string <-> mpz_t
-            m_table_G    list   <-> mpz_t[]
-            m_h          int    <-> size_t
-            m_t          int    <-> size_t
-            m_w          int    <-> size_t
-    """
-    def __init__(self):
-        pass
-    
-    def __str__(self):
-        return str(self.__dict__)
-
-class Opt_paillier_secret_key(object):
-    """
-    Attributes:
-        p                               string <-> mpz_t
-        q                               string <-> mpz_t
-        p_                              string <-> mpz_t
-        q_                              string <-> mpz_t
-        alpha                           string <-> mpz_t
-        beta                            string <-> mpz_t
-        P                               string <-> mpz_t
-        Q                               string <-> mpz_t
-        P_squared                       string <-> mpz_t
-        Q_squared                       string <-> mpz_t
-        double_alpha                    string <-> mpz_t
-        double_beta                     string <-> mpz_t
-        double_alpha_inverse            string <-> mpz_t
-        P_squared_mul_P_squared_inverse string <-> mpz_t
-        P_mul_P_inverse                 string <-> mpz_t
-        double_p                        string <-> mpz_t
-        double_q                        string <-> mpz_t
-        Q_mul_double_p_inverse          string <-> mpz_t
-        P_mul_double_q_inverse          string <-> mpz_t
-    """
-    def __init__(self):
-        pass
-
-    def __str__(self):
-        return str(self.__dict__)
-
-class Opt_paillier_ciphertext(object):
-    """
-    Attributes:
-        ciphertext   string <-> mpz_t
-    """
-    def __init__(self):
-        pass
-
-    def __str__(self):
-        return str(self.__dict__)
+# Keys and ciphertexts are native handles owning the GMP values, the
+# fixed-base tables of the public key are built once by keygen and reused by
+# every call. They pickle to a compact binary form to cross the wire.
+Opt_paillier_public_key = opt_paillier_c2py.OptPublicKey
+Opt_paillier_secret_key = opt_paillier_c2py.OptSecretKey
+Opt_paillier_ciphertext = opt_paillier_c2py.OptCiphertext
+Opt_paillier_ciphertext_vector = opt_paillier_c2py.OptCiphertextVector
 
 def opt_paillier_keygen(k_sec = 112):
     
-    pub = Opt_paillier_public_key()
-    prv = Opt_paillier_secret_key()
-
-    opt_paillier_c2py.opt_paillier_keygen_warpper(k_sec, pub, prv)
+    pub, prv = opt_paillier_c2py.opt_paillier_keygen_warpper(k_sec)
 
     return pub, prv
 
@@ -82,9 +23,7 @@ def opt_paillier_encrypt_crt(pub, prv, plain_text):
 
     plain_text_str = str(plain_text)
 
-    cipher_text = Opt_paillier_ciphertext()
-
-    opt_paillier_c2py.opt_paillier_encrypt_crt_warpper(cipher_text, pub, prv, plain_text_str)
+    cipher_text = opt_paillier_c2py.opt_paillier_encrypt_crt_warpper(pub, prv, plain_text_str)
 
     return cipher_text
 
@@ -96,9 +35,7 @@ def opt_paillier_encrypt(pub, plain_text):
 
     plain_text_str = str(plain_text)
 
-    cipher_text = Opt_paillier_ciphertext()
-
-    opt_paillier_c2py.opt_paillier_encrypt_warpper(cipher_text, pub, plain_text_str)
+    cipher_text = opt_paillier_c2py.opt_paillier_encrypt_warpper(pub, plain_text_str)
 
     return cipher_text
 
@@ -123,9 +60,7 @@ def opt_paillier_add(pub, op1_cipher_text, op2_cipher_text):
         print("opt_paillier_add op2_cipher_text should be type of Opt_paillier_ciphertext()")
         return
 
-    add_res_cipher_text = Opt_paillier_ciphertext()
-
-    opt_paillier_c2py.opt_paillier_add_warpper(add_res_cipher_text, op1_cipher_text, op2_cipher_text, pub)
+    add_res_cipher_text = opt_paillier_c2py.opt_paillier_add_warpper(op1_cipher_text, op2_cipher_text, pub)
 
     return add_res_cipher_text
 
@@ -138,8 +73,49 @@ def opt_paillier_cons_mul(pub, op1_cipher_text, op2_cons_value):
         print("opt_paillier_cons_mul op2_cons_value should be type of int()")
         return
 
-    cons_mul_res_cipher_text = Opt_paillier_ciphertext()
-
-    opt_paillier_c2py.opt_paillier_cons_mul_warpper(cons_mul_res_cipher_text, op1_cipher_text, str(op2_cons_value), pub)
+    cons_mul_res_cipher_text = opt_paillier_c2py.opt_paillier_cons_mul_warpper(op1_cipher_text, str(op2_cons_value), pub)
 
     return cons_mul_res_cipher_text
+
+# The vector functions run natively over thread_num threads (0 for one per
+# core) with the GIL released. An integer numpy array is passed as int64
+# without conversion, any other sequence of int as decimal strings.
+def _vector_values(values):
+    if isinstance(values, np.ndarray) and np.issubdtype(values.dtype, np.integer):
+        return values.astype(np.int64, copy=False).ravel()
+    return [str(int(value)) for value in values]
+
+def opt_paillier_encrypt_vector(pub, plain_texts, thread_num = 0):
+
+    return opt_paillier_c2py.opt_paillier_encrypt_vector_warpper(pub, _vector_values(plain_texts), thread_num)
+
+def opt_paillier_encrypt_crt_vector(pub, prv, plain_texts, thread_num = 0):
+
+    return opt_paillier_c2py.opt_paillier_encrypt_crt_vector_warpper(pub, prv, _vector_values(plain_texts), thread_num)
+
+def opt_paillier_decrypt_crt_vector(pub, prv, cipher_texts, thread_num = 0):
+
+    if not isinstance (cipher_texts, Opt_paillier_ciphertext_vector):
+        print("opt_paillier_decrypt_crt_vector cipher_texts should be type of Opt_paillier_ciphertext_vector()")
+        return
+
+    return opt_paillier_c2py.opt_paillier_decrypt_crt_vector_warpper(pub, prv, cipher_texts, thread_num)
+
+def opt_paillier_add_vector(pub, op1_cipher_texts, op2_cipher_texts, thread_num = 0):
+
+    if not isinstance (op1_cipher_texts, Opt_paillier_ciphertext_vector):
+        print("opt_paillier_add_vector op1_cipher_texts should be type of Opt_paillier_ciphertext_vector()")
+        return
+    if not isinstance (op2_cipher_texts, Opt_paillier_ciphertext_vector):
+        print("opt_paillier_add_vector op2_cipher_texts should be type of Opt_paillier_ciphertext_vector()")
+        return
+
+    return opt_paillier_c2py.opt_paillier_add_vector_warpper(op1_cipher_texts, op2_cipher_texts, pub, thread_num)
+
+def opt_paillier_cons_mul_vector(pub, op1_cipher_texts, op2_cons_values, thread_num = 0):
+
+    if not isinstance (op1_cipher_texts, Opt_paillier_ciphertext_vector):
+        print("opt_paillier_cons_mul_vector op1_cipher_texts should be type of Opt_paillier_ciphertext_vector()")
+        return
+
+    return opt_paillier_c2py.opt_paillier_cons_mul_vector_warpper(op1_cipher_texts, _vector_values(op2_cons_values), pub, thread_num)
@@ -1,3 +1,4 @@
+import numpy as np
 import opt_paillier_c2py
 
 class Opt_paillier_pack_ciphertext(object):
@@ -90,3 +91,47 @@ def opt_paillier_pack_add(pub, op1_pack_cipher_text, op2_pack_cipher_text):
 
     return add_res_cipher_text
 
+# Packed api over numpy buffers, packing and encryption run natively over
+# thread_num threads (0 for one per core) with the GIL released. Float
+# arrays are encoded as fixed point with precision fractional bits, the
+# same precision has to be given to decrypt.
+Opt_paillier_crt_mod = opt_paillier_c2py.OptCrtMod
+Opt_paillier_packed_ciphertext = opt_paillier_c2py.OptPackedCiphertext
+
+def _fixed_point(values, precision):
+    values = np.asarray(values)
+    if np.issubdtype(values.dtype, np.floating):
+        values = np.round(values * float(1 << precision))
+    elif precision:
+        values = values.astype(np.int64) << precision
+    return values.astype(np.int64, copy=False).ravel()
+
+def opt_paillier_packed_encrypt_crt(pub, prv, values, crt_mod = None, precision = 0, thread_num = 0):
+
+    return opt_paillier_c2py.opt_paillier_packed_encrypt_crt_warpper(pub, prv, _fixed_point(values, precision), crt_mod, thread_num)
+
+def opt_paillier_packed_encrypt(pub, values, crt_mod = None, precision = 0, thread_num = 0):
+
+    return opt_paillier_c2py.opt_paillier_packed_encrypt_warpper(pub, _fixed_point(values, precision), crt_mod, thread_num)
+
+def opt_paillier_packed_decrypt_crt(pub, prv, packed_cipher_text, precision = 0, thread_num = 0):
+
+    if not isinstance (packed_cipher_text, Opt_paillier_packed_ciphertext):
+        print("opt_paillier_packed_decrypt_crt packed_cipher_text should be type of Opt_paillier_packed_ciphertext()")
+        return
+
+    decrypt_texts = opt_paillier_c2py.opt_paillier_packed_decrypt_crt_warpper(pub, prv, packed_cipher_text, thread_num)
+    if precision:
+        return np.array(decrypt_texts, dtype=np.float64) / float(1 << precision)
+    return decrypt_texts
+
+def opt_paillier_packed_add(pub, op1_packed_cipher_text, op2_packed_cipher_text, thread_num = 0):
+
+    if not isinstance (op1_packed_cipher_text, Opt_paillier_packed_ciphertext):
+        print("opt_paillier_packed_add op1_packed_cipher_text should be type of Opt_paillier_packed_ciphertext()")
+        return
+    if not isinstance (op2_packed_cipher_text, Opt_paillier_packed_ciphertext):
+        print("opt_paillier_packed_add op2_packed_cipher_text should be type of Opt_paillier_packed_ciphertext()")
+        return
+
+    return opt_paillier_c2py.opt_paillier_packed_add_warpper(op1_packed_cipher_text, op2_packed_cipher_text, pub, thread_num)
@@ -0,0 +1,60 @@
+from primihub_channel import IOService, Session, SessionMode
+import numpy as np
+import threading
+from os import path
+import pytest
+
+PORT = 1313
+
+@pytest.fixture
+def channels():
+    ios = IOService(1)
+    server = Session(ios, "127.0.0.1:%d" % PORT, SessionMode.Server, "buffer_test")
+    client = Session(ios, "127.0.0.1:%d" % PORT, SessionMode.Client, "buffer_test")
+    server_chl = server.addChannel("buffer", "buffer")
+    client_chl = client.addChannel("buffer", "buffer")
+    yield server_chl, client_chl
+    server_chl.close()
+    client_chl.close()
+
+def test_channel_buffer_round_trip(channels):
+    server_chl, client_chl = channels
+    values = np.arange(1000, dtype=np.float64) * 0.5
+    matrix = np.arange(12, dtype=np.int64).reshape(3, 4)
+
+    # the peer blocks in recv with the GIL released while this thread sends
+    received = {}
+    def echo():
+        received["array"] = server_chl.recvArray(np.dtype(np.float64))
+        server_chl.sendBuffer(received["array"])
+        dest = np.zeros(16, dtype=np.int64)
+        received["count"] = server_chl.recvInto(dest)
+        received["into"] = dest
+        received["empty"] = server_chl.recvArray()
+        received["bytes"] = server_chl.recv()
+    peer = threading.Thread(target=echo)
+    peer.start()
+
+    client_chl.sendBuffer(values)
+    back = client_chl.recvArray(np.dtype(np.float64))
+    pending = client_chl.asyncSendBuffer(matrix)
+    pending.wait()
+    client_chl.sendBuffer(np.zeros(0, dtype=np.float32))
+    client_chl.sendBuffer(b"hello")
+    peer.join()
+
+    assert np.array_equal(received["array"], values)
+    assert np.array_equal(back, values)
+    assert received["count"] == matrix.nbytes
+    assert np.array_equal(received["into"][:matrix.size], matrix.ravel())
+    assert received["empty"].size == 0
+    assert received["bytes"] == "hello"
+
+def test_channel_recv_array_rejects_partial_items(channels):
+    server_chl, client_chl = channels
+    client_chl.sendBuffer(np.zeros(3, dtype=np.uint8))
+    with pytest.raises(ValueError):
+        server_chl.recvArray(np.dtype(np.float64))
+
+if __name__ == '__main__':
+    pytest.main(['-q', path.dirname(__file__)])
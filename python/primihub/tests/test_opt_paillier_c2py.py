@@ -1,5 +1,8 @@
 from python.primihub.primitive.opt_paillier_c2py_warpper import *
+import numpy as np
+import pickle
 import random
+import struct
 import time
 from os import path
 import pytest
@@ -100,5 +103,76 @@ def test_opt_paillier_c2py():
 
     print("========================================================")
 
+def test_opt_paillier_pickle():
+    pub, prv = opt_paillier_keygen(112)
+    plain_text = random_plaintext(2048)
+    cipher_text = opt_paillier_encrypt_crt(pub, prv, plain_text)
+
+    pub2 = pickle.loads(pickle.dumps(pub))
+    prv2 = pickle.loads(pickle.dumps(prv))
+    cipher_text2 = pickle.loads(pickle.dumps(cipher_text))
+
+    assert pub2.n == pub.n
+    assert opt_paillier_decrypt_crt(pub2, prv2, cipher_text2) == plain_text
+    add_res = opt_paillier_add(pub2, cipher_text, cipher_text2)
+    assert opt_paillier_decrypt_crt(pub, prv, add_res) == 2 * plain_text
+
+def skip_mpz(data, pos):
+    count = struct.unpack_from("<Q", data, pos + 1)[0]
+    return pos + 1 + 8 + count
+
+def test_opt_paillier_deserialize_rejects_corrupt_keys():
+    pub, prv = opt_paillier_keygen(112)
+    pub_data = pub.serialize()
+    prv_data = prv.serialize()
+
+    # nbits and lbits, then n, half_n, n_squared, h_s and the m_mod of the
+    # first fixed base table, followed by its m_h and m_t
+    pos = 16
+    for _ in range(5):
+        pos = skip_mpz(pub_data, pos)
+    for table_size in [2**64 - 1, 2**40, len(pub_data)]:
+        corrupt = bytearray(pub_data)
+        struct.pack_into("<Q", corrupt, pos + 8, table_size)
+        with pytest.raises(ValueError):
+            Opt_paillier_public_key.deserialize(bytes(corrupt))
+
+    # a length that wraps the read position
+    for key_type, data, first in [(Opt_paillier_public_key, pub_data, 16),
+                                  (Opt_paillier_secret_key, prv_data, 0)]:
+        corrupt = bytearray(data)
+        struct.pack_into("<Q", corrupt, first + 1, 2**64 - 8)
+        with pytest.raises(ValueError):
+            key_type.deserialize(bytes(corrupt))
+
+    # truncated in every part of the key
+    for size in [0, 20, len(pub_data) // 2, len(pub_data) - 1]:
+        with pytest.raises(ValueError):
+            Opt_paillier_public_key.deserialize(pub_data[:size])
+    for size in [0, len(prv_data) // 2, len(prv_data) - 1]:
+        with pytest.raises(ValueError):
+            Opt_paillier_secret_key.deserialize(prv_data[:size])
+
+def test_opt_paillier_vector():
+    pub, prv = opt_paillier_keygen(112)
+    size = 100
+    plain_texts1 = np.random.randint(-2**40, 2**40, size=size, dtype=np.int64)
+    plain_texts2 = [random_plaintext(1024) for _ in range(size)]
+    cons_values = np.random.randint(-2**20, 2**20, size=size, dtype=np.int64)
+
+    cipher_texts1 = opt_paillier_encrypt_crt_vector(pub, prv, plain_texts1)
+    cipher_texts2 = opt_paillier_encrypt_vector(pub, plain_texts2, thread_num=2)
+    assert len(cipher_texts1) == size
+    assert opt_paillier_decrypt_crt_vector(pub, prv, cipher_texts1) == plain_texts1.tolist()
+    assert opt_paillier_decrypt_crt(pub, prv, cipher_texts2[3]) == plain_texts2[3]
+
+    add_res = opt_paillier_add_vector(pub, cipher_texts1, cipher_texts2)
+    expect = [int(a) + b for a, b in zip(plain_texts1, plain_texts2)]
+    assert opt_paillier_decrypt_crt_vector(pub, prv, add_res) == expect
+
+    mul_res = opt_paillier_cons_mul_vector(pub, pickle.loads(pickle.dumps(cipher_texts1)), cons_values)
+    expect = [int(a) * int(b) for a, b in zip(plain_texts1, cons_values)]
+    assert opt_paillier_decrypt_crt_vector(pub, prv, mul_res) == expect
+
 if __name__ == '__main__':
     pytest.main(['-q', path.dirname(__file__)])
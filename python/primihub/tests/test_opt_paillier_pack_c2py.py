@@ -1,5 +1,7 @@
 from python.primihub.primitive.opt_paillier_c2py_warpper import *
 from python.primihub.primitive.opt_paillier_pack_c2py_warpper import *
+import numpy as np
+import pickle
 import random
 import time
 from os import path
@@ -75,5 +77,29 @@ def test_opt_paillier_pack_c2py():
     print("========================================================")
 
 
+def test_opt_paillier_packed():
+    pub, prv = opt_paillier_keygen(112)
+    crt_mod = Opt_paillier_crt_mod()
+    size = 100
+    values1 = np.random.randint(-2**40, 2**40, size=size, dtype=np.int64)
+    values2 = np.random.randint(-2**40, 2**40, size=size, dtype=np.int64)
+
+    packed1 = opt_paillier_packed_encrypt_crt(pub, prv, values1, crt_mod)
+    packed2 = opt_paillier_packed_encrypt(pub, values2, crt_mod, thread_num=2)
+    assert len(packed1) == size
+    assert opt_paillier_packed_decrypt_crt(pub, prv, packed1) == values1.tolist()
+
+    add_res = opt_paillier_packed_add(pub, pickle.loads(pickle.dumps(packed1)), packed2)
+    assert opt_paillier_packed_decrypt_crt(pub, prv, add_res) == (values1 + values2).tolist()
+
+    gradients = np.random.uniform(-1, 1, size=size)
+    packed = opt_paillier_packed_encrypt_crt(pub, prv, gradients, precision=32)
+    decoded = opt_paillier_packed_decrypt_crt(pub, prv, packed, precision=32)
+    assert np.allclose(decoded, gradients, atol=2**-31)
+
+def test_opt_paillier_crt_mod_rejects_empty():
+    with pytest.raises(ValueError):
+        Opt_paillier_crt_mod(0, 70)
+
 if __name__ == '__main__':
     pytest.main(['-q', path.dirname(__file__)])
\ No newline at end of file
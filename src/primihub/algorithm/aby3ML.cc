@@ -1,25 +1,40 @@
 
 #include "src/primihub/algorithm/aby3ML.h"
 
+#include "src/primihub/util/parallel.h"
+
 namespace primihub {
 
 void aby3ML::init(u64 partyIdx, Session& prev, Session& next,
-  block seed) {
-  mPreproPrev = prev.addChannel(); 
-  mPreproNext = next.addChannel();
-  mPrev = prev.addChannel();
-  mNext = next.addChannel();
+  block seed, const std::string& name) {
+  if (name.empty()) {
+    mPreproPrev = prev.addChannel();
+    mPreproNext = next.addChannel();
+    mPrev = prev.addChannel();
+    mNext = next.addChannel();
+  } else {
+    std::string prepro = name + "_prepro", main = name + "_main";
+    mPreproPrev = prev.addChannel(prepro, prepro);
+    mPreproNext = next.addChannel(prepro, prepro);
+    mPrev = prev.addChannel(main, main);
+    mNext = next.addChannel(main, main);
+  }
 
   auto commPtr = std::make_shared<CommPkg>(mPrev, mNext);
   
   mRt.init(partyIdx, commPtr);
+  // the calling thread computes too.
+  mRt.setWorkerNum(DefaultWorkerNum() - 1);
+  mRt.setCoalescing(true);
 
   PRNG prng(seed);
   mEnc.init(partyIdx, *commPtr.get(), prng.get<block>());
   mEval.init(partyIdx, *commPtr.get(), prng.get<block>());
+  mEval.startPreprocess();
 }
 
 void aby3ML::fini(void) {
+  mEval.stopPreprocess();
   mPreproPrev.close();
   mPreproNext.close();
   mPrev.close();
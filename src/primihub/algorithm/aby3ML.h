@@ -29,8 +29,10 @@ class aby3ML {
     return mRt.mPartyIdx;
   }
 
+  // Channels are named name + "_prepro" and name + "_main" when a name is
+  // given, so that tasks sharing the sessions don't pick up each other's.
   void init(u64 partyIdx, Session& prev, Session& next,
-    block seed);
+    block seed, const std::string& name = "");
 
   void fini(void);
 
@@ -112,8 +114,10 @@ class aby3ML {
     return size;
   }
 
+  // Generate the randomness of n truncated values before the online
+  // phase, the evaluator keeps refilling it in background afterwards.
   void preprocess(u64 n, Decimal d) {
-    TODO("implement this");
+    mEval.preprocess(n);
   }
 
   template<Decimal D>
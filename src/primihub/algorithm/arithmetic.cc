@@ -48,6 +48,7 @@ ArithmeticExecutor::ArithmeticExecutor(
 
   party_id_ = iter->second.vm(0).party_id();
   LOG(INFO) << "Note party id of this node is " << party_id_ << ".";
+  channel_name_ = config.job_id + "_" + config.task_id;
 
   if (party_id_ == 0) {
     rpc::Node &node = party_id_node_map[0];
@@ -190,12 +191,13 @@ int ArithmeticExecutor::loadDataset() {
 
 int ArithmeticExecutor::initPartyComm(void) {
   if (is_cmp) {
-    mpc_op_exec_->setup(next_ip_, prev_ip_, next_port_, prev_port_);
+    mpc_op_exec_->setup(next_ip_, prev_ip_, next_port_, prev_port_,
+                        channel_name_);
     return 0;
   }
 
   mpc_exec_->initMPCRuntime(party_id_, next_ip_, prev_ip_, next_port_,
-                            prev_port_);
+                            prev_port_, channel_name_);
   return 0;
 }
 
@@ -41,9 +41,8 @@ private:
   uint16_t local_id_;
   std::pair<std::string, uint16_t> next_addr_;
   std::pair<std::string, uint16_t> prev_addr_;
-  Session ep_next_;
-  Session ep_prev_;
-  IOService ios_;
+  // Names the channels of this task in the node's pooled sessions.
+  std::string channel_name_;
   std::string next_ip_, prev_ip_;
   uint16_t next_port_, prev_port_;
   std::string data_file_path_;
@@ -49,7 +49,12 @@ logistic_main(sf64Matrix<D> &train_data_0_1, sf64Matrix<D> &train_label_0_1,
 
   auto preStart = std::chrono::system_clock::now();
 
-  // p.preprocess((B + dim) * IT, D);
+  // Every batch truncates the B values of X*w and the dim values of the
+  // update of w.
+  u64 dim = train_data_0_1.cols();
+  u64 batches = train_data_0_1.rows() / B;
+  p.mEval.mTruncPool.resetStats();
+  p.preprocess((B + dim) * batches * IT, D);
 
   double preBytes =
       p.mPreproNext.getTotalDataSent() + p.mPreproPrev.getTotalDataSent();
@@ -85,6 +90,13 @@ logistic_main(sf64Matrix<D> &train_data_0_1, sf64Matrix<D> &train_label_0_1,
 
   double bytes = p.mNext.getTotalDataSent() + p.mPrev.getTotalDataSent();
 
+  auto pool_stats = p.mEval.mTruncPool.getStats();
+  LOG(INFO) << "Truncation randomness: " << pool_stats.mPooled
+            << " values preprocessed in " << pool_stats.mOfflineSeconds
+            << "s offline, " << pool_stats.mInline
+            << " values generated online, online waited "
+            << pool_stats.mOnlineSeconds << "s.";
+
   if (print) {
     ostreamLock ooo(std::cout);
     ooo << " B:" << B << " IT:" << IT << " => " << (double(IT) / seconds)
@@ -122,6 +134,7 @@ LogisticRegressionExecutor::LogisticRegressionExecutor(
 
   local_id_ = iter->second.vm(0).party_id();
   LOG(INFO) << "Note party id of this node is " << local_id_ << ".";
+  channel_name_ = config.job_id + "_" + config.task_id;
 
   if (local_id_ == 0) {
     rpc::Node &node = party_id_node_map[0];
@@ -282,14 +295,14 @@ int LogisticRegressionExecutor::initPartyComm(void) {
     ss << "sess_" << local_id_ << "_2";
     std::string sess_name_2 = ss.str();
 
-    ep_next_.start(ios_, next_addr_.first, next_addr_.second,
-                   SessionMode::Server, sess_name_1);
+    ep_next_ = SessionPool::getInstance().getSession(
+        next_addr_.first, next_addr_.second, SessionMode::Server, sess_name_1);
     LOG(INFO) << "[Next] Init server session, party " << local_id_ << ", "
               << "ip " << next_addr_.first << ", port " << next_addr_.second
               << ", name " << sess_name_1 << ".";
 
-    ep_prev_.start(ios_, prev_addr_.first, prev_addr_.second,
-                   SessionMode::Server, sess_name_2);
+    ep_prev_ = SessionPool::getInstance().getSession(
+        prev_addr_.first, prev_addr_.second, SessionMode::Server, sess_name_2);
     LOG(INFO) << "[Prev] Init server session, party " << local_id_ << ", "
               << "ip " << prev_addr_.first << ", port " << prev_addr_.second
               << ", name " << sess_name_2 << ".";
@@ -302,14 +315,14 @@ int LogisticRegressionExecutor::initPartyComm(void) {
     ss << "sess_" << (local_id_ + 2) % 3 << "_1";
     std::string sess_name_2 = ss.str();
 
-    ep_next_.start(ios_, next_addr_.first, next_addr_.second,
-                   SessionMode::Server, sess_name_1);
+    ep_next_ = SessionPool::getInstance().getSession(
+        next_addr_.first, next_addr_.second, SessionMode::Server, sess_name_1);
     LOG(INFO) << "[Next] Init server session, party " << local_id_ << ", "
               << "ip " << next_addr_.first << ", port " << next_addr_.second
               << ", name " << sess_name_1 << ".";
 
-    ep_prev_.start(ios_, prev_addr_.first, prev_addr_.second,
-                   SessionMode::Client, sess_name_2);
+    ep_prev_ = SessionPool::getInstance().getSession(
+        prev_addr_.first, prev_addr_.second, SessionMode::Client, sess_name_2);
     LOG(INFO) << "[Prev] Init client session, party " << local_id_ << ", "
               << "ip " << prev_addr_.first << ", port " << prev_addr_.second
               << ", name " << sess_name_2 << ".";
@@ -323,21 +336,25 @@ int LogisticRegressionExecutor::initPartyComm(void) {
     ss << "sess_" << (local_id_ + 2) % 3 << "_1";
     std::string sess_name_2 = ss.str();
 
-    ep_next_.start(ios_, next_addr_.first, next_addr_.second,
-                   SessionMode::Client, sess_name_1);
+    ep_next_ = SessionPool::getInstance().getSession(
+        next_addr_.first, next_addr_.second, SessionMode::Client, sess_name_1);
     LOG(INFO) << "[Next] Init client session, party " << local_id_ << ", "
               << "ip " << next_addr_.first << ", port " << next_addr_.second
               << ", name " << sess_name_1 << ".";
 
-    ep_prev_.start(ios_, prev_addr_.first, prev_addr_.second,
-                   SessionMode::Client, sess_name_2);
+    ep_prev_ = SessionPool::getInstance().getSession(
+        prev_addr_.first, prev_addr_.second, SessionMode::Client, sess_name_2);
     LOG(INFO) << "[Prev] Init client session, party " << local_id_ << ", "
               << "ip " << prev_addr_.first << ", port " << prev_addr_.second
               << ", name " << sess_name_2 << ".";
   }
 
-  auto chann_next = ep_next_.addChannel();
-  auto chann_prev = ep_prev_.addChannel();
+  // The sessions are shared with other tasks of this node, channels of this
+  // task are named after it.
+  auto chann_next =
+      ep_next_.addChannel(channel_name_ + "_hello", channel_name_ + "_hello");
+  auto chann_prev =
+      ep_prev_.addChannel(channel_name_ + "_hello", channel_name_ + "_hello");
 
   chann_next.waitForConnection();
   chann_prev.waitForConnection();
@@ -365,15 +382,14 @@ int LogisticRegressionExecutor::initPartyComm(void) {
   chann_next.close();
   chann_prev.close();
 
-  engine_.init(local_id_, ep_prev_, ep_next_, toBlock(local_id_));
+  engine_.init(local_id_, ep_prev_, ep_next_, toBlock(local_id_),
+               channel_name_);
   LOG(INFO) << "Init party communication finish.";
 
   return 0;
 }
 
 int LogisticRegressionExecutor::finishPartyComm(void) {
-  ep_next_.stop();
-  ep_prev_.stop();
   engine_.fini();
   return 0;
 }
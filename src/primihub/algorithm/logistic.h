@@ -42,6 +42,7 @@
 #include "src/primihub/util/network/socket/channel.h"
 #include "src/primihub/util/network/socket/ioservice.h"
 #include "src/primihub/util/network/socket/session.h"
+#include "src/primihub/util/network/socket/session_pool.h"
 
 namespace primihub {
 eMatrix<double>
@@ -81,7 +82,8 @@ private:
   aby3ML engine_;
   Session ep_next_;
   Session ep_prev_;
-  IOService ios_;
+  // Names the channels of this task in the node's pooled sessions.
+  std::string channel_name_;
 
   // Logistic regression parameters
   std::string train_input_filepath_, test_input_filepath_;
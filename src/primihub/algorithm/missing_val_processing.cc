@@ -2,6 +2,7 @@
 
 #include <arrow/api.h>
 #include <arrow/array.h>
+#include <arrow/compute/api.h>
 #include <arrow/io/api.h>
 #include <arrow/io/file.h>
 #include <arrow/result.h>
@@ -13,6 +14,7 @@
 #include <parquet/stream_reader.h>
 #include <rapidjson/document.h>
 
+#include <cmath>
 #include <iostream>
 
 #include "src/primihub/data_store/csv/csv_driver.h"
@@ -68,6 +70,7 @@ MissingProcess::MissingProcess(PartyConfig &config,
 
   party_id_ = iter->second.vm(0).party_id();
   LOG(INFO) << "Note party id of this node is " << party_id_ << ".";
+  channel_name_ = config.job_id + "_" + config.task_id;
 
   if (party_id_ == 0) {
     rpc::Node &node = party_id_node_map[0];
@@ -194,144 +197,140 @@ int MissingProcess::loadDataset() {
 
 int MissingProcess::initPartyComm(void) {
   LOG(INFO) << "Begin to init party comm.";
-  mpc_op_exec_->setup(next_ip_, prev_ip_, next_port_, prev_port_);
+  mpc_op_exec_->setup(next_ip_, prev_ip_, next_port_, prev_port_,
+                      channel_name_);
   LOG(INFO) << "Finish to init party comm.";
   return 0;
 }
 
-int MissingProcess::execute() {
-  try {
-    arrow::Result<std::shared_ptr<Table>> res_table;
-    std::shared_ptr<arrow::Table> new_table;
-    std::shared_ptr<arrow::Array> data_array;
-    for (auto itr = col_and_dtype_.begin(); itr != col_and_dtype_.end();
-         itr++) {
-      std::vector<std::string>::iterator t =
-          std::find(local_col_names.begin(), local_col_names.end(), itr->first);
-      double double_sum = 0;
-      i64 int_sum = 0;
-      if (t != local_col_names.end()) {
-        int tmp_index = std::distance(local_col_names.begin(), t);
-        if (itr->second == 1) {
-          auto array = std::static_pointer_cast<Int64Array>(
-              table->column(tmp_index)->chunk(0));
-          for (int64_t j = 0; j < array->length(); j++) {
-            int_sum += array->Value(j);
-          }
-          auto tmp_array = table->column(tmp_index)->chunk(0);
-
-          int_sum =
-              int_sum / (array->length() - tmp_array->data()->GetNullCount());
-        } else if (itr->second == 2) {
-          // check schema
-          if (table->schema()->GetFieldByName(itr->first)->type()->id() == 9) {
-            auto array = std::static_pointer_cast<Int64Array>(
-                table->column(tmp_index)->chunk(0));
-            for (int64_t j = 0; j < array->length(); j++) {
-              double_sum += array->Value(j);
-            }
-            auto tmp_array = table->column(tmp_index)->chunk(0);
-            double_sum = double_sum /
-                         (array->length() - tmp_array->data()->GetNullCount());
-          } else {
-            auto array = std::static_pointer_cast<DoubleArray>(
-                table->column(tmp_index)->chunk(0));
-            for (int64_t j = 0; j < array->length(); j++) {
-              double_sum += array->Value(j);
-            }
-            auto tmp_array = table->column(tmp_index)->chunk(0);
-            double_sum = double_sum /
-                         (array->length() - tmp_array->data()->GetNullCount());
-          }
-        }
+namespace {
+// The double sum of a column is split at 2^32 so that it isn't bound by
+// the range of i64 in fixed point: the high word is a plain integer and
+// only the remainder, below 2^32, goes into D16. Three parties adding up
+// keep both words far from overflow.
+const double kSumSplit = 4294967296.0;
+// Largest |sum| whose high word still fits i64 after adding three of them.
+const double kMaxDoubleSum = 9.0e18 / 3 * kSumSplit;
+}  // namespace
+
+int fillNullWithMean(MPCOperator *mpc_op,
+                     const std::map<std::string, uint32_t> &col_and_dtype,
+                     std::shared_ptr<arrow::Table> *table) {
+  // Every party puts the sum and the count of the non-null values of each
+  // column into one row of a matrix, a party without the column leaves its
+  // row at zero. All parties share the matrix at the same time, so
+  // revealing it gives the totals of all columns at once.
+  u64 num_cols = col_and_dtype.size();
+  i64Matrix local_stat(num_cols, 3);
+  local_stat.setZero();
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns(num_cols);
+
+  u64 row = 0;
+  for (auto itr = col_and_dtype.begin(); itr != col_and_dtype.end();
+       itr++, row++) {
+    int index = (*table)->schema()->GetFieldIndex(itr->first);
+    if (index < 0)
+      continue;
+
+    // A column which fails here is left out by this party only, its row
+    // still goes into the MPC sum below or the other parties would hang.
+    std::shared_ptr<arrow::ChunkedArray> column = (*table)->column(index);
+    std::shared_ptr<arrow::DataType> type =
+        itr->second == 1 ? arrow::int64() : arrow::float64();
+    if (!column->type()->Equals(type)) {
+      auto res_cast = arrow::compute::Cast(column, type);
+      if (!res_cast.ok()) {
+        LOG(ERROR) << "Cast column " << itr->first << " to "
+                   << type->ToString() << " failed: " << res_cast.status();
+        continue;
       }
+      column = res_cast.ValueUnsafe().chunked_array();
+    }
+
+    auto res_sum = arrow::compute::Sum(column);
+    if (!res_sum.ok()) {
+      LOG(ERROR) << "Sum column " << itr->first
+                 << " failed: " << res_sum.status();
+      continue;
+    }
+    std::shared_ptr<arrow::Scalar> sum = res_sum.ValueUnsafe().scalar();
+    if (sum->is_valid) {
       if (itr->second == 1) {
-        si64 sharedInt;
-        LOG(INFO) << "Begin to handle column " << itr->first << ".";
-        LOG(INFO) << "Begin to run MPC sum.";
-        mpc_op_exec_->createShares(int_sum, sharedInt);
-        i64 new_sum = mpc_op_exec_->revealAll(sharedInt);
-        LOG(INFO) << "Finish to run MPC sum.";
-        new_sum = new_sum / 3;
-        if (t != local_col_names.end()) {
-          int tmp_index = std::distance(local_col_names.begin(), t);
-          auto csv_array = std::static_pointer_cast<Int64Array>(
-              table->column(tmp_index)->chunk(0));
-          std::vector<int> null_index;
-          auto tmp_array = table->column(tmp_index)->chunk(0);
-          for (int i = 0; i < tmp_array->length(); i++) {
-            if (tmp_array->IsNull(i))
-              null_index.push_back(i);
-          }
-          std::vector<i64> new_col;
-          for (int64_t i = 0; i < csv_array->length(); i++) {
-            new_col.push_back(csv_array->Value(i));
-          }
-          for (auto itr = null_index.begin(); itr != null_index.end(); itr++) {
-            new_col[*itr] = new_sum;
-          }
-          arrow::Int64Builder int64_builder;
-          int64_builder.AppendValues(new_col);
-          int64_builder.Finish(&data_array);
-
-          arrow::ChunkedArray *new_array = new arrow::ChunkedArray(data_array);
-
-          auto ptr_Array = std::shared_ptr<arrow::ChunkedArray>(new_array);
-          res_table = table->SetColumn(
-              tmp_index, arrow::field(itr->first, arrow::int64()), ptr_Array);
-          table = res_table.ValueUnsafe();
-        }
-      } else if (itr->second == 2) {
-        sf64<D16> sharedFixedInt;
-        LOG(INFO) << "Begin to handle column " << itr->first << ".";
-        LOG(INFO) << "Begin to run MPC sum.";
-        mpc_op_exec_->createShares(double_sum, sharedFixedInt);
-        double new_sum = mpc_op_exec_->revealAll(sharedFixedInt);
-        LOG(INFO) << "Finish to run MPC sum.";
-
-        new_sum = new_sum / 3;
-
-        if (t != local_col_names.end()) {
-          std::vector<double> new_col;
-          int tmp_index = std::distance(local_col_names.begin(), t);
-
-          if (table->schema()->GetFieldByName(itr->first)->type()->id() == 9) {
-            auto csv_array = std::static_pointer_cast<Int64Array>(
-                table->column(tmp_index)->chunk(0));
-
-            for (int64_t j = 0; j < csv_array->length(); j++) {
-              new_col.push_back(csv_array->Value(j));
-            }
-          } else {
-            auto csv_array = std::static_pointer_cast<DoubleArray>(
-                table->column(tmp_index)->chunk(0));
-
-            for (int64_t i = 0; i < csv_array->length(); i++) {
-              new_col.push_back(csv_array->Value(i));
-            }
-          }
-          std::vector<int> null_index;
-          auto tmp_array = table->column(tmp_index)->chunk(0);
-          for (int i = 0; i < tmp_array->length(); i++) {
-            if (tmp_array->IsNull(i))
-              null_index.push_back(i);
-          }
-          for (auto itr = null_index.begin(); itr != null_index.end(); itr++) {
-            new_col[*itr] = new_sum;
-          }
-          arrow::DoubleBuilder double_builder;
-          double_builder.AppendValues(new_col);
-          double_builder.Finish(&data_array);
-
-          arrow::ChunkedArray *new_array = new arrow::ChunkedArray(data_array);
-
-          auto ptr_Array = std::shared_ptr<arrow::ChunkedArray>(new_array);
-          res_table = table->SetColumn(
-              tmp_index, arrow::field(itr->first, arrow::float64()), ptr_Array);
-          table = res_table.ValueUnsafe();
+        local_stat(row, 0) =
+            std::static_pointer_cast<arrow::Int64Scalar>(sum)->value;
+      } else {
+        double value =
+            std::static_pointer_cast<arrow::DoubleScalar>(sum)->value;
+        if (!std::isfinite(value) || std::fabs(value) > kMaxDoubleSum) {
+          LOG(ERROR) << "Sum " << value << " of column " << itr->first
+                     << " is out of the range of fixed point, leave it out.";
+          continue;
         }
+        double high = std::trunc(value / kSumSplit);
+        local_stat(row, 1) = static_cast<i64>(high);
+        local_stat(row, 0) = f64<D16>(value - high * kSumSplit).mValue;
       }
     }
+    local_stat(row, 2) = column->length() - column->null_count();
+    columns[row] = column;
+  }
+
+  LOG(INFO) << "Begin to run MPC sum of " << num_cols << " columns.";
+  si64Matrix shared_stat(num_cols, 3);
+  mpc_op->createShares(local_stat, shared_stat);
+  i64Matrix global_stat = mpc_op->revealAll(shared_stat);
+  LOG(INFO) << "Finish to run MPC sum.";
+
+  row = 0;
+  for (auto itr = col_and_dtype.begin(); itr != col_and_dtype.end();
+       itr++, row++) {
+    if (columns[row] == nullptr)
+      continue;
+
+    i64 count = global_stat(row, 2);
+    if (count == 0) {
+      LOG(WARNING) << "Column " << itr->first
+                   << " has no value in any party, skip it.";
+      continue;
+    }
+
+    std::shared_ptr<arrow::Scalar> mean;
+    if (itr->second == 1) {
+      mean =
+          std::make_shared<arrow::Int64Scalar>(global_stat(row, 0) / count);
+    } else {
+      f64<D16> low;
+      low.mValue = global_stat(row, 0);
+      double sum = static_cast<double>(global_stat(row, 1)) * kSumSplit +
+                   static_cast<double>(low);
+      mean = std::make_shared<arrow::DoubleScalar>(sum / count);
+    }
+
+    auto res_fill = arrow::compute::FillNull(columns[row], mean);
+    if (!res_fill.ok()) {
+      LOG(ERROR) << "Fill null of column " << itr->first
+                 << " failed: " << res_fill.status();
+      return -1;
+    }
+
+    int index = (*table)->schema()->GetFieldIndex(itr->first);
+    auto res_table = (*table)->SetColumn(
+        index, arrow::field(itr->first, columns[row]->type()),
+        res_fill.ValueUnsafe().chunked_array());
+    if (!res_table.ok()) {
+      LOG(ERROR) << "Replace column " << itr->first
+                 << " failed: " << res_table.status();
+      return -1;
+    }
+    *table = res_table.ValueUnsafe();
+  }
+  return 0;
+}
+
+int MissingProcess::execute() {
+  try {
+    if (fillNullWithMean(mpc_op_exec_, col_and_dtype_, &table) != 0)
+      return -1;
   } catch (std::exception &e) {
     LOG(ERROR) << "In party " << party_id_ << ":\n" << e.what() << ".";
   }
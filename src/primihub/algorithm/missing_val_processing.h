@@ -7,6 +7,8 @@
 
 #include <algorithm>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -19,6 +21,15 @@
 #include "src/primihub/service/dataset/service.h"
 
 namespace primihub {
+// Fills the nulls of the columns in col_and_dtype, where 1 marks an int64
+// column and anything else a double one, with the mean of the column over
+// the rows of the three parties of mpc_op. A party which lacks a column
+// still takes part with no rows. All parties call this at the same time
+// with the same columns.
+int fillNullWithMean(MPCOperator *mpc_op,
+                     const std::map<std::string, uint32_t> &col_and_dtype,
+                     std::shared_ptr<arrow::Table> *table);
+
 class MissingProcess : public AlgorithmBase {
  public:
   explicit MissingProcess(PartyConfig &config,
@@ -36,9 +47,8 @@ class MissingProcess : public AlgorithmBase {
   MPCOperator *mpc_op_exec_;
   std::pair<std::string, uint16_t> next_addr_;
   std::pair<std::string, uint16_t> prev_addr_;
-  Session ep_next_;
-  Session ep_prev_;
-  IOService ios_;
+  // Names the channels of this task in the node's pooled sessions.
+  std::string channel_name_;
   std::string next_ip_, prev_ip_;
   uint16_t next_port_, prev_port_;
   std::string data_file_path_;
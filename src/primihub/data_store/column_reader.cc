@@ -0,0 +1,194 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "src/primihub/data_store/column_reader.h"
+
+#include <arrow/csv/api.h>
+#include <arrow/filesystem/localfs.h>
+#include <arrow/io/api.h>
+#include <glog/logging.h>
+
+namespace primihub {
+
+namespace {
+
+// return false when max_num values have been visited
+bool VisitArrayValues(const arrow::Array& array,
+                      const ColumnValueVisitor& visitor,
+                      int64_t max_num, int64_t* visited) {
+  auto type_id = array.type_id();
+  bool is_binary_like = type_id == arrow::Type::STRING ||
+                        type_id == arrow::Type::BINARY;
+  for (int64_t i = 0; i < array.length(); i++) {
+    if (max_num > 0 && *visited == max_num) {
+      return false;
+    }
+    (*visited)++;
+    if (array.IsNull(i)) {
+      visitor(std::string_view());
+      continue;
+    }
+    if (is_binary_like) {
+      int32_t len = 0;
+      auto& binary_array = static_cast<const arrow::BinaryArray&>(array);
+      const uint8_t* data = binary_array.GetValue(i, &len);
+      visitor(std::string_view(reinterpret_cast<const char*>(data), len));
+      continue;
+    }
+    auto maybe_scalar = array.GetScalar(i);
+    if (!maybe_scalar.ok()) {
+      visitor(std::string_view());
+      continue;
+    }
+    std::string value = (*maybe_scalar)->ToString();
+    visitor(value);
+  }
+  return true;
+}
+
+std::shared_ptr<arrow::io::InputStream>
+OpenCSVInputStream(const std::string& file_path) {
+  arrow::fs::LocalFileSystem local_fs(
+      arrow::fs::LocalFileSystemOptions::Defaults());
+  auto result_ifstream = local_fs.OpenInputStream(file_path);
+  if (!result_ifstream.ok()) {
+    LOG(ERROR) << "Failed to open file: " << file_path << " "
+               << result_ifstream.status().ToString();
+    return nullptr;
+  }
+  return result_ifstream.ValueOrDie();
+}
+
+}  // namespace
+
+int64_t VisitColumnValues(const arrow::ChunkedArray& column,
+                          const ColumnValueVisitor& visitor,
+                          int64_t max_num) {
+  int64_t visited = 0;
+  for (const auto& chunk : column.chunks()) {
+    if (!VisitArrayValues(*chunk, visitor, max_num, &visited)) {
+      break;
+    }
+  }
+  return visited;
+}
+
+int64_t VisitCSVColumn(const std::string& file_path, int data_col,
+                       const ColumnValueVisitor& visitor, int64_t max_num) {
+  arrow::io::IOContext io_context = arrow::io::default_io_context();
+  auto read_options = arrow::csv::ReadOptions::Defaults();
+  read_options.use_threads = true;
+  auto parse_options = arrow::csv::ParseOptions::Defaults();
+  auto convert_options = arrow::csv::ConvertOptions::Defaults();
+
+  // Probe the header to resolve the column name, only the first block
+  // is parsed by this reader.
+  std::string col_name;
+  {
+    auto input = OpenCSVInputStream(file_path);
+    if (input == nullptr) {
+      return -1;
+    }
+    auto maybe_reader = arrow::csv::StreamingReader::Make(
+        io_context, input, read_options, parse_options, convert_options);
+    if (!maybe_reader.ok()) {
+      LOG(ERROR) << "Create csv reader for " << file_path << " failed: "
+                 << maybe_reader.status().ToString();
+      return -1;
+    }
+    auto schema = (*maybe_reader)->schema();
+    if (data_col < 0 || data_col >= schema->num_fields()) {
+      LOG(ERROR) << "dataset colunum number is smaller than data_col, "
+                 << "dataset total colum: " << schema->num_fields()
+                 << " expected col index: " << data_col;
+      return -1;
+    }
+    col_name = schema->field(data_col)->name();
+  }
+
+  // Convert only the requested column, and always as string so that
+  // type inference on the first block can not reject later blocks.
+  convert_options.include_columns = {col_name};
+  convert_options.column_types[col_name] = arrow::utf8();
+  auto input = OpenCSVInputStream(file_path);
+  if (input == nullptr) {
+    return -1;
+  }
+  auto maybe_reader = arrow::csv::StreamingReader::Make(
+      io_context, input, read_options, parse_options, convert_options);
+  if (!maybe_reader.ok()) {
+    LOG(ERROR) << "Create csv reader for " << file_path << " failed: "
+               << maybe_reader.status().ToString();
+    return -1;
+  }
+  auto reader = *maybe_reader;
+
+  int64_t visited = 0;
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (true) {
+    auto status = reader->ReadNext(&batch);
+    if (!status.ok()) {
+      LOG(ERROR) << "Read csv file " << file_path << " failed: "
+                 << status.ToString();
+      return -1;
+    }
+    if (batch == nullptr) {
+      break;
+    }
+    if (!VisitArrayValues(*batch->column(0), visitor, max_num, &visited)) {
+      break;
+    }
+  }
+  VLOG(5) << "visited " << visited << " records of column " << col_name
+          << " in " << file_path;
+  return visited;
+}
+
+int64_t LoadColumnFromCSV(const std::string& file_path, int data_col,
+                          std::vector<std::string>* col_array,
+                          int64_t max_num) {
+  return VisitCSVColumn(file_path, data_col,
+      [col_array](std::string_view value) {
+        col_array->emplace_back(value);
+      },
+      max_num);
+}
+
+int64_t LoadColumnFromTable(const std::shared_ptr<arrow::Table>& table,
+                            int data_col,
+                            std::vector<std::string>* col_array,
+                            int64_t max_num) {
+  int num_col = table->num_columns();
+  if (data_col < 0 || data_col >= num_col) {
+    LOG(ERROR) << "dataset colunum number is smaller than data_col, "
+               << "dataset total colum: " << num_col
+               << " expected col index: " << data_col;
+    return -1;
+  }
+  auto column = table->column(data_col);
+  int64_t num_rows = column->length();
+  if (max_num > 0 && max_num < num_rows) {
+    num_rows = max_num;
+  }
+  col_array->reserve(col_array->size() + num_rows);
+  return VisitColumnValues(*column,
+      [col_array](std::string_view value) {
+        col_array->emplace_back(value);
+      },
+      max_num);
+}
+
+}  // namespace primihub
@@ -0,0 +1,66 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef SRC_PRIMIHUB_DATA_STORE_COLUMN_READER_H_
+#define SRC_PRIMIHUB_DATA_STORE_COLUMN_READER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <arrow/api.h>
+
+namespace primihub {
+
+// Called once per row. The view points into an arrow buffer and is only
+// valid during the call, copy it if it must outlive the visitor.
+using ColumnValueVisitor = std::function<void(std::string_view)>;
+
+// Visit every value of every chunk in column, null values are passed as
+// empty views. Binary/string chunks are visited without copying, other types
+// are formatted through their scalar representation.
+// return number of visited values, or -1 on error.
+int64_t VisitColumnValues(const arrow::ChunkedArray& column,
+                          const ColumnValueVisitor& visitor,
+                          int64_t max_num = 0);
+
+// Stream column data_col of a csv file batch by batch with
+// arrow::csv::StreamingReader. Only the requested column is converted,
+// always as utf8, so the whole table is never resident in memory.
+// return number of visited values, or -1 on error.
+int64_t VisitCSVColumn(const std::string& file_path, int data_col,
+                       const ColumnValueVisitor& visitor,
+                       int64_t max_num = 0);
+
+// Helpers used by PSI/PIR tasks which need owned strings. Each row is
+// copied once from the arrow buffer into col_array: the PSI and PIR
+// libraries take and keep std::vector<std::string>, and the rows are
+// selected again after the intersection, so the strings must outlive the
+// arrow batches. Readers which can consume a row in place should use
+// VisitCSVColumn/VisitColumnValues, which pass views and copy nothing.
+int64_t LoadColumnFromCSV(const std::string& file_path, int data_col,
+                          std::vector<std::string>* col_array,
+                          int64_t max_num = 0);
+int64_t LoadColumnFromTable(const std::shared_ptr<arrow::Table>& table,
+                            int data_col,
+                            std::vector<std::string>* col_array,
+                            int64_t max_num = 0);
+
+}  // namespace primihub
+
+#endif  // SRC_PRIMIHUB_DATA_STORE_COLUMN_READER_H_
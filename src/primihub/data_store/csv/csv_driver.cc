@@ -14,6 +14,10 @@
  limitations under the License.
  */
 
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
 #include <variant>
 
 #include "src/primihub/data_store/csv/csv_driver.h"
@@ -21,16 +25,228 @@
 
 
 #include <arrow/api.h>
+#include <arrow/compute/api.h>
 #include <arrow/csv/api.h>
 #include <arrow/csv/writer.h>
 #include <arrow/filesystem/localfs.h>
 #include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
 #include <fstream>
 #include <glog/logging.h>
 #include <iostream>
 
 namespace primihub {
 
+namespace {
+
+// blocks of read_options.block_size bytes the column types are inferred
+// from, enough for the file to be opened without parsing all of it.
+constexpr int kSchemaSampleBlocks = 8;
+
+constexpr char kSchemaMagic[8] = {'P', 'H', 'C', 'S', 'V', 'S', 'C', '1'};
+
+struct SchemaFileHeader {
+  char magic[8];
+  int64_t file_size;
+  int64_t file_mtime_ns;
+  int64_t sample_blocks;
+  int64_t schema_size;
+};
+
+// Type ladder of a column, a column moves up when a block doesn't convert
+// to its current type.
+enum class ColumnKind { kNull, kBool, kInt, kDouble, kTimestamp, kString };
+
+ColumnKind WidenColumnKind(ColumnKind kind, const arrow::Array& values) {
+  if (kind == ColumnKind::kString || values.null_count() == values.length()) {
+    return kind;
+  }
+  auto converts = [&values](const std::shared_ptr<arrow::DataType>& type) {
+    return arrow::compute::Cast(values, type).ok();
+  };
+  switch (kind) {
+  case ColumnKind::kNull:
+    if (converts(arrow::int64())) return ColumnKind::kInt;
+    if (converts(arrow::float64())) return ColumnKind::kDouble;
+    if (converts(arrow::boolean())) return ColumnKind::kBool;
+    if (converts(arrow::timestamp(arrow::TimeUnit::SECOND))) {
+      return ColumnKind::kTimestamp;
+    }
+    return ColumnKind::kString;
+  case ColumnKind::kBool:
+    return converts(arrow::boolean()) ? kind : ColumnKind::kString;
+  case ColumnKind::kTimestamp:
+    return converts(arrow::timestamp(arrow::TimeUnit::SECOND))
+               ? kind
+               : ColumnKind::kString;
+  case ColumnKind::kInt:
+    if (converts(arrow::int64())) return kind;
+    return converts(arrow::float64()) ? ColumnKind::kDouble
+                                      : ColumnKind::kString;
+  default:
+    return converts(arrow::float64()) ? kind : ColumnKind::kString;
+  }
+}
+
+std::shared_ptr<arrow::DataType> ColumnKindType(ColumnKind kind) {
+  switch (kind) {
+  case ColumnKind::kNull:
+    return arrow::null();
+  case ColumnKind::kBool:
+    return arrow::boolean();
+  case ColumnKind::kInt:
+    return arrow::int64();
+  case ColumnKind::kDouble:
+    return arrow::float64();
+  case ColumnKind::kTimestamp:
+    // ISO 8601 dates and date times.
+    return arrow::timestamp(arrow::TimeUnit::SECOND);
+  default:
+    return arrow::utf8();
+  }
+}
+
+// Infer the column types from the first kSchemaSampleBlocks blocks instead
+// of the first one, so every read of the file converts to the same schema.
+arrow::Result<std::shared_ptr<arrow::Schema>>
+InferCSVSchema(const std::string& file_path) {
+  arrow::fs::LocalFileSystem local_fs(
+      arrow::fs::LocalFileSystemOptions::Defaults());
+  arrow::io::IOContext io_context = arrow::io::default_io_context();
+  auto read_options = arrow::csv::ReadOptions::Defaults();
+  auto parse_options = arrow::csv::ParseOptions::Defaults();
+  auto convert_options = arrow::csv::ConvertOptions::Defaults();
+
+  // the first reader only resolves the column names.
+  std::vector<std::string> names;
+  {
+    ARROW_ASSIGN_OR_RAISE(auto input, local_fs.OpenInputStream(file_path));
+    ARROW_ASSIGN_OR_RAISE(
+        auto reader,
+        arrow::csv::StreamingReader::Make(io_context, input, read_options,
+                                          parse_options, convert_options));
+    names = reader->schema()->field_names();
+  }
+
+  // read every value as a string, empty ones as nulls like the inference.
+  for (const auto& name : names) {
+    convert_options.column_types[name] = arrow::utf8();
+  }
+  convert_options.strings_can_be_null = true;
+  ARROW_ASSIGN_OR_RAISE(auto input, local_fs.OpenInputStream(file_path));
+  ARROW_ASSIGN_OR_RAISE(
+      auto reader,
+      arrow::csv::StreamingReader::Make(io_context, input, read_options,
+                                        parse_options, convert_options));
+  std::vector<ColumnKind> kinds(names.size(), ColumnKind::kNull);
+  std::shared_ptr<arrow::RecordBatch> batch;
+  for (int block = 0; block < kSchemaSampleBlocks; block++) {
+    ARROW_RETURN_NOT_OK(reader->ReadNext(&batch));
+    if (batch == nullptr) {
+      break;
+    }
+    for (size_t i = 0; i < kinds.size(); i++) {
+      kinds[i] = WidenColumnKind(kinds[i], *batch->column(i));
+    }
+  }
+
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (size_t i = 0; i < names.size(); i++) {
+    fields.push_back(arrow::field(names[i], ColumnKindType(kinds[i])));
+  }
+  return arrow::schema(std::move(fields));
+}
+
+int StatFile(const std::string& file_path, int64_t* size, int64_t* mtime_ns) {
+  struct stat file_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0) {
+    return -1;
+  }
+  *size = file_stat.st_size;
+  *mtime_ns = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 +
+              file_stat.st_mtim.tv_nsec;
+  return 0;
+}
+
+// the schema saved by SaveSchemaFile for this version of the csv file, or
+// nullptr.
+std::shared_ptr<arrow::Schema> LoadSchemaFile(const std::string& schema_path,
+                                              int64_t file_size,
+                                              int64_t file_mtime_ns) {
+  FILE* in = fopen(schema_path.c_str(), "rb");
+  if (in == nullptr) {
+    return nullptr;
+  }
+  SchemaFileHeader header;
+  bool ok = fread(&header, sizeof(header), 1, in) == 1 &&
+            std::memcmp(header.magic, kSchemaMagic,
+                        sizeof(kSchemaMagic)) == 0 &&
+            header.file_size == file_size &&
+            header.file_mtime_ns == file_mtime_ns &&
+            header.sample_blocks == kSchemaSampleBlocks &&
+            header.schema_size > 0 && header.schema_size <= (1 << 24);
+  std::string content;
+  if (ok) {
+    content.resize(header.schema_size);
+    ok = fread(&content[0], 1, content.size(), in) == content.size();
+  }
+  fclose(in);
+  if (!ok) {
+    return nullptr;
+  }
+  arrow::io::BufferReader reader(
+      reinterpret_cast<const uint8_t*>(content.data()), content.size());
+  arrow::ipc::DictionaryMemo dictionary_memo;
+  auto maybe_schema = arrow::ipc::ReadSchema(&reader, &dictionary_memo);
+  if (!maybe_schema.ok()) {
+    return nullptr;
+  }
+  return *maybe_schema;
+}
+
+int SaveSchemaFile(const std::string& schema_path, int64_t file_size,
+                   int64_t file_mtime_ns, const arrow::Schema& schema) {
+  auto maybe_buffer = arrow::ipc::SerializeSchema(schema);
+  if (!maybe_buffer.ok()) {
+    return -1;
+  }
+  const auto& buffer = *maybe_buffer;
+  // a unique temporary name, concurrent writers never write the same file.
+  std::string tmp_path = schema_path + ".XXXXXX";
+  int fd = mkstemp(&tmp_path[0]);
+  if (fd < 0) {
+    return -1;
+  }
+  FILE* out = fdopen(fd, "wb");
+  if (out == nullptr) {
+    close(fd);
+    std::remove(tmp_path.c_str());
+    return -1;
+  }
+  SchemaFileHeader header;
+  std::memcpy(header.magic, kSchemaMagic, sizeof(kSchemaMagic));
+  header.file_size = file_size;
+  header.file_mtime_ns = file_mtime_ns;
+  header.sample_blocks = kSchemaSampleBlocks;
+  header.schema_size = buffer->size();
+  bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+            fwrite(buffer->data(), 1, buffer->size(), out) ==
+                static_cast<size_t>(buffer->size());
+  if (fclose(out) != 0 || !ok) {
+    std::remove(tmp_path.c_str());
+    return -1;
+  }
+  // as readable as the csv, like the row index.
+  chmod(tmp_path.c_str(), 0644);
+  if (std::rename(tmp_path.c_str(), schema_path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace
+
 // csv cursor implementation
 CSVCursor::CSVCursor(std::string filePath, std::shared_ptr<CSVDriver> driver) {
   this->filePath = filePath;
@@ -59,6 +275,10 @@ std::shared_ptr<primihub::Dataset> CSVCursor::read() {
   auto read_options = arrow::csv::ReadOptions::Defaults();
   auto parse_options = arrow::csv::ParseOptions::Defaults();
   auto convert_options = arrow::csv::ConvertOptions::Defaults();
+  // the schema of the ranges and streams of the file.
+  if (setColumnTypes(&convert_options) != 0) {
+    return nullptr;
+  }
 
   // Instantiate TableReader from input stream and options
   auto maybe_reader = arrow::csv::TableReader::Make(
@@ -81,8 +301,151 @@ std::shared_ptr<primihub::Dataset> CSVCursor::read() {
 
 std::shared_ptr<primihub::Dataset> CSVCursor::read(int64_t offset,
                                                    int64_t limit) {
-  // TODO
-  return nullptr;
+  if (row_index_ == nullptr) {
+    row_index_ = std::make_unique<CSVRowIndex>(filePath);
+  }
+  // built once on first access, reloaded only if the file changed.
+  if (row_index_->load() != 0) {
+    LOG(ERROR) << "Load row index of " << filePath << " failed.";
+    return nullptr;
+  }
+  int64_t begin = 0;
+  int64_t end = 0;
+  if (row_index_->locateRows(offset, limit, &begin, &end) != 0) {
+    LOG(ERROR) << "Invalid range, offset: " << offset << " limit: " << limit;
+    return nullptr;
+  }
+
+  arrow::fs::LocalFileSystem local_fs(
+      arrow::fs::LocalFileSystemOptions::Defaults());
+  auto result_file = local_fs.OpenInputFile(filePath);
+  if (!result_file.ok()) {
+    LOG(ERROR) << "Failed to open file: " << filePath;
+    return nullptr;
+  }
+  auto file = result_file.ValueOrDie();
+  // header line followed by the requested rows.
+  int64_t header_size = row_index_->headerSize();
+  auto maybe_buffer =
+      arrow::AllocateResizableBuffer(header_size + (end - begin));
+  if (!maybe_buffer.ok()) {
+    LOG(ERROR) << "Allocate buffer failed: " << maybe_buffer.status();
+    return nullptr;
+  }
+  std::shared_ptr<arrow::ResizableBuffer> buffer = std::move(*maybe_buffer);
+  auto maybe_read = file->ReadAt(0, header_size, buffer->mutable_data());
+  if (!maybe_read.ok() || *maybe_read != header_size) {
+    LOG(ERROR) << "Read csv header of " << filePath << " failed.";
+    return nullptr;
+  }
+  maybe_read = file->ReadAt(begin, end - begin,
+                            buffer->mutable_data() + header_size);
+  if (!maybe_read.ok() || *maybe_read != end - begin) {
+    LOG(ERROR) << "Read rows of " << filePath << " failed.";
+    return nullptr;
+  }
+
+  arrow::io::IOContext io_context = arrow::io::default_io_context();
+  auto input = std::make_shared<arrow::io::BufferReader>(buffer);
+  auto read_options = arrow::csv::ReadOptions::Defaults();
+  auto parse_options = arrow::csv::ParseOptions::Defaults();
+  auto convert_options = arrow::csv::ConvertOptions::Defaults();
+  // the types of the file, not of the rows in this range.
+  if (setColumnTypes(&convert_options) != 0) {
+    return nullptr;
+  }
+  auto maybe_reader = arrow::csv::TableReader::Make(
+      io_context, input, read_options, parse_options, convert_options);
+  if (!maybe_reader.ok()) {
+    LOG(ERROR) << "Create csv reader failed: " << maybe_reader.status();
+    return nullptr;
+  }
+  auto maybe_table = (*maybe_reader)->Read();
+  if (!maybe_table.ok()) {
+    LOG(ERROR) << "Read rows [" << offset << ", " << offset + limit
+               << ") of " << filePath << " failed: " << maybe_table.status();
+    return nullptr;
+  }
+  return std::make_shared<primihub::Dataset>(*maybe_table, this->driver_);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatchReader>>
+CSVCursor::readStream(const std::vector<std::string>& columns) {
+  arrow::fs::LocalFileSystem local_fs(
+      arrow::fs::LocalFileSystemOptions::Defaults());
+  ARROW_ASSIGN_OR_RAISE(auto input, local_fs.OpenInputStream(filePath));
+
+  arrow::io::IOContext io_context = arrow::io::default_io_context();
+  auto read_options = arrow::csv::ReadOptions::Defaults();
+  auto parse_options = arrow::csv::ParseOptions::Defaults();
+  auto convert_options = arrow::csv::ConvertOptions::Defaults();
+  convert_options.include_columns = columns;
+  // the types of the sampled blocks, a later block which doesn't fit the
+  // types of the first one alone would fail in the middle of the stream.
+  if (setColumnTypes(&convert_options) != 0) {
+    return arrow::Status::IOError("Infer schema of ", filePath, " failed.");
+  }
+  // a batch holds the rows of one block of read_options.block_size bytes.
+  ARROW_ASSIGN_OR_RAISE(
+      auto reader,
+      arrow::csv::StreamingReader::Make(io_context, input, read_options,
+                                        parse_options, convert_options));
+  return std::static_pointer_cast<arrow::RecordBatchReader>(reader);
+}
+
+int CSVCursor::readMeta(std::shared_ptr<arrow::Schema>* schema,
+                        int64_t* num_rows) {
+  // the schema every read and stream of the file converts to.
+  auto convert_options = arrow::csv::ConvertOptions::Defaults();
+  if (setColumnTypes(&convert_options) != 0) {
+    return -1;
+  }
+  if (row_index_ == nullptr) {
+    row_index_ = std::make_unique<CSVRowIndex>(filePath);
+  }
+  if (row_index_->load() != 0) {
+    LOG(ERROR) << "Load row index of " << filePath << " failed.";
+    return -1;
+  }
+  *schema = file_schema_;
+  *num_rows = row_index_->numRows();
+  return 0;
+}
+
+int CSVCursor::setColumnTypes(arrow::csv::ConvertOptions* convert_options) {
+  int64_t file_size = 0;
+  int64_t file_mtime_ns = 0;
+  if (StatFile(filePath, &file_size, &file_mtime_ns) != 0) {
+    LOG(ERROR) << "stat csv file " << filePath << " failed.";
+    return -1;
+  }
+  // inferred once per version of the file and kept in a sidecar file, a
+  // new cursor or a restarted node doesn't parse the file again.
+  if (file_schema_ == nullptr || schema_file_size_ != file_size ||
+      schema_file_mtime_ns_ != file_mtime_ns) {
+    file_schema_ =
+        LoadSchemaFile(schemaPath(filePath), file_size, file_mtime_ns);
+    if (file_schema_ == nullptr) {
+      auto maybe_schema = InferCSVSchema(filePath);
+      if (!maybe_schema.ok()) {
+        LOG(ERROR) << "Infer schema of " << filePath << " failed: "
+                   << maybe_schema.status();
+        return -1;
+      }
+      file_schema_ = *maybe_schema;
+      if (SaveSchemaFile(schemaPath(filePath), file_size, file_mtime_ns,
+                         *file_schema_) != 0) {
+        LOG(WARNING) << "save csv schema " << schemaPath(filePath)
+                     << " failed, keep it in memory only.";
+      }
+    }
+    schema_file_size_ = file_size;
+    schema_file_mtime_ns_ = file_mtime_ns;
+  }
+  for (const auto& field : file_schema_->fields()) {
+    convert_options->column_types[field->name()] = field->type();
+  }
+  return 0;
 }
 
 int CSVCursor::write(std::shared_ptr<primihub::Dataset> dataset) {
@@ -17,8 +17,15 @@
 #ifndef SRC_PRIMIHUB_DATA_STORE_CSV_CSV_DRIVER_H_
 #define SRC_PRIMIHUB_DATA_STORE_CSV_CSV_DRIVER_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/csv/options.h>
+
 #include "src/primihub/data_store/dataset.h"
 #include "src/primihub/data_store/driver.h"
+#include "src/primihub/data_store/csv/csv_row_index.h"
 
 namespace primihub {
 class CSVDriver;
@@ -28,14 +35,40 @@ public:
   CSVCursor(std::string filePath, std::shared_ptr<CSVDriver> driver);
   ~CSVCursor();
   std::shared_ptr<primihub::Dataset> read() override;
-  std::shared_ptr<primihub::Dataset> read(int64_t offset, int64_t limit);
+  // read rows [offset, offset + limit) using the sidecar row-offset index,
+  // only the requested byte range of the file is parsed.
+  std::shared_ptr<primihub::Dataset> read(int64_t offset, int64_t limit) override;
   int write(std::shared_ptr<primihub::Dataset> dataset) override;
   void close() override;
+  // stream the file block by block with the column types of the file,
+  // only the given columns are converted.
+  arrow::Result<std::shared_ptr<arrow::RecordBatchReader>>
+  readStream(const std::vector<std::string>& columns) override;
+  // the schema of the file, inferred from its first blocks, and the rows
+  // counted by the sidecar row index without blank lines, both are cached
+  // in sidecar files. NOTE a quoted field with line breaks is counted once
+  // per line, see CSVRowIndex.
+  int readMeta(std::shared_ptr<arrow::Schema>* schema,
+               int64_t* num_rows) override;
+
+  static std::string schemaPath(const std::string& file_path) {
+    return file_path + ".schema";
+  }
 
 private:
+  // set the column types inferred from the first blocks of the file, every
+  // read, range and block then converts to the same schema.
+  // NOTE a value past the sampled blocks which doesn't convert to the type
+  // of its column fails the read of its block.
+  int setColumnTypes(arrow::csv::ConvertOptions* convert_options);
+
   std::string filePath;
   unsigned long long offset = 0;
   std::shared_ptr<CSVDriver> driver_;
+  std::unique_ptr<CSVRowIndex> row_index_{nullptr};
+  std::shared_ptr<arrow::Schema> file_schema_{nullptr};
+  int64_t schema_file_size_{-1};
+  int64_t schema_file_mtime_ns_{-1};
 };
 
 class CSVDriver : public DataDriver,
@@ -0,0 +1,271 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "src/primihub/data_store/csv/csv_row_index.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <glog/logging.h>
+
+namespace primihub {
+
+namespace {
+constexpr char kIndexMagic[8] = {'P', 'H', 'C', 'S', 'V', 'I', 'D', '2'};
+constexpr size_t kScanBufferSize = 1 << 20;
+
+struct IndexFileHeader {
+  char magic[8];
+  int64_t file_size;
+  int64_t file_mtime_ns;
+  int64_t stride;
+  int64_t header_size;
+  int64_t num_rows;
+  int64_t num_offsets;
+};
+int64_t MtimeNs(const struct stat& file_stat) {
+  return static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 +
+         file_stat.st_mtim.tv_nsec;
+}
+}  // namespace
+
+CSVRowIndex::CSVRowIndex(const std::string& file_path)
+    : file_path_(file_path) {}
+
+int CSVRowIndex::load() {
+  struct stat file_stat;
+  if (stat(file_path_.c_str(), &file_stat) != 0) {
+    LOG(ERROR) << "stat csv file " << file_path_ << " failed.";
+    return -1;
+  }
+  if (loaded_ && file_size_ == file_stat.st_size &&
+      file_mtime_ns_ == MtimeNs(file_stat)) {
+    return 0;
+  }
+  loaded_ = false;
+  file_size_ = file_stat.st_size;
+  file_mtime_ns_ = MtimeNs(file_stat);
+  if (loadFromFile() == 0) {
+    loaded_ = true;
+    return 0;
+  }
+  if (build() != 0) {
+    return -1;
+  }
+  loaded_ = true;
+  if (saveToFile() != 0) {
+    // a read-only directory only costs a rebuild next time.
+    LOG(WARNING) << "save csv row index " << indexPath(file_path_)
+                 << " failed, keep it in memory only.";
+  }
+  return 0;
+}
+
+int64_t CSVRowIndex::scanLines(int64_t pos,
+                               const LineVisitor& visitor) const {
+  std::ifstream in(file_path_, std::ios::binary);
+  if (!in.is_open()) {
+    LOG(ERROR) << "open csv file " << file_path_ << " failed.";
+    return -1;
+  }
+  in.seekg(pos);
+  std::vector<char> buffer(std::min<int64_t>(kScanBufferSize,
+                                             file_size_ - pos + 1));
+  int64_t line_start = pos;
+  char last_byte = '\0';
+  while (in) {
+    in.read(buffer.data(), buffer.size());
+    int64_t read_size = in.gcount();
+    if (read_size <= 0) {
+      break;
+    }
+    const char* begin = buffer.data();
+    const char* end = begin + read_size;
+    const char* p = begin;
+    while (p < end) {
+      const char* line_break =
+          static_cast<const char*>(std::memchr(p, '\n', end - p));
+      if (line_break == nullptr) {
+        break;
+      }
+      int64_t line_end = pos + (line_break - begin);
+      char before = line_break > begin ? line_break[-1] : last_byte;
+      // "\n" or "\r\n" alone is a blank line.
+      bool blank = line_end == line_start ||
+                   (line_end == line_start + 1 && before == '\r');
+      p = line_break + 1;
+      int64_t next = line_end + 1;
+      if (!visitor(line_start, next, blank)) {
+        return next;
+      }
+      line_start = next;
+    }
+    last_byte = end[-1];
+    pos += read_size;
+  }
+  if (line_start < file_size_) {
+    // last line without line break
+    bool blank = line_start + 1 == file_size_ && last_byte == '\r';
+    visitor(line_start, file_size_, blank);
+  }
+  return file_size_;
+}
+
+int CSVRowIndex::build() {
+  row_offsets_.clear();
+  num_rows_ = 0;
+  header_size_ = -1;
+  int64_t ret = scanLines(0, [this](int64_t start, int64_t next, bool blank) {
+    if (header_size_ < 0) {
+      header_size_ = next;
+      return true;
+    }
+    if (blank) {
+      return true;
+    }
+    if (num_rows_ % kRowIndexStride == 0) {
+      row_offsets_.push_back(start);
+    }
+    num_rows_++;
+    return true;
+  });
+  if (ret < 0) {
+    return -1;
+  }
+  if (header_size_ < 0) {
+    // empty file
+    header_size_ = file_size_;
+  }
+  VLOG(5) << "build csv row index for " << file_path_
+          << " rows: " << num_rows_ << " header size: " << header_size_;
+  return 0;
+}
+
+int64_t CSVRowIndex::skipRows(int64_t pos, int64_t num_rows) const {
+  if (num_rows <= 0) {
+    return pos;
+  }
+  int64_t ret = scanLines(pos,
+      [&num_rows](int64_t start, int64_t next, bool blank) {
+        if (!blank) {
+          num_rows--;
+        }
+        return num_rows > 0;
+      });
+  return ret < 0 ? file_size_ : ret;
+}
+
+int CSVRowIndex::locateRows(int64_t offset, int64_t limit,
+                            int64_t* begin, int64_t* end) const {
+  if (!loaded_ || offset < 0 || limit < 0) {
+    return -1;
+  }
+  if (offset >= num_rows_ || limit == 0) {
+    *begin = *end = file_size_;
+    return 0;
+  }
+  int64_t checkpoint = offset / kRowIndexStride;
+  *begin = skipRows(row_offsets_[checkpoint],
+                     offset - checkpoint * kRowIndexStride);
+  int64_t last = offset + limit;
+  if (last >= num_rows_) {
+    *end = file_size_;
+    return 0;
+  }
+  // start from the closest checkpoint before the end row
+  int64_t end_checkpoint = last / kRowIndexStride;
+  if (end_checkpoint * kRowIndexStride > offset) {
+    *end = skipRows(row_offsets_[end_checkpoint],
+                     last - end_checkpoint * kRowIndexStride);
+  } else {
+    *end = skipRows(*begin, limit);
+  }
+  return 0;
+}
+
+int CSVRowIndex::loadFromFile() {
+  std::ifstream in(indexPath(file_path_), std::ios::binary);
+  if (!in.is_open()) {
+    return -1;
+  }
+  IndexFileHeader header;
+  in.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (in.gcount() != sizeof(header) ||
+      std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) != 0) {
+    return -1;
+  }
+  if (header.file_size != file_size_ ||
+      header.file_mtime_ns != file_mtime_ns_ ||
+      header.stride != kRowIndexStride) {
+    VLOG(5) << "csv row index of " << file_path_ << " is stale, rebuild it.";
+    return -1;
+  }
+  row_offsets_.resize(header.num_offsets);
+  in.read(reinterpret_cast<char*>(row_offsets_.data()),
+          header.num_offsets * sizeof(int64_t));
+  if (in.gcount() !=
+      static_cast<std::streamsize>(header.num_offsets * sizeof(int64_t))) {
+    row_offsets_.clear();
+    return -1;
+  }
+  header_size_ = header.header_size;
+  num_rows_ = header.num_rows;
+  return 0;
+}
+
+int CSVRowIndex::saveToFile() const {
+  std::string index_path = indexPath(file_path_);
+  // a unique temporary name, concurrent builders never write the same file.
+  std::string tmp_path = index_path + ".XXXXXX";
+  int fd = mkstemp(&tmp_path[0]);
+  if (fd < 0) {
+    return -1;
+  }
+  FILE* out = fdopen(fd, "wb");
+  if (out == nullptr) {
+    close(fd);
+    std::remove(tmp_path.c_str());
+    return -1;
+  }
+  IndexFileHeader header;
+  std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+  header.file_size = file_size_;
+  header.file_mtime_ns = file_mtime_ns_;
+  header.stride = kRowIndexStride;
+  header.header_size = header_size_;
+  header.num_rows = num_rows_;
+  header.num_offsets = row_offsets_.size();
+  bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+            fwrite(row_offsets_.data(), sizeof(int64_t), row_offsets_.size(),
+                   out) == row_offsets_.size();
+  if (fclose(out) != 0 || !ok) {
+    std::remove(tmp_path.c_str());
+    return -1;
+  }
+  // mkstemp creates the file 0600, the index is as readable as the csv.
+  chmod(tmp_path.c_str(), 0644);
+  // rename is atomic, concurrent readers never see a partial index.
+  if (std::rename(tmp_path.c_str(), index_path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace primihub
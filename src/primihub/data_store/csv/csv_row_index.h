@@ -0,0 +1,84 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef SRC_PRIMIHUB_DATA_STORE_CSV_CSV_ROW_INDEX_H_
+#define SRC_PRIMIHUB_DATA_STORE_CSV_CSV_ROW_INDEX_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace primihub {
+
+// Sparse row-offset index of a csv file. The byte offset of every
+// kRowIndexStride-th data row is recorded, so locating any row costs at most
+// one seek plus a scan of kRowIndexStride lines. The index is kept in a
+// sidecar file "<csv file>.idx" and rebuilt when the size or modify time of
+// the csv file changes.
+// Blank lines, "\n" or "\r\n" alone, are not rows, as for the arrow csv
+// reader. The index is checked against the size and the nanosecond modify
+// time of the csv file.
+// NOTE: rows are split on '\n', quoted fields containing line breaks are
+// not supported, such a row is counted once per line.
+class CSVRowIndex {
+ public:
+  static constexpr int64_t kRowIndexStride = 1024;
+
+  explicit CSVRowIndex(const std::string& file_path);
+
+  // load the sidecar index or build it by scanning the file once.
+  int load();
+  bool loaded() const { return loaded_; }
+
+  int64_t numRows() const { return num_rows_; }
+  // bytes of the header line, including the line break.
+  int64_t headerSize() const { return header_size_; }
+  int64_t fileSize() const { return file_size_; }
+  int64_t fileMtimeNs() const { return file_mtime_ns_; }
+
+  // byte range [begin, end) covering rows [offset, offset + limit).
+  int locateRows(int64_t offset, int64_t limit,
+                 int64_t* begin, int64_t* end) const;
+
+  static std::string indexPath(const std::string& file_path) {
+    return file_path + ".idx";
+  }
+
+ private:
+  int build();
+  int loadFromFile();
+  int saveToFile() const;
+  // visitor(line_start, next_line_start, blank) is called for each line
+  // from pos until it returns false. return the position after the last
+  // visited line, or -1 if the file can't be read.
+  using LineVisitor = std::function<bool(int64_t, int64_t, bool)>;
+  int64_t scanLines(int64_t pos, const LineVisitor& visitor) const;
+  // skip num_rows non-blank lines starting at pos, return the new position.
+  int64_t skipRows(int64_t pos, int64_t num_rows) const;
+
+  std::string file_path_;
+  bool loaded_{false};
+  int64_t file_size_{0};
+  int64_t file_mtime_ns_{0};
+  int64_t header_size_{0};
+  int64_t num_rows_{0};
+  std::vector<int64_t> row_offsets_;
+};
+
+}  // namespace primihub
+
+#endif  // SRC_PRIMIHUB_DATA_STORE_CSV_CSV_ROW_INDEX_H_
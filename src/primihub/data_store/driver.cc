@@ -17,7 +17,76 @@
 
 #include "src/primihub/data_store/driver.h"
 
+#include <arrow/api.h>
+
+#include "src/primihub/data_store/dataset.h"
+
 namespace primihub {
+
+namespace {
+
+// TableBatchReader keeps a non-owning reference to the table, this reader
+// keeps the table alive for as long as the batches are read.
+class OwningTableReader : public arrow::RecordBatchReader {
+ public:
+  explicit OwningTableReader(std::shared_ptr<arrow::Table> table)
+      : table_(std::move(table)), reader_(*table_) {}
+
+  std::shared_ptr<arrow::Schema> schema() const override {
+    return table_->schema();
+  }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+    return reader_.ReadNext(batch);
+  }
+
+ private:
+  std::shared_ptr<arrow::Table> table_;
+  arrow::TableBatchReader reader_;
+};
+
+}  // namespace
+
+//////////////////////////////////// Cursor ///////////////////////////////////////////////
+arrow::Result<std::shared_ptr<arrow::RecordBatchReader>>
+Cursor::readStream(const std::vector<std::string>& columns) {
+  auto dataset = this->read();
+  if (dataset == nullptr) {
+    return arrow::Status::IOError("Read dataset failed.");
+  }
+  auto table_ptr = std::get_if<std::shared_ptr<arrow::Table>>(&dataset->data);
+  if (table_ptr == nullptr) {
+    return arrow::Status::NotImplemented("Dataset is not a table.");
+  }
+  auto table = *table_ptr;
+  if (!columns.empty()) {
+    std::vector<int> indices;
+    for (const auto& name : columns) {
+      int index = table->schema()->GetFieldIndex(name);
+      if (index < 0) {
+        return arrow::Status::KeyError("No column named ", name);
+      }
+      indices.push_back(index);
+    }
+    ARROW_ASSIGN_OR_RAISE(table, table->SelectColumns(indices));
+  }
+  return std::make_shared<OwningTableReader>(std::move(table));
+}
+
+int Cursor::readMeta(std::shared_ptr<arrow::Schema>* schema,
+                     int64_t* num_rows) {
+  auto dataset = this->read();
+  if (dataset == nullptr) {
+    return -1;
+  }
+  auto table_ptr = std::get_if<std::shared_ptr<arrow::Table>>(&dataset->data);
+  if (table_ptr == nullptr) {
+    return -1;
+  }
+  *schema = (*table_ptr)->schema();
+  *num_rows = (*table_ptr)->num_rows();
+  return 0;
+}
 ///////////////////////////////// DataDriver //////////////////////////////////////////////
 std::shared_ptr<Cursor>& DataDriver::getCursor() { return cursor; }
 std::string DataDriver::getDriverType() const { return driver_type; }
@@ -31,7 +31,8 @@
 #include <exception>
 #include <memory>
 
-
+#include <arrow/record_batch.h>
+#include <arrow/result.h>
 
 // #include "src/primihub/common/clp.h"
 // #include "src/primihub/common/type/type.h"
@@ -48,6 +49,15 @@ class Cursor {
     virtual std::shared_ptr<primihub::Dataset> read(int64_t offset, int64_t limit) = 0;
     virtual int write(std::shared_ptr<primihub::Dataset> dataset) = 0;
     virtual void close() = 0;
+    // read the dataset as a stream of record batches, only the given
+    // columns if any. The default reads the whole dataset first, cursors
+    // which can read incrementally override it to keep one batch in memory.
+    virtual arrow::Result<std::shared_ptr<arrow::RecordBatchReader>>
+    readStream(const std::vector<std::string>& columns);
+    // probe the schema and the number of rows without reading the data,
+    // used to register a dataset. The default reads the whole dataset.
+    virtual int readMeta(std::shared_ptr<arrow::Schema>* schema,
+                         int64_t* num_rows);
 };
 
 class DataDriver {
@@ -31,6 +31,101 @@
 
 namespace primihub {
 
+namespace {
+
+constexpr int64_t kSQLiteBatchRows = 64 * 1024;
+
+// Steps a prepared query and converts up to kSQLiteBatchRows rows into a
+// record batch per ReadNext. col_indices[i] is the query column of field i
+// of the schema, a field is either utf8, binary, int64 or float64. stepped
+// tells that the query was already stepped once and its row is not read.
+class SQLiteBatchReader : public arrow::RecordBatchReader {
+ public:
+  SQLiteBatchReader(std::shared_ptr<SQLiteDriver> driver,
+                    std::unique_ptr<SQLite::Statement> query,
+                    std::shared_ptr<arrow::Schema> schema,
+                    std::vector<int> col_indices, bool stepped)
+      : driver_(std::move(driver)), query_(std::move(query)),
+        schema_(std::move(schema)), col_indices_(std::move(col_indices)),
+        stepped_(stepped) {}
+
+  std::shared_ptr<arrow::Schema> schema() const override { return schema_; }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+    *batch = nullptr;
+    if (done_) {
+      return arrow::Status::OK();
+    }
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+    for (const auto& field : schema_->fields()) {
+      std::unique_ptr<arrow::ArrayBuilder> builder;
+      ARROW_RETURN_NOT_OK(arrow::MakeBuilder(arrow::default_memory_pool(),
+                                             field->type(), &builder));
+      builders.push_back(std::move(builder));
+    }
+
+    int64_t num_rows = 0;
+    try {
+      while (num_rows < kSQLiteBatchRows) {
+        bool has_row = stepped_ ? query_->hasRow() : query_->executeStep();
+        stepped_ = false;
+        if (!has_row) {
+          done_ = true;
+          break;
+        }
+        for (size_t i = 0; i < col_indices_.size(); i++) {
+          ARROW_RETURN_NOT_OK(appendValue(i, builders[i].get()));
+        }
+        num_rows++;
+      }
+    } catch (std::exception& e) {
+      return arrow::Status::IOError("Step sqlite query failed: ", e.what());
+    }
+    if (num_rows == 0) {
+      return arrow::Status::OK();
+    }
+
+    std::vector<std::shared_ptr<arrow::Array>> arrays(builders.size());
+    for (size_t i = 0; i < builders.size(); i++) {
+      ARROW_RETURN_NOT_OK(builders[i]->Finish(&arrays[i]));
+    }
+    *batch = arrow::RecordBatch::Make(schema_, num_rows, std::move(arrays));
+    return arrow::Status::OK();
+  }
+
+ private:
+  arrow::Status appendValue(size_t i, arrow::ArrayBuilder* builder) {
+    SQLite::Column column = query_->getColumn(col_indices_[i]);
+    if (column.isNull()) {
+      return builder->AppendNull();
+    }
+    switch (schema_->field(i)->type()->id()) {
+    case arrow::Type::STRING:
+      return static_cast<arrow::StringBuilder*>(builder)->Append(
+          column.getString());
+    case arrow::Type::BINARY:
+      return static_cast<arrow::BinaryBuilder*>(builder)->Append(
+          static_cast<const uint8_t*>(column.getBlob()), column.getBytes());
+    case arrow::Type::INT64:
+      return static_cast<arrow::Int64Builder*>(builder)->Append(
+          column.getInt64());
+    default:
+      return static_cast<arrow::DoubleBuilder*>(builder)->Append(
+          column.getDouble());
+    }
+  }
+
+  // keeps the db connection of the query open.
+  std::shared_ptr<SQLiteDriver> driver_;
+  std::unique_ptr<SQLite::Statement> query_;
+  std::shared_ptr<arrow::Schema> schema_;
+  std::vector<int> col_indices_;
+  bool stepped_{false};
+  bool done_{false};
+};
+
+}  // namespace
+
 // sqlite cursor implementation
 SQLiteCursor::SQLiteCursor(const std::string& sql, std::shared_ptr<SQLiteDriver> driver) {
   this->sql_ = sql;
@@ -41,118 +136,144 @@ SQLiteCursor::~SQLiteCursor() { this->close(); }
 
 void SQLiteCursor::close() {}
 
-// read all data from csv file
+// read all rows of the query, with the schema of readStream.
 std::shared_ptr<primihub::Dataset>
 SQLiteCursor::read() {
-  VLOG(5) << "sql_sql_sql_sql_: " << sql_;
-  std::shared_ptr<arrow::Table> table{nullptr};
-  auto& db_connector = this->driver_->getDBConnector();
-  SQLite::Statement sql_query(*db_connector, sql_);
-  std::map<std::string, std::unique_ptr<TypeContainer>> query_result;
-  std::vector<std::tuple<std::string, sql_type_t>> col_metas;
-  bool col_meta_collected{false};
-  std::vector<std::shared_ptr<arrow::Field>> result_schema_filed;
-  while (sql_query.executeStep()) {
-    for (size_t i = 0; i < sql_query.getColumnCount(); i++) {
-      std::string col_type = sql_query.getColumnDeclaredType(i);
-      auto col_name = sql_query.getColumnOriginName(i);
-      if (!col_meta_collected) {
-        sql_type_t sql_col_type = this->get_sql_type_by_type_name(col_type);
-        switch (sql_col_type) {
-        case sql_type_t::STRING:
-          col_metas.emplace_back(std::make_tuple(col_name, sql_col_type));
-          result_schema_filed.push_back(arrow::field(col_name, arrow::binary()));
-          break;
-        case sql_type_t::INT:
-          col_metas.emplace_back(std::make_tuple(col_name, sql_col_type));
-          result_schema_filed.push_back(arrow::field(col_name, arrow::int64()));
-          break;
-        case sql_type_t::DOUBLE:
-          col_metas.emplace_back(std::make_tuple(col_name, sql_col_type));
-          result_schema_filed.push_back(arrow::field(col_name, arrow::float64()));
-          break;
-        default:
-          break;
-        }
-      }
-      // process data
-      switch (std::get<1>(col_metas[i])) {
-      case sql_type_t::STRING: {
-        std::string col_value = sql_query.getColumn(i);
-        if (query_result.find(col_name) == query_result.end()) {
-          query_result[col_name] = std::make_unique<TypeContainer>(sql_type_t::STRING);
-        }
-        query_result[col_name]->string_values.emplace_back(std::move(col_value));
-      }
-      break;
-      case sql_type_t::INT: {
-        int64_t col_value = sql_query.getColumn(i);
-        if (query_result.find(col_name) == query_result.end()) {
-          query_result[col_name] = std::make_unique<TypeContainer>(sql_type_t::INT);
-        }
-        query_result[col_name]->int_values.emplace_back(col_value);
-      }
-      break;
-      case sql_type_t::DOUBLE: {
-        double col_value = sql_query.getColumn(i);
-        if (query_result.find(col_name) == query_result.end()) {
-          query_result[col_name] = std::make_unique<TypeContainer>(sql_type_t::DOUBLE);
+  VLOG(5) << "query sql: " << sql_;
+  auto maybe_reader = readStream({});
+  if (!maybe_reader.ok()) {
+    LOG(ERROR) << "Read query " << sql_ << " failed: " << maybe_reader.status();
+    return nullptr;
+  }
+  std::shared_ptr<arrow::Table> table;
+  auto status = (*maybe_reader)->ReadAll(&table);
+  if (!status.ok()) {
+    LOG(ERROR) << "Read query " << sql_ << " failed: " << status;
+    return nullptr;
+  }
+  return std::make_shared<primihub::Dataset>(table, this->driver_);
+}
 
-        }
-        query_result[col_name]->double_values.emplace_back(col_value);
-      }
+std::shared_ptr<primihub::Dataset>
+SQLiteCursor::read(int64_t offset, int64_t limit) {
+  return nullptr;
+}
+
+void SQLiteCursor::queryFields(
+    SQLite::Statement& query,
+    std::vector<std::shared_ptr<arrow::Field>>* fields,
+    bool* stepped) {
+  *stepped = false;
+  for (int i = 0; i < query.getColumnCount(); i++) {
+    std::string col_name = query.getColumnName(i);
+    std::string decl_type;
+    try {
+      decl_type = query.getColumnDeclaredType(i);
+    } catch (std::exception& e) {
+      // expressions have no declared type.
+    }
+    std::shared_ptr<arrow::DataType> type;
+    switch (this->get_sql_type_by_type_name(decl_type)) {
+    case sql_type_t::STRING:
+      type = arrow::utf8();
+      break;
+    case sql_type_t::INT:
+    case sql_type_t::INT64:
+      type = arrow::int64();
       break;
-      default:
-      LOG(ERROR) << "unknown sql type: ";
+    case sql_type_t::DOUBLE:
+      type = arrow::float64();
       break;
+    default: {
+      // the storage class of the value in the first row, text if there is
+      // no row or the value is null.
+      if (!*stepped) {
+        query.executeStep();
+        *stepped = true;
       }
+      SQLite::Column column = query.getColumn(i);
+      if (!query.hasRow() || column.isNull() || column.isText()) {
+        type = arrow::utf8();
+      } else if (column.isInteger()) {
+        type = arrow::int64();
+      } else if (column.isFloat()) {
+        type = arrow::float64();
+      } else {
+        type = arrow::binary();
+      }
+      VLOG(5) << "column " << col_name << " of sql type " << decl_type
+              << " read as " << type->ToString();
     }
-    col_meta_collected = true;
-  }
-  // convert data to arrow array
-  std::vector<std::shared_ptr<arrow::Array>> array_data;
-  for (size_t i = 0; i < col_metas.size(); i++) {
-    auto& col_name = std::get<0>(col_metas[i]);
-    auto& col_type = std::get<1>(col_metas[i]);
-    switch (col_type) {
-    case sql_type_t::STRING:{
-      arrow::StringBuilder builder;
-      auto& string_values = query_result[col_name]->string_values;
-      std::shared_ptr<arrow::Array> array;
-      builder.AppendValues(string_values);
-      builder.Finish(&array);
-      array_data.push_back(std::move(array));
-    }
-    break;
-    case sql_type_t::INT:{
-      arrow::NumericBuilder<arrow::Int64Type> builder;
-      auto& int_values = query_result[col_name]->int_values;
-      std::shared_ptr<arrow::Array> array;
-      builder.AppendValues(int_values);
-      builder.Finish(&array);
-      array_data.push_back(std::move(array));
     }
-    break;
-    case sql_type_t::DOUBLE: {
-      arrow::NumericBuilder<arrow::DoubleType> builder;
-      auto& double_values = query_result[col_name]->double_values;
-      std::shared_ptr<arrow::Array> array;
-      builder.AppendValues(double_values);
-      builder.Finish(&array);
-      array_data.push_back(std::move(array));
+    fields->push_back(arrow::field(col_name, type));
+  }
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatchReader>>
+SQLiteCursor::readStream(const std::vector<std::string>& columns) {
+  auto& db_connector = this->driver_->getDBConnector();
+  std::unique_ptr<SQLite::Statement> query;
+  try {
+    query = std::make_unique<SQLite::Statement>(*db_connector, sql_);
+  } catch (std::exception& e) {
+    return arrow::Status::IOError("Prepare sqlite query failed: ", e.what());
+  }
+
+  // the schema is fixed by the declared types and, for a column without
+  // one, by the first row before any batch is converted.
+  std::vector<std::shared_ptr<arrow::Field>> all_fields;
+  bool stepped = false;
+  try {
+    queryFields(*query, &all_fields, &stepped);
+  } catch (std::exception& e) {
+    return arrow::Status::IOError("Step sqlite query failed: ", e.what());
+  }
+  std::map<std::string, int> query_columns;
+  for (size_t i = 0; i < all_fields.size(); i++) {
+    query_columns[all_fields[i]->name()] = i;
+  }
+
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<int> col_indices;
+  if (columns.empty()) {
+    fields = std::move(all_fields);
+    for (size_t i = 0; i < fields.size(); i++) {
+      col_indices.push_back(i);
     }
-    break;
+  } else {
+    for (const auto& name : columns) {
+      auto it = query_columns.find(name);
+      if (it == query_columns.end()) {
+        return arrow::Status::KeyError("No column named ", name);
+      }
+      fields.push_back(all_fields[it->second]);
+      col_indices.push_back(it->second);
     }
   }
-  auto schema = std::make_shared<arrow::Schema>(result_schema_filed);
-  table = arrow::Table::Make(schema, array_data);
-  auto dataset = std::make_shared<primihub::Dataset>(table, this->driver_);
-  return dataset;
+  return std::make_shared<SQLiteBatchReader>(
+      this->driver_, std::move(query), arrow::schema(std::move(fields)),
+      std::move(col_indices), stepped);
 }
 
-std::shared_ptr<primihub::Dataset>
-SQLiteCursor::read(int64_t offset, int64_t limit) {
-  return nullptr;
+int SQLiteCursor::readMeta(std::shared_ptr<arrow::Schema>* schema,
+                           int64_t* num_rows) {
+  auto& db_connector = this->driver_->getDBConnector();
+  try {
+    SQLite::Statement query(*db_connector, sql_);
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    bool stepped = false;
+    queryFields(query, &fields, &stepped);
+    *schema = arrow::schema(std::move(fields));
+
+    SQLite::Statement count_query(*db_connector,
+                                  "select count(*) from (" + sql_ + ")");
+    count_query.executeStep();
+    *num_rows = count_query.getColumn(0).getInt64();
+  } catch (std::exception& e) {
+    LOG(ERROR) << "Read meta of query " << sql_ << " failed: " << e.what();
+    return -1;
+  }
+  return 0;
 }
 
 int SQLiteCursor::write(std::shared_ptr<primihub::Dataset> dataset) {
@@ -32,6 +32,14 @@ public:
   std::shared_ptr<primihub::Dataset> read(int64_t offset, int64_t limit);
   int write(std::shared_ptr<primihub::Dataset> dataset) override;
   void close() override;
+  // step the query kSQLiteBatchRows rows at a time, only the given columns
+  // are kept.
+  arrow::Result<std::shared_ptr<arrow::RecordBatchReader>>
+  readStream(const std::vector<std::string>& columns) override;
+  // the schema of readStream and the rows counted by sqlite, no row is
+  // converted.
+  int readMeta(std::shared_ptr<arrow::Schema>* schema,
+               int64_t* num_rows) override;
 
  protected:
   enum class sql_type_t : int8_t{
@@ -42,14 +50,6 @@ public:
     DOUBLE,
     UNKONW,
   };
-  struct TypeContainer {
-    explicit TypeContainer(sql_type_t col_type) : col_type_(col_type) {}
-    std::vector<std::string> string_values;
-    std::vector<float> float_values;
-    std::vector<double> double_values;
-    std::vector<int64_t> int_values;
-    sql_type_t col_type_;
-  };
   sql_type_t get_sql_type_by_type_name(const std::string& type_name) {
     auto it = sql_type_name_to_enum.find(type_name);
     if (it != sql_type_name_to_enum.end()) {
@@ -57,6 +57,13 @@ public:
     }
     return sql_type_t::UNKONW;
   }
+  // fields of the columns of a prepared query, named as in the result. A
+  // column without a known declared type, e.g. an expression, takes the
+  // type of its value in the first row, *stepped tells if the query was
+  // stepped for it.
+  void queryFields(SQLite::Statement& query,
+                   std::vector<std::shared_ptr<arrow::Field>>* fields,
+                   bool* stepped);
 
  private:
   std::string sql_;
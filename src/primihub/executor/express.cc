@@ -1,5 +1,7 @@
 #include <glog/logging.h>
+#include <algorithm>
 #include <sstream>
+#include <type_traits>
 
 #include "src/primihub/executor/express.h"
 
@@ -632,7 +634,8 @@ void MPCExpressExecutor::initMPCRuntime(uint32_t party_id,
                                         const std::string &next_ip,
                                         const std::string &prev_ip,
                                         uint16_t next_port,
-                                        uint16_t prev_port) {
+                                        uint16_t prev_port,
+                                        const std::string &channel_name) {
   std::string next_name;
   std::string prev_name;
 
@@ -648,7 +651,7 @@ void MPCExpressExecutor::initMPCRuntime(uint32_t party_id,
   }
 
   mpc_op_ = new MPCOperator(party_id, next_name, prev_name);
-  mpc_op_->setup(next_ip, prev_ip, next_port, prev_port);
+  mpc_op_->setup(next_ip, prev_ip, next_port, prev_port, channel_name);
 
   party_id_ = party_id;
   return;
@@ -1097,121 +1100,246 @@ void MPCExpressExecutor::runMPCDivFP64(TokenValue &val1, TokenValue &val2,
   createTokenValue(sh_res, res);
 }
 
-void MPCExpressExecutor::BeforeMPCRun(std::stack<std::string> &token_stk,
-                                      std::stack<TokenValue> &val_stk,
-                                      TokenValue &val1, TokenValue &val2,
-                                      std::string &a, std::string &b) {
-  b = token_stk.top();
-  token_stk.pop();
-  a = token_stk.top();
-  token_stk.pop();
+int MPCExpressExecutor::buildExprDAG(std::vector<ExprNode> &nodes,
+                                     int64_t &root) {
+  std::stack<std::string> suffix_stk = suffix_stk_;
+  std::stack<int64_t> operand_stk;
+  std::map<std::string, int64_t> node_index;
+
+  auto find_or_add = [&](ExprNode &&node) {
+    auto iter = node_index.find(node.token);
+    if (iter != node_index.end())
+      return iter->second;
+    int64_t index = static_cast<int64_t>(nodes.size());
+    node_index[node.token] = index;
+    nodes.emplace_back(std::move(node));
+    return index;
+  };
 
-  val2 = val_stk.top();
-  val_stk.pop();
-  val1 = val_stk.top();
-  val_stk.pop();
+  while (!suffix_stk.empty()) {
+    std::string token = suffix_stk.top();
+    suffix_stk.pop();
 
-  suffix_stk_.pop();
-}
+    if (!isOperator(token)) {
+      operand_stk.push(find_or_add(ExprNode{0, token, -1, -1, 0}));
+      continue;
+    }
 
-void MPCExpressExecutor::AfterMPCRun(std::stack<std::string> &token_stk,
-                                     std::stack<TokenValue> &val_stk,
-                                     std::string &new_token, TokenValue &res) {
-  token_stk.push(new_token);
-  token_val_map_[new_token] = res;
-  val_stk.push(res);
+    if (operand_stk.size() < 2) {
+      LOG(ERROR) << "Operator '" << token << "' lacks operand.";
+      return -1;
+    }
+    int64_t rhs = operand_stk.top();
+    operand_stk.pop();
+    int64_t lhs = operand_stk.top();
+    operand_stk.pop();
+
+    char op = token[0];
+    // Order operands of commutative operators, so that "a*b" and "b*a"
+    // end up in the same node.
+    if ((op == '+' || op == '*') && nodes[rhs].token < nodes[lhs].token)
+      std::swap(lhs, rhs);
+
+    std::string new_token =
+        "(" + nodes[lhs].token + token + nodes[rhs].token + ")";
+    uint32_t depth = std::max(nodes[lhs].depth, nodes[rhs].depth) + 1;
+    operand_stk.push(find_or_add(ExprNode{op, new_token, lhs, rhs, depth}));
+  }
+
+  if (operand_stk.size() != 1) {
+    LOG(ERROR) << "Illegal express, " << operand_stk.size()
+               << " operands left after parse.";
+    return -1;
+  }
+
+  root = operand_stk.top();
+  return 0;
 }
 
-int MPCExpressExecutor::runMPCEvaluate(void) {
-  std::stack<std::string> stk1;
-  std::stack<TokenValue> val_stk;
+int MPCExpressExecutor::createInputShares(std::vector<ExprNode> &nodes) {
+  uint32_t val_count = feed_dict_->getColumnValuesCount();
+  // Local values must live until their share tasks are done.
+  std::vector<f64Matrix<D>> fixed_vals;
+  std::vector<i64Matrix> int_vals;
+  fixed_vals.reserve(nodes.size());
+  int_vals.reserve(nodes.size());
+  std::vector<Sh3Task> tasks;
+
+  for (auto &node : nodes) {
+    if (node.op != 0)
+      continue;
 
-  while (!suffix_stk_.empty()) {
-    std::string token = suffix_stk_.top();
-    if (token == "+") {
-      std::string a, b;
-      TokenValue val1, val2, res;
-      BeforeMPCRun(stk1, val_stk, val1, val2, a, b);
+    TokenValue token_val;
+    if (createTokenValue(node.token, token_val)) {
+      LOG(ERROR) << "Construct token value for token '" << node.token
+                 << "' failed.";
+      return -1;
+    }
 
+    if (token_type_map_[node.token] == TokenType::COLUMN) {
+      bool is_remote = (token_val.type == 4);
       if (fp64_run_) {
-        LOG(INFO) << "Run FP64 Add between '" << a << "' and '" << b << "'.";
-        runMPCAddFP64(val1, val2, res);
-        LOG(INFO) << "Run FP64 Add finish.";
+        sf64Matrix<D> *sh_val = new sf64Matrix<D>(val_count, 1);
+        if (is_remote) {
+          tasks.emplace_back(
+              mpc_op_->enc.remoteFixedMatrix(mpc_op_->runtime, *sh_val));
+        } else {
+          eMatrix<double> m;
+          constructFP64Matrix(token_val, m);
+          fixed_vals.emplace_back(m.rows(), m.cols());
+          for (i64 i = 0; i < m.size(); i++)
+            fixed_vals.back()(i) = m(i);
+          tasks.emplace_back(mpc_op_->enc.localFixedMatrix(
+              mpc_op_->runtime, fixed_vals.back(), *sh_val));
+        }
+        createTokenValue(sh_val, token_val);
       } else {
-        LOG(INFO) << "Run I64 Add between '" << a << " and '" << b << "'.";
-        si64Matrix sh_sum;
-        runMPCAddI64(val1, val2, res);
-        LOG(INFO) << "Run I64 Add finish.";
+        si64Matrix *sh_val = new si64Matrix(val_count, 1);
+        if (is_remote) {
+          tasks.emplace_back(
+              mpc_op_->enc.remoteIntMatrix(mpc_op_->runtime, *sh_val));
+        } else {
+          int_vals.emplace_back();
+          constructI64Matrix(token_val, int_vals.back());
+          tasks.emplace_back(mpc_op_->enc.localIntMatrix(
+              mpc_op_->runtime, int_vals.back(), *sh_val));
+        }
+        createTokenValue(sh_val, token_val);
       }
+    }
 
-      std::string new_token = "(" + a + "+" + b + ")";
-      AfterMPCRun(stk1, val_stk, new_token, res);
-    } else if (token == "-") {
-      std::string a, b;
-      TokenValue val1, val2, res;
-      BeforeMPCRun(stk1, val_stk, val1, val2, a, b);
+    token_val_map_[node.token] = token_val;
+  }
 
-      if (fp64_run_) {
-        LOG(INFO) << "Run FP64 Sub between '" << a << "' and '" << b << "'.";
-        runMPCSubFP64(val1, val2, res);
-        LOG(INFO) << "Run FP64 Sub finish.";
-      } else {
-        LOG(INFO) << "Run I64 Sub between '" << a << " and '" << b << "'.";
-        si64Matrix sh_sum;
-        runMPCSubI64(val1, val2, res);
-        LOG(INFO) << "Run I64 Sub finish.";
-      }
+  for (auto &task : tasks)
+    task.get();
 
-      std::string new_token = "(" + a + "-" + b + ")";
-      AfterMPCRun(stk1, val_stk, new_token, res);
-    } else if (token == "*") {
-      std::string a, b;
-      TokenValue val1, val2, res;
-      BeforeMPCRun(stk1, val_stk, val1, val2, a, b);
+  LOG(INFO) << "Create shares for " << tasks.size() << " columns finish.";
+  return 0;
+}
 
-      if (fp64_run_) {
-        LOG(INFO) << "Run FP64 Mul between '" << a << "' and '" << b << "'.";
-        runMPCMulFP64(val1, val2, res);
-        LOG(INFO) << "Run FP64 Mul finish.";
+int MPCExpressExecutor::scheduleMPCOp(std::vector<ExprNode> &nodes,
+                                      int64_t index,
+                                      std::vector<Sh3Task> &tasks) {
+  ExprNode &node = nodes[index];
+  // Operands are shares or constants here, columns are shared by
+  // createInputShares.
+  TokenValue val1 = token_val_map_[nodes[node.lhs].token];
+  TokenValue val2 = token_val_map_[nodes[node.rhs].token];
+  TokenValue res;
+  bool is_share1 = (val1.type == 5 || val1.type == 6);
+  bool is_share2 = (val2.type == 5 || val2.type == 6);
+  if (!is_share1 && !is_share2) {
+    LOG(ERROR) << "Operator in " << node.token
+               << " between two constants is not supported.";
+    return -1;
+  }
+
+  uint32_t val_count = feed_dict_->getColumnValuesCount();
+  switch (node.op) {
+  case '+':
+    if (fp64_run_)
+      runMPCAddFP64(val1, val2, res);
+    else
+      runMPCAddI64(val1, val2, res);
+    break;
+  case '-':
+    if (fp64_run_)
+      runMPCSubFP64(val1, val2, res);
+    else
+      runMPCSubI64(val1, val2, res);
+    break;
+  case '*':
+    if (fp64_run_) {
+      sf64Matrix<D> *sh_res = new sf64Matrix<D>(val_count, 1);
+      if (is_share1 && is_share2) {
+        tasks.emplace_back(mpc_op_->eval.asyncDotMul(
+            mpc_op_->runtime, *val1.val_union.sh_fp64_m,
+            *val2.val_union.sh_fp64_m, *sh_res));
       } else {
-        LOG(INFO) << "Run I64 Mul between '" << a << " and '" << b << "'.";
-        si64Matrix sh_sum;
-        runMPCMulI64(val1, val2, res);
-        LOG(INFO) << "Run I64 Mul finish.";
+        // Multiply with a fixed point constant needs a truncation round.
+        TokenValue &const_val = is_share1 ? val2 : val1;
+        TokenValue &share_val = is_share1 ? val1 : val2;
+        f64<D> constfixed = const_val.val_union.fp64_val;
+        tasks.emplace_back(mpc_op_->eval.asyncConstFixedMul(
+            mpc_op_->runtime, constfixed, *share_val.val_union.sh_fp64_m,
+            *sh_res));
       }
-
-      std::string new_token = "(" + a + "*" + b + ")";
-      AfterMPCRun(stk1, val_stk, new_token, res);
-    } else if (token == "/") {
-      std::string a, b;
-      TokenValue val1, val2, res;
-      BeforeMPCRun(stk1, val_stk, val1, val2, a, b);
-      LOG(INFO) << "Run FP64 Div between '" << a << "' and '" << b << "'.";
-      runMPCDivFP64(val1, val2, res);
-      LOG(INFO) << "Run FP64 Div finish.";
-      std::string new_token = "(" + a + "/" + b + ")";
-      AfterMPCRun(stk1, val_stk, new_token, res);
+      createTokenValue(sh_res, res);
+    } else if (is_share1 && is_share2) {
+      si64Matrix *sh_res = new si64Matrix(val_count, 1);
+      tasks.emplace_back(mpc_op_->eval.asyncDotMul(
+          mpc_op_->runtime, *val1.val_union.sh_i64_m,
+          *val2.val_union.sh_i64_m, *sh_res));
+      createTokenValue(sh_res, res);
     } else {
-      stk1.push(token);
-      suffix_stk_.pop();
+      runMPCMulI64(val1, val2, res);
+    }
+    break;
+  default:
+    LOG(ERROR) << "Unknown operator " << node.op << ".";
+    return -1;
+  }
 
-      TokenValue token_val;
-      if (createTokenValue(token, token_val)) {
-        LOG(ERROR) << "Construct token value for token '" << token
-                   << "' failed.";
+  token_val_map_[node.token] = res;
+  return 0;
+}
+
+int MPCExpressExecutor::runMPCEvaluate(void) {
+  std::vector<ExprNode> nodes;
+  int64_t root = -1;
+  if (buildExprDAG(nodes, root)) {
+    LOG(ERROR) << "Compile express " << expr_ << " failed.";
+    return -1;
+  }
+
+  if (createInputShares(nodes))
+    return -1;
+
+  std::map<uint32_t, std::vector<int64_t>> levels;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (nodes[i].op != 0)
+      levels[nodes[i].depth].push_back(i);
+  }
+
+  // Operations of the same depth are independent. Their MPC tasks are
+  // scheduled together and run in the same rounds, so the latency depends
+  // on the depth of the express instead of the operator count.
+  for (auto &level : levels) {
+    std::vector<Sh3Task> tasks;
+    std::vector<int64_t> div_nodes;
+    for (auto index : level.second) {
+      if (nodes[index].op == '/') {
+        div_nodes.push_back(index);
+      } else if (scheduleMPCOp(nodes, index, tasks)) {
+        // Tasks already scheduled reference the shares, finish them.
+        for (auto &task : tasks)
+          task.get();
         return -1;
       }
+    }
+
+    for (auto &task : tasks)
+      task.get();
 
-      val_stk.push(token_val);
-      token_val_map_[token] = token_val;
+    // Division runs its own sequence of rounds.
+    for (auto index : div_nodes) {
+      TokenValue &val1 = token_val_map_[nodes[nodes[index].lhs].token];
+      TokenValue &val2 = token_val_map_[nodes[nodes[index].rhs].token];
+      TokenValue res;
+      LOG(INFO) << "Run FP64 Div " << nodes[index].token << ".";
+      runMPCDivFP64(val1, val2, res);
+      token_val_map_[nodes[index].token] = res;
     }
-  }
 
-  while (!stk1.empty()) {
-    suffix_stk_.push(stk1.top());
-    stk1.pop();
+    LOG(INFO) << "Run " << level.second.size() << " operators of depth "
+              << level.first << " finish.";
   }
 
+  while (!suffix_stk_.empty())
+    suffix_stk_.pop();
+  suffix_stk_.push(nodes[root].token);
+
   return 0;
 }
 
@@ -1311,244 +1439,239 @@ void MPCExpressExecutor::Clean(void) {
 
 MPCExpressExecutor::~MPCExpressExecutor() { Clean(); }
 
-void LocalExpressExecutor::beforeLocalCalculate(
-    std::stack<std::string> &token_stk, std::stack<TokenValue> &val_stk,
-    TokenValue &val1, TokenValue &val2, std::string &a, std::string &b) {
-  mpc_exec_->BeforeMPCRun(token_stk, val_stk, val1, val2, a, b);
+// Value of a slot of the program stack over one block, either a run of
+// values or a constant which applies to every row.
+template <typename T> struct LocalSlot {
+  const T *vec; // nullptr for a constant.
+  T val;
+};
+
+// Apply a binary operator to one block. The loops carry no branch and no
+// call, so that the compiler vectorizes them. out may be the same buffer
+// as a.vec, never b.vec.
+template <typename T, typename Op>
+static inline void runLocalKernel(const LocalSlot<T> &a,
+                                  const LocalSlot<T> &b, T *out, size_t n,
+                                  Op op) {
+  if (a.vec && b.vec) {
+    const T *x = a.vec;
+    const T *y = b.vec;
+    for (size_t i = 0; i < n; i++)
+      out[i] = op(x[i], y[i]);
+  } else if (a.vec) {
+    const T *x = a.vec;
+    const T y = b.val;
+    for (size_t i = 0; i < n; i++)
+      out[i] = op(x[i], y);
+  } else {
+    const T x = a.val;
+    const T *y = b.vec;
+    for (size_t i = 0; i < n; i++)
+      out[i] = op(x, y[i]);
+  }
 }
 
-void LocalExpressExecutor::afterLocalCalculate(
-    std::stack<std::string> &token_stk, std::stack<TokenValue> &val_stk,
-    std::string &new_token, TokenValue &res) {
-  token_stk.push(new_token);
-  token_val_map_[new_token] = res;
-  val_stk.push(res);
+template <typename T> static T foldLocalConstant(char op, T a, T b) {
+  switch (op) {
+  case '+':
+    return a + b;
+  case '-':
+    return a - b;
+  case '*':
+    return a * b;
+  default:
+    return a / b;
+  }
 }
 
-int LocalExpressExecutor::runLocalEvaluate() {
-  std::string expr = mpc_exec_->expr_;
-  LOG(INFO) << expr;
-  mpc_exec_->parseExpress(expr);
-
-  std::stack<std::string> stk1;
-  std::stack<TokenValue> val_stk;
-
+int LocalExpressExecutor::compileLocalProgram(std::vector<LocalInstr> &prog,
+                                              std::vector<std::string> &cols,
+                                              size_t &max_depth) {
   std::stack<std::string> &suffix_stk = mpc_exec_->suffix_stk_;
+  std::map<std::string, int32_t> col_index;
+  // Whether each value on the program stack is a constant, an operator of
+  // two constants is folded into a single operand.
+  std::vector<bool> is_const;
+  bool fp64_run = mpc_exec_->fp64_run_;
+
+  max_depth = 0;
   while (!suffix_stk.empty()) {
     std::string token = suffix_stk.top();
-    if (token == "+") {
-      std::string a, b;
-      TokenValue val1, val2, res;
-      std::string new_token;
-      beforeLocalCalculate(stk1, val_stk, val1, val2, a, b);
-      if (mpc_exec_->fp64_run_) {
-        std::vector<double> *p_vec_sum = new std::vector<double>();
-        if (val1.type != 2 && val2.type != 2) {
-          p_vec_sum->resize(val1.val_union.fp64_vec->size());
-          for (size_t i = 0; i < p_vec_sum->size(); i++)
-            (*p_vec_sum)[i] =
-                (*val1.val_union.fp64_vec)[i] + (*val2.val_union.fp64_vec)[i];
-        } else {
-          if (val1.type == 2) {
-            p_vec_sum->resize(val2.val_union.fp64_vec->size());
-            for (size_t i = 0; i < p_vec_sum->size(); i++)
-              (*p_vec_sum)[i] =
-                  val1.val_union.fp64_val + (*val2.val_union.fp64_vec)[i];
-          } else {
-            p_vec_sum->resize(val1.val_union.fp64_vec->size());
-            for (size_t i = 0; i < p_vec_sum->size(); i++)
-              (*p_vec_sum)[i] =
-                  val2.val_union.fp64_val + (*val1.val_union.fp64_vec)[i];
-          }
-        }
-        res.val_union.fp64_vec = p_vec_sum;
-        res.type = 0;
-      } else {
-        std::vector<int64_t> *p_vec_sum = new std::vector<int64_t>();
-        if (val1.type != 3 && val2.type != 3) {
-          p_vec_sum->resize(val1.val_union.i64_vec->size());
-          for (size_t i = 0; i < p_vec_sum->size(); i++)
-            (*p_vec_sum)[i] =
-                (*val1.val_union.i64_vec)[i] + (*val2.val_union.i64_vec)[i];
-        } else {
-          if (val1.type == 3) {
-            p_vec_sum->resize(val2.val_union.i64_vec->size());
-            for (size_t i = 0; i < p_vec_sum->size(); i++)
-              (*p_vec_sum)[i] =
-                  val1.val_union.i64_val + (*val2.val_union.i64_vec)[i];
-          } else {
-            p_vec_sum->resize(val1.val_union.i64_vec->size());
-            for (size_t i = 0; i < p_vec_sum->size(); i++)
-              (*p_vec_sum)[i] =
-                  val2.val_union.i64_val + (*val1.val_union.i64_vec)[i];
-          }
-        }
-        res.val_union.i64_vec = p_vec_sum;
-        res.type = 1;
+    suffix_stk.pop();
+
+    if (mpc_exec_->isOperator(token)) {
+      char op = token[0];
+      if (is_const.size() < 2) {
+        LOG(ERROR) << "Operator '" << op << "' has not enough operand.";
+        return -1;
       }
-      new_token = "(" + a + "+" + b + ")";
-      afterLocalCalculate(stk1, val_stk, new_token, res);
-    } else if (token == "-") {
-      std::string a, b;
-      TokenValue val1, val2, res;
-      std::string new_token;
-      beforeLocalCalculate(stk1, val_stk, val1, val2, a, b);
-      if (mpc_exec_->fp64_run_) {
-        std::vector<double> *p_vec_sub = new std::vector<double>();
-        if (val1.type != 2 && val2.type != 2) {
-          p_vec_sub->resize(val1.val_union.fp64_vec->size());
-          for (size_t i = 0; i < p_vec_sub->size(); i++)
-            (*p_vec_sub)[i] =
-                (*val1.val_union.fp64_vec)[i] - (*val2.val_union.fp64_vec)[i];
-        } else {
-          if (val1.type == 2) {
-            p_vec_sub->resize(val2.val_union.fp64_vec->size());
-            for (size_t i = 0; i < p_vec_sub->size(); i++)
-              (*p_vec_sub)[i] =
-                  val1.val_union.fp64_val - (*val2.val_union.fp64_vec)[i];
-          } else {
-            p_vec_sub->resize(val1.val_union.fp64_vec->size());
-            for (size_t i = 0; i < p_vec_sub->size(); i++)
-              (*p_vec_sub)[i] =
-                  (*val1.val_union.fp64_vec)[i] - val2.val_union.fp64_val;
-          }
-        }
-        res.val_union.fp64_vec = p_vec_sub;
-        res.type = 0;
-      } else {
-        std::vector<int64_t> *p_vec_sub = new std::vector<int64_t>();
-        if (val1.type != 3 && val2.type != 3) {
-          p_vec_sub->resize(val1.val_union.i64_vec->size());
-          for (size_t i = 0; i < p_vec_sub->size(); i++)
-            (*p_vec_sub)[i] =
-                (*val1.val_union.i64_vec)[i] - (*val2.val_union.i64_vec)[i];
-        } else {
-          if (val1.type == 3) {
-            p_vec_sub->resize(val2.val_union.i64_vec->size());
-            for (size_t i = 0; i < p_vec_sub->size(); i++)
-              (*p_vec_sub)[i] =
-                  val1.val_union.i64_val - (*val2.val_union.i64_vec)[i];
-          } else {
-            p_vec_sub->resize(val1.val_union.i64_vec->size());
-            for (size_t i = 0; i < p_vec_sub->size(); i++)
-              (*p_vec_sub)[i] =
-                  (*val1.val_union.i64_vec)[i] - val2.val_union.i64_val;
-          }
-        }
-        res.val_union.i64_vec = p_vec_sub;
-        res.type = 1;
+      if (op == '/' && !fp64_run) {
+        LOG(ERROR) << "Operator '/' is only supported in FP64 run mode.";
+        return -1;
       }
-      new_token = "(" + a + "-" + b + ")";
-      afterLocalCalculate(stk1, val_stk, new_token, res);
-    } else if (token == "*") {
-      std::string a, b;
-      TokenValue val1, val2, res;
-      std::string new_token;
-      beforeLocalCalculate(stk1, val_stk, val1, val2, a, b);
-      if (mpc_exec_->fp64_run_) {
-        std::vector<double> *p_vec_mul = new std::vector<double>();
-        if (val1.type != 2 && val2.type != 2) {
-          p_vec_mul->resize(val1.val_union.fp64_vec->size());
-          for (size_t i = 0; i < p_vec_mul->size(); i++)
-            (*p_vec_mul)[i] =
-                (*val1.val_union.fp64_vec)[i] * (*val2.val_union.fp64_vec)[i];
-        } else {
-          if (val1.type == 2) {
-            p_vec_mul->resize(val2.val_union.fp64_vec->size());
-            for (size_t i = 0; i < p_vec_mul->size(); i++)
-              (*p_vec_mul)[i] =
-                  val1.val_union.fp64_val * (*val2.val_union.fp64_vec)[i];
-          } else {
-            p_vec_mul->resize(val1.val_union.fp64_vec->size());
-            for (size_t i = 0; i < p_vec_mul->size(); i++)
-              (*p_vec_mul)[i] =
-                  (*val1.val_union.fp64_vec)[i] * val2.val_union.fp64_val;
-          }
-        }
-        res.val_union.fp64_vec = p_vec_mul;
-        res.type = 0;
-      } else {
-        std::vector<int64_t> *p_vec_mul = new std::vector<int64_t>();
-        if (val1.type != 3 && val2.type != 3) {
-          p_vec_mul->resize(val1.val_union.i64_vec->size());
-          for (size_t i = 0; i < p_vec_mul->size(); i++)
-            (*p_vec_mul)[i] =
-                (*val1.val_union.i64_vec)[i] * (*val2.val_union.i64_vec)[i];
-        } else {
-          if (val1.type == 3) {
-            p_vec_mul->resize(val2.val_union.i64_vec->size());
-            for (size_t i = 0; i < p_vec_mul->size(); i++)
-              (*p_vec_mul)[i] =
-                  val1.val_union.i64_val * (*val2.val_union.i64_vec)[i];
-          } else {
-            p_vec_mul->resize(val1.val_union.i64_vec->size());
-            for (size_t i = 0; i < p_vec_mul->size(); i++)
-              (*p_vec_mul)[i] =
-                  (*val1.val_union.i64_vec)[i] * val2.val_union.i64_val;
-          }
-        }
-        res.val_union.i64_vec = p_vec_mul;
-        res.type = 1;
+
+      bool b_const = is_const.back();
+      is_const.pop_back();
+      if (b_const && is_const.back()) {
+        LocalInstr b = prog.back();
+        prog.pop_back();
+        LocalInstr &a = prog.back();
+        if (fp64_run)
+          a.fp64_val = foldLocalConstant(op, a.fp64_val, b.fp64_val);
+        else
+          a.i64_val = foldLocalConstant(op, a.i64_val, b.i64_val);
+        continue;
       }
-      new_token = "(" + a + "*" + b + ")";
-      afterLocalCalculate(stk1, val_stk, new_token, res);
-    } else if (token == "/") {
-      std::string a, b;
-      TokenValue val1, val2, res;
-      std::string new_token;
-      beforeLocalCalculate(stk1, val_stk, val1, val2, a, b);
-      std::vector<double> *p_vec_div = new std::vector<double>();
-      if (val1.type != 2 && val2.type != 2) {
-        p_vec_div->resize(val1.val_union.fp64_vec->size());
-        for (size_t i = 0; i < p_vec_div->size(); i++)
-          (*p_vec_div)[i] =
-              (*val1.val_union.fp64_vec)[i] / (*val2.val_union.fp64_vec)[i];
-      } else {
-        if (val1.type == 2) {
-          p_vec_div->resize(val2.val_union.fp64_vec->size());
-          for (size_t i = 0; i < p_vec_div->size(); i++)
-            (*p_vec_div)[i] =
-                val1.val_union.fp64_val / (*val2.val_union.fp64_vec)[i];
+
+      is_const.back() = false;
+      prog.push_back(LocalInstr{op, -1, 0, 0});
+      continue;
+    }
+
+    auto type_iter = mpc_exec_->token_type_map_.find(token);
+    if (type_iter == mpc_exec_->token_type_map_.end()) {
+      LOG(ERROR) << "Can't find type of token '" << token << "'.";
+      return -1;
+    }
+
+    LocalInstr instr{0, -1, 0, 0};
+    if (type_iter->second == MPCExpressExecutor::TokenType::COLUMN) {
+      auto iter = col_index.find(token);
+      if (iter == col_index.end()) {
+        iter = col_index.insert(std::make_pair(token, cols.size())).first;
+        cols.push_back(token);
+      }
+      instr.col = iter->second;
+    } else if (fp64_run) {
+      instr.fp64_val = std::stod(token);
+    } else {
+      instr.i64_val = atol(token.c_str());
+    }
+
+    prog.push_back(instr);
+    is_const.push_back(instr.col < 0);
+    max_depth = std::max(max_depth, is_const.size());
+  }
+
+  if (is_const.size() != 1) {
+    LOG(ERROR) << "Express leaves " << is_const.size()
+               << " values on stack, expect one.";
+    return -1;
+  }
+
+  return 0;
+}
+
+template <typename T>
+int LocalExpressExecutor::runLocalProgram(const std::vector<LocalInstr> &prog,
+                                          const std::vector<std::string> &cols,
+                                          size_t max_depth,
+                                          std::vector<T> &result) {
+  std::vector<const T *> col_vals;
+  size_t count = 0;
+  for (auto &col : cols) {
+    std::vector<T> *p_col_vec = nullptr;
+    if (new_feed->getColumnValues(col, &p_col_vec)) {
+      LOG(ERROR) << "Get column value with token '" << col << "' failed.";
+      return -1;
+    }
+    col_vals.push_back(p_col_vec->data());
+    count = p_col_vec->size();
+  }
+
+  result.resize(count);
+  if (prog.size() == 1) {
+    std::copy(col_vals[0], col_vals[0] + count, result.begin());
+    return 0;
+  }
+
+  // A block of scratch for every depth of the stack, reused by all blocks.
+  // The last operator writes into result directly.
+  std::vector<T> scratch(max_depth * kLocalBlockSize);
+  std::vector<LocalSlot<T>> stk(max_depth);
+
+  for (size_t begin = 0; begin < count; begin += kLocalBlockSize) {
+    size_t n = count - begin;
+    if (n > kLocalBlockSize)
+      n = kLocalBlockSize;
+    size_t top = 0;
+    for (size_t pc = 0; pc < prog.size(); pc++) {
+      const LocalInstr &instr = prog[pc];
+      if (instr.op == 0) {
+        LocalSlot<T> &slot = stk[top++];
+        if (instr.col >= 0) {
+          slot.vec = col_vals[instr.col] + begin;
         } else {
-          p_vec_div->resize(val1.val_union.fp64_vec->size());
-          for (size_t i = 0; i < p_vec_div->size(); i++)
-            (*p_vec_div)[i] =
-                (*val1.val_union.fp64_vec)[i] / val2.val_union.fp64_val;
+          slot.vec = nullptr;
+          slot.val = std::is_same<T, double>::value
+                         ? static_cast<T>(instr.fp64_val)
+                         : static_cast<T>(instr.i64_val);
         }
+        continue;
       }
-      res.val_union.fp64_vec = p_vec_div;
-      res.type = 0;
-      new_token = "(" + a + "/" + b + ")";
-      afterLocalCalculate(stk1, val_stk, new_token, res);
-    } else {
-      stk1.push(token);
-      suffix_stk.pop();
-      TokenValue token_val;
-      if (createTokenValue(token, token_val)) {
-        LOG(ERROR) << "Construct token value for token '" << token
-                   << "' failed.";
-        return -1;
+
+      top--;
+      LocalSlot<T> &a = stk[top - 1];
+      const LocalSlot<T> &b = stk[top];
+      T *out = (pc + 1 == prog.size())
+                   ? result.data() + begin
+                   : scratch.data() + (top - 1) * kLocalBlockSize;
+
+      switch (instr.op) {
+      case '+':
+        runLocalKernel(a, b, out, n, [](T x, T y) { return x + y; });
+        break;
+      case '-':
+        runLocalKernel(a, b, out, n, [](T x, T y) { return x - y; });
+        break;
+      case '*':
+        runLocalKernel(a, b, out, n, [](T x, T y) { return x * y; });
+        break;
+      default:
+        runLocalKernel(a, b, out, n, [](T x, T y) { return x / y; });
+        break;
       }
-      val_stk.push(token_val);
-      token_val_map_[token] = token_val;
+      a.vec = out;
     }
   }
-  while (!stk1.empty()) {
-    suffix_stk.push(stk1.top());
-    stk1.pop();
+
+  return 0;
+}
+
+int LocalExpressExecutor::runLocalEvaluate() {
+  std::string expr = mpc_exec_->expr_;
+  LOG(INFO) << expr;
+  while (!mpc_exec_->suffix_stk_.empty())
+    mpc_exec_->suffix_stk_.pop();
+  mpc_exec_->parseExpress(expr);
+
+  // The express is compiled into a postfix program once, then the whole
+  // program runs over one block of rows at a time, so intermediate values
+  // never leave the cache and no memory is allocated per operator.
+  std::vector<LocalInstr> prog;
+  std::vector<std::string> cols;
+  size_t max_depth = 0;
+  if (compileLocalProgram(prog, cols, max_depth)) {
+    LOG(ERROR) << "Compile express '" << expr << "' failed.";
+    return -1;
   }
-  string final_token = suffix_stk.top();
-  suffix_stk.pop();
-  TokenValue finalVal = token_val_map_[final_token];
-  if (finalVal.type == 0)
-    for (int i = 0; i < finalVal.val_union.fp64_vec->size(); i++) {
-      final_val_double.push_back((*finalVal.val_union.fp64_vec)[i]);
-    }
+
+  if (cols.empty()) {
+    LOG(ERROR) << "Express '" << expr << "' has no column.";
+    return -1;
+  }
+
+  int ret;
+  if (mpc_exec_->fp64_run_)
+    ret = runLocalProgram(prog, cols, max_depth, final_val_double);
   else
-    for (int i = 0; i < finalVal.val_union.i64_vec->size(); i++) {
-      final_val_int64.push_back((*finalVal.val_union.i64_vec)[i]);
-    }
-  // return
+    ret = runLocalProgram(prog, cols, max_depth, final_val_int64);
+
+  if (ret) {
+    LOG(ERROR) << "Evaluate express '" << expr << "' failed.";
+    return -1;
+  }
+
   return 0;
 }
 
@@ -1572,52 +1695,9 @@ void LocalExpressExecutor::creatNewFeedDict() {
       new MPCExpressExecutor::FeedDict(new_col_cfg, mpc_exec_->fp64_run_);
 }
 
-int LocalExpressExecutor::createTokenValue(
-    const std::string &token, MPCExpressExecutor::TokenValue &token_val) {
-  MPCExpressExecutor::TokenType type = mpc_exec_->token_type_map_[token];
-  if (type == MPCExpressExecutor::TokenType::COLUMN) {
-    if (mpc_exec_->fp64_run_) {
-      if (new_feed->getColumnValues(token, &(token_val.val_union.fp64_vec))) {
-        LOG(ERROR) << "Get column value with token '" << token << "' failed.";
-        return -1;
-      }
-      token_val.type = 0;
-    } else {
-      if (new_feed->getColumnValues(token, &(token_val.val_union.i64_vec))) {
-        LOG(ERROR) << "Get column value with token '" << token << "' failed.";
-        return -1;
-      }
-      token_val.type = 1;
-    }
-  } else {
-    if (mpc_exec_->fp64_run_) {
-      token_val.val_union.fp64_val = std::stod(token);
-      token_val.type = 2;
-    } else {
-      token_val.val_union.i64_val = atol(token.c_str());
-      token_val.type = 3;
-    }
-  }
-  return 0;
-}
-
 LocalExpressExecutor::~LocalExpressExecutor() {
-  for (auto iter = token_val_map_.begin(); iter != token_val_map_.end();
-       iter++) {
-    switch (iter->second.type) {
-    case 5:
-      delete iter->second.val_union.sh_fp64_m;
-      break;
-    case 6:
-      delete iter->second.val_union.sh_i64_m;
-      break;
-    default:
-      break;
-    }
-  }
   delete new_feed;
   delete new_col_cfg;
-  token_val_map_.clear();
 }
 
 } // namespace primihub
@@ -6,6 +6,7 @@
 #include <map>
 #include <stack>
 #include <string>
+#include <vector>
 
 #include "src/primihub/operator/aby3_operator.h"
 
@@ -46,7 +47,8 @@ public:
   // Method group 5: Init MPC operator.
   void initMPCRuntime(uint32_t party_id, const std::string &next_ip,
                       const std::string &prev_ip, uint16_t next_port,
-                      uint16_t prev_port);
+                      uint16_t prev_port,
+                      const std::string &channel_name = "");
 
   // Method group 6: Execute express with MPC protocol.
   int runMPCEvaluate(void);
@@ -202,14 +204,6 @@ private:
 
   inline void createFP64Shares(TokenValue &val, sf64Matrix<D> &sh_val);
 
-  inline void BeforeMPCRun(std::stack<std::string> &token_stk,
-                           std::stack<TokenValue> &val_stk, TokenValue &val1,
-                           TokenValue &val2, std::string &a, std::string &b);
-
-  inline void AfterMPCRun(std::stack<std::string> &token_stk,
-                          std::stack<TokenValue> &val_stk,
-                          std::string &new_token, TokenValue &res);
-
   void runMPCAddFP64(TokenValue &val1, TokenValue &val2, TokenValue &res);
 
   void runMPCAddI64(TokenValue &val1, TokenValue &val2, TokenValue &res);
@@ -224,6 +218,27 @@ private:
 
   void runMPCDivFP64(TokenValue &val1, TokenValue &val2, TokenValue &res);
 
+  // A node of the operator DAG compiled from the suffix express, identical
+  // sub-expresses share one node. token is the canonical text of the node
+  // and the key of its value in token_val_map_.
+  struct ExprNode {
+    char op; // '+', '-', '*', '/', or 0 for a column or a constant.
+    std::string token;
+    int64_t lhs;
+    int64_t rhs;
+    uint32_t depth;
+  };
+
+  int buildExprDAG(std::vector<ExprNode> &nodes, int64_t &root);
+
+  // Create shares of every column in one batch of MPC tasks.
+  int createInputShares(std::vector<ExprNode> &nodes);
+
+  // Start the operation of nodes[index], an operation which communicates
+  // is appended to tasks and finishes once the task is done.
+  int scheduleMPCOp(std::vector<ExprNode> &nodes, int64_t index,
+                    std::vector<Sh3Task> &tasks);
+
   bool isOperator(const char op);
   bool isOperator(const std::string &op);
   int Priority(const char str);
@@ -275,15 +290,31 @@ public:
   }
 
 private:
-  // using I64StackType = std::stack<std::vector<int64_t> *>;
-  // using FP64StackType = std::stack<std::vector<double> *>;
+  // Rows evaluated per pass of the program, a block of every temporary
+  // stays in L1/L2 cache while all operators of the express run over it.
+  static const size_t kLocalBlockSize = 2048;
+
+  // One step of the postfix program compiled from the express. An operand
+  // step pushes a column or a constant, an operator step pops two values
+  // and pushes its result.
+  struct LocalInstr {
+    char op;     // '+', '-', '*', '/', or 0 for an operand.
+    int32_t col; // index into the program's columns, -1 for a constant.
+    double fp64_val;
+    int64_t i64_val;
+  };
 
   void createNewColumnConfig();
 
   void creatNewFeedDict();
 
-  int createTokenValue(const std::string &token,
-                       MPCExpressExecutor::TokenValue &token_val);
+  int compileLocalProgram(std::vector<LocalInstr> &prog,
+                          std::vector<std::string> &cols, size_t &max_depth);
+
+  template <typename T>
+  int runLocalProgram(const std::vector<LocalInstr> &prog,
+                      const std::vector<std::string> &cols, size_t max_depth,
+                      std::vector<T> &result);
 
   template <typename T>
   void importColumnValues(std::map<std::string, std::vector<T>> &col_and_val) {
@@ -292,24 +323,7 @@ private:
     return;
   }
 
-  inline void
-  beforeLocalCalculate(std::stack<std::string> &token_stk,
-                       std::stack<MPCExpressExecutor::TokenValue> &val_stk,
-                       MPCExpressExecutor::TokenValue &val1,
-                       MPCExpressExecutor::TokenValue &val2, std::string &a,
-                       std::string &b);
-
-  inline void
-  afterLocalCalculate(std::stack<std::string> &token_stk,
-                      std::stack<MPCExpressExecutor::TokenValue> &val_stk,
-                      std::string &new_token,
-                      MPCExpressExecutor::TokenValue &res);
-
-  // std::map<std::string, std::vector<int64_t> *> i64_token_val_map_;
-  // std::map<std::string, std::vector<double> *> fp64_token_val_map_;
-
   MPCExpressExecutor *mpc_exec_;
-  std::map<std::string, MPCExpressExecutor::TokenValue> token_val_map_;
   MPCExpressExecutor::FeedDict *new_feed;
   MPCExpressExecutor::ColumnConfig *new_col_cfg;
   std::vector<double> final_val_double;
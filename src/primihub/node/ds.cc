@@ -40,7 +40,10 @@ namespace primihub {
         }
 
         DatasetMeta mate;
-        auto dataset = dataset_service_->newDataset(driver, fid, mate);
+        if (dataset_service_->registerDataset(driver, fid, mate) != 0) {
+            response->set_ret_code(2);
+            return grpc::Status::OK;
+        }
 
         response->set_ret_code(0);
         response->set_dataset_url(mate.getDataURL());
@@ -31,6 +31,8 @@
 #include "src/primihub/service/dataset/util.hpp"
 #include "src/primihub/task/language/factory.h"
 #include "src/primihub/task/semantic/parser.h"
+#include "src/primihub/task/semantic/psi_setup_cache.h"
+#include "src/primihub/task/semantic/result_sync.h"
 #include "src/primihub/util/file_util.h"
 
 using grpc::Server;
@@ -45,6 +47,18 @@ ABSL_FLAG(std::string, node_id, "node0", "unique node_id");
 ABSL_FLAG(std::string, config, "./config/node.yaml", "config file");
 ABSL_FLAG(bool, singleton, false, "singleton mode"); // TODO: remove this flag
 ABSL_FLAG(int, service_port, 50050, "node service port");
+ABSL_FLAG(int, max_worker_tasks, 0,
+          "max running worker tasks, 0 means one per core");
+ABSL_FLAG(int, max_server_tasks, 0,
+          "max running psi/pir server tasks of each kind, 0 means one per core");
+ABSL_FLAG(int, max_queued_tasks, 64, "max tasks waiting to run");
+ABSL_FLAG(int, task_queue_timeout, 60, "seconds a task waits to run");
+ABSL_FLAG(std::string, psi_setup_cache_dir, "/tmp/primihub/psi_setup",
+          "directory of precomputed psi server setups");
+ABSL_FLAG(int64_t, psi_key_epoch, 0,
+          "bump to rotate the psi server key of precomputed setups");
+ABSL_FLAG(int, psi_setup_cache_entries, 16,
+          "max psi server setups kept in memory");
 
 namespace primihub {
 Status VMNodeImpl::Send(ServerContext* context,
@@ -56,11 +70,15 @@ Status VMNodeImpl::Send(ServerContext* context,
     std::string task_id;
     int storage_type{-1};
     std::string storage_info;
-    std::vector<std::string> recv_data;
-    VLOG(5) << "VMNodeImpl::Send: received xxx: ";
+    // every chunk goes to disk as soon as it is read, the next chunk is
+    // not read before, which pushes back on the sender through the stream.
+    primihub::task::ResultFileWriter result_writer;
+    bool finished{false};
+    int64_t num_rows{0};
+    uint64_t checksum{0};
+    int ret{0};
     TaskRequest request;
     while (reader->Read(&request)) {
-        VLOG(5) << "read finised";
         if (!recv_meta_info) {
             job_id = request.job_id();
             task_id = request.task_id();
@@ -71,38 +89,32 @@ Status VMNodeImpl::Send(ServerContext* context,
                     << "task_id: " << task_id << " "
                     << "storage_type: " << storage_type << " "
                     << "storage_info: " << storage_info;
+            if (storage_type == primihub::rpc::TaskRequest::FILE) {
+                ret = result_writer.open(storage_info);
+            }
         }
-        auto item_size = request.data().size();
-        VLOG(5) << "item_size: " << item_size;
-        for (size_t i = 0; i < item_size; i++) {
-            recv_data.push_back(request.data(i));
+        VLOG(5) << "item_size: " << request.data().size();
+        if (ret == 0 && storage_type == primihub::rpc::TaskRequest::FILE) {
+            ret = result_writer.append(request);
+        }
+        if (request.finished()) {
+            finished = true;
+            num_rows = request.num_rows();
+            checksum = request.checksum();
         }
     }
 
-    if (storage_type == primihub::rpc::TaskRequest::FILE) {
-        std::string data_path = storage_info;
-        save_data_to_file(data_path, std::move(recv_data));
+    if (ret == 0 && recv_meta_info &&
+        storage_type == primihub::rpc::TaskRequest::FILE) {
+        ret = result_writer.finish(finished, num_rows, checksum);
     }
     VLOG(5) << "end of read data from client";
-    response->set_ret_code(primihub::rpc::retcode::SUCCESS);
-    return Status::OK;
-}
-
-int VMNodeImpl::save_data_to_file(const std::string& data_path, std::vector<std::string>&& save_data) {
-    if (ValidateDir(data_path)) {
-        LOG(ERROR) << "file path is not exist, please check";
-        return -1;
-    }
-    auto data = std::move(save_data);
-    if (data.empty()) {
-        return 0;
-    }
-    std::ofstream in_fs(data_path, std::ios::out);
-    for (const auto& data_item : data) {
-        in_fs << data_item << "\n";
+    if (ret) {
+        response->set_ret_code(primihub::rpc::retcode::FAIL);
+    } else {
+        response->set_ret_code(primihub::rpc::retcode::SUCCESS);
     }
-    in_fs.close();
-    return 0;
+    return Status::OK;
 }
 
 Status VMNodeImpl::SubmitTask(ServerContext *context,
@@ -116,10 +128,30 @@ Status VMNodeImpl::SubmitTask(ServerContext *context,
     std::string job_task = pushTaskRequest->task().job_id() + pushTaskRequest->task().task_id();
     pushTaskReply->set_job_id(pushTaskRequest->task().job_id());
 
-    // if (running_set.find(job_task) != running_set.end()) {
-    //     pushTaskReply->set_ret_code(1);
-    //     return Status::OK;
-    // }
+    auto task_type = pushTaskRequest->task().type();
+    TaskClass task_class = TaskClass::WORKER;
+    if (task_type == primihub::rpc::TaskType::ACTOR_TASK ||
+        task_type == primihub::rpc::TaskType::TEE_TASK ||
+        task_type == primihub::rpc::TaskType::PIR_TASK ||
+        task_type == primihub::rpc::TaskType::PSI_TASK) {
+        task_class = TaskClass::SCHEDULE;
+    }
+    int priority = 0;
+    const auto &param_map = pushTaskRequest->task().params().param_map();
+    auto priority_it = param_map.find("taskPriority");
+    if (priority_it != param_map.end()) {
+        priority = priority_it->second.value_int32();
+    }
+    // a scheduler may dispatch a task with the same ids back to this node,
+    // so pushed tasks are not checked for duplicates.
+    std::unique_ptr<TaskExecutor::Slot> slot;
+    auto admission = task_executor.admit("", task_class, priority, &slot);
+    if (admission != TaskExecutor::Admission::ADMITTED) {
+        // 1: doing  2: error
+        pushTaskReply->set_ret_code(
+            admission == TaskExecutor::Admission::DUPLICATE ? 1 : 2);
+        return Status::OK;
+    }
 
     // actor
     if (pushTaskRequest->task().type() == primihub::rpc::TaskType::ACTOR_TASK ||
@@ -145,14 +177,17 @@ Status VMNodeImpl::SubmitTask(ServerContext *context,
     } else if (pushTaskRequest->task().type() == primihub::rpc::TaskType::PIR_TASK ||
             pushTaskRequest->task().type() == primihub::rpc::TaskType::PSI_TASK) {
         LOG(INFO) << "start to schedule schedule task";
-        absl::MutexLock lock(&parser_mutex_);
-        std::shared_ptr<LanguageParser> lan_parser_ =
-            LanguageParserFactory::Create(*pushTaskRequest);
-        if (lan_parser_ == nullptr) {
-            pushTaskReply->set_ret_code(1);
-            return Status::OK;
+        std::shared_ptr<LanguageParser> lan_parser_;
+        {
+            // only parsing is serialized, the jobs are scheduled concurrently
+            absl::MutexLock lock(&parser_mutex_);
+            lan_parser_ = LanguageParserFactory::Create(*pushTaskRequest);
+            if (lan_parser_ == nullptr) {
+                pushTaskReply->set_ret_code(1);
+                return Status::OK;
+            }
+            lan_parser_->parseDatasets();
         }
-        lan_parser_->parseDatasets();
 
         // Construct protocol semantic parser
         auto _psp = ProtocolSemanticParser(this->node_id, this->singleton,
@@ -168,10 +203,8 @@ Status VMNodeImpl::SubmitTask(ServerContext *context,
         VLOG(5) << "end schedule schedule task for type: " << _type;
     } else {
         LOG(INFO) << "start to create worker for task";
-        running_set.insert(job_task);
         std::shared_ptr<Worker> worker = CreateWorker();
         worker->execute(pushTaskRequest);
-        running_set.erase(job_task);
     }
     return Status::OK;
 }
@@ -185,41 +218,62 @@ Status VMNodeImpl::ExecuteTask(ServerContext *context,
                                const ExecuteTaskRequest *taskRequest,
                                ExecuteTaskResponse *taskResponse) {
     std::string job_task = "";
-    primihub::rpc::TaskType taskType;
+    TaskClass task_class;
     if (taskRequest->algorithm_request_case() ==
         ExecuteTaskRequest::AlgorithmRequestCase::kPsiRequest) {
-        taskType = primihub::rpc::TaskType::NODE_PSI_TASK;
+        task_class = TaskClass::PSI_SERVER;
         job_task = taskRequest->psi_request().job_id() +
                    taskRequest->psi_request().task_id();
-        if (running_set.find(job_task) != running_set.end()) {
-            taskResponse->mutable_psi_response()->set_ret_code(1);
-            return Status::OK;
-        }
     } else if (taskRequest->algorithm_request_case() ==
                ExecuteTaskRequest::AlgorithmRequestCase::kPirRequest) {
-        taskType = primihub::rpc::TaskType::NODE_PIR_TASK;
+        task_class = TaskClass::PIR_SERVER;
         job_task = taskRequest->pir_request().job_id() +
                    taskRequest->pir_request().task_id();
-        if (running_set.find(job_task) != running_set.end()) {
-            taskResponse->mutable_pir_response()->set_ret_code(1);
-            return Status::OK;
+    } else {
+        return Status::OK;
+    }
+
+    std::unique_ptr<TaskExecutor::Slot> slot;
+    auto admission = task_executor.admit(job_task, task_class, 0, &slot);
+    if (admission != TaskExecutor::Admission::ADMITTED) {
+        // 1: doing  2: error
+        int ret_code = admission == TaskExecutor::Admission::DUPLICATE ? 1 : 2;
+        if (task_class == TaskClass::PSI_SERVER) {
+            taskResponse->mutable_psi_response()->set_ret_code(ret_code);
+        } else {
+            taskResponse->mutable_pir_response()->set_ret_code(ret_code);
         }
+        return Status::OK;
     }
 
-    if (taskType == primihub::rpc::TaskType::NODE_PSI_TASK ||
-        taskType == primihub::rpc::TaskType::NODE_PIR_TASK) {
-        LOG(INFO) << "Start to create PSI/PIR server task";
-        running_set.insert(job_task);
-        std::shared_ptr<Worker> worker = CreateWorker();
-        running_map.insert({job_task, worker});
-        worker->execute(taskRequest, taskResponse);
-        running_map.erase(job_task);
-        running_set.erase(job_task);
+    LOG(INFO) << "Start to create PSI/PIR server task";
+    std::shared_ptr<Worker> worker = CreateWorker();
+    worker->execute(taskRequest, taskResponse);
+    return Status::OK;
+}
 
-        return Status::OK;
-    } else {
+Status VMNodeImpl::ExecutePsiStream(ServerContext *context,
+        ServerReaderWriter<PsiStreamResponse, PsiStreamRequest> *stream) {
+    PsiStreamRequest first_request;
+    if (!stream->Read(&first_request)) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT,
+                      "psi stream closed before the first request");
+    }
+    std::string job_task = first_request.job_id() + first_request.task_id();
+    std::unique_ptr<TaskExecutor::Slot> slot;
+    auto admission = task_executor.admit(job_task, TaskClass::PSI_SERVER, 0, &slot);
+    if (admission != TaskExecutor::Admission::ADMITTED) {
+        PsiStreamResponse response;
+        response.set_ret_code(
+            admission == TaskExecutor::Admission::DUPLICATE ? 1 : 2);
+        stream->Write(response);
         return Status::OK;
     }
+
+    LOG(INFO) << "Start to create PSI server stream task";
+    std::shared_ptr<Worker> worker = CreateWorker();
+    worker->executePsiStream(stream, &first_request);
+    return Status::OK;
 }
 
 std::shared_ptr<Worker> VMNodeImpl::CreateWorker() {
@@ -304,9 +358,49 @@ int main(int argc, char **argv) {
     int service_port = absl::GetFlag(FLAGS_service_port);
     std::string config_file = absl::GetFlag(FLAGS_config);
 
+    // the limits end up as size_t, a negative flag would wrap to a huge
+    // limit, so refuse to start instead. 0 means one per core for the
+    // running task limits only.
+    int max_worker_flag = absl::GetFlag(FLAGS_max_worker_tasks);
+    int max_server_flag = absl::GetFlag(FLAGS_max_server_tasks);
+    int max_queued_flag = absl::GetFlag(FLAGS_max_queued_tasks);
+    int queue_timeout_flag = absl::GetFlag(FLAGS_task_queue_timeout);
+    int psi_cache_entries_flag = absl::GetFlag(FLAGS_psi_setup_cache_entries);
+    if (max_worker_flag < 0 || max_server_flag < 0) {
+        LOG(ERROR) << "--max_worker_tasks and --max_server_tasks must be >= 0, "
+                   << "got " << max_worker_flag << " and " << max_server_flag;
+        return EXIT_FAILURE;
+    }
+    if (max_queued_flag <= 0 || queue_timeout_flag <= 0 ||
+        psi_cache_entries_flag <= 0) {
+        LOG(ERROR) << "--max_queued_tasks, --task_queue_timeout and "
+                   << "--psi_setup_cache_entries must be > 0, got "
+                   << max_queued_flag << ", " << queue_timeout_flag
+                   << " and " << psi_cache_entries_flag;
+        return EXIT_FAILURE;
+    }
+
+    primihub::TaskExecutorOptions executor_options;
+    size_t max_worker_tasks = static_cast<size_t>(max_worker_flag);
+    size_t max_server_tasks = static_cast<size_t>(max_server_flag);
+    executor_options.class_limits = {{
+        0,  // scheduling, one per core
+        max_worker_tasks,
+        max_server_tasks,
+        max_server_tasks,
+    }};
+    executor_options.max_queued = static_cast<size_t>(max_queued_flag);
+    executor_options.max_wait = std::chrono::seconds(queue_timeout_flag);
+
+    primihub::task::PsiSetupCache::getInstance().configure(
+        absl::GetFlag(FLAGS_psi_setup_cache_dir),
+        absl::GetFlag(FLAGS_psi_key_epoch),
+        static_cast<size_t>(psi_cache_entries_flag));
+
     std::string node_ip = "0.0.0.0";
     node_service = new primihub::VMNodeImpl(node_id, node_ip, service_port,
-                                            singleton, config_file);
+                                            singleton, config_file,
+                                            executor_options);
     data_service = new primihub::DataServiceImpl(
         node_service->getNodelet()->getDataService(),
         node_service->getNodelet()->getNodeletAddr());
@@ -41,6 +41,7 @@
 
 #include "src/primihub/common/config/config.h"
 #include "src/primihub/node/nodelet.h"
+#include "src/primihub/node/task_executor.h"
 
 #include "src/primihub/node/worker/worker.h"
 #include "src/primihub/protos/psi.grpc.pb.h"
@@ -68,6 +69,8 @@ using primihub::rpc::PirRequest;
 using primihub::rpc::PirResponse;
 using primihub::rpc::PsiRequest;
 using primihub::rpc::PsiResponse;
+using primihub::rpc::PsiStreamRequest;
+using primihub::rpc::PsiStreamResponse;
 using primihub::rpc::PushTaskReply;
 using primihub::rpc::PushTaskRequest;
 
@@ -83,10 +86,11 @@ class VMNodeImpl final: public VMNode::Service {
   public:
     explicit VMNodeImpl(const std::string &node_id_,
                         const std::string &node_ip_, int service_port_,
-                        bool singleton_, const std::string &config_file_path_)
+                        bool singleton_, const std::string &config_file_path_,
+                        const TaskExecutorOptions &executor_options = TaskExecutorOptions())
         : node_id(node_id_), node_ip(node_ip_), service_port(service_port_),
-          singleton(singleton_), config_file_path(config_file_path_) {
-        running_set.clear();
+          singleton(singleton_), config_file_path(config_file_path_),
+          task_executor(executor_options) {
         nodelet = std::make_shared<Nodelet>(config_file_path);
     }
     ~VMNodeImpl() override {
@@ -100,6 +104,8 @@ class VMNodeImpl final: public VMNode::Service {
     Status ExecuteTask(ServerContext *context,
                        const ExecuteTaskRequest *taskRequest,
                        ExecuteTaskResponse *taskResponse) override;
+    Status ExecutePsiStream(ServerContext *context,
+                            ServerReaderWriter<PsiStreamResponse, PsiStreamRequest> *stream) override;
     Status Send(ServerContext* context,
                 ServerReader<TaskRequest>* reader,
                 TaskResponse* response) override;
@@ -114,7 +120,6 @@ class VMNodeImpl final: public VMNode::Service {
 
     std::shared_ptr<Nodelet> getNodelet() { return this->nodelet; }
  protected:
-    int save_data_to_file(const std::string& data_path, std::vector<std::string>&& save_data);
     int validate_file_path(const std::string& data_path) { return 0;}
   private:
     std::unordered_map<std::string, std::shared_ptr<Worker>>
@@ -130,8 +135,8 @@ class VMNodeImpl final: public VMNode::Service {
     // PeerDatasetMap peer_dataset_map;
     // std::shared_ptr<LanguageParser> lan_parser_;
     bool singleton;
-    std::set<std::string> running_set;
-    std::map<std::string, std::shared_ptr<Worker>> running_map;
+    // admission control and tracking of the tasks running on this node
+    TaskExecutor task_executor;
 
     std::shared_ptr<Nodelet> nodelet;
     std::string config_file_path;
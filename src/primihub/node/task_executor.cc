@@ -0,0 +1,107 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "src/primihub/node/task_executor.h"
+
+#include <glog/logging.h>
+
+#include "src/primihub/util/parallel.h"
+
+namespace primihub {
+
+TaskExecutor::TaskExecutor(const TaskExecutorOptions& options)
+    : class_limits_(options.class_limits), max_queued_(options.max_queued),
+      max_wait_(options.max_wait) {
+    for (auto& limit : class_limits_) {
+        if (limit == 0) {
+            limit = DefaultWorkerNum();
+        }
+    }
+}
+
+TaskExecutor::Admission TaskExecutor::admit(const std::string& job_task,
+                                            TaskClass cls, int priority,
+                                            std::unique_ptr<Slot>* slot) {
+    size_t index = static_cast<size_t>(cls);
+    std::unique_lock<std::mutex> lck(mtx_);
+    if (!job_task.empty() && job_tasks_.count(job_task)) {
+        return Admission::DUPLICATE;
+    }
+    WaitKey key{-priority, next_seq_++};
+    if (waiting_[index].empty() && num_running_[index] < class_limits_[index]) {
+        num_running_[index]++;
+        job_tasks_.insert(job_task);
+        slot->reset(new Slot(this, job_task, cls));
+        return Admission::ADMITTED;
+    }
+    if (num_queued_ >= max_queued_) {
+        LOG(WARNING) << "Task queue is full, reject task " << job_task;
+        return Admission::BUSY;
+    }
+
+    VLOG(5) << "queue task " << job_task << " of class " << index
+            << ", running: " << num_running_[index];
+    waiting_[index].insert(key);
+    num_queued_++;
+    job_tasks_.insert(job_task);
+    bool ready = cv_.wait_for(lck, max_wait_,
+                              [&]() { return isNext(cls, key); });
+    waiting_[index].erase(key);
+    num_queued_--;
+    if (!ready) {
+        job_tasks_.erase(job_tasks_.find(job_task));
+        // the waiters behind this one may be able to start now
+        cv_.notify_all();
+        LOG(WARNING) << "Task " << job_task << " waited more than "
+                     << max_wait_.count() << "ms, reject it";
+        return Admission::BUSY;
+    }
+    num_running_[index]++;
+    slot->reset(new Slot(this, job_task, cls));
+    return Admission::ADMITTED;
+}
+
+bool TaskExecutor::isNext(TaskClass cls, const WaitKey& key) {
+    size_t index = static_cast<size_t>(cls);
+    return num_running_[index] < class_limits_[index] &&
+           *waiting_[index].begin() == key;
+}
+
+void TaskExecutor::release(const std::string& job_task, TaskClass cls) {
+    {
+        std::lock_guard<std::mutex> lck(mtx_);
+        num_running_[static_cast<size_t>(cls)]--;
+        job_tasks_.erase(job_tasks_.find(job_task));
+    }
+    cv_.notify_all();
+}
+
+bool TaskExecutor::isRunning(const std::string& job_task) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return job_tasks_.count(job_task) > 0;
+}
+
+size_t TaskExecutor::numRunning(TaskClass cls) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return num_running_[static_cast<size_t>(cls)];
+}
+
+size_t TaskExecutor::numQueued() {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return num_queued_;
+}
+
+}  // namespace primihub
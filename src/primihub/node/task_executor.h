@@ -0,0 +1,115 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef SRC_PRIMIHUB_NODE_TASK_EXECUTOR_H_
+#define SRC_PRIMIHUB_NODE_TASK_EXECUTOR_H_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace primihub {
+
+// Kinds of work a node runs for its rpc handlers. Every class has its own
+// concurrency limit, so a task blocked on a peer task of another class,
+// e.g. a psi client waiting for the psi server on the same node, can never
+// be starved by it.
+enum class TaskClass : int {
+    SCHEDULE = 0,    // parse and dispatch a job to the nodes
+    WORKER = 1,      // tasks pushed by a scheduler through SubmitTask
+    PSI_SERVER = 2,  // ExecuteTask / ExecutePsiStream for psi
+    PIR_SERVER = 3,  // ExecuteTask for pir
+};
+constexpr size_t kNumTaskClass = 4;
+
+struct TaskExecutorOptions {
+    // max running tasks of every class, 0 means one per core
+    std::array<size_t, kNumTaskClass> class_limits{{0, 0, 0, 0}};
+    // max tasks waiting for a slot over all classes, more are rejected
+    size_t max_queued{64};
+    // a queued task is rejected if it can't start within max_wait
+    std::chrono::milliseconds max_wait{std::chrono::seconds(60)};
+};
+
+// Admission control and job tracking of a node. Handlers acquire a slot
+// before running a task and hold it until the task is done, waiting
+// tasks of a class are started by priority, then by arrival.
+class TaskExecutor {
+public:
+    enum class Admission {
+        ADMITTED,
+        DUPLICATE,  // a task with the same id is running or queued
+        BUSY,       // queue is full or max_wait expired
+    };
+
+    // Running slot of a task, released on destruction.
+    class Slot {
+    public:
+        ~Slot() { executor_->release(job_task_, cls_); }
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+    private:
+        friend class TaskExecutor;
+        Slot(TaskExecutor* executor, std::string job_task, TaskClass cls)
+            : executor_(executor), job_task_(std::move(job_task)), cls_(cls) {}
+        TaskExecutor* executor_;
+        std::string job_task_;
+        TaskClass cls_;
+    };
+
+    explicit TaskExecutor(const TaskExecutorOptions& options = TaskExecutorOptions());
+
+    // Block until the task may run, on ADMITTED slot holds its slot.
+    // An empty job_task is never treated as duplicate.
+    Admission admit(const std::string& job_task, TaskClass cls, int priority,
+                    std::unique_ptr<Slot>* slot);
+
+    bool isRunning(const std::string& job_task);
+    size_t numRunning(TaskClass cls);
+    size_t numQueued();
+
+private:
+    // waiting order, higher priority first then arrival
+    using WaitKey = std::pair<int, uint64_t>;
+
+    void release(const std::string& job_task, TaskClass cls);
+    bool isNext(TaskClass cls, const WaitKey& key);
+
+    std::array<size_t, kNumTaskClass> class_limits_;
+    size_t max_queued_;
+    std::chrono::milliseconds max_wait_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::array<size_t, kNumTaskClass> num_running_{};
+    std::array<std::set<WaitKey>, kNumTaskClass> waiting_;
+    size_t num_queued_{0};
+    uint64_t next_seq_{0};
+    // job ids of running and queued tasks
+    std::multiset<std::string> job_tasks_;
+};
+
+}  // namespace primihub
+
+#endif  // SRC_PRIMIHUB_NODE_TASK_EXECUTOR_H_
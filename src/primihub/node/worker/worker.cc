@@ -156,4 +156,18 @@ void Worker::execute(const ExecuteTaskRequest *taskRequest,
     }
 }
 
+int Worker::executePsiStream(
+        grpc::ServerReaderWriter<rpc::PsiStreamResponse, rpc::PsiStreamRequest> *stream,
+        rpc::PsiStreamRequest *first_request) {
+    auto dataset_service = nodelet->getDataService();
+    auto psi_task = std::make_shared<task::PSIServerTask>(this->node_id,
+                                                          first_request->params(),
+                                                          dataset_service);
+    int ret = psi_task->executeStream(stream, *first_request);
+    if (ret != 0) {
+        LOG(ERROR) << "Error occurs during server node execute psi stream.";
+    }
+    return ret;
+}
+
 } // namespace primihub
@@ -70,6 +70,11 @@ class Worker {
     void execute(const ExecuteTaskRequest *taskRequest,
                  ExecuteTaskResponse *taskResponse);
 
+    // first_request is the first message already read from stream.
+    int executePsiStream(
+        grpc::ServerReaderWriter<rpc::PsiStreamResponse, rpc::PsiStreamRequest> *stream,
+        rpc::PsiStreamRequest *first_request);
+
  private:
   std::unordered_map<std::string, std::shared_ptr<Worker>> workers_
         GUARDED_BY(worker_map_mutex_);
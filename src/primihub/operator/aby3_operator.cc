@@ -1,45 +1,39 @@
 #include "src/primihub/operator/aby3_operator.h"
 #include <glog/logging.h>
 
+#include "src/primihub/util/parallel.h"
+
 namespace primihub {
 int MPCOperator::setup(std::string next_ip, std::string prev_ip, u32 next_port,
-                       u32 prev_port) {
+                       u32 prev_port, const std::string &channel_name) {
   CommPkg comm = CommPkg();
-  Session ep_next_;
-  Session ep_prev_;
+  SessionMode next_mode, prev_mode;
 
   switch (partyIdx) {
   case 0:
-    ep_next_.start(ios, next_ip, next_port, SessionMode::Server, next_name);
-    ep_prev_.start(ios, prev_ip, prev_port, SessionMode::Server, prev_name);
-
-    VLOG(3) << "Start server session, listen port " << next_port << ".";
-    VLOG(3) << "Start server session, listen port " << prev_port << ".";
-
+    next_mode = SessionMode::Server;
+    prev_mode = SessionMode::Server;
     break;
   case 1:
-    ep_next_.start(ios, next_ip, next_port, SessionMode::Server, next_name);
-    ep_prev_.start(ios, prev_ip, prev_port, SessionMode::Client, prev_name);
-
-    VLOG(3) << "Start server session, listen port " << next_port << ".";
-    VLOG(3) << "Start client session, connect to " << prev_ip << ":"
-            << prev_port << ".";
-
+    next_mode = SessionMode::Server;
+    prev_mode = SessionMode::Client;
     break;
   default:
-    ep_next_.start(ios, next_ip, next_port, SessionMode::Client, next_name);
-    ep_prev_.start(ios, prev_ip, prev_port, SessionMode::Client, prev_name);
-
-    VLOG(3) << "Start client session, connect to " << next_ip << ":"
-            << next_port << ".";
-    VLOG(3) << "Start client session, connect to " << prev_ip << ":"
-            << prev_port << ".";
-
+    next_mode = SessionMode::Client;
+    prev_mode = SessionMode::Client;
     break;
   }
 
-  comm.setNext(ep_next_.addChannel());
-  comm.setPrev(ep_prev_.addChannel());
+  // The sessions stay open in the node's pool after this task, only the
+  // channels named after it belong to the task.
+  SessionPool &pool = SessionPool::getInstance();
+  comm.setNext(
+      pool.addChannel(next_ip, next_port, next_mode, next_name, channel_name));
+  comm.setPrev(
+      pool.addChannel(prev_ip, prev_port, prev_mode, prev_name, channel_name));
+  VLOG(3) << "Add channel " << channel_name << " to session " << next_name
+          << " (" << next_ip << ":" << next_port << ") and session "
+          << prev_name << " (" << prev_ip << ":" << prev_port << ").";
   comm.mNext().waitForConnection();
   comm.mPrev().waitForConnection();
   comm.mNext().send(partyIdx);
@@ -66,6 +60,7 @@ int MPCOperator::setup(std::string next_ip, std::string prev_ip, u32 next_port,
 
   // Establishes some shared randomness needed for the later protocols
   eval.init(partyIdx, comm, sysRandomSeed());
+  eval.startPreprocess();
 
   binEval.mPrng.SetSeed(toBlock(partyIdx));
   gen.init(toBlock(partyIdx), toBlock((partyIdx + 1) % 3));
@@ -75,10 +70,14 @@ int MPCOperator::setup(std::string next_ip, std::string prev_ip, u32 next_port,
   mPrev = comm.mPrev();
   auto commPtr = std::make_shared<CommPkg>(comm.mPrev(), comm.mNext());
   runtime.init(partyIdx, commPtr);
+  // the calling thread computes too.
+  runtime.setWorkerNum(DefaultWorkerNum() - 1);
+  runtime.setCoalescing(true);
   return 1;
 }
 
 void MPCOperator::fini() {
+  eval.stopPreprocess();
   mPrev.close();
   mNext.close();
 }
@@ -99,12 +98,21 @@ void MPCOperator::createShares(si64 &dest) {
   enc.remoteInt(runtime, dest).get();
 }
 
+Sh3Task MPCOperator::sendShape(const std::array<u64, 2> &size) {
+  Sh3Task dep = runtime.noDependencies();
+  return dep.then([size](CommPkgBase *comm, Sh3Task &self) {
+    auto &comm_cast = dynamic_cast<CommPkg &>(*comm);
+    comm_cast.mNext().asyncSendCopy(size);
+    comm_cast.mPrev().asyncSendCopy(size);
+  });
+}
+
 si64Matrix MPCOperator::createSharesByShape(const i64Matrix &val) {
   std::array<u64, 2> size{static_cast<unsigned long long>(val.rows()), static_cast<unsigned long long>(val.cols())};
-  mNext.asyncSendCopy(size);
-  mPrev.asyncSendCopy(size);
+  auto shape = sendShape(size);
   si64Matrix dest(size[0], size[1]);
   enc.localIntMatrix(runtime, val, dest).get();
+  shape.get();
   return dest;
 }
 
@@ -125,10 +133,10 @@ si64Matrix MPCOperator::createSharesByShape(u64 pIdx) {
 // only support val is column vector
 sbMatrix MPCOperator::createBinSharesByShape(i64Matrix &val, u64 bitCount) {
   std::array<u64, 2> size{static_cast<unsigned long long>(val.rows()), bitCount};
-  mNext.asyncSendCopy(size);
-  mPrev.asyncSendCopy(size);
+  auto shape = sendShape(size);
   sbMatrix dest(size[0], size[1]);
   enc.localBinMatrix(runtime, val, dest).get();
+  shape.get();
   return dest;
 }
 
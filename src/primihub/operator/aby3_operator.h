@@ -24,13 +24,13 @@
 #include "src/primihub/util/network/socket/commpkg.h"
 #include "src/primihub/util/network/socket/ioservice.h"
 #include "src/primihub/util/network/socket/session.h"
+#include "src/primihub/util/network/socket/session_pool.h"
 
 namespace primihub {
 const uint8_t VAL_BITCOUNT = 64;
 class MPCOperator {
 public:
   Channel mNext, mPrev;
-  IOService ios;
   Sh3Encryptor enc;
   Sh3BinaryEvaluator binEval;
   Sh3ShareGen gen;
@@ -47,8 +47,11 @@ public:
   MPCOperator(u64 partyIdx_, string NextName, string PrevName)
       : partyIdx(partyIdx_), next_name(NextName), prev_name(PrevName) {}
 
+  // Takes the channels to the next and prev party from the node's session
+  // pool, tasks which run at the same time must use different
+  // channel_names.
   int setup(std::string next_ip, std::string prev_ip, u32 next_port,
-            u32 prev_port);
+            u32 prev_port, const std::string &channel_name = "");
   void fini();
   template <Decimal D>
   void createShares(const eMatrix<double> &vals, sf64Matrix<D> &sharedMatrix) {
@@ -73,10 +76,10 @@ public:
   template <Decimal D>
   sf64Matrix<D> createSharesByShape(const f64Matrix<D> &val) {
     std::array<u64, 2> size{val.rows(), val.cols()};
-    mNext.asyncSendCopy(size);
-    mPrev.asyncSendCopy(size);
+    auto shape = sendShape(size);
     sf64Matrix<D> dest(size[0], size[1]);
     enc.localFixedMatrix(runtime, val, dest).get();
+    shape.get();
     return dest;
   }
 
@@ -101,6 +104,10 @@ public:
 
   void createShares(si64& dest);
 
+  // Send the shape to both parties in the runtime's next round, the
+  // shares created right after go out in the same round.
+  Sh3Task sendShape(const std::array<u64, 2> &size);
+
   si64Matrix createSharesByShape(const i64Matrix &val);
 
   si64Matrix createSharesByShape(u64 partyIdx);
@@ -859,5 +866,5 @@ public:
 
   void MPC_Compare(sbMatrix &sh_res);
 };
-#endif
 } // namespace primihub
+#endif
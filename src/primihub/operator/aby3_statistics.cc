@@ -0,0 +1,265 @@
+// Copyright [2022] <primihub.com>
+#include "src/primihub/operator/aby3_statistics.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "src/primihub/primitive/circuit/beta_library.h"
+
+namespace primihub {
+namespace {
+// A single value goes into D16 as it is, so that the circuit can compare
+// it. Three of them still add up inside i64.
+const double kMaxFixedValue = 70368744177664.0;  // 2^46
+
+// Sums are split at 2^32, the high word is a plain integer and only the
+// remainder goes into D16, so a sum isn't bound by the range of a value.
+const double kSumSplit = 4294967296.0;
+// Largest |sum| whose high word still fits i64 after adding three of them.
+const double kMaxSplitSum = 9.0e18 / 3 * kSumSplit;
+
+i64 toFixed(double value) { return f64<D16>(value).mValue; }
+
+double fromFixed(i64 value) {
+  f64<D16> fixed;
+  fixed.mValue = value;
+  return static_cast<double>(fixed);
+}
+
+bool inFixedRange(double value) {
+  return std::isfinite(value) && std::fabs(value) <= kMaxFixedValue;
+}
+
+// value must be finite and at most kMaxSplitSum.
+void toSplitFixed(double value, i64 *low, i64 *high) {
+  double high_part = std::trunc(value / kSumSplit);
+  *high = static_cast<i64>(high_part);
+  *low = toFixed(value - high_part * kSumSplit);
+}
+
+double fromSplitFixed(i64 low, i64 high) {
+  return static_cast<double>(high) * kSumSplit + fromFixed(low);
+}
+
+}  // namespace
+
+MPCStatistics::MPCStatistics(MPCOperator &mpc_op) : mpc_op_(mpc_op) {
+  buildMinMaxCircuit();
+}
+
+// Inputs a, b and c are the values of party 0, 1 and 2, the outputs are
+// their minimum and their maximum. The three comparisons don't depend on
+// each other, so the circuit is one comparison and two multiplexers deep.
+void MPCStatistics::buildMinMaxCircuit() {
+  const u64 bits = sizeof(i64) * 8;
+  BetaCircuit &cd = min_max_cir_;
+  BetaBundle a(bits), b(bits), c(bits), min(bits), max(bits);
+  BetaBundle a_lt_b(1), b_lt_c(1), a_lt_c(1), c_wins(1), ab(bits), temp(1);
+
+  cd.addInputBundle(a);
+  cd.addInputBundle(b);
+  cd.addInputBundle(c);
+  cd.addOutputBundle(min);
+  cd.addOutputBundle(max);
+  cd.addTempWireBundle(a_lt_b);
+  cd.addTempWireBundle(b_lt_c);
+  cd.addTempWireBundle(a_lt_c);
+  cd.addTempWireBundle(c_wins);
+  cd.addTempWireBundle(ab);
+  cd.addTempWireBundle(temp);
+
+  BetaLibrary::int_int_lt_build(cd, a, b, a_lt_b);
+  BetaLibrary::int_int_lt_build(cd, b, c, b_lt_c);
+  BetaLibrary::int_int_lt_build(cd, a, c, a_lt_c);
+
+  // min(a, b), then c if it's below that.
+  BetaLibrary::int_int_multiplex_build(cd, a, b, a_lt_b, ab, temp);
+  BetaLibrary::int_int_multiplex_build(cd, a_lt_c, b_lt_c, a_lt_b, c_wins,
+                                       temp);
+  BetaLibrary::int_int_multiplex_build(cd, ab, c, c_wins, min, temp);
+
+  // max(a, b), then c if that's below it.
+  BetaLibrary::int_int_multiplex_build(cd, b, a, a_lt_b, ab, temp);
+  BetaLibrary::int_int_multiplex_build(cd, b_lt_c, a_lt_c, a_lt_b, c_wins,
+                                       temp);
+  BetaLibrary::int_int_multiplex_build(cd, c, ab, c_wins, max, temp);
+
+  cd.levelByAndDepth();
+}
+
+i64Matrix MPCStatistics::sumOverParties(const i64Matrix &local) {
+  // Every party inputs its matrix at the same time, the zero shares the
+  // three inputs are masked with add up to the sum of the matrices.
+  si64Matrix shared(local.rows(), local.cols());
+  mpc_op_.createShares(local, shared);
+  return mpc_op_.revealAll(shared);
+}
+
+Sh3Task MPCStatistics::minMaxOverParties(const i64Matrix &local) {
+  Sh3Encryptor &enc = mpc_op_.enc;
+  Sh3Runtime &runtime = mpc_op_.runtime;
+  const u64 bits = sizeof(i64) * 8;
+  u64 rows = local.rows();
+
+  local_extremes_ = local;
+  extreme_inputs_.assign(3, sbMatrix(rows, bits));
+  min_shares_.resize(rows, bits);
+  max_shares_.resize(rows, bits);
+
+  // The three parties input their values in one round.
+  Sh3Task input = runtime.noDependencies();
+  for (u64 i = 0; i < 3; ++i) {
+    Sh3Task task =
+        i == mpc_op_.partyIdx
+            ? enc.localBinMatrix(runtime.noDependencies(), local_extremes_,
+                                 extreme_inputs_[i])
+            : enc.remoteBinMatrix(runtime.noDependencies(), extreme_inputs_[i]);
+    input = i == 0 ? task : (input && task);
+  }
+
+  Sh3Task eval = mpc_op_.binEval.asyncEvaluate(
+      input, &min_max_cir_, mpc_op_.gen,
+      {&extreme_inputs_[0], &extreme_inputs_[1], &extreme_inputs_[2]},
+      {&min_shares_, &max_shares_});
+
+  // The minimum of the maxima and the maximum of the minima would tell
+  // more than the statistics, only the halves asked for are revealed.
+  u64 half = rows / 2;
+  extreme_shares_.resize(rows, bits);
+  extremes_.resize(rows, 1);
+  Sh3Task select = eval.then([this, rows, half](Sh3Task &self) {
+    for (u64 i = 0; i < 2; ++i) {
+      i64 *dest = extreme_shares_.mShares[i].data();
+      std::copy_n(min_shares_.mShares[i].data(), half, dest);
+      std::copy_n(max_shares_.mShares[i].data() + half, rows - half,
+                  dest + half);
+    }
+  });
+  return enc.revealAll(select, extreme_shares_, extremes_);
+}
+
+std::vector<ColumnStatistics>
+MPCStatistics::compute(const std::vector<std::vector<double>> &columns,
+                       const std::vector<std::vector<double>> &bin_edges) {
+  u64 num_cols = columns.size();
+  if (!bin_edges.empty() && bin_edges.size() != num_cols)
+    throw std::runtime_error("Need the bin edges of all columns or none.");
+
+  // Every column takes two rows for its sum, one for its count, one for
+  // the number of its values out of the fixed-point range and one for
+  // each bin of its histogram.
+  std::vector<u64> offsets(num_cols + 1, 0);
+  std::vector<u64> num_bins(num_cols, 0);
+  for (u64 i = 0; i < num_cols; ++i) {
+    if (!bin_edges.empty() && bin_edges[i].size() > 1)
+      num_bins[i] = bin_edges[i].size() - 1;
+    offsets[i + 1] = offsets[i] + 4 + num_bins[i];
+  }
+
+  // The rows of a party without values in a column stay at zero, and its
+  // extremes at the far end of the range so that they never win.
+  i64Matrix local_sums(offsets.back(), 1);
+  i64Matrix local_extremes(2 * num_cols, 1);
+  local_sums.setZero();
+  for (u64 i = 0; i < num_cols; ++i) {
+    i64 *sums = local_sums.data() + offsets[i];
+    i64 &min = local_extremes(i);
+    i64 &max = local_extremes(num_cols + i);
+    min = std::numeric_limits<i64>::max();
+    max = std::numeric_limits<i64>::min();
+
+    // An out of range value is only counted, all parties see the count
+    // and reject the column together once the MPC is done.
+    double sum = 0;
+    for (double value : columns[i]) {
+      if (!inFixedRange(value)) {
+        sums[3]++;
+        continue;
+      }
+      sum += value;
+      i64 fixed = toFixed(value);
+      min = std::min(min, fixed);
+      max = std::max(max, fixed);
+    }
+    if (std::fabs(sum) <= kMaxSplitSum)
+      toSplitFixed(sum, &sums[0], &sums[1]);
+    else
+      sums[3]++;
+    sums[2] = columns[i].size();
+
+    if (num_bins[i] == 0)
+      continue;
+    const std::vector<double> &edges = bin_edges[i];
+    for (double value : columns[i]) {
+      if (value < edges.front() || value > edges.back())
+        continue;
+      u64 bin = std::upper_bound(edges.begin(), edges.end(), value) -
+                edges.begin() - 1;
+      sums[4 + std::min(bin, num_bins[i] - 1)]++;
+    }
+  }
+
+  LOG(INFO) << "Begin to compute statistics of " << num_cols << " columns.";
+  Sh3Task extremes_task = minMaxOverParties(local_extremes);
+
+  std::vector<ColumnStatistics> stats(num_cols);
+  std::vector<i64> out_of_range(num_cols);
+  i64Matrix total_sums = sumOverParties(local_sums);
+  for (u64 i = 0; i < num_cols; ++i) {
+    const i64 *sums = total_sums.data() + offsets[i];
+    ColumnStatistics &stat = stats[i];
+    stat.count = sums[2];
+    stat.sum = fromSplitFixed(sums[0], sums[1]);
+    stat.mean = stat.count ? stat.sum / stat.count : 0;
+    stat.histogram.assign(sums + 4, sums + 4 + num_bins[i]);
+    out_of_range[i] = sums[3];
+  }
+
+  // The squared deviations are taken from the mean of all rows, which
+  // keeps them small compared to the sum of squares. Their total still
+  // grows with the rows, so it's split like the sums.
+  i64Matrix local_deviations(num_cols, 3);
+  local_deviations.setZero();
+  for (u64 i = 0; i < num_cols; ++i) {
+    if (out_of_range[i] != 0)
+      continue;
+    double deviation = 0;
+    for (double value : columns[i])
+      deviation += (value - stats[i].mean) * (value - stats[i].mean);
+    if (deviation > kMaxSplitSum)
+      local_deviations(i, 2) = 1;
+    else
+      toSplitFixed(deviation, &local_deviations(i, 0), &local_deviations(i, 1));
+  }
+  i64Matrix total_deviations = sumOverParties(local_deviations);
+
+  extremes_task.get();
+  for (u64 i = 0; i < num_cols; ++i) {
+    ColumnStatistics &stat = stats[i];
+    if (stat.count == 0)
+      continue;
+    stat.variance =
+        fromSplitFixed(total_deviations(i, 0), total_deviations(i, 1)) /
+        stat.count;
+    stat.min = fromFixed(extremes_(i));
+    stat.max = fromFixed(extremes_(num_cols + i));
+  }
+  LOG(INFO) << "Finish to compute statistics.";
+
+  for (u64 i = 0; i < num_cols; ++i) {
+    if (out_of_range[i] != 0 || total_deviations(i, 2) != 0) {
+      LOG(ERROR) << "Column " << i << " has " << out_of_range[i]
+                 << " values beyond +-" << kMaxFixedValue
+                 << " or a variance out of the fixed-point range.";
+      throw std::runtime_error("Column out of the fixed-point range.");
+    }
+  }
+
+  return stats;
+}
+
+}  // namespace primihub
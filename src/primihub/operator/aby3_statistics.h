@@ -0,0 +1,79 @@
+// Copyright [2022] <primihub.com>
+#ifndef SRC_PRIMIHUB_OPERATOR_ABY3_STATISTICS_H_
+#define SRC_PRIMIHUB_OPERATOR_ABY3_STATISTICS_H_
+
+#include <vector>
+
+#include "src/primihub/operator/aby3_operator.h"
+#include "src/primihub/primitive/circuit/beta_circuit.h"
+
+namespace primihub {
+// Statistics of one column over the rows of all three parties.
+struct ColumnStatistics {
+  u64 count = 0;
+  double sum = 0;
+  double mean = 0;
+  // Population variance.
+  double variance = 0;
+  double min = 0;
+  double max = 0;
+  // histogram[i] counts the values in [edges[i], edges[i + 1]), the last
+  // bin also takes the values equal to edges.back().
+  std::vector<u64> histogram;
+};
+
+// Statistics of a table whose rows are split between the three parties of
+// an MPCOperator, every party holds the same columns. All columns go
+// through the MPC together, so the number of rounds doesn't grow with the
+// number of columns:
+//   - count, sum and histograms take one input round and one reveal,
+//   - the variance takes one more of each, on the deviations from the
+//     mean found before,
+//   - min and max take one input round, one evaluation of a circuit which
+//     picks the smallest and the largest of the three local values of all
+//     columns at once, and one reveal. They run while the two steps above
+//     do.
+// Only the statistics are revealed, the values of a party and the
+// statistics of its own rows stay hidden from the other two. Values go
+// through the MPC in fixed point with D16, sums and squared deviations
+// are split into a high word and a D16 remainder so that they aren't bound
+// by the range of i64.
+class MPCStatistics {
+ public:
+  explicit MPCStatistics(MPCOperator &mpc_op);
+
+  // columns[i] are the non-null values of column i held by this party and
+  // may be empty. bin_edges is either empty or has the sorted public edges
+  // of the histogram of every column, a column with less than two edges
+  // gets no histogram. All parties call this at the same time with the
+  // same number of columns and the same bin edges. Throws on all parties
+  // once the MPC is done if a column has a value beyond +-2^46, which
+  // D16 can't compare.
+  std::vector<ColumnStatistics>
+  compute(const std::vector<std::vector<double>> &columns,
+          const std::vector<std::vector<double>> &bin_edges = {});
+
+ private:
+  // Shares the matrix of every party and reveals their sum.
+  i64Matrix sumOverParties(const i64Matrix &local);
+
+  // Starts to find, over the three parties, the minimum of each of the
+  // first half of the rows of local and the maximum of each of the second
+  // half. The result is in extremes_ once the task is done.
+  Sh3Task minMaxOverParties(const i64Matrix &local);
+
+  void buildMinMaxCircuit();
+
+  MPCOperator &mpc_op_;
+  BetaCircuit min_max_cir_;
+
+  // Used by the tasks of minMaxOverParties while they run.
+  i64Matrix local_extremes_;
+  std::vector<sbMatrix> extreme_inputs_;
+  sbMatrix min_shares_, max_shares_, extreme_shares_;
+  i64Matrix extremes_;
+};
+
+}  // namespace primihub
+
+#endif  // SRC_PRIMIHUB_OPERATOR_ABY3_STATISTICS_H_
@@ -23,6 +23,19 @@ struct CrtMod {
   mp_bitcnt_t mod_size;
 };
 
+/**
+ * @brief precomputed basis of the CRT over all crt_size moduli
+ * 
+ * coef[i] = 1 mod crt_mod[i] and 0 mod the others, so that packing
+ * is a dot product instead of an inversion per element
+ * 
+ */
+struct CrtBasis {
+  mpz_t muls;
+  mpz_t* coef;
+  size_t crt_size;
+};
+
 void init_crt(
   CrtMod** crtmod,
   const size_t crt_size,
@@ -42,6 +55,21 @@ void data_retrieve_crt(
   const size_t data_size,
   const int radix = 10);
 
+void init_crt_basis(
+  CrtBasis** basis,
+  const CrtMod* crtmod);
+
+/**
+ * @brief pack up to crt_size int64 values, missing slots are packed as 0
+ * 
+ */
+void data_packing_crt_ll(
+  mpz_t res,
+  const ll* seq,
+  const size_t seq_size,
+  const CrtMod* crtmod,
+  const CrtBasis* basis);
+
 // void data_packing_mul(
 //   mpz_t res,
 //   const mpz_t cipher_pack,
@@ -50,4 +78,7 @@ void data_retrieve_crt(
 void free_crt(
   CrtMod* crtmod);
 
+void free_crt_basis(
+  CrtBasis* basis);
+
 #endif
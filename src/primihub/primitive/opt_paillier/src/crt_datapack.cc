@@ -11,6 +11,9 @@ void init_crt(
   CrtMod** crtmod,
   const size_t crt_size,
   const mp_bitcnt_t mod_size) {
+    if (crt_size == 0) {
+      throw "crt_size must be positive";
+    }
     (*crtmod) = (CrtMod*)malloc(sizeof(CrtMod));
     (*crtmod)->crt_size = crt_size;
     (*crtmod)->mod_size = mod_size;
@@ -87,6 +90,53 @@ void data_retrieve_crt(
     mpz_clear(cur);
   }
 
+void init_crt_basis(
+  CrtBasis** basis,
+  const CrtMod* crtmod) {
+    if (crtmod->crt_size == 0) {
+      throw "crt_size of crt basis must be positive";
+    }
+    (*basis) = (CrtBasis*)malloc(sizeof(CrtBasis));
+    (*basis)->crt_size = crtmod->crt_size;
+    (*basis)->coef = (mpz_t*)malloc(sizeof(mpz_t) * crtmod->crt_size);
+    mpz_init_set_ui((*basis)->muls, 1);
+    for (size_t i = 0; i < crtmod->crt_size; ++i) {
+      mpz_mul((*basis)->muls, (*basis)->muls, crtmod->crt_mod[i]);
+    }
+    mpz_t inv;
+    mpz_init(inv);
+    for (size_t i = 0; i < crtmod->crt_size; ++i) {
+      mpz_init((*basis)->coef[i]);
+      mpz_divexact((*basis)->coef[i], (*basis)->muls, crtmod->crt_mod[i]);
+      mpz_invert(inv, (*basis)->coef[i], crtmod->crt_mod[i]);
+      mpz_mul((*basis)->coef[i], (*basis)->coef[i], inv);
+    }
+    mpz_clear(inv);
+  }
+
+void data_packing_crt_ll(
+  mpz_t res,
+  const ll* seq,
+  const size_t seq_size,
+  const CrtMod* crtmod,
+  const CrtBasis* basis) {
+    if (seq_size > crtmod->crt_size) {
+      throw "size of packing is more than crt's";
+    }
+    mpz_set_ui(res, 0);
+    mpz_t cur;
+    mpz_init(cur);
+    for (size_t i = 0; i < seq_size; ++i) {
+      mpz_set_si(cur, seq[i]);
+      if (seq[i] < 0) {
+        mpz_add(cur, cur, crtmod->crt_mod[i]);
+      }
+      mpz_addmul(res, cur, basis->coef[i]);
+    }
+    mpz_mod(res, res, basis->muls);
+    mpz_clear(cur);
+  }
+
 // void data_packing_mul(
 //   mpz_t res,
 //   const mpz_t cipher_pack,
@@ -107,3 +157,15 @@ void free_crt(
     free(crtmod);
     crtmod = nullptr;
   }
+
+void free_crt_basis(
+  CrtBasis* basis) {
+    for (size_t i = 0; i < basis->crt_size; ++i) {
+      mpz_clear(basis->coef[i]);
+    }
+    free(basis->coef);
+    basis->coef = nullptr;
+    mpz_clear(basis->muls);
+    free(basis);
+    basis = nullptr;
+  }
@@ -906,15 +906,16 @@ void Sh3BinaryEvaluator::roundCallback(CommPkg& comm, Sh3Task task) {
             t2[6] = s1_in0[k + 6] ^ AllOneBlock;
             t2[7] = s1_in0[k + 7] ^ AllOneBlock;
 
-            // t3 = mem11 & mem00
-            s0_Out[k + 0] = s1_in1[k + 0] & t0[0];
-            s0_Out[k + 1] = s1_in1[k + 1] & t0[1];
-            s0_Out[k + 2] = s1_in1[k + 2] & t0[2];
-            s0_Out[k + 3] = s1_in1[k + 3] & t0[3];
-            s0_Out[k + 4] = s1_in1[k + 4] & t0[4];
-            s0_Out[k + 5] = s1_in1[k + 5] & t0[5];
-            s0_Out[k + 6] = s1_in1[k + 6] & t0[6];
-            s0_Out[k + 7] = s1_in1[k + 7] & t0[7];
+            // t3 = mem11 & mem00, a | b is the complement of nor(a, b)
+            // so the inputs are complemented as for Nor.
+            s0_Out[k + 0] = (s1_in1[k + 0] ^ AllOneBlock) & t0[0];
+            s0_Out[k + 1] = (s1_in1[k + 1] ^ AllOneBlock) & t0[1];
+            s0_Out[k + 2] = (s1_in1[k + 2] ^ AllOneBlock) & t0[2];
+            s0_Out[k + 3] = (s1_in1[k + 3] ^ AllOneBlock) & t0[3];
+            s0_Out[k + 4] = (s1_in1[k + 4] ^ AllOneBlock) & t0[4];
+            s0_Out[k + 5] = (s1_in1[k + 5] ^ AllOneBlock) & t0[5];
+            s0_Out[k + 6] = (s1_in1[k + 6] ^ AllOneBlock) & t0[6];
+            s0_Out[k + 7] = (s1_in1[k + 7] ^ AllOneBlock) & t0[7];
 
             // t2 = mem10 & mem01
             t2[0] = t2[0] & t1[0];
@@ -956,15 +957,16 @@ void Sh3BinaryEvaluator::roundCallback(CommPkg& comm, Sh3Task task) {
             s0_Out[k + 6] = s0_Out[k + 6] ^ t1[6];
             s0_Out[k + 7] = s0_Out[k + 7] ^ t1[7];
 
-            // out = mem11 & mem00 ^ mem10 & mem01 ^ mem00 & mem01 ^ z0 ^ z1
-            s0_Out[k + 0] = s0_Out[k + 0] ^ z[k + 0];
-            s0_Out[k + 1] = s0_Out[k + 1] ^ z[k + 1];
-            s0_Out[k + 2] = s0_Out[k + 2] ^ z[k + 2];
-            s0_Out[k + 3] = s0_Out[k + 3] ^ z[k + 3];
-            s0_Out[k + 4] = s0_Out[k + 4] ^ z[k + 4];
-            s0_Out[k + 5] = s0_Out[k + 5] ^ z[k + 5];
-            s0_Out[k + 6] = s0_Out[k + 6] ^ z[k + 6];
-            s0_Out[k + 7] = s0_Out[k + 7] ^ z[k + 7];
+            // out = nor(a, b) ^ 1 ^ z0 ^ z1, every party flips its share
+            // and the three flips add up to one.
+            s0_Out[k + 0] = s0_Out[k + 0] ^ z[k + 0] ^ AllOneBlock;
+            s0_Out[k + 1] = s0_Out[k + 1] ^ z[k + 1] ^ AllOneBlock;
+            s0_Out[k + 2] = s0_Out[k + 2] ^ z[k + 2] ^ AllOneBlock;
+            s0_Out[k + 3] = s0_Out[k + 3] ^ z[k + 3] ^ AllOneBlock;
+            s0_Out[k + 4] = s0_Out[k + 4] ^ z[k + 4] ^ AllOneBlock;
+            s0_Out[k + 5] = s0_Out[k + 5] ^ z[k + 5] ^ AllOneBlock;
+            s0_Out[k + 6] = s0_Out[k + 6] ^ z[k + 6] ^ AllOneBlock;
+            s0_Out[k + 7] = s0_Out[k + 7] ^ z[k + 7] ^ AllOneBlock;
           }
 #ifndef NDEBUG
           ccCheck();
@@ -1544,6 +1546,28 @@ void Sh3BinaryEvaluator::DEBUG_Triple::assign(
 
         mBits = t;
     }
+    else if (type == GateType::Or)
+    {
+        plain = vIn0 | vIn1;
+
+        std::array<u8, 3> t;
+        for (u64 b = 0; b < 3; ++b)
+        {
+            auto bb = b ? (b - 1) : 2;
+            auto in00 = 1 ^ in0.mBits[b];
+            auto in01 = 1 ^ in0.mBits[bb];
+            auto in10 = 1 ^ in1.mBits[b];
+            auto in11 = 1 ^ in1.mBits[bb];
+
+            t[b]
+                = (in00 & in10)
+                ^ (in00 & in11)
+                ^ (in01 & in10)
+                ^ 1;
+        }
+
+        mBits = t;
+    }
     else if (type == GateType::a)
     {
         plain = vIn0;
@@ -9,6 +9,8 @@ namespace primihub {
     mPartyIdx = partyIdx;
     mOtPrev.setSeed(mShareGen.mNextCommon.get<block>());
     mOtNext.setSeed(mShareGen.mPrevCommon.get<block>());
+    mTruncPool.init(mShareGen.mPrevCommon.get<block>(),
+                    mShareGen.mNextCommon.get<block>());
   }
 
   void Sh3Evaluator::init(u64 partyIdx, CommPkg& comm, block seed,
@@ -17,6 +19,8 @@ namespace primihub {
     mPartyIdx = partyIdx;
     mOtPrev.setSeed(mShareGen.mNextCommon.get<block>());
     mOtNext.setSeed(mShareGen.mPrevCommon.get<block>());
+    mTruncPool.init(mShareGen.mPrevCommon.get<block>(),
+                    mShareGen.mNextCommon.get<block>());
   }
 
   Sh3Task Sh3Evaluator::asyncMul(Sh3Task dependency, const si64& A,
@@ -68,11 +72,13 @@ namespace primihub {
 
   Sh3Task Sh3Evaluator::asyncMul(Sh3Task dependency, const si64Matrix& A,
                                  const si64Matrix& B, si64Matrix& C) {
-    return dependency.then([&](CommPkgBase* comm, Sh3Task self) {
+    // The products are local, the runtime may compute them together with
+    // the ones of other ready tasks.
+    return dependency.thenLocal([&]() {
         C.mShares[0] = A.mShares[0] * B.mShares[0]
                       + A.mShares[0] * B.mShares[1]
                       + A.mShares[1] * B.mShares[0];
-
+    }).then([&](CommPkgBase* comm, Sh3Task self) {
         for (u64 i = 0; i < C.size(); ++i) {
             C.mShares[0](i) += mShareGen.getShare();
         }
@@ -305,10 +311,8 @@ namespace primihub {
       // if (mPartyIdx == 0)
       {
         // mShareGen.mPrevCommon.get(pair.mR.data(), pair.mR.size());
-        mShareGen.mNextCommon.get(pair.mRTrunc[0].data(),
-              pair.mRTrunc[0].size());
-        mShareGen.mPrevCommon.get(pair.mRTrunc[1].data(),
-              pair.mRTrunc[1].size());
+        mTruncPool.get(pair.mRTrunc[0].data(), pair.mRTrunc[1].data(),
+                       pair.mR.size());
         for (u64 i = 0; i < pair.mR.size(); ++i) {
             auto& t0 = pair.mRTrunc[0](i);
             auto& t1 = pair.mRTrunc[1](i);
@@ -370,10 +374,13 @@ namespace primihub {
 
   Sh3Task Sh3Evaluator::asyncMul(Sh3Task dependency, const si64Matrix& A,
         const si64Matrix& B, si64Matrix& C, u64 shift) {
-    return dependency.then([&, shift](CommPkgBase* comm, Sh3Task& self) -> void {
-      i64Matrix abMinusR = A.mShares[0] * B.mShares[0]
-                         + A.mShares[0] * B.mShares[1]
-                         + A.mShares[1] * B.mShares[0];
+    auto prod = std::make_shared<i64Matrix>();
+    return dependency.thenLocal([&, prod]() {
+      *prod = A.mShares[0] * B.mShares[0]
+            + A.mShares[0] * B.mShares[1]
+            + A.mShares[1] * B.mShares[0];
+    }).then([&, shift, prod](CommPkgBase* comm, Sh3Task& self) -> void {
+      i64Matrix abMinusR = std::move(*prod);
 
       auto truncationTuple = getTruncationTuple(abMinusR.rows(),
                                                 abMinusR.cols(), shift);
@@ -525,11 +532,12 @@ namespace primihub {
   Sh3Task Sh3Evaluator::asyncDotMul(Sh3Task dependency, const si64Matrix &A,
                                   const si64Matrix &B, si64Matrix &C) {
     return dependency
-        .then([&](CommPkgBase *comm, Sh3Task self) {
+        .thenLocal([&]() {
           C.mShares[0] = A.mShares[0].array() * B.mShares[0].array() +
                          A.mShares[0].array() * B.mShares[1].array() +
                          A.mShares[1].array() * B.mShares[0].array();
-
+        })
+        .then([&](CommPkgBase *comm, Sh3Task self) {
           for (u64 i = 0; i < C.size(); ++i) {
             C.mShares[0](i) += mShareGen.getShare();
           }
@@ -552,11 +560,15 @@ namespace primihub {
   Sh3Task Sh3Evaluator::asyncDotMul(Sh3Task dependency, const si64Matrix &A,
                                   const si64Matrix &B, si64Matrix &C,
                                   u64 shift) {
+    auto prod = std::make_shared<i64Matrix>();
     return dependency
-        .then([&, shift](CommPkgBase *comm, Sh3Task &self) -> void {
-          i64Matrix abMinusR = A.mShares[0].array() * B.mShares[0].array() +
-                               A.mShares[0].array() * B.mShares[1].array() +
-                               A.mShares[1].array() * B.mShares[0].array();
+        .thenLocal([&, prod]() {
+          *prod = A.mShares[0].array() * B.mShares[0].array() +
+                  A.mShares[0].array() * B.mShares[1].array() +
+                  A.mShares[1].array() * B.mShares[0].array();
+        })
+        .then([&, shift, prod](CommPkgBase *comm, Sh3Task &self) -> void {
+          i64Matrix abMinusR = std::move(*prod);
 
           auto truncationTuple =
               getTruncationTuple(abMinusR.rows(), abMinusR.cols(), shift);
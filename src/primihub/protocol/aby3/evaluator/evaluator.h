@@ -11,6 +11,7 @@
 #include "src/primihub/common/type/fixed_point.h"
 #include "src/primihub/protocol/aby3/runtime.h"
 #include "src/primihub/protocol/aby3/sh3_gen.h"
+#include "src/primihub/protocol/aby3/evaluator/truncation_pool.h"
 #include "src/primihub/primitive/ot/share_ot.h"
 #include "src/primihub/util/log.h"
 #include "src/primihub/util/crypto/prng.h"
@@ -117,9 +118,18 @@ class Sh3Evaluator {
 
   TruncationPair getTruncationTuple(u64 xSize, u64 ySize, u64 d);
 
+  // Offline phase, generate the randomness of n truncated values now.
+  void preprocess(u64 n) { mTruncPool.fill(n); }
+
+  // Keep generating randomness of truncation in background between and
+  // during online operations.
+  void startPreprocess() { mTruncPool.start(); }
+  void stopPreprocess() { mTruncPool.stop(); }
+
   u64 mPartyIdx = -1, mTruncationIdx = 0;
   Sh3ShareGen mShareGen;
   SharedOT mOtPrev, mOtNext;
+  Sh3TruncationPool mTruncPool;
 
   Sh3Task asyncConstMul_test(Sh3Task dependency, const i64& A, const si64& B,
                              si64& C);
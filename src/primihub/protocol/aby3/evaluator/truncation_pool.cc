@@ -0,0 +1,171 @@
+#include "src/primihub/protocol/aby3/evaluator/truncation_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace primihub {
+
+  namespace {
+    // two elements per AES block.
+    const u64 kChunkBlocks = Sh3TruncationPool::kChunkSize / 2;
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+      return std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count();
+    }
+  }  // namespace
+
+  void Sh3TruncationPool::init(const block& prevKey, const block& nextKey,
+                               u64 capacity) {
+    stop();
+    mPrevAes.setKey(prevKey);
+    mNextAes.setKey(nextKey);
+    mMaxChunks = std::max<u64>(1, (capacity + kChunkSize - 1) / kChunkSize);
+
+    std::lock_guard<std::mutex> lck(mMtx);
+    mReady.clear();
+    mConsumeIdx = 0;
+    mNextChunk = 0;
+    mStats = Stats();
+    mCurOffset = kChunkSize;
+  }
+
+  void Sh3TruncationPool::generate(u64 idx, Chunk& chunk) const {
+    chunk.mNext.resize(kChunkBlocks);
+    chunk.mPrev.resize(kChunkBlocks);
+    mNextAes.ecbEncCounterMode(idx * kChunkBlocks, kChunkBlocks,
+                               chunk.mNext.data());
+    mPrevAes.ecbEncCounterMode(idx * kChunkBlocks, kChunkBlocks,
+                               chunk.mPrev.data());
+  }
+
+  void Sh3TruncationPool::fill(u64 n) {
+    u64 chunks = std::min(mMaxChunks, (n + kChunkSize - 1) / kChunkSize);
+    std::unique_lock<std::mutex> lck(mMtx);
+    while (mNextChunk - mConsumeIdx < chunks) {
+      u64 idx = mNextChunk++;
+      lck.unlock();
+
+      auto start = std::chrono::steady_clock::now();
+      Chunk chunk;
+      generate(idx, chunk);
+      double seconds = secondsSince(start);
+
+      lck.lock();
+      mReady.emplace(idx, std::move(chunk));
+      mStats.mOfflineSeconds += seconds;
+      mCv.notify_all();
+    }
+  }
+
+  void Sh3TruncationPool::start() {
+    if (mWorker.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> lck(mMtx);
+      mStop = false;
+    }
+    mWorker = std::thread([this]() { workerLoop(); });
+  }
+
+  void Sh3TruncationPool::stop() {
+    if (!mWorker.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> lck(mMtx);
+      mStop = true;
+    }
+    mCv.notify_all();
+    mWorker.join();
+  }
+
+  void Sh3TruncationPool::workerLoop() {
+    std::unique_lock<std::mutex> lck(mMtx);
+    while (true) {
+      mCv.wait(lck, [this]() {
+        return mStop || mNextChunk - mConsumeIdx < mMaxChunks;
+      });
+      if (mStop)
+        break;
+
+      u64 idx = mNextChunk++;
+      lck.unlock();
+
+      auto start = std::chrono::steady_clock::now();
+      Chunk chunk;
+      generate(idx, chunk);
+      double seconds = secondsSince(start);
+
+      lck.lock();
+      mReady.emplace(idx, std::move(chunk));
+      mStats.mOfflineSeconds += seconds;
+      mCv.notify_all();
+    }
+  }
+
+  void Sh3TruncationPool::takeChunk() {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lck(mMtx);
+    u64 idx = mConsumeIdx++;
+    auto iter = mReady.find(idx);
+    if (iter == mReady.end()) {
+      if (idx >= mNextChunk) {
+        // Nobody generated this chunk, the background thread continues
+        // after it.
+        mNextChunk = idx + 1;
+        lck.unlock();
+        generate(idx, mCur);
+        mCurOffset = 0;
+
+        lck.lock();
+        mStats.mInline += kChunkSize;
+        mStats.mOnlineSeconds += secondsSince(start);
+        mCv.notify_all();
+        return;
+      }
+
+      // The background thread is generating it right now.
+      mCv.wait(lck, [this, idx]() { return mReady.count(idx) > 0; });
+      iter = mReady.find(idx);
+      mStats.mOnlineSeconds += secondsSince(start);
+    }
+
+    mCur = std::move(iter->second);
+    mReady.erase(iter);
+    mCurOffset = 0;
+    mStats.mPooled += kChunkSize;
+    mCv.notify_all();
+  }
+
+  void Sh3TruncationPool::get(i64* next, i64* prev, u64 n) {
+    while (n) {
+      if (mCurOffset == kChunkSize)
+        takeChunk();
+
+      u64 count = std::min(n, kChunkSize - mCurOffset);
+      auto nextSrc = reinterpret_cast<const u8*>(mCur.mNext.data());
+      auto prevSrc = reinterpret_cast<const u8*>(mCur.mPrev.data());
+      std::memcpy(next, nextSrc + mCurOffset * sizeof(i64),
+                  count * sizeof(i64));
+      std::memcpy(prev, prevSrc + mCurOffset * sizeof(i64),
+                  count * sizeof(i64));
+
+      mCurOffset += count;
+      next += count;
+      prev += count;
+      n -= count;
+    }
+  }
+
+  Sh3TruncationPool::Stats Sh3TruncationPool::getStats() {
+    std::lock_guard<std::mutex> lck(mMtx);
+    return mStats;
+  }
+
+  void Sh3TruncationPool::resetStats() {
+    std::lock_guard<std::mutex> lck(mMtx);
+    mStats = Stats();
+  }
+
+}  // namespace primihub
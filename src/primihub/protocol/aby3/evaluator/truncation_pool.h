@@ -0,0 +1,94 @@
+#ifndef SRC_primihub_PROTOCOL_ABY3_EVALUATOR_TRUNCATION_POOL_H_
+#define SRC_primihub_PROTOCOL_ABY3_EVALUATOR_TRUNCATION_POOL_H_
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/primihub/common/defines.h"
+#include "src/primihub/util/crypto/aes/aes.h"
+
+namespace primihub {
+
+// Preprocessed randomness of truncation pairs. Both shares of a pair come
+// from AES in counter mode under a key common with the next party and one
+// common with the previous party, so element i is the same whichever
+// thread generated it and whenever it did. The elements are generated
+// ahead of time, by fill() in an offline phase or by a background thread,
+// into a bounded pool which the online multiplications consume in order.
+// Every party consumes the same elements in the same order since they run
+// the same circuit, and a chunk the pool does not hold yet is generated on
+// the online path.
+class Sh3TruncationPool {
+ public:
+  // elements generated at once, the pool holds whole chunks.
+  static const u64 kChunkSize = 4096;
+
+  struct Stats {
+    // elements taken from the pool and generated on the online path.
+    u64 mPooled = 0;
+    u64 mInline = 0;
+    // time spent on generating ahead of use, and on generating or
+    // waiting for elements on the online path.
+    double mOfflineSeconds = 0;
+    double mOnlineSeconds = 0;
+  };
+
+  Sh3TruncationPool() = default;
+  Sh3TruncationPool(const Sh3TruncationPool&) = delete;
+  Sh3TruncationPool& operator=(const Sh3TruncationPool&) = delete;
+  ~Sh3TruncationPool() { stop(); }
+
+  // capacity is the max number of elements the pool holds.
+  void init(const block& prevKey, const block& nextKey,
+            u64 capacity = 1 << 18);
+
+  // Generate elements in the calling thread until n, or capacity, are
+  // ready.
+  void fill(u64 n);
+
+  // Keep the pool full in a background thread until stop().
+  void start();
+  void stop();
+
+  // Take the next n elements, next and prev receive the shares common
+  // with the next and the previous party.
+  void get(i64* next, i64* prev, u64 n);
+
+  Stats getStats();
+  void resetStats();
+
+ private:
+  struct Chunk {
+    std::vector<block> mNext, mPrev;
+  };
+
+  void generate(u64 idx, Chunk& chunk) const;
+  // Make mCur the next chunk to consume.
+  void takeChunk();
+  void workerLoop();
+
+  AES_Type mNextAes, mPrevAes;
+  u64 mMaxChunks = 0;
+
+  std::mutex mMtx;
+  std::condition_variable mCv;
+  // generated chunks which are not consumed yet.
+  std::map<u64, Chunk> mReady;
+  // first chunk not consumed and first chunk nobody generated, the chunks
+  // in between are ready or being generated by the background thread.
+  u64 mConsumeIdx = 0, mNextChunk = 0;
+  bool mStop = false;
+  std::thread mWorker;
+  Stats mStats;
+
+  // chunk being consumed, only touched by the online path.
+  Chunk mCur;
+  u64 mCurOffset = kChunkSize;
+};
+
+}  // namespace primihub
+
+#endif  // SRC_primihub_PROTOCOL_ABY3_EVALUATOR_TRUNCATION_POOL_H_
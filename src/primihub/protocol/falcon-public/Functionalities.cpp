@@ -14,85 +14,33 @@ namespace primihub
 		extern string SECURITY_TYPE;
 
 		/******************************** Functionalities 2PC ********************************/
-		// Share Truncation, truncate shares of a by power (in place) (power is logarithmic)
-		void funcTruncate(RSSVectorMyType &a, size_t power, size_t size)
+		// Truncation by a public divisor on the planes of a: a - rPrime is
+		// opened, divided in the clear and added back onto r.
+		static void funcTruncatePlanes(RSSVectorMyType &a, size_t divisor, size_t size)
 		{
-			log_print("funcTruncate");
-
-			RSSVectorMyType r(size), rPrime(size);
+			assert(a.size() == size && "a.size mismatch for truncate function");
+			RSSPlanes planes(a), r, rPrime;
 			vector<myType> reconst(size);
-			PrecomputeObject.getDividedShares(r, rPrime, (1 << power), size);
-			for (int i = 0; i < size; ++i)
-				a[i] = a[i] - rPrime[i];
-
-			funcReconstruct(a, reconst, size, "Truncate reconst", false);
-			dividePlain(reconst, (1 << power));
-			if (partyNum == PARTY_A)
-			{
-				for (int i = 0; i < size; ++i)
-				{
-					a[i].first = r[i].first + reconst[i];
-					a[i].second = r[i].second;
-				}
-			}
+			PrecomputeObject.getDividedShares(r, rPrime, divisor, size);
+			subtractPlanes(planes, rPrime, planes);
 
-			if (partyNum == PARTY_B)
-			{
-				for (int i = 0; i < size; ++i)
-				{
-					a[i].first = r[i].first;
-					a[i].second = r[i].second;
-				}
-			}
+			funcReconstruct(planes, reconst, size, "Truncate reconst", false);
+			dividePlain(reconst, divisor);
+			addPublicShare(r, reconst.data(), partyNum);
+			r.toVector(a);
+		}
 
-			if (partyNum == PARTY_C)
-			{
-				for (int i = 0; i < size; ++i)
-				{
-					a[i].first = r[i].first;
-					a[i].second = r[i].second + reconst[i];
-				}
-			}
+		// Share Truncation, truncate shares of a by power (in place) (power is logarithmic)
+		void funcTruncate(RSSVectorMyType &a, size_t power, size_t size)
+		{
+			log_print("funcTruncate");
+			funcTruncatePlanes(a, (1 << power), size);
 		}
 
 		void funcTruncatePublic(RSSVectorMyType &a, size_t divisor, size_t size)
 		{
 			log_print("funcTruncate");
-
-			RSSVectorMyType r(size), rPrime(size);
-			vector<myType> reconst(size);
-			PrecomputeObject.getDividedShares(r, rPrime, divisor, size);
-			for (int i = 0; i < size; ++i)
-				a[i] = a[i] - rPrime[i];
-
-			funcReconstruct(a, reconst, size, "Truncate reconst", false);
-			dividePlain(reconst, divisor);
-			if (partyNum == PARTY_A)
-			{
-				for (int i = 0; i < size; ++i)
-				{
-					a[i].first = r[i].first + reconst[i];
-					a[i].second = r[i].second;
-				}
-			}
-
-			if (partyNum == PARTY_B)
-			{
-				for (int i = 0; i < size; ++i)
-				{
-					a[i].first = r[i].first;
-					a[i].second = r[i].second;
-				}
-			}
-
-			if (partyNum == PARTY_C)
-			{
-				for (int i = 0; i < size; ++i)
-				{
-					a[i].first = r[i].first;
-					a[i].second = r[i].second + reconst[i];
-				}
-			}
+			funcTruncatePlanes(a, divisor, size);
 		}
 
 		// Fixed-point data has to be processed outside this function.
@@ -305,6 +253,45 @@ namespace primihub
 			}
 		}
 
+		// Semi-honest reconstruction sends plane(0) as it is, the malicious
+		// one goes through the RSSVectorMyType version.
+		void funcReconstruct(const RSSPlanes &a, vector<myType> &b, size_t size, string str, bool print)
+		{
+			log_print("Reconst: RSSPlanes, myType");
+			assert(a.size() == size && "a.size mismatch for reconstruct function");
+
+			if (SECURITY_TYPE.compare("Semi-honest") != 0)
+			{
+				RSSVectorMyType temp;
+				a.toVector(temp);
+				funcReconstruct(temp, b, size, str, print);
+				return;
+			}
+
+			vector<myType> a_prev(size, 0);
+			addPlane(a.plane(0), a.plane(1), b.data(), size);
+
+			thread *threads = new thread[2];
+
+			threads[0] = thread(sendBuffer<myType>, a.plane(0), nextParty(partyNum), size);
+			threads[1] = thread(receiveVector<myType>, ref(a_prev), prevParty(partyNum), size);
+
+			for (int i = 0; i < 2; i++)
+				threads[i].join();
+
+			delete[] threads;
+
+			addPlane(b.data(), a_prev.data(), b.data(), size);
+
+			if (print)
+			{
+				std::cout << str << ": \t\t";
+				for (int i = 0; i < size; ++i)
+					print_linear(b[i], "SIGNED");
+				std::cout << std::endl;
+			}
+		}
+
 		void funcReconstruct(const RSSVectorMyType &a, vector<myType> &b, size_t size, string str, bool print)
 		{
 			log_print("Reconst: RSSMyType, myType");
@@ -678,46 +665,17 @@ namespace primihub
 
 			matrixMultRSS(a, b, temp3, rows, common_dim, columns, transpose_a, transpose_b);
 
-			RSSVectorMyType r(final_size), rPrime(final_size);
+			RSSPlanes r, rPrime;
 			PrecomputeObject.getDividedShares(r, rPrime, (1 << truncation), final_size);
-			for (int i = 0; i < final_size; ++i)
-				temp3[i] = temp3[i] - rPrime[i].first;
+			subtractPlane(temp3.data(), rPrime.plane(0), temp3.data(), final_size);
 
 			funcReconstruct3out3(temp3, diffReconst, final_size, "Mat-Mul diff reconst", false);
 			if (SECURITY_TYPE.compare("Malicious") == 0)
 				funcCheckMaliciousMatMul(a, b, c, temp3, rows, common_dim, columns, transpose_a, transpose_b);
 			dividePlain(diffReconst, (1 << truncation));
 
-			// for (int i = 0; i < 128; ++i)
-			// 	print_linear(diffReconst[i], "FLOAT");
-			// cout << endl;
-
-			if (partyNum == PARTY_A)
-			{
-				for (int i = 0; i < final_size; ++i)
-				{
-					c[i].first = r[i].first + diffReconst[i];
-					c[i].second = r[i].second;
-				}
-			}
-
-			if (partyNum == PARTY_B)
-			{
-				for (int i = 0; i < final_size; ++i)
-				{
-					c[i].first = r[i].first;
-					c[i].second = r[i].second;
-				}
-			}
-
-			if (partyNum == PARTY_C)
-			{
-				for (int i = 0; i < final_size; ++i)
-				{
-					c[i].first = r[i].first;
-					c[i].second = r[i].second + diffReconst[i];
-				}
-			}
+			addPublicShare(r, diffReconst.data(), partyNum);
+			r.toVector(c);
 		}
 
 		// Term by term multiplication of 64-bit vectors overriding precision
@@ -730,74 +688,36 @@ namespace primihub
 			assert(c.size() == size && "Matrix c incorrect for Mat-Mul");
 
 			vector<myType> temp3(size, 0);
+			RSSPlanes planes_a(a), planes_b(b);
+			dotProductPlanes(planes_a, planes_b, temp3.data());
 
 			if (truncation == false)
 			{
-				vector<myType> recv(size, 0);
-				for (int i = 0; i < size; ++i)
-				{
-					temp3[i] += a[i].first * b[i].first +
-								a[i].first * b[i].second +
-								a[i].second * b[i].first;
-				}
+				RSSPlanes product(size);
+				std::copy(temp3.begin(), temp3.end(), product.plane(0));
 
 				thread *threads = new thread[2];
 
-				threads[0] = thread(sendVector<myType>, ref(temp3), prevParty(partyNum), size);
-				threads[1] = thread(receiveVector<myType>, ref(recv), nextParty(partyNum), size);
+				threads[0] = thread(sendBuffer<myType>, product.plane(0), prevParty(partyNum), size);
+				threads[1] = thread(receiveBuffer<myType>, product.plane(1), nextParty(partyNum), size);
 
 				for (int i = 0; i < 2; i++)
 					threads[i].join();
 				delete[] threads;
 
-				for (int i = 0; i < size; ++i)
-				{
-					c[i].first = temp3[i];
-					c[i].second = recv[i];
-				}
+				product.toVector(c);
 			}
 			else
 			{
 				vector<myType> diffReconst(size, 0);
-				RSSVectorMyType r(size), rPrime(size);
+				RSSPlanes r, rPrime;
 				PrecomputeObject.getDividedShares(r, rPrime, (1 << precision), size);
-
-				for (int i = 0; i < size; ++i)
-				{
-					temp3[i] += a[i].first * b[i].first +
-								a[i].first * b[i].second +
-								a[i].second * b[i].first -
-								rPrime[i].first;
-				}
+				subtractPlane(temp3.data(), rPrime.plane(0), temp3.data(), size);
 
 				funcReconstruct3out3(temp3, diffReconst, size, "Dot-product diff reconst", false);
 				dividePlain(diffReconst, (1 << precision));
-				if (partyNum == PARTY_A)
-				{
-					for (int i = 0; i < size; ++i)
-					{
-						c[i].first = r[i].first + diffReconst[i];
-						c[i].second = r[i].second;
-					}
-				}
-
-				if (partyNum == PARTY_B)
-				{
-					for (int i = 0; i < size; ++i)
-					{
-						c[i].first = r[i].first;
-						c[i].second = r[i].second;
-					}
-				}
-
-				if (partyNum == PARTY_C)
-				{
-					for (int i = 0; i < size; ++i)
-					{
-						c[i].first = r[i].first;
-						c[i].second = r[i].second + diffReconst[i];
-					}
-				}
+				addPublicShare(r, diffReconst.data(), partyNum);
+				r.toVector(c);
 			}
 			if (SECURITY_TYPE.compare("Malicious") == 0)
 				funcCheckMaliciousDotProd(a, b, c, temp3, size);
@@ -1,6 +1,7 @@
 
 #pragma once
 #include "tools.h"
+#include "RSSPlanes.h"
 #include "connect.h"
 #include "globals.h"
 using namespace std;
@@ -21,6 +22,7 @@ void funcGetShares(RSSVectorMyType &a, const vector<myType> &data);
 void funcGetShares(RSSVectorSmallType &a, const vector<smallType> &data);
 void funcReconstructBit(const RSSVectorSmallType &a, vector<smallType> &b, size_t size, string str, bool print);
 void funcReconstruct(const RSSVectorMyType &a, vector<myType> &b, size_t size, string str, bool print);
+void funcReconstruct(const RSSPlanes &a, vector<myType> &b, size_t size, string str, bool print);
 void funcReconstruct(const RSSVectorSmallType &a, vector<smallType> &b, size_t size, string str, bool print);
 void funcReconstruct3out3(const vector<myType> &a, vector<myType> &b, size_t size, string str, bool print);
 void funcMatMul(const RSSVectorMyType &a, const RSSVectorMyType &b, RSSVectorMyType &c, 
@@ -30,6 +30,17 @@ namespace primihub
 			}
 		}
 
+		void Precompute::getDividedShares(RSSPlanes &r, RSSPlanes &rPrime, int d, size_t size)
+		{
+			r.resize(size);
+			rPrime.resize(size);
+			for (int i = 0; i < 2; ++i)
+			{
+				std::fill(r.plane(i), r.plane(i) + size, 0);
+				std::fill(rPrime.plane(i), rPrime.plane(i) + size, 0);
+			}
+		}
+
 		void Precompute::getRandomBitShares(RSSVectorSmallType &a, size_t size)
 		{
 			assert(a.size() == size && "size mismatch for getRandomBitShares");
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "globals.h"
+#include "RSSPlanes.h"
 
 namespace primihub
 {
@@ -19,6 +20,7 @@ namespace primihub
 			~Precompute();
 
 			void getDividedShares(RSSVectorMyType &r, RSSVectorMyType &rPrime, int d, size_t size);
+			void getDividedShares(RSSPlanes &r, RSSPlanes &rPrime, int d, size_t size);
 			void getRandomBitShares(RSSVectorSmallType &a, size_t size);
 			void getSelectorBitShares(RSSVectorSmallType &c, RSSVectorMyType &m_c, size_t size);
 			void getShareConvertObjects(RSSVectorMyType &r, RSSVectorSmallType &shares_r, RSSVectorSmallType &alpha, size_t size);
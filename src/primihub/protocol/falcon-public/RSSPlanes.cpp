@@ -0,0 +1,229 @@
+
+#include "RSSPlanes.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace primihub
+{
+	namespace falcon
+	{
+		static_assert(sizeof(myType) == 4, "The plane kernels work on 32 bit lanes");
+
+		// Block of b kept in cache while all rows of a go over it,
+		// MATMUL_BLOCK_K x MATMUL_BLOCK_N words of two planes is 256 KB.
+#define MATMUL_BLOCK_K 128
+#define MATMUL_BLOCK_N 256
+
+		void RSSPlanes::resize(size_t size)
+		{
+			m_size = size;
+			m_plane[0].resize(size);
+			m_plane[1].resize(size);
+		}
+
+		void RSSPlanes::fromVector(const RSSVectorMyType &vec)
+		{
+			resize(vec.size());
+			myType *p0 = plane(0), *p1 = plane(1);
+			for (size_t i = 0; i < m_size; ++i)
+			{
+				p0[i] = vec[i].first;
+				p1[i] = vec[i].second;
+			}
+		}
+
+		void RSSPlanes::fromMatrix(const RSSVectorMyType &vec, size_t rows, size_t columns, bool transpose)
+		{
+			assert(vec.size() == rows * columns && "Matrix size mismatch for fromMatrix");
+			if (!transpose)
+			{
+				fromVector(vec);
+				return;
+			}
+
+			resize(rows * columns);
+			myType *p0 = plane(0), *p1 = plane(1);
+			for (size_t i = 0; i < rows; ++i)
+				for (size_t j = 0; j < columns; ++j)
+				{
+					p0[i * columns + j] = vec[j * rows + i].first;
+					p1[i * columns + j] = vec[j * rows + i].second;
+				}
+		}
+
+		void RSSPlanes::toVector(RSSVectorMyType &vec) const
+		{
+			vec.resize(m_size);
+			const myType *p0 = plane(0), *p1 = plane(1);
+			for (size_t i = 0; i < m_size; ++i)
+			{
+				vec[i].first = p0[i];
+				vec[i].second = p1[i];
+			}
+		}
+
+		void addPlane(const myType *a, const myType *b, myType *c, size_t size)
+		{
+			size_t i = 0;
+#ifdef __AVX2__
+			for (; i + 8 <= size; i += 8)
+			{
+				__m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+				__m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+				_mm256_storeu_si256((__m256i *)(c + i), _mm256_add_epi32(va, vb));
+			}
+#endif
+			for (; i < size; ++i)
+				c[i] = a[i] + b[i];
+		}
+
+		void subtractPlane(const myType *a, const myType *b, myType *c, size_t size)
+		{
+			size_t i = 0;
+#ifdef __AVX2__
+			for (; i + 8 <= size; i += 8)
+			{
+				__m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+				__m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+				_mm256_storeu_si256((__m256i *)(c + i), _mm256_sub_epi32(va, vb));
+			}
+#endif
+			for (; i < size; ++i)
+				c[i] = a[i] - b[i];
+		}
+
+		void addPlanes(const RSSPlanes &a, const RSSPlanes &b, RSSPlanes &c)
+		{
+			assert(a.size() == b.size() && "Size mismatch for addPlanes");
+			c.resize(a.size());
+			addPlane(a.plane(0), b.plane(0), c.plane(0), a.size());
+			addPlane(a.plane(1), b.plane(1), c.plane(1), a.size());
+		}
+
+		void subtractPlanes(const RSSPlanes &a, const RSSPlanes &b, RSSPlanes &c)
+		{
+			assert(a.size() == b.size() && "Size mismatch for subtractPlanes");
+			c.resize(a.size());
+			subtractPlane(a.plane(0), b.plane(0), c.plane(0), a.size());
+			subtractPlane(a.plane(1), b.plane(1), c.plane(1), a.size());
+		}
+
+		// a.first * b.first + a.first * b.second + a.second * b.first, with
+		// the first two terms folded into one multiplication.
+		void dotProductPlanes(const RSSPlanes &a, const RSSPlanes &b, myType *c)
+		{
+			assert(a.size() == b.size() && "Size mismatch for dotProductPlanes");
+			const myType *a0 = a.plane(0), *a1 = a.plane(1);
+			const myType *b0 = b.plane(0), *b1 = b.plane(1);
+			size_t size = a.size(), i = 0;
+#ifdef __AVX2__
+			for (; i + 8 <= size; i += 8)
+			{
+				__m256i va0 = _mm256_loadu_si256((const __m256i *)(a0 + i));
+				__m256i va1 = _mm256_loadu_si256((const __m256i *)(a1 + i));
+				__m256i vb0 = _mm256_loadu_si256((const __m256i *)(b0 + i));
+				__m256i vb1 = _mm256_loadu_si256((const __m256i *)(b1 + i));
+				__m256i acc = _mm256_mullo_epi32(va0, _mm256_add_epi32(vb0, vb1));
+				acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(va1, vb0));
+				_mm256_storeu_si256((__m256i *)(c + i), acc);
+			}
+#endif
+			for (; i < size; ++i)
+				c[i] = a0[i] * (b0[i] + b1[i]) + a1[i] * b0[i];
+		}
+
+		// c[j] += x * u[j] + y * v[j] for j in [0, size).
+		static inline void multiplyAddRow(myType *c, myType x, const myType *u,
+										  myType y, const myType *v, size_t size)
+		{
+			size_t j = 0;
+#ifdef __AVX2__
+			__m256i vx = _mm256_set1_epi32(x), vy = _mm256_set1_epi32(y);
+			for (; j + 8 <= size; j += 8)
+			{
+				__m256i acc = _mm256_loadu_si256((const __m256i *)(c + j));
+				__m256i vu = _mm256_loadu_si256((const __m256i *)(u + j));
+				__m256i vv = _mm256_loadu_si256((const __m256i *)(v + j));
+				acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(vx, vu));
+				acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(vy, vv));
+				_mm256_storeu_si256((__m256i *)(c + j), acc);
+			}
+#endif
+			for (; j < size; ++j)
+				c[j] += x * u[j] + y * v[j];
+		}
+
+		// With bSum = b.first + b.second the share is
+		// a.first * bSum + a.second * b.first, two products per term instead
+		// of three. The loops go over blocks of b so that a block stays in
+		// cache for all rows of a, and the innermost loop runs along a row
+		// of b and c.
+		void matMulPlanes(const RSSPlanes &a, const RSSPlanes &b, myType *c,
+						  size_t rows, size_t common_dim, size_t columns)
+		{
+			assert(a.size() == rows * common_dim && "Matrix a incorrect for matMulPlanes");
+			assert(b.size() == common_dim * columns && "Matrix b incorrect for matMulPlanes");
+
+			PlaneVector bSum(b.size());
+			addPlane(b.plane(0), b.plane(1), bSum.data(), b.size());
+			const myType *a0 = a.plane(0), *a1 = a.plane(1), *b0 = b.plane(0);
+
+			std::memset(c, 0, rows * columns * sizeof(myType));
+			for (size_t jj = 0; jj < columns; jj += MATMUL_BLOCK_N)
+			{
+				size_t jEnd = std::min(columns, jj + MATMUL_BLOCK_N);
+				for (size_t kk = 0; kk < common_dim; kk += MATMUL_BLOCK_K)
+				{
+					size_t kEnd = std::min(common_dim, kk + MATMUL_BLOCK_K);
+					for (size_t i = 0; i < rows; ++i)
+					{
+						myType *cRow = c + i * columns + jj;
+						for (size_t k = kk; k < kEnd; ++k)
+							multiplyAddRow(cRow, a0[i * common_dim + k], bSum.data() + k * columns + jj,
+										   a1[i * common_dim + k], b0 + k * columns + jj, jEnd - jj);
+					}
+				}
+			}
+		}
+
+		void dividePlainPow2(myType *vec, size_t size, size_t power)
+		{
+			assert(power < BIT_SIZE - 1 && "Power too large for dividePlainPow2");
+			if (power == 0)
+				return;
+
+			// Negative values get 2^power - 1 added first so that the
+			// arithmetic shift rounds towards zero.
+			size_t i = 0;
+#ifdef __AVX2__
+			__m128i count = _mm_cvtsi32_si128((int)power);
+			__m128i biasCount = _mm_cvtsi32_si128((int)(BIT_SIZE - power));
+			for (; i + 8 <= size; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256((const __m256i *)(vec + i));
+				__m256i bias = _mm256_srl_epi32(_mm256_srai_epi32(v, 31), biasCount);
+				_mm256_storeu_si256((__m256i *)(vec + i), _mm256_sra_epi32(_mm256_add_epi32(v, bias), count));
+			}
+#endif
+			for (; i < size; ++i)
+			{
+				int32_t v = (int32_t)vec[i];
+				myType bias = (myType)(v >> 31) >> (BIT_SIZE - power);
+				vec[i] = (myType)((int32_t)(vec[i] + bias) >> power);
+			}
+		}
+
+		void addPublicShare(RSSPlanes &a, const myType *value, int party)
+		{
+			if (party == PARTY_A)
+				addPlane(a.plane(0), value, a.plane(0), a.size());
+			if (party == PARTY_C)
+				addPlane(a.plane(1), value, a.plane(1), a.size());
+		}
+	} // namespace falcon
+} // namespace primihub
@@ -0,0 +1,95 @@
+
+#ifndef RSS_PLANES_H
+#define RSS_PLANES_H
+
+#pragma once
+#include "globals.h"
+#include <cstdlib>
+#include <new>
+
+namespace primihub
+{
+	namespace falcon
+	{
+#define PLANE_ALIGNMENT 32
+
+		// Allocates planes on PLANE_ALIGNMENT so that a plane starts on a
+		// 256 bit lane and whole vectors of it never straddle a cache line.
+		template <typename T>
+		struct PlaneAllocator
+		{
+			typedef T value_type;
+
+			PlaneAllocator() = default;
+			template <typename U>
+			PlaneAllocator(const PlaneAllocator<U> &) {}
+
+			T *allocate(size_t n)
+			{
+				size_t bytes = (n * sizeof(T) + PLANE_ALIGNMENT - 1) / PLANE_ALIGNMENT * PLANE_ALIGNMENT;
+				void *ptr = _aligned_malloc(bytes, PLANE_ALIGNMENT);
+				if (ptr == nullptr)
+					throw std::bad_alloc();
+				return static_cast<T *>(ptr);
+			}
+			void deallocate(T *ptr, size_t) { _aligned_free(ptr); }
+
+			template <typename U>
+			bool operator==(const PlaneAllocator<U> &) const { return true; }
+			template <typename U>
+			bool operator!=(const PlaneAllocator<U> &) const { return false; }
+		};
+
+		typedef std::vector<myType, PlaneAllocator<myType>> PlaneVector;
+
+		// Replicated shares with the two halves of every share in separate
+		// planes, plane(0) holds what RSSVectorMyType keeps in .first and
+		// plane(1) what it keeps in .second. The kernels below then work on
+		// whole vectors of one plane and a plane can be sent as it is.
+		class RSSPlanes
+		{
+		public:
+			RSSPlanes() {}
+			explicit RSSPlanes(size_t size) { resize(size); }
+			explicit RSSPlanes(const RSSVectorMyType &vec) { fromVector(vec); }
+
+			void resize(size_t size);
+			size_t size() const { return m_size; }
+
+			myType *plane(int i) { return m_plane[i].data(); }
+			const myType *plane(int i) const { return m_plane[i].data(); }
+
+			void fromVector(const RSSVectorMyType &vec);
+			// Packs a rows x columns matrix, vec holds its transpose if
+			// transpose is set.
+			void fromMatrix(const RSSVectorMyType &vec, size_t rows, size_t columns, bool transpose);
+			void toVector(RSSVectorMyType &vec) const;
+
+		private:
+			size_t m_size = 0;
+			PlaneVector m_plane[2];
+		};
+
+		// c = a + b and c = a - b on both planes, c may alias a or b.
+		void addPlanes(const RSSPlanes &a, const RSSPlanes &b, RSSPlanes &c);
+		void subtractPlanes(const RSSPlanes &a, const RSSPlanes &b, RSSPlanes &c);
+		void addPlane(const myType *a, const myType *b, myType *c, size_t size);
+		void subtractPlane(const myType *a, const myType *b, myType *c, size_t size);
+
+		// This party's 3-out-of-3 share of the term by term product of a and b.
+		void dotProductPlanes(const RSSPlanes &a, const RSSPlanes &b, myType *c);
+
+		// This party's 3-out-of-3 share of the product of the rows x common_dim
+		// matrix a and the common_dim x columns matrix b, both row major.
+		void matMulPlanes(const RSSPlanes &a, const RSSPlanes &b, myType *c,
+						  size_t rows, size_t common_dim, size_t columns);
+
+		// Signed division by 2^power rounding towards zero, same as dividePlain.
+		void dividePlainPow2(myType *vec, size_t size, size_t power);
+
+		// Adds the public value to the share, PARTY_A holds it in plane(0)
+		// and PARTY_C in plane(1).
+		void addPublicShare(RSSPlanes &a, const myType *value, int party);
+	} // namespace falcon
+} // namespace primihub
+#endif
@@ -41,6 +41,10 @@ namespace primihub
     void resume_communication();
     void end_communication(string str);
 
+    template <typename T>
+    void sendBuffer(const T *data, size_t player, size_t size);
+    template <typename T>
+    void receiveBuffer(T *data, size_t player, size_t size);
     template <typename T>
     void sendVector(const vector<T> &vec, size_t player, size_t size);
     template <typename T>
@@ -150,6 +154,22 @@ namespace primihub
     // 	delete[] threads;
     // }
 
+    // Sends size elements starting at data, e.g. one plane of RSSPlanes
+    // without copying it into a vector first.
+    template <typename T>
+    void sendBuffer(const T *data, size_t player, size_t size)
+    {
+      if (!communicationSenders[player]->sendMsg(data, size * sizeof(T), 0))
+        cout << "Send vector error" << endl;
+    }
+
+    template <typename T>
+    void receiveBuffer(T *data, size_t player, size_t size)
+    {
+      if (!communicationReceivers[player]->receiveMsg(data, size * sizeof(T), 0))
+        cout << "Receive myType vector error" << endl;
+    }
+
     template <typename T>
     void sendVector(const vector<T> &vec, size_t player, size_t size)
     {
@@ -166,8 +186,7 @@ namespace primihub
         cout << "smallType" << endl;
 #endif
 
-      if (!communicationSenders[player]->sendMsg(vec.data(), size * sizeof(T), 0))
-        cout << "Send vector error" << endl;
+      sendBuffer<T>(vec.data(), player, size);
     }
 
     template <typename T>
@@ -186,9 +205,7 @@ namespace primihub
         cout << "smallType" << endl;
 #endif
 
-      if (!communicationReceivers[player]->receiveMsg(vec.data(), size * sizeof(T),
-                                                      0))
-        cout << "Receive myType vector error" << endl;
+      receiveBuffer<T>(vec.data(), player, size);
     }
 
     template <typename T>
@@ -4,6 +4,7 @@
 #include <mutex>
 #include <bitset>
 #include "EigenMatMul.h"
+#include "RSSPlanes.h"
 
 using namespace std;
 namespace primihub
@@ -455,45 +456,12 @@ namespace primihub
 						   size_t transpose_a, size_t transpose_b)
 		{
 #if (!USING_EIGEN)
-			/********************************* Triple For Loop *********************************/
-			RSSVectorMyType triple_a(rows * common_dim), triple_b(common_dim * columns);
-
-			for (size_t i = 0; i < rows; ++i)
-			{
-				for (size_t j = 0; j < common_dim; ++j)
-				{
-					if (transpose_a)
-						triple_a[i * common_dim + j] = a[j * rows + i];
-					else
-						triple_a[i * common_dim + j] = a[i * common_dim + j];
-				}
-			}
-
-			for (size_t i = 0; i < common_dim; ++i)
-			{
-				for (size_t j = 0; j < columns; ++j)
-				{
-					if (transpose_b)
-						triple_b[i * columns + j] = b[j * common_dim + i];
-					else
-						triple_b[i * columns + j] = b[i * columns + j];
-				}
-			}
-
-			for (int i = 0; i < rows; ++i)
-			{
-				for (int j = 0; j < columns; ++j)
-				{
-					temp3[i * columns + j] = 0;
-					for (int k = 0; k < common_dim; ++k)
-					{
-						temp3[i * columns + j] += triple_a[i * common_dim + k].first * triple_b[k * columns + j].first +
-												  triple_a[i * common_dim + k].first * triple_b[k * columns + j].second +
-												  triple_a[i * common_dim + k].second * triple_b[k * columns + j].first;
-					}
-				}
-			}
-/********************************* Triple For Loop *********************************/
+			/********************************* Blocked Mat-Mul on planes *********************************/
+			RSSPlanes planes_a, planes_b;
+			planes_a.fromMatrix(a, rows, common_dim, transpose_a);
+			planes_b.fromMatrix(b, common_dim, columns, transpose_b);
+			matMulPlanes(planes_a, planes_b, temp3.data(), rows, common_dim, columns);
+/********************************* Blocked Mat-Mul on planes *********************************/
 #endif
 #if (USING_EIGEN)
 			/********************************* WITH EIGEN Mat-Mul *********************************/
@@ -556,6 +524,15 @@ namespace primihub
 		{
 			assert((divisor != 0) && "Cannot divide by 0");
 
+			if (BIT_SIZE == 32 && divisor > 0 && (divisor & (divisor - 1)) == 0)
+			{
+				size_t power = 0;
+				while ((1 << power) != divisor)
+					++power;
+				dividePlainPow2(vec.data(), vec.size(), power);
+				return;
+			}
+
 			if (BIT_SIZE == 32)
 				for (int i = 0; i < vec.size(); ++i)
 					vec[i] = (myType)((double)((int32_t)vec[i]) / (double)((int32_t)divisor));
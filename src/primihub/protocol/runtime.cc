@@ -2,6 +2,7 @@
 #include "src/primihub/protocol/runtime.h"
 #include "src/primihub/protocol/scheduler.h"
 #include "src/primihub/common/defines.h"
+#include "src/primihub/common/finally.h"
 
 namespace primihub
 {
@@ -17,7 +18,7 @@ namespace primihub
 
       auto tt = mSched.addTask(TaskType::Round, deps2);
 
-      auto& newTask = mTasks.emplace(tt.mTaskIdx, ShTaskBase{}).first->second;
+      auto& newTask = mTasks.emplace(tt.mTaskIdx);
       newTask.mFunc = std::forward<ShTask::RoundFunc>(func);
       newTask.mName = std::forward<std::string>(name);
 
@@ -39,7 +40,7 @@ namespace primihub
 
       auto tt = mSched.addTask(TaskType::Round, deps2);
 
-      auto& newTask = mTasks.emplace(tt.mTaskIdx, ShTaskBase{}).first->second;
+      auto& newTask = mTasks.emplace(tt.mTaskIdx);
       newTask.mFunc = std::forward<ShTask::ContinuationFunc>(func);
       newTask.mName = std::forward<std::string>(name);
 
@@ -50,6 +51,30 @@ namespace primihub
     }
   }
 
+  ShTask Runtime::addTask(span<ShTask> deps,
+    ShTask::LocalFunc&& func, std::string&& name) {
+    if (func) {
+      std::vector<Task> deps2(deps.size());
+      for (u64 i = 0; i < deps.size(); ++i) {
+        deps2[i].mSched = &mSched;
+        deps2[i].mTaskIdx = deps[i].mIdx;
+      }
+
+      // A local task doesn't communicate, so it runs in the round its
+      // dependencies finish in and its children don't lose a round.
+      auto tt = mSched.addTask(TaskType::Continuation, deps2);
+
+      auto& newTask = mTasks.emplace(tt.mTaskIdx);
+      newTask.mFunc = std::forward<ShTask::LocalFunc>(func);
+      newTask.mName = std::forward<std::string>(name);
+
+      return { this, (i64)tt.mTaskIdx };
+    } else {
+      std::cout << "empty task (local function)" << std::endl;
+      throw RTE_LOC;
+    }
+  }
+
   ShTask Runtime::addClosure(ShTask dep) {
     Task dd;
     dd.mSched = &mSched;
@@ -68,7 +93,7 @@ namespace primihub
 
     auto tt = mSched.addTask(TaskType::Round, deps2);
 
-    auto& newTask = mTasks.emplace(tt.mTaskIdx, ShTaskBase{}).first->second;
+    auto& newTask = mTasks.emplace(tt.mTaskIdx);
     newTask.mFunc = ShTaskBase::And{};
     newTask.mName = std::forward<std::string>(name);
 
@@ -76,11 +101,13 @@ namespace primihub
   }
 
   void Runtime::runUntilTaskCompletes(ShTask task) {
+    Finally release([this]() { holdSends(false); });
     while (task.isCompleted() == false)
       runNext();
   }
 
   void Runtime::runAll() {
+    Finally release([this]() { holdSends(false); });
     while (mTasks.size())
       runNext();
   }
@@ -89,34 +116,104 @@ namespace primihub
     if (mSched.mTasks.size() == 0)
       return;
 
+    Finally release([this]() { holdSends(false); });
     mSched.currentTask();
     while (mSched.mReady.size()) {
       runNext();
     }
   }
 
+  void Runtime::holdSends(bool on) {
+    if (mHolding == on || mCommPtr == nullptr)
+      return;
+    // A task of the round may send to one party and wait for the other,
+    // which only answers once it got its own share of the round.
+    std::vector<Channel> group;
+    for (auto &chl : mCommPtr->mChannels)
+      group.push_back(chl.second);
+    for (auto &chl : mCommPtr->mChannels) {
+      if (on)
+        chl.second.flushWith(group);
+      chl.second.setCoalescing(on);
+    }
+    mHolding = on;
+  }
+
+  void Runtime::flushSends() {
+    if (mHolding == false)
+      return;
+    for (auto &chl : mCommPtr->mChannels)
+      chl.second.flushSends();
+  }
+
   void Runtime::runNext() {
     if (mIsActive)
       throw std::runtime_error("The runtime is currently running a different task. Do not call ShTask.get() recursively. " LOCATION);
 
+    if (mCoalesce) {
+      // The tasks of the next round wait for what this round sent.
+      if (mSched.mReady.size() == 0)
+        flushSends();
+      holdSends(true);
+    }
+
     auto tt = mSched.currentTask();
     auto task = mTasks.find(tt.mTaskIdx);
 
     ShTask t{ this, tt.mTaskIdx, ShTask::Type::Evaluation };
-    auto roundFuncPtr = boost::get<ShTask::RoundFunc>(&task->second.mFunc);
+    auto roundFuncPtr = boost::get<ShTask::RoundFunc>(&task->mFunc);
     auto continueFuncPtr = boost::get<ShTask::ContinuationFunc>(
-                                            &task->second.mFunc);
+                                            &task->mFunc);
+    auto localFuncPtr = boost::get<ShTask::LocalFunc>(&task->mFunc);
+
+    if (localFuncPtr && mPool) {
+      runLocalTasks();
+      return;
+    }
 
     mIsActive = true;
     if (roundFuncPtr)
       (*roundFuncPtr)(mCommPtr.get(), t);
     else if (continueFuncPtr)
       (*continueFuncPtr)(t);
+    else if (localFuncPtr)
+      (*localFuncPtr)();
     mIsActive = false;
 
-    mTasks.erase(task);
+    mTasks.erase(tt.mTaskIdx);
     mSched.popTask();
 
   }
 
+  void Runtime::runLocalTasks() {
+    // Only the local tasks at the front are taken, then the tasks they
+    // make ready are queued in the same order as if they ran one by one.
+    std::vector<ShTask::LocalFunc*> funcs;
+    for (auto idx : mSched.mReady) {
+      auto task = mTasks.find(idx);
+      auto localFuncPtr = task ?
+          boost::get<ShTask::LocalFunc>(&task->mFunc) : nullptr;
+      if (localFuncPtr == nullptr)
+        break;
+      funcs.push_back(localFuncPtr);
+    }
+
+    mIsActive = true;
+    try {
+      if (funcs.size() == 1)
+        (*funcs[0])();
+      else
+        mPool->run(funcs.size(), [&funcs](u64 i) { (*funcs[i])(); });
+    } catch (...) {
+      mIsActive = false;
+      throw;
+    }
+    mIsActive = false;
+
+    for (u64 i = 0; i < funcs.size(); ++i) {
+      mTasks.erase(mSched.mReady.front());
+      mSched.popTask();
+    }
+  }
+
 } // namespace primihub
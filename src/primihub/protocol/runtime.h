@@ -19,6 +19,8 @@
 #include "src/primihub/common/gsl/span"
 #include "src/primihub/protocol/scheduler.h"
 #include "src/primihub/protocol/sh_task.h"
+#include "src/primihub/protocol/task_slab.h"
+#include "src/primihub/protocol/work_stealing_pool.h"
 #include "src/primihub/util/log.h"
 #include "src/primihub/util/network/socket/commpkg.h"
 #include "src/primihub/util/network/socket/session.h"
@@ -49,6 +51,21 @@ public:
     mNullTask.mIdx = -1;
   }
 
+  // Run the local tasks which are ready at once on numWorkers threads
+  // besides the calling one, 0 runs every task on the calling thread.
+  // Communication and the order of every other task are unchanged.
+  void setWorkerNum(u64 numWorkers) {
+    if (numWorkers)
+      mPool = std::make_shared<WorkStealingPool>(numWorkers);
+    else
+      mPool.reset();
+  }
+
+  // Hold the sends of a round and write them as one batch per channel
+  // once the round is done, see Channel::setCoalescing. Whatever is held
+  // is also written when the runtime returns to its caller.
+  void setCoalescing(bool on) { mCoalesce = on; }
+
   const ShTask &noDependencies() const { return mNullTask; }
   operator ShTask() const { return noDependencies(); }
 
@@ -58,6 +75,9 @@ public:
   ShTask addTask(span<ShTask> deps, ShTask::ContinuationFunc &&func,
                  std::string &&name);
 
+  ShTask addTask(span<ShTask> deps, ShTask::LocalFunc &&func,
+                 std::string &&name);
+
   ShTask addClosure(ShTask dep);
   ShTask addAnd(span<ShTask> deps, std::string &&name);
 
@@ -65,6 +85,13 @@ public:
   void runNext();
   void runAll();
   void runOneRound();
+  // Run the local tasks at the front of the ready queue on the pool.
+  void runLocalTasks();
+
+  // The caller may wait for a reply to what a round sent, so the run
+  // functions stop holding sends when they return.
+  void holdSends(bool on);
+  void flushSends();
 
   // protected:
   bool mPrint = false;
@@ -72,9 +99,12 @@ public:
   std::shared_ptr<CommPkgBase> mCommPtr; // FIXME CommPkg需要被不同协议重新实现
 
   bool mIsActive = false;
-  std::unordered_map<u64, ShTaskBase> mTasks;
+  TaskSlab<ShTaskBase> mTasks;
   Scheduler mSched;
   ShTask mNullTask;
+  std::shared_ptr<WorkStealingPool> mPool;
+  bool mCoalesce = false;
+  bool mHolding = false;
 };
 
 } // namespace primihub
@@ -10,11 +10,11 @@ namespace primihub
         if (idx > mTaskIdx)
             throw RTE_LOC;
 
-        auto iter = mTasks.find(idx);
-        if (iter == mTasks.end())
+        auto task = mTasks.find(idx);
+        if (task == nullptr)
             throw RTE_LOC;
 
-        if (iter->second.mUpstream.size())
+        if (task->mUpstream.size())
             throw RTE_LOC;
 
         mReady.push_back(idx);
@@ -25,11 +25,11 @@ namespace primihub
         if (idx > mTaskIdx)
             throw RTE_LOC;
 
-        auto iter = mTasks.find(idx);
-        if (iter == mTasks.end())
+        auto task = mTasks.find(idx);
+        if (task == nullptr)
             throw RTE_LOC;
 
-        if (iter->second.mUpstream.size())
+        if (task->mUpstream.size())
             throw RTE_LOC;
 
         mNextRound.push_back(idx);
@@ -48,7 +48,7 @@ namespace primihub
     Task Scheduler::addTask(TaskType t, span<Task> deps)
     {
         auto idx = mTaskIdx++;
-        auto x = mTasks.emplace(idx, TaskBase(t, idx));
+        auto &x = mTasks.emplace(idx, t, idx);
 
         for (auto &d : deps)
         {
@@ -60,10 +60,10 @@ namespace primihub
 
             auto db = mTasks.find(d.mTaskIdx);
 
-            if (db != mTasks.end())
+            if (db != nullptr)
             {
-                db->second.addDownstream(idx);
-                x.first->second.addUpstream(d.mTaskIdx);
+                db->addDownstream(idx);
+                x.addUpstream(d.mTaskIdx);
             }
             else
             {
@@ -72,7 +72,7 @@ namespace primihub
             }
         }
 
-        if (x.first->second.mUpstream.size() == 0)
+        if (x.mUpstream.size() == 0)
         {
             addReady(idx);
         }
@@ -104,9 +104,9 @@ namespace primihub
 
             auto db = mTasks.find(d.mTaskIdx);
 
-            if (db != mTasks.end())
+            if (db != nullptr)
             {
-                db->second.addClosure(idx);
+                db->addClosure(idx);
                 x.addUpstream(d.mTaskIdx);
             }
             else
@@ -148,48 +148,48 @@ namespace primihub
     void Scheduler::removeTask(u64 idx)
     {
         auto task = mTasks.find(idx);
-        if (task == mTasks.end())
+        if (task == nullptr)
             throw RTE_LOC;
 
-        if (task->second.mUpstream.size())
+        if (task->mUpstream.size())
             throw RTE_LOC;
 
-        for (auto &d : task->second.mDownstream)
+        for (auto &d : task->mDownstream)
         {
             auto ds = mTasks.find(d);
-            if (ds == mTasks.end())
+            if (ds == nullptr)
                 throw RTE_LOC;
 
-            ds->second.removeUpstream(idx);
-            if (ds->second.mUpstream.size() == 0)
+            ds->removeUpstream(idx);
+            if (ds->mUpstream.size() == 0)
             {
-                if (ds->second.mType == TaskType::Round)
+                if (ds->mType == TaskType::Round)
                     addNextRound(d);
                 else
                     addReady(d);
             }
 
-            for (auto &c : task->second.mClosures)
+            for (auto &c : task->mClosures)
             {
                 auto cc = mTasks.find(c);
-                if (cc == mTasks.end())
+                if (cc == nullptr)
                     throw RTE_LOC;
 
-                ds->second.addClosure(c);
-                cc->second.addUpstream(d);
+                ds->addClosure(c);
+                cc->addUpstream(d);
             }
         }
 
-        for (auto &c : task->second.mClosures)
+        for (auto &c : task->mClosures)
         {
             auto cc = mTasks.find(c);
-            cc->second.removeUpstream(idx);
-            if (cc->second.mUpstream.size() == 0)
+            cc->removeUpstream(idx);
+            if (cc->mUpstream.size() == 0)
             {
                 removeTask(c);
             }
         }
-        mTasks.erase(task);
+        mTasks.erase(idx);
     }
 
     Task Scheduler::nullTask()
@@ -209,22 +209,22 @@ namespace primihub
             ss << " " << r;
         }
         ss << "\n---------------------------------\n";
-        for (auto &x : mTasks)
+        mTasks.forEach([&](TaskBase &x)
         {
-            ss << x.second.mIdx << "\n"
+            ss << x.mIdx << "\n"
                << "\tup:";
 
-            for (auto u : x.second.mUpstream)
+            for (auto u : x.mUpstream)
                 ss << " " << u;
 
             ss << "\n\tdw:";
-            for (auto u : x.second.mDownstream)
+            for (auto u : x.mDownstream)
                 ss << " " << u;
             ss << "\n\tcl:";
-            for (auto u : x.second.mClosures)
+            for (auto u : x.mClosures)
                 ss << " " << u;
             ss << "\n";
-        }
+        });
 
         return ss.str();
     }
@@ -3,11 +3,11 @@
 #ifndef SRC_PRIMIHUB_PROTOCOL_SCHEDULER_H_
 #define SRC_PRIMIHUB_PROTOCOL_SCHEDULER_H_
 
-#include <unordered_map>
 #include <list>
 
 #include "src/primihub/common/defines.h"
 #include "src/primihub/protocol/task.h"
+#include "src/primihub/protocol/task_slab.h"
 #include "src/primihub/common/gsl/span"
 
 namespace primihub
@@ -39,7 +39,7 @@ namespace primihub
 
   // private: // FIXME need private
     i64 mTaskIdx = 0;
-    std::unordered_map<u64, TaskBase> mTasks;
+    TaskSlab<TaskBase> mTasks;
     std::list<i64> mReady, mNextRound;
   };
 
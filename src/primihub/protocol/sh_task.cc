@@ -20,6 +20,10 @@ namespace primihub {
     return getRuntime().addTask({ this, 1 }, std::move(task), std::move(name));
   }
 
+  ShTask ShTask::thenLocal(LocalFunc task) {
+    return getRuntime().addTask({ this, 1 }, std::move(task), {});
+  }
+
   ShTask ShTask::getClosure() {
     return getRuntime().addClosure(*this);
   }
@@ -41,16 +45,12 @@ namespace primihub {
   }
 
   bool ShTask::isCompleted() {
-    auto iter = mRuntime->mSched.mTasks.find(mIdx);
-    return iter == mRuntime->mSched.mTasks.end();
+    return mRuntime->mSched.mTasks.find(mIdx) == nullptr;
   }
 
 
   ShTaskBase* ShTask::basePtr() {
-    auto iter = mRuntime->mTasks.find(mIdx);
-    if (iter != mRuntime->mTasks.end())
-      return &iter->second;
-    return nullptr;
+    return mRuntime->mTasks.find(mIdx);
   }
 
 } 
@@ -25,6 +25,9 @@ class ShTask {
     public:
         using RoundFunc = fu2::unique_function<void(CommPkgBase* commPtr, ShTask& self)>;
         using ContinuationFunc = fu2::unique_function<void(ShTask& self)>;
+        // Pure local computation, it must neither communicate nor touch
+        // the runtime. Ready local tasks may run in parallel.
+        using LocalFunc = fu2::unique_function<void()>;
         enum Type { Evaluation, Closure };
         
         // returns the associated runtime.
@@ -45,6 +48,10 @@ class ShTask {
         // schedule a task that can be executed in the same round as this task.
         ShTask then(ContinuationFunc task, std::string name);
 
+        // schedules a local computation that can be executed in the
+        // following round, on the worker threads of the runtime if any.
+        ShTask thenLocal(LocalFunc task);
+
         // Get a task that is fulfilled when all of this tasks dependencies
         // are fulfilled.
         ShTask getClosure();
@@ -91,7 +98,8 @@ class ShTaskBase {
                         Closure,
                         And,
                         ShTask::RoundFunc,
-                        ShTask::ContinuationFunc>
+                        ShTask::ContinuationFunc,
+                        ShTask::LocalFunc>
         mFunc = EmptyState{};
 };
 
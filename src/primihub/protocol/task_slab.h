@@ -0,0 +1,78 @@
+#ifndef SRC_PRIMIHUB_PROTOCOL_TASK_SLAB_H_
+#define SRC_PRIMIHUB_PROTOCOL_TASK_SLAB_H_
+
+#include <deque>
+#include <optional>
+#include <utility>
+
+#include "src/primihub/common/defines.h"
+
+namespace primihub
+{
+
+    // Tasks indexed by their id. Ids are handed out in increasing order
+    // and tasks finish roughly in that order, so the tasks live in a flat
+    // run of slots indexed by id - mBase, and the finished slots at the
+    // front are dropped. References to a task stay valid while other tasks
+    // are added or erased.
+    template <typename T>
+    class TaskSlab
+    {
+    public:
+        T *find(i64 idx)
+        {
+            if (idx < mBase || idx >= mBase + (i64)mSlots.size())
+                return nullptr;
+            auto &slot = mSlots[idx - mBase];
+            return slot ? &*slot : nullptr;
+        }
+
+        template <typename... Args>
+        T &emplace(i64 idx, Args &&...args)
+        {
+            if (idx < mBase)
+                throw RTE_LOC;
+            while (idx >= mBase + (i64)mSlots.size())
+                mSlots.emplace_back();
+
+            auto &slot = mSlots[idx - mBase];
+            if (slot)
+                throw RTE_LOC;
+            slot.emplace(std::forward<Args>(args)...);
+            ++mSize;
+            return *slot;
+        }
+
+        void erase(i64 idx)
+        {
+            if (find(idx) == nullptr)
+                throw RTE_LOC;
+            mSlots[idx - mBase].reset();
+            --mSize;
+
+            while (mSlots.size() && !mSlots.front())
+            {
+                mSlots.pop_front();
+                ++mBase;
+            }
+        }
+
+        u64 size() const { return mSize; }
+
+        template <typename Func>
+        void forEach(Func &&func)
+        {
+            for (auto &slot : mSlots)
+                if (slot)
+                    func(*slot);
+        }
+
+    private:
+        i64 mBase = 0;
+        u64 mSize = 0;
+        std::deque<std::optional<T>> mSlots;
+    };
+
+} // namespace primihub
+
+#endif  // SRC_PRIMIHUB_PROTOCOL_TASK_SLAB_H_
@@ -0,0 +1,128 @@
+
+#include "src/primihub/protocol/work_stealing_pool.h"
+
+namespace primihub
+{
+
+    WorkStealingPool::WorkStealingPool(u64 numWorkers)
+    {
+        for (u64 i = 0; i <= numWorkers; ++i)
+            mQueues.emplace_back(new Queue);
+
+        for (u64 i = 0; i < numWorkers; ++i)
+            mWorkers.emplace_back([this, i]() { workerLoop(i); });
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lck(mMtx);
+            mStop = true;
+        }
+        mStartCv.notify_all();
+        for (auto &t : mWorkers)
+            t.join();
+    }
+
+    void WorkStealingPool::run(u64 n, const std::function<void(u64)> &func)
+    {
+        if (n == 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lck(mMtx);
+            mFunc = &func;
+            mPending = n;
+            mError = nullptr;
+
+            // Neighbouring jobs go to the same queue, they often touch
+            // neighbouring data.
+            u64 numQueues = mQueues.size();
+            for (u64 q = 0; q < numQueues; ++q)
+            {
+                std::lock_guard<std::mutex> qlck(mQueues[q]->mMtx);
+                for (u64 i = q * n / numQueues; i < (q + 1) * n / numQueues; ++i)
+                    mQueues[q]->mJobs.push_back(i);
+            }
+            ++mBatchIdx;
+        }
+        mStartCv.notify_all();
+
+        runJobs(mQueues.size() - 1);
+
+        std::unique_lock<std::mutex> lck(mMtx);
+        mDoneCv.wait(lck, [this]() { return mPending == 0; });
+        mFunc = nullptr;
+        if (mError)
+            std::rethrow_exception(mError);
+    }
+
+    bool WorkStealingPool::popOrSteal(u64 self, u64 &job)
+    {
+        {
+            auto &own = *mQueues[self];
+            std::lock_guard<std::mutex> lck(own.mMtx);
+            if (own.mJobs.size())
+            {
+                job = own.mJobs.back();
+                own.mJobs.pop_back();
+                return true;
+            }
+        }
+
+        for (u64 i = 1; i < mQueues.size(); ++i)
+        {
+            auto &victim = *mQueues[(self + i) % mQueues.size()];
+            std::lock_guard<std::mutex> lck(victim.mMtx);
+            if (victim.mJobs.size())
+            {
+                job = victim.mJobs.front();
+                victim.mJobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::runJobs(u64 self)
+    {
+        u64 job;
+        while (popOrSteal(self, job))
+        {
+            std::exception_ptr error;
+            try
+            {
+                (*mFunc)(job);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lck(mMtx);
+            if (error && !mError)
+                mError = error;
+            if (--mPending == 0)
+                mDoneCv.notify_all();
+        }
+    }
+
+    void WorkStealingPool::workerLoop(u64 self)
+    {
+        u64 batchIdx = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lck(mMtx);
+                mStartCv.wait(lck, [&]() {
+                    return mStop || mBatchIdx != batchIdx;
+                });
+                if (mStop)
+                    return;
+                batchIdx = mBatchIdx;
+            }
+            runJobs(self);
+        }
+    }
+
+} // namespace primihub
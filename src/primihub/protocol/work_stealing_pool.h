@@ -0,0 +1,64 @@
+#ifndef SRC_PRIMIHUB_PROTOCOL_WORK_STEALING_POOL_H_
+#define SRC_PRIMIHUB_PROTOCOL_WORK_STEALING_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/primihub/common/defines.h"
+
+namespace primihub
+{
+
+    // Threads which run batches of independent jobs. Every worker, and the
+    // thread calling run(), owns a queue of jobs. It takes jobs from the
+    // back of its own queue and steals from the front of the others once
+    // its own is empty, so a batch of jobs of uneven cost keeps all of
+    // them busy.
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool(u64 numWorkers);
+        ~WorkStealingPool();
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        // Call func(i) for every i in [0, n) and return once all are done,
+        // the first exception thrown by a job is rethrown. Only one thread
+        // may run a batch at a time.
+        void run(u64 n, const std::function<void(u64)> &func);
+
+        u64 numWorkers() const { return mWorkers.size(); }
+
+    private:
+        struct Queue
+        {
+            std::mutex mMtx;
+            std::deque<u64> mJobs;
+        };
+
+        bool popOrSteal(u64 self, u64 &job);
+        void runJobs(u64 self);
+        void workerLoop(u64 self);
+
+        // one queue per worker, the last one belongs to the caller of run().
+        std::vector<std::unique_ptr<Queue>> mQueues;
+        std::vector<std::thread> mWorkers;
+
+        std::mutex mMtx;
+        std::condition_variable mStartCv, mDoneCv;
+        const std::function<void(u64)> *mFunc = nullptr;
+        u64 mBatchIdx = 0;
+        u64 mPending = 0;
+        std::exception_ptr mError;
+        bool mStop = false;
+    };
+
+} // namespace primihub
+
+#endif  // SRC_PRIMIHUB_PROTOCOL_WORK_STEALING_POOL_H_
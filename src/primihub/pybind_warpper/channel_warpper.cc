@@ -15,7 +15,12 @@
  */
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <future>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "src/primihub/util/network/socket/ioservice.h"
 #include "src/primihub/util/network/socket/session.h"
@@ -27,9 +32,64 @@ using primihub::SessionMode;
 using primihub::IOService;
 using primihub::Session;
 using primihub::Channel;
+using primihub::ReceiveAtMost;
+using primihub::u8;
 
 namespace py = pybind11;
 
+namespace {
+
+// Contiguous bytes of any object supporting the buffer protocol, the
+// buffer stays pinned as long as the returned view lives. Empty buffers
+// are fine, they go out as a zero size message.
+std::unique_ptr<Py_buffer, void (*)(Py_buffer*)> pinBuffer(
+    const py::buffer& buf, bool writable) {
+  std::unique_ptr<Py_buffer, void (*)(Py_buffer*)> view(
+      new Py_buffer(), [](Py_buffer* view) {
+        PyBuffer_Release(view);
+        delete view;
+      });
+  int flags = PyBUF_C_CONTIGUOUS | (writable ? PyBUF_WRITABLE : 0);
+  if (PyObject_GetBuffer(buf.ptr(), view.get(), flags) != 0) {
+    delete view.release();
+    throw py::error_already_set();
+  }
+  return view;
+}
+
+// An asyncSendBuffer in flight, the buffer is released once the send
+// completed, the destructor waits for it if wait was never called.
+class PendingSend {
+ public:
+  PendingSend(std::unique_ptr<Py_buffer, void (*)(Py_buffer*)> view,
+              std::future<void> future)
+      : view_(std::move(view)), future_(std::move(future)) {}
+  ~PendingSend() {
+    if (future_.valid()) {
+      py::gil_scoped_release release;
+      future_.wait();
+    }
+  }
+
+  void wait() {
+    if (!future_.valid()) {
+      return;
+    }
+    {
+      py::gil_scoped_release release;
+      future_.wait();
+    }
+    view_.reset();
+    future_.get();
+  }
+
+ private:
+  std::unique_ptr<Py_buffer, void (*)(Py_buffer*)> view_;
+  std::future<void> future_;
+};
+
+}  // namespace
+
 
 PYBIND11_MODULE(primihub_channel, m) {
   py::class_<IOService>(m, "IOService")
@@ -46,13 +106,69 @@ PYBIND11_MODULE(primihub_channel, m) {
   
   py::class_<Channel>(m, "Channel")
         .def(py::init<>())
-        .def("send", &Channel::send<std::string>)
+        .def("send", &Channel::send<std::string>,
+             py::call_guard<py::gil_scoped_release>())
         .def("asyncSendCopy", &Channel::asyncSendCopy<std::string>)
         .def("recv", [](Channel &self) {
               std::string recv_str;
-              self.recv(recv_str);
+              {
+                py::gil_scoped_release release;
+                self.recv(recv_str);
+              }
               return recv_str;
         })
+        // Zero copy interface over the buffer protocol, i.e. bytes,
+        // bytearray, memoryview and numpy arrays. The memory is sent in
+        // place and blocking calls release the GIL.
+        .def("sendBuffer", [](Channel &self, const py::buffer &buf) {
+              auto view = pinBuffer(buf, false);
+              py::gil_scoped_release release;
+              self.send(static_cast<const u8*>(view->buf), view->len);
+        })
+        // The buffer must not be modified until the returned handle is
+        // waited on or dropped.
+        .def("asyncSendBuffer", [](Channel &self, const py::buffer &buf) {
+              auto view = pinBuffer(buf, false);
+              auto future = self.asyncSendFuture(
+                  static_cast<const u8*>(view->buf), view->len);
+              return std::unique_ptr<PendingSend>(
+                  new PendingSend(std::move(view), std::move(future)));
+        })
+        // Receive into a writable buffer at least as large as the message,
+        // returns the number of bytes received.
+        .def("recvInto", [](Channel &self, const py::buffer &buf) {
+              auto view = pinBuffer(buf, true);
+              ReceiveAtMost<u8> dest(static_cast<u8*>(view->buf), view->len);
+              {
+                py::gil_scoped_release release;
+                self.recv(dest);
+              }
+              return dest.receivedSize();
+        })
+        // Receive into a new numpy array of dtype which owns the receive
+        // buffer of the channel.
+        .def("recvArray", [](Channel &self, const py::dtype &dtype) {
+              auto buffer = std::make_unique<std::vector<u8>>();
+              {
+                py::gil_scoped_release release;
+                self.recv(*buffer);
+              }
+              size_t itemsize = dtype.itemsize();
+              if (itemsize == 0 || buffer->size() % itemsize != 0) {
+                throw std::invalid_argument(
+                    "received " + std::to_string(buffer->size()) +
+                    " bytes, not a multiple of the dtype size");
+              }
+              u8* data = buffer->data();
+              auto count = static_cast<py::ssize_t>(buffer->size() / itemsize);
+              py::capsule owner(buffer.release(), [](void* ptr) {
+                delete static_cast<std::vector<u8>*>(ptr);
+              });
+              return py::array(dtype, {count}, {}, data, owner);
+        }, py::arg("dtype") = py::dtype::of<uint8_t>())
         .def("close", &Channel::close);
 
+  py::class_<PendingSend>(m, "PendingSend")
+        .def("wait", &PendingSend::wait);
+
 }
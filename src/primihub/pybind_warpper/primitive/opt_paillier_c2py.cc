@@ -1,253 +1,720 @@
 #include "opt_paillier_c2py.hpp"
 
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include "src/primihub/util/parallel.h"
+
 namespace py = pybind11;
 using namespace pybind11::literals;
 
-py::dict fb_instance_2_pydict(fb_instance fb) {
-    py::dict dict = py::dict();
-    dict["m_mod"]     = mpz_get_str(nullptr, BASE, fb.m_mod);
-    py::list t_pylist = py::list();
-    for (size_t i = 0; i <= fb.m_t; i++) {
-        t_pylist.append(mpz_get_str(nullptr, BASE, fb.m_table_G[i]));
+namespace {
+
+void write_u64(std::string* out, uint64_t value) {
+    out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint64_t read_u64(const std::string& in, size_t* pos) {
+    uint64_t value;
+    if (sizeof(value) > in.size() - *pos) {
+        throw std::invalid_argument("truncated opt paillier data");
+    }
+    memcpy(&value, in.data() + *pos, sizeof(value));
+    *pos += sizeof(value);
+    return value;
+}
+
+// sign byte, length and big endian magnitude from mpz_export
+void write_mpz(std::string* out, const mpz_t value) {
+    size_t count = 0;
+    void* data = mpz_export(nullptr, &count, 1, 1, 1, 0, value);
+    out->push_back(mpz_sgn(value) < 0 ? 1 : 0);
+    write_u64(out, count);
+    out->append(static_cast<const char*>(data), count);
+    void (*free_func)(void*, size_t);
+    mp_get_memory_functions(nullptr, nullptr, &free_func);
+    free_func(data, count);
+}
+
+// value must be initialized
+void read_mpz(const std::string& in, size_t* pos, mpz_t value) {
+    if (*pos >= in.size()) {
+        throw std::invalid_argument("truncated opt paillier data");
+    }
+    bool negative = in[(*pos)++] != 0;
+    uint64_t count = read_u64(in, pos);
+    // compared against the bytes left, *pos + count could wrap
+    if (count > in.size() - *pos) {
+        throw std::invalid_argument("truncated opt paillier data");
+    }
+    mpz_import(value, count, 1, 1, 1, 0, in.data() + *pos);
+    *pos += count;
+    if (negative) {
+        mpz_neg(value, value);
     }
-    dict["m_table_G"] = t_pylist;
-    dict["m_h"]       = fb.m_h;
-    dict["m_t"]       = fb.m_t;
-    dict["m_w"]       = fb.m_w;
-    return dict;
 }
 
-fb_instance pydict_2_fb_instance(py::dict dict) {
-    fb_instance fb;
-    mpz_init_set_str(fb.m_mod, std::string(py::str(dict["m_mod"])).c_str(), BASE);
-    fb.m_t = py::int_(dict["m_t"]);
-    fb.m_table_G = (mpz_t*)malloc(sizeof(mpz_t)*(fb.m_t+1));
-    py::list py_m_table_G = dict["m_table_G"];
+void write_fb_instance(std::string* out, const fb_instance& fb) {
+    write_mpz(out, fb.m_mod);
+    write_u64(out, fb.m_h);
+    write_u64(out, fb.m_t);
+    write_u64(out, fb.m_w);
     for (size_t i = 0; i <= fb.m_t; i++) {
-        mpz_init_set_str(fb.m_table_G[i], std::string(py::str(py_m_table_G[i])).c_str(), BASE);
+        write_mpz(out, fb.m_table_G[i]);
     }
-    fb.m_h = py::int_(dict["m_h"]);
-    fb.m_w = py::int_(dict["m_w"]);
-    return fb;
 }
 
-void opt_paillier_keygen_warpper(
-    int k_sec, 
-    const py::object &py_pub, 
-    const py::object &py_prv) {
+// fb is either read in full or left with nothing allocated
+void read_fb_instance(const std::string& in, size_t* pos, fb_instance* fb) {
+    mpz_init(fb->m_mod);
+    try {
+        read_mpz(in, pos, fb->m_mod);
+        fb->m_h = read_u64(in, pos);
+        fb->m_t = read_u64(in, pos);
+        fb->m_w = read_u64(in, pos);
+        // each of the m_t + 1 values takes at least a sign byte and a length
+        if (fb->m_t >= (in.size() - *pos) / (1 + sizeof(uint64_t))) {
+            throw std::invalid_argument("truncated opt paillier data");
+        }
+    } catch (...) {
+        mpz_clear(fb->m_mod);
+        throw;
+    }
+    fb->m_table_G = (mpz_t*)malloc(sizeof(mpz_t)*(fb->m_t+1));
+    if (fb->m_table_G == nullptr) {
+        mpz_clear(fb->m_mod);
+        throw std::bad_alloc();
+    }
+    for (size_t i = 0; i <= fb->m_t; i++) {
+        mpz_init(fb->m_table_G[i]);
+    }
+    try {
+        for (size_t i = 0; i <= fb->m_t; i++) {
+            read_mpz(in, pos, fb->m_table_G[i]);
+        }
+    } catch (...) {
+        fbpowmod_end_extend(*fb);
+        throw;
+    }
+}
 
-    opt_public_key_t* pub;
-    opt_secret_key_t* prv;
+// every mpz field of the secret key, in serialization order
+std::vector<mpz_ptr> secret_key_fields(opt_secret_key_t* prv) {
+    return {prv->p, prv->q, prv->p_, prv->q_, prv->alpha, prv->beta,
+            prv->P, prv->Q, prv->P_squared, prv->Q_squared,
+            prv->double_alpha, prv->double_beta, prv->double_alpha_inverse,
+            prv->P_squared_mul_P_squared_inverse, prv->P_mul_P_inverse,
+            prv->double_p, prv->double_q, prv->Q_mul_double_p_inverse,
+            prv->P_mul_double_q_inverse};
+}
 
-    opt_paillier_keygen(k_sec, &pub, &prv);
+void free_gmp_str(char* str) {
+    void (*free_func)(void*, size_t);
+    mp_get_memory_functions(nullptr, nullptr, &free_func);
+    free_func(str, strlen(str) + 1);
+}
 
-    py::dict py_pub_dict = py_pub.attr("__dict__");
-    py_pub_dict["nbits"]           = pub->nbits;
-    py_pub_dict["lbits"]           = pub->lbits;
-    py_pub_dict["n"]               = mpz_get_str(nullptr, BASE, pub->n);
-    py_pub_dict["half_n"]          = mpz_get_str(nullptr, BASE, pub->half_n);
-    py_pub_dict["n_squared"]       = mpz_get_str(nullptr, BASE, pub->n_squared);
-    py_pub_dict["h_s"]             = mpz_get_str(nullptr, BASE, pub->h_s);
-    py_pub_dict["fb_mod_P_sqaured"]= fb_instance_2_pydict(pub->fb_mod_P_sqaured);
-    py_pub_dict["fb_mod_Q_sqaured"]= fb_instance_2_pydict(pub->fb_mod_Q_sqaured);
-
-    py::dict py_prv_dict = py_prv.attr("__dict__");
-    py_prv_dict["p"]                               = mpz_get_str(nullptr, BASE, prv->p);
-    py_prv_dict["q"]                               = mpz_get_str(nullptr, BASE, prv->q);
-    py_prv_dict["p_"]                              = mpz_get_str(nullptr, BASE, prv->p_);
-    py_prv_dict["q_"]                              = mpz_get_str(nullptr, BASE, prv->q_);
-    py_prv_dict["alpha"]                           = mpz_get_str(nullptr, BASE, prv->alpha);
-    py_prv_dict["beta"]                            = mpz_get_str(nullptr, BASE, prv->beta);
-    py_prv_dict["P"]                               = mpz_get_str(nullptr, BASE, prv->P);
-    py_prv_dict["Q"]                               = mpz_get_str(nullptr, BASE, prv->Q);
-    py_prv_dict["P_squared"]                       = mpz_get_str(nullptr, BASE, prv->P_squared);
-    py_prv_dict["Q_squared"]                       = mpz_get_str(nullptr, BASE, prv->Q_squared);
-    py_prv_dict["double_alpha"]                    = mpz_get_str(nullptr, BASE, prv->double_alpha);
-    py_prv_dict["double_beta"]                     = mpz_get_str(nullptr, BASE, prv->double_beta);
-    py_prv_dict["double_alpha_inverse"]            = mpz_get_str(nullptr, BASE, prv->double_alpha_inverse);
-    py_prv_dict["P_squared_mul_P_squared_inverse"] = mpz_get_str(nullptr, BASE, prv->P_squared_mul_P_squared_inverse);
-    py_prv_dict["P_mul_P_inverse"]                 = mpz_get_str(nullptr, BASE, prv->P_mul_P_inverse);
-    py_prv_dict["double_p"]                        = mpz_get_str(nullptr, BASE, prv->double_p);
-    py_prv_dict["double_q"]                        = mpz_get_str(nullptr, BASE, prv->double_q);
-    py_prv_dict["Q_mul_double_p_inverse"]          = mpz_get_str(nullptr, BASE, prv->Q_mul_double_p_inverse);
-    py_prv_dict["P_mul_double_q_inverse"]          = mpz_get_str(nullptr, BASE, prv->P_mul_double_q_inverse);
-}
-
-opt_public_key_t* py_pub_2_cpp_pub(const py::object &py_pub) {
-    opt_public_key_t* res = (opt_public_key_t*)malloc(sizeof(opt_public_key_t));
+std::string mpz_to_str(const mpz_t value) {
+    char* tmp_str = mpz_get_str(nullptr, BASE, value);
+    std::string res(tmp_str);
+    free_gmp_str(tmp_str);
+    return res;
+}
 
-    py::dict py_pub_dict = py_pub.attr("__dict__");
-    res->nbits     = py::int_(py_pub_dict["nbits"]);
-    res->lbits     = py::int_(py_pub_dict["lbits"]);
-    mpz_init_set_str(res->n,         std::string(py::str(py_pub_dict["n"])).c_str(), BASE);
-    mpz_init_set_str(res->half_n,    std::string(py::str(py_pub_dict["half_n"])).c_str(), BASE);
-    mpz_init_set_str(res->n_squared, std::string(py::str(py_pub_dict["n_squared"])).c_str(), BASE);
-    mpz_init_set_str(res->h_s,       std::string(py::str(py_pub_dict["h_s"])).c_str(), BASE);
-    res->fb_mod_P_sqaured = pydict_2_fb_instance(py_pub_dict["fb_mod_P_sqaured"]);
-    res->fb_mod_Q_sqaured = pydict_2_fb_instance(py_pub_dict["fb_mod_Q_sqaured"]);
+std::string plaintext_to_str(const mpz_t plain_text, const opt_public_key_t* pub) {
+    char* tmp_str;
+    opt_paillier_get_plaintext(tmp_str, plain_text, pub, PYTHON_INPUT_BASE);
+    std::string res(tmp_str);
+    free_gmp_str(tmp_str);
+    return res;
+}
+
+// same mapping of negative values as opt_paillier_set_plaintext
+void set_plaintext(mpz_t res, int64_t value, const opt_public_key_t* pub) {
+    mpz_set_si(res, value);
+    if (value < 0) {
+        mpz_add(res, res, pub->n);
+    }
+}
 
+void set_plaintext(mpz_t res, const std::string& value, const opt_public_key_t* pub) {
+    opt_paillier_set_plaintext(res, value.c_str(), pub, PYTHON_INPUT_BASE);
+}
+
+// Run func(begin, end, scratch) over shards of [0, total) with the GIL
+// released, scratch is an mpz_t owned by the shard and reused by its items.
+template <typename Func>
+void parallel_mpz(size_t total, size_t thread_num, Func&& func) {
+    py::gil_scoped_release release;
+    size_t shard_num = primihub::ShardNum(total, thread_num, VECTOR_MIN_SHARD_SIZE);
+    primihub::ParallelForShards(total, shard_num,
+        [&](size_t, size_t begin, size_t end) {
+            mpz_t scratch;
+            mpz_init(scratch);
+            func(begin, end, scratch);
+            mpz_clear(scratch);
+        });
+}
+
+template <typename T>
+std::shared_ptr<OptCiphertextVector> encrypt_vector(
+    const OptPublicKey &py_pub,
+    const OptSecretKey *py_prv,
+    const T* plain_texts,
+    size_t size,
+    size_t thread_num) {
+
+    auto res = std::make_shared<OptCiphertextVector>(size);
+    parallel_mpz(size, thread_num, [&](size_t begin, size_t end, mpz_t plain_text) {
+        for (size_t i = begin; i < end; i++) {
+            set_plaintext(plain_text, plain_texts[i], py_pub.get());
+            if (py_prv == nullptr) {
+                opt_paillier_encrypt(res->at(i), py_pub.get(), plain_text);
+            } else {
+                opt_paillier_encrypt_crt_fb(res->at(i), py_pub.get(), py_prv->get(), plain_text);
+            }
+        }
+    });
     return res;
 }
 
-opt_secret_key_t* py_prv_2_cpp_prv(const py::object &py_prv) {
+template <typename T>
+std::shared_ptr<OptCiphertextVector> cons_mul_vector(
+    const OptCiphertextVector &py_cipher_texts,
+    const T* cons_values,
+    size_t size,
+    const OptPublicKey &py_pub,
+    size_t thread_num) {
+
+    if (size != py_cipher_texts.size()) {
+        throw std::invalid_argument("cons_values and cipher_texts differ in size");
+    }
+    auto res = std::make_shared<OptCiphertextVector>(size);
+    parallel_mpz(size, thread_num, [&](size_t begin, size_t end, mpz_t cons_value) {
+        for (size_t i = begin; i < end; i++) {
+            set_plaintext(cons_value, cons_values[i], py_pub.get());
+            opt_paillier_constant_mul(res->at(i), py_cipher_texts.at(i), cons_value, py_pub.get());
+        }
+    });
+    return res;
+}
+
+py::list to_py_ints(const std::vector<std::string>& values) {
+    py::list res(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        PyObject* value = PyLong_FromString(values[i].c_str(), nullptr, PYTHON_INPUT_BASE);
+        if (value == nullptr) {
+            throw py::error_already_set();
+        }
+        PyList_SET_ITEM(res.ptr(), i, value);
+    }
+    return res;
+}
+
+const int64_t* int64_data(const py::array_t<int64_t, py::array::c_style | py::array::forcecast> &values) {
+    if (values.ndim() != 1) {
+        throw std::invalid_argument("expect a one dimension array");
+    }
+    return values.data();
+}
+
+}  // namespace
+
+std::string OptPublicKey::n() const {
+    return mpz_to_str(pub_->n);
+}
+
+std::string OptPublicKey::half_n() const {
+    return mpz_to_str(pub_->half_n);
+}
+
+std::string OptPublicKey::serialize() const {
+    std::string out;
+    write_u64(&out, pub_->nbits);
+    write_u64(&out, pub_->lbits);
+    write_mpz(&out, pub_->n);
+    write_mpz(&out, pub_->half_n);
+    write_mpz(&out, pub_->n_squared);
+    write_mpz(&out, pub_->h_s);
+    write_fb_instance(&out, pub_->fb_mod_P_sqaured);
+    write_fb_instance(&out, pub_->fb_mod_Q_sqaured);
+    return out;
+}
+
+std::shared_ptr<OptPublicKey> OptPublicKey::deserialize(const std::string& data) {
+    opt_public_key_t* res = (opt_public_key_t*)malloc(sizeof(opt_public_key_t));
+    if (res == nullptr) {
+        throw std::bad_alloc();
+    }
+    mpz_inits(res->n, res->half_n, res->n_squared, res->h_s, nullptr);
+    bool has_fb_P = false;
+    try {
+        size_t pos = 0;
+        res->nbits = read_u64(data, &pos);
+        res->lbits = read_u64(data, &pos);
+        read_mpz(data, &pos, res->n);
+        read_mpz(data, &pos, res->half_n);
+        read_mpz(data, &pos, res->n_squared);
+        read_mpz(data, &pos, res->h_s);
+        read_fb_instance(data, &pos, &res->fb_mod_P_sqaured);
+        has_fb_P = true;
+        read_fb_instance(data, &pos, &res->fb_mod_Q_sqaured);
+    } catch (...) {
+        mpz_clears(res->n, res->half_n, res->n_squared, res->h_s, nullptr);
+        if (has_fb_P) {
+            fbpowmod_end_extend(res->fb_mod_P_sqaured);
+        }
+        free(res);
+        throw;
+    }
+    return std::make_shared<OptPublicKey>(res);
+}
+
+std::string OptSecretKey::serialize() const {
+    std::string out;
+    for (auto field : secret_key_fields(prv_)) {
+        write_mpz(&out, field);
+    }
+    return out;
+}
+
+std::shared_ptr<OptSecretKey> OptSecretKey::deserialize(const std::string& data) {
     opt_secret_key_t* res = (opt_secret_key_t*)malloc(sizeof(opt_secret_key_t));
+    if (res == nullptr) {
+        throw std::bad_alloc();
+    }
+    auto fields = secret_key_fields(res);
+    for (auto field : fields) {
+        mpz_init(field);
+    }
+    try {
+        size_t pos = 0;
+        for (auto field : fields) {
+            read_mpz(data, &pos, field);
+        }
+    } catch (...) {
+        opt_paillier_freeprvkey(res);
+        throw;
+    }
+    return std::make_shared<OptSecretKey>(res);
+}
+
+std::string OptCiphertext::serialize() const {
+    std::string out;
+    write_mpz(&out, value_);
+    return out;
+}
+
+std::shared_ptr<OptCiphertext> OptCiphertext::deserialize(const std::string& data) {
+    auto res = std::make_shared<OptCiphertext>();
+    size_t pos = 0;
+    read_mpz(data, &pos, res->get());
+    return res;
+}
 
-    py::dict py_prv_dict = py_prv.attr("__dict__");
-    mpz_init_set_str(res->p                              , std::string(py::str(py_prv_dict["p"])).c_str(), BASE);
-    mpz_init_set_str(res->q                              , std::string(py::str(py_prv_dict["q"])).c_str(), BASE);
-    mpz_init_set_str(res->p_                             , std::string(py::str(py_prv_dict["p_"])).c_str(), BASE);
-    mpz_init_set_str(res->q_                             , std::string(py::str(py_prv_dict["q_"])).c_str(), BASE);
-    mpz_init_set_str(res->alpha                          , std::string(py::str(py_prv_dict["alpha"])).c_str(), BASE);
-    mpz_init_set_str(res->beta                           , std::string(py::str(py_prv_dict["beta"])).c_str(), BASE);
-    mpz_init_set_str(res->P                              , std::string(py::str(py_prv_dict["P"])).c_str(), BASE);
-    mpz_init_set_str(res->Q                              , std::string(py::str(py_prv_dict["Q"])).c_str(), BASE);
-    mpz_init_set_str(res->P_squared                      , std::string(py::str(py_prv_dict["P_squared"])).c_str(), BASE);
-    mpz_init_set_str(res->Q_squared                      , std::string(py::str(py_prv_dict["Q_squared"])).c_str(), BASE);
-    mpz_init_set_str(res->double_alpha                   , std::string(py::str(py_prv_dict["double_alpha"])).c_str(), BASE);
-    mpz_init_set_str(res->double_beta                    , std::string(py::str(py_prv_dict["double_beta"])).c_str(), BASE);
-    mpz_init_set_str(res->double_alpha_inverse           , std::string(py::str(py_prv_dict["double_alpha_inverse"])).c_str(), BASE);
-    mpz_init_set_str(res->P_squared_mul_P_squared_inverse, std::string(py::str(py_prv_dict["P_squared_mul_P_squared_inverse"])).c_str(), BASE);
-    mpz_init_set_str(res->P_mul_P_inverse                , std::string(py::str(py_prv_dict["P_mul_P_inverse"])).c_str(), BASE);
-    mpz_init_set_str(res->double_p                       , std::string(py::str(py_prv_dict["double_p"])).c_str(), BASE);
-    mpz_init_set_str(res->double_q                       , std::string(py::str(py_prv_dict["double_q"])).c_str(), BASE);
-    mpz_init_set_str(res->Q_mul_double_p_inverse         , std::string(py::str(py_prv_dict["Q_mul_double_p_inverse"])).c_str(), BASE);
-    mpz_init_set_str(res->P_mul_double_q_inverse         , std::string(py::str(py_prv_dict["P_mul_double_q_inverse"])).c_str(), BASE);
+OptCiphertextVector::OptCiphertextVector(size_t size) : values_(size) {
+    for (auto &value : values_) {
+        mpz_init(&value);
+    }
+}
+
+OptCiphertextVector::~OptCiphertextVector() {
+    for (auto &value : values_) {
+        mpz_clear(&value);
+    }
+}
 
+std::shared_ptr<OptCiphertext> OptCiphertextVector::item(size_t i) const {
+    if (i >= values_.size()) {
+        throw py::index_error();
+    }
+    auto res = std::make_shared<OptCiphertext>();
+    mpz_set(res->get(), at(i));
     return res;
 }
 
-void opt_paillier_encrypt_warpper(
-    const py::object &py_cipher_text,
-    const py::object &py_pub, 
+std::string OptCiphertextVector::serialize() const {
+    std::string out;
+    write_u64(&out, values_.size());
+    for (auto &value : values_) {
+        write_mpz(&out, &value);
+    }
+    return out;
+}
+
+std::shared_ptr<OptCiphertextVector> OptCiphertextVector::deserialize(const std::string& data) {
+    size_t pos = 0;
+    uint64_t size = read_u64(data, &pos);
+    // every value takes at least a sign byte and a length
+    if (size > data.size() / (1 + sizeof(uint64_t))) {
+        throw std::invalid_argument("truncated opt paillier data");
+    }
+    auto res = std::make_shared<OptCiphertextVector>(size);
+    for (size_t i = 0; i < size; i++) {
+        read_mpz(data, &pos, res->at(i));
+    }
+    return res;
+}
+
+OptCrtMod::OptCrtMod(size_t crt_size, size_t mod_size) {
+    if (crt_size == 0) {
+        throw std::invalid_argument("crt_size must be positive");
+    }
+    init_crt(&crtmod_, crt_size, mod_size);
+    init_crt_basis(&basis_, crtmod_);
+}
+
+OptCrtMod::OptCrtMod(CrtMod* crtmod) : crtmod_(crtmod) {
+    init_crt_basis(&basis_, crtmod_);
+}
+
+OptCrtMod::~OptCrtMod() {
+    free_crt_basis(basis_);
+    free_crt(crtmod_);
+}
+
+bool OptCrtMod::equals(const OptCrtMod& other) const {
+    if (this == &other) {
+        return true;
+    }
+    if (crt_size() != other.crt_size()) {
+        return false;
+    }
+    for (size_t i = 0; i < crt_size(); i++) {
+        if (mpz_cmp(crtmod_->crt_mod[i], other.crtmod_->crt_mod[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string OptCrtMod::serialize() const {
+    std::string out;
+    write_u64(&out, crtmod_->mod_size);
+    write_u64(&out, crtmod_->crt_size);
+    for (size_t i = 0; i < crtmod_->crt_size; i++) {
+        write_mpz(&out, crtmod_->crt_mod[i]);
+    }
+    return out;
+}
+
+std::shared_ptr<OptCrtMod> OptCrtMod::deserialize(const std::string& data) {
+    size_t pos = 0;
+    uint64_t mod_size = read_u64(data, &pos);
+    uint64_t crt_size = read_u64(data, &pos);
+    if (crt_size == 0 || crt_size > data.size() / (1 + sizeof(uint64_t))) {
+        throw std::invalid_argument("truncated opt paillier data");
+    }
+    CrtMod* crtmod = (CrtMod*)malloc(sizeof(CrtMod));
+    crtmod->mod_size = mod_size;
+    crtmod->crt_size = crt_size;
+    crtmod->crt_mod = (mpz_t*)malloc(sizeof(mpz_t) * crt_size);
+    crtmod->crt_half_mod = (mpz_t*)malloc(sizeof(mpz_t) * crt_size);
+    for (size_t i = 0; i < crt_size; i++) {
+        mpz_init(crtmod->crt_mod[i]);
+        mpz_init(crtmod->crt_half_mod[i]);
+    }
+    try {
+        for (size_t i = 0; i < crt_size; i++) {
+            read_mpz(data, &pos, crtmod->crt_mod[i]);
+            mpz_div_ui(crtmod->crt_half_mod[i], crtmod->crt_mod[i], 2);
+        }
+    } catch (...) {
+        free_crt(crtmod);
+        throw;
+    }
+    return std::shared_ptr<OptCrtMod>(new OptCrtMod(crtmod));
+}
+
+std::string OptPackedCiphertext::serialize() const {
+    std::string out;
+    std::string crt_mod = crt_mod_->serialize();
+    write_u64(&out, crt_mod.size());
+    out.append(crt_mod);
+    write_u64(&out, size_);
+    out.append(packs_->serialize());
+    return out;
+}
+
+std::shared_ptr<OptPackedCiphertext> OptPackedCiphertext::deserialize(const std::string& data) {
+    size_t pos = 0;
+    uint64_t crt_mod_size = read_u64(data, &pos);
+    if (crt_mod_size > data.size() - pos) {
+        throw std::invalid_argument("truncated opt paillier data");
+    }
+    auto crt_mod = OptCrtMod::deserialize(data.substr(pos, crt_mod_size));
+    pos += crt_mod_size;
+    uint64_t size = read_u64(data, &pos);
+    auto packs = OptCiphertextVector::deserialize(data.substr(pos));
+    if (packs->size() != pack_num(size, crt_mod->crt_size())) {
+        throw std::invalid_argument("packed cipher text size mismatch");
+    }
+    return std::make_shared<OptPackedCiphertext>(crt_mod, size, packs);
+}
+
+py::tuple opt_paillier_keygen_warpper(int k_sec) {
+    opt_public_key_t* pub;
+    opt_secret_key_t* prv;
+
+    opt_paillier_keygen(k_sec, &pub, &prv);
+
+    return py::make_tuple(std::make_shared<OptPublicKey>(pub),
+                          std::make_shared<OptSecretKey>(prv));
+}
+
+std::shared_ptr<OptCiphertext> opt_paillier_encrypt_warpper(
+    const OptPublicKey &py_pub,
     const std::string py_plain_text) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
 
     mpz_t plain_text;
-    mpz_t cipher_text;
     mpz_init(plain_text);
-    mpz_init(cipher_text);
+    auto cipher_text = std::make_shared<OptCiphertext>();
 
-    opt_paillier_set_plaintext(plain_text, py_plain_text.c_str(), pub, PYTHON_INPUT_BASE);
+    opt_paillier_set_plaintext(plain_text, py_plain_text.c_str(), py_pub.get(), PYTHON_INPUT_BASE);
 
-    opt_paillier_encrypt(cipher_text, pub, plain_text);
+    opt_paillier_encrypt(cipher_text->get(), py_pub.get(), plain_text);
 
-    py::dict py_cipher_text_dict = py_cipher_text.attr("__dict__");
-    py_cipher_text_dict["ciphertext"] = mpz_get_str(nullptr, BASE, cipher_text);
-
-    mpz_clears(plain_text, cipher_text, nullptr);
-    opt_paillier_freepubkey(pub);
+    mpz_clear(plain_text);
+    return cipher_text;
 }
 
-void opt_paillier_encrypt_crt_warpper(
-    const py::object &py_cipher_text,
-    const py::object &py_pub, 
-    const py::object &py_prv,
+std::shared_ptr<OptCiphertext> opt_paillier_encrypt_crt_warpper(
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
     const std::string py_plain_text) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
-    opt_secret_key_t* prv = py_prv_2_cpp_prv(py_prv);
 
     mpz_t plain_text;
-    mpz_t cipher_text;
     mpz_init(plain_text);
-    mpz_init(cipher_text);
-
-    opt_paillier_set_plaintext(plain_text, py_plain_text.c_str(), pub, PYTHON_INPUT_BASE);
+    auto cipher_text = std::make_shared<OptCiphertext>();
 
-    opt_paillier_encrypt_crt_fb(cipher_text, pub, prv, plain_text);
+    opt_paillier_set_plaintext(plain_text, py_plain_text.c_str(), py_pub.get(), PYTHON_INPUT_BASE);
 
-    py::dict py_cipher_text_dict = py_cipher_text.attr("__dict__");
-    py_cipher_text_dict["ciphertext"] = mpz_get_str(nullptr, BASE, cipher_text);
+    opt_paillier_encrypt_crt_fb(cipher_text->get(), py_pub.get(), py_prv.get(), plain_text);
 
-    mpz_clears(plain_text, cipher_text, nullptr);
-    opt_paillier_freepubkey(pub);
-    opt_paillier_freeprvkey(prv);
+    mpz_clear(plain_text);
+    return cipher_text;
 }
 
-py::str opt_paillier_decrypt_crt_warpper(
-    const py::object &py_pub, 
-    const py::object &py_prv,
-    const py::object &py_cipher_text) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
-    opt_secret_key_t* prv = py_prv_2_cpp_prv(py_prv);
+std::string opt_paillier_decrypt_crt_warpper(
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
+    const OptCiphertext &py_cipher_text) {
 
-    mpz_t cipher_text;
     mpz_t decrypt_text;
-    mpz_init(cipher_text);
     mpz_init(decrypt_text);
 
-    py::dict py_cipher_text_dict = py_cipher_text.attr("__dict__");
-    mpz_set_str(cipher_text, std::string(py::str(py_cipher_text_dict["ciphertext"])).c_str(), BASE); // 0: success -1:error
+    opt_paillier_decrypt_crt(decrypt_text, py_pub.get(), py_prv.get(), py_cipher_text.get());
 
-    opt_paillier_decrypt_crt(decrypt_text, pub, prv, cipher_text);
+    std::string res = plaintext_to_str(decrypt_text, py_pub.get());
+    mpz_clear(decrypt_text);
+    return res;
+}
 
-    char *tmp_str;
-    opt_paillier_get_plaintext(tmp_str, decrypt_text, pub, PYTHON_INPUT_BASE);
+std::shared_ptr<OptCiphertext> opt_paillier_add_warpper(
+    const OptCiphertext &py_op1,
+    const OptCiphertext &py_op2,
+    const OptPublicKey &py_pub) {
 
-    mpz_clears(cipher_text, decrypt_text, nullptr);
-    opt_paillier_freepubkey(pub);
-    opt_paillier_freeprvkey(prv);
+    auto res = std::make_shared<OptCiphertext>();
+    opt_paillier_add(res->get(), py_op1.get(), py_op2.get(), py_pub.get());
+    return res;
+}
+
+std::shared_ptr<OptCiphertext> opt_paillier_cons_mul_warpper(
+    const OptCiphertext &py_cipher_text,
+    const std::string &py_cons_value,
+    const OptPublicKey &py_pub) {
+
+    mpz_t cons_value;
+    mpz_init(cons_value);
+    auto res = std::make_shared<OptCiphertext>();
+
+    opt_paillier_set_plaintext(cons_value, py_cons_value.c_str(), py_pub.get());
 
-    return std::string(tmp_str);
+    opt_paillier_constant_mul(res->get(), py_cipher_text.get(), cons_value, py_pub.get());
+
+    mpz_clear(cons_value);
+    return res;
 }
 
-void opt_paillier_add_warpper(
-    const py::object &py_add_res,
-    const py::object &py_op1,
-    const py::object &py_op2,
-    const py::object &py_pub) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+using Int64Array = py::array_t<int64_t, py::array::c_style | py::array::forcecast>;
 
-    mpz_t op1;
-    mpz_t op2;
-    mpz_t res;
-    mpz_init(op1);
-    mpz_init(op2);
-    mpz_init(res);
+std::shared_ptr<OptCiphertextVector> opt_paillier_encrypt_vector_warpper(
+    const OptPublicKey &py_pub,
+    const std::vector<std::string> &py_plain_texts,
+    size_t thread_num) {
+    return encrypt_vector(py_pub, nullptr, py_plain_texts.data(), py_plain_texts.size(), thread_num);
+}
 
-    py::dict py_op1_dict = py_op1.attr("__dict__");
-    mpz_set_str(op1, std::string(py::str(py_op1_dict["ciphertext"])).c_str(), BASE); // 0: success -1:error
-    py::dict py_op2_dict = py_op2.attr("__dict__");
-    mpz_set_str(op2, std::string(py::str(py_op2_dict["ciphertext"])).c_str(), BASE); // 0: success -1:error
+std::shared_ptr<OptCiphertextVector> opt_paillier_encrypt_int64_vector_warpper(
+    const OptPublicKey &py_pub,
+    const Int64Array &py_plain_texts,
+    size_t thread_num) {
+    return encrypt_vector(py_pub, nullptr, int64_data(py_plain_texts), py_plain_texts.size(), thread_num);
+}
+
+std::shared_ptr<OptCiphertextVector> opt_paillier_encrypt_crt_vector_warpper(
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
+    const std::vector<std::string> &py_plain_texts,
+    size_t thread_num) {
+    return encrypt_vector(py_pub, &py_prv, py_plain_texts.data(), py_plain_texts.size(), thread_num);
+}
 
-    opt_paillier_add(res, op1, op2, pub);
+std::shared_ptr<OptCiphertextVector> opt_paillier_encrypt_crt_int64_vector_warpper(
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
+    const Int64Array &py_plain_texts,
+    size_t thread_num) {
+    return encrypt_vector(py_pub, &py_prv, int64_data(py_plain_texts), py_plain_texts.size(), thread_num);
+}
 
-    py::dict py_add_res_dict = py_add_res.attr("__dict__");
-    py_add_res_dict["ciphertext"] = mpz_get_str(nullptr, BASE, res);
+py::list opt_paillier_decrypt_crt_vector_warpper(
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
+    const OptCiphertextVector &py_cipher_texts,
+    size_t thread_num) {
+
+    std::vector<std::string> decrypt_texts(py_cipher_texts.size());
+    parallel_mpz(decrypt_texts.size(), thread_num, [&](size_t begin, size_t end, mpz_t decrypt_text) {
+        for (size_t i = begin; i < end; i++) {
+            opt_paillier_decrypt_crt(decrypt_text, py_pub.get(), py_prv.get(), py_cipher_texts.at(i));
+            decrypt_texts[i] = plaintext_to_str(decrypt_text, py_pub.get());
+        }
+    });
 
-    mpz_clears(op1, op2, res, nullptr);
-    opt_paillier_freepubkey(pub);
+    return to_py_ints(decrypt_texts);
 }
 
-void opt_paillier_cons_mul_warpper(
-    const py::object &py_cons_mul_res,
-    const py::object &py_cipher_text,
-    const py::str    &py_cons_value,
-    const py::object &py_pub) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+std::shared_ptr<OptCiphertextVector> opt_paillier_add_vector_warpper(
+    const OptCiphertextVector &py_op1,
+    const OptCiphertextVector &py_op2,
+    const OptPublicKey &py_pub,
+    size_t thread_num) {
 
-    mpz_t cipher_text;
-    mpz_t cons_value;
-    mpz_t res;
-    mpz_init(cipher_text);
-    mpz_init(cons_value);
-    mpz_init(res);
+    if (py_op1.size() != py_op2.size()) {
+        throw std::invalid_argument("two cipher text vectors differ in size");
+    }
+    auto res = std::make_shared<OptCiphertextVector>(py_op1.size());
+    parallel_mpz(res->size(), thread_num, [&](size_t begin, size_t end, mpz_t) {
+        for (size_t i = begin; i < end; i++) {
+            opt_paillier_add(res->at(i), py_op1.at(i), py_op2.at(i), py_pub.get());
+        }
+    });
+    return res;
+}
+
+std::shared_ptr<OptCiphertextVector> opt_paillier_cons_mul_vector_warpper(
+    const OptCiphertextVector &py_cipher_texts,
+    const std::vector<std::string> &py_cons_values,
+    const OptPublicKey &py_pub,
+    size_t thread_num) {
+    return cons_mul_vector(py_cipher_texts, py_cons_values.data(), py_cons_values.size(), py_pub, thread_num);
+}
 
-    py::dict py_cipher_text_dict = py_cipher_text.attr("__dict__");
-    mpz_set_str(cipher_text, std::string(py::str(py_cipher_text_dict["ciphertext"])).c_str(), BASE); // 0: success -1:error
-    opt_paillier_set_plaintext(cons_value, std::string(py_cons_value).c_str(), pub);
+std::shared_ptr<OptCiphertextVector> opt_paillier_cons_mul_int64_vector_warpper(
+    const OptCiphertextVector &py_cipher_texts,
+    const Int64Array &py_cons_values,
+    const OptPublicKey &py_pub,
+    size_t thread_num) {
+    return cons_mul_vector(py_cipher_texts, int64_data(py_cons_values), py_cons_values.size(), py_pub, thread_num);
+}
 
-    opt_paillier_constant_mul(res, cipher_text, cons_value, pub);
+std::shared_ptr<OptPackedCiphertext> packed_encrypt(
+    const OptPublicKey &py_pub,
+    const OptSecretKey *py_prv,
+    const Int64Array &py_plain_texts,
+    std::shared_ptr<OptCrtMod> py_crt_mod,
+    size_t thread_num) {
 
-    py::dict py_mul_res_dict = py_cons_mul_res.attr("__dict__");
-    py_mul_res_dict["ciphertext"] = mpz_get_str(nullptr, BASE, res);
+    if (py_crt_mod == nullptr) {
+        py_crt_mod = std::make_shared<OptCrtMod>(CRT_MOD_MAX_DIMENSION, CRT_MOD_SIZE);
+    }
+    const int64_t* plain_texts = int64_data(py_plain_texts);
+    size_t size = py_plain_texts.size();
+    size_t crt_size = py_crt_mod->crt_size();
+    auto packs = std::make_shared<OptCiphertextVector>(
+        OptPackedCiphertext::pack_num(size, crt_size));
+    const OptCrtMod &crt_mod = *py_crt_mod;
+    parallel_mpz(packs->size(), thread_num, [&](size_t begin, size_t end, mpz_t pack) {
+        for (size_t i = begin; i < end; i++) {
+            size_t offset = i * crt_size;
+            size_t data_size = std::min(size - offset, crt_size);
+            data_packing_crt_ll(pack, reinterpret_cast<const ll*>(plain_texts + offset),
+                                data_size, crt_mod.get(), crt_mod.basis());
+            if (py_prv == nullptr) {
+                opt_paillier_encrypt(packs->at(i), py_pub.get(), pack);
+            } else {
+                opt_paillier_encrypt_crt_fb(packs->at(i), py_pub.get(), py_prv->get(), pack);
+            }
+        }
+    });
+    return std::make_shared<OptPackedCiphertext>(py_crt_mod, size, packs);
+}
+
+std::shared_ptr<OptPackedCiphertext> opt_paillier_packed_encrypt_warpper(
+    const OptPublicKey &py_pub,
+    const Int64Array &py_plain_texts,
+    std::shared_ptr<OptCrtMod> py_crt_mod,
+    size_t thread_num) {
+    return packed_encrypt(py_pub, nullptr, py_plain_texts, std::move(py_crt_mod), thread_num);
+}
 
-    mpz_clears(cipher_text, cons_value, res, nullptr);
-    opt_paillier_freepubkey(pub);
+std::shared_ptr<OptPackedCiphertext> opt_paillier_packed_encrypt_crt_warpper(
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
+    const Int64Array &py_plain_texts,
+    std::shared_ptr<OptCrtMod> py_crt_mod,
+    size_t thread_num) {
+    return packed_encrypt(py_pub, &py_prv, py_plain_texts, std::move(py_crt_mod), thread_num);
+}
+
+py::list opt_paillier_packed_decrypt_crt_warpper(
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
+    const OptPackedCiphertext &py_packed,
+    size_t thread_num) {
+
+    const OptCiphertextVector &packs = *py_packed.packs();
+    const CrtMod* crtmod = py_packed.crt_mod()->get();
+    size_t size = py_packed.size();
+    std::vector<std::string> decrypt_texts(size);
+    parallel_mpz(packs.size(), thread_num, [&](size_t begin, size_t end, mpz_t pack) {
+        mpz_t cur;
+        mpz_init(cur);
+        for (size_t i = begin; i < end; i++) {
+            opt_paillier_decrypt_crt(pack, py_pub.get(), py_prv.get(), packs.at(i));
+            // same as data_retrieve_crt, without a malloc per value
+            size_t offset = i * crtmod->crt_size;
+            size_t data_size = std::min(size - offset, crtmod->crt_size);
+            for (size_t j = 0; j < data_size; j++) {
+                mpz_mod(cur, pack, crtmod->crt_mod[j]);
+                if (mpz_cmp(cur, crtmod->crt_half_mod[j]) >= 0) {
+                    mpz_sub(cur, cur, crtmod->crt_mod[j]);
+                }
+                decrypt_texts[offset + j] = mpz_to_str(cur);
+            }
+        }
+        mpz_clear(cur);
+    });
+    return to_py_ints(decrypt_texts);
+}
+
+std::shared_ptr<OptPackedCiphertext> opt_paillier_packed_add_warpper(
+    const OptPackedCiphertext &py_op1,
+    const OptPackedCiphertext &py_op2,
+    const OptPublicKey &py_pub,
+    size_t thread_num) {
+
+    if (py_op1.size() != py_op2.size()) {
+        throw std::invalid_argument("two packed cipher texts differ in size");
+    }
+    if (!py_op1.crt_mod()->equals(*py_op2.crt_mod())) {
+        throw std::invalid_argument("two packed cipher texts differ in crt mod");
+    }
+    auto packs = opt_paillier_add_vector_warpper(*py_op1.packs(), *py_op2.packs(), py_pub, thread_num);
+    return std::make_shared<OptPackedCiphertext>(py_op1.crt_mod(), py_op1.size(), packs);
 }
 
 py::dict crtMod_2_dict(CrtMod* crtmod) {
@@ -255,8 +722,8 @@ py::dict crtMod_2_dict(CrtMod* crtmod) {
     py::list crt_half_mod = py::list();
     py::list crt_mod = py::list();
     for (size_t i = 0; i < crtmod->crt_size; ++i) {
-        crt_half_mod.append(mpz_get_str(nullptr, BASE, crtmod->crt_half_mod[i]));
-        crt_mod.append(mpz_get_str(nullptr, BASE, crtmod->crt_mod[i]));
+        crt_half_mod.append(mpz_to_str(crtmod->crt_half_mod[i]));
+        crt_mod.append(mpz_to_str(crtmod->crt_mod[i]));
     }
     res["crt_half_mod"] = crt_half_mod;
     res["crt_mod"] = crt_mod;
@@ -285,12 +752,12 @@ CrtMod* dict_2_CrtMod(py::dict py_crtMod) {
 
 void opt_paillier_pack_encrypt_warpper(
     const py::object &py_pack_cipher_text,
-    const py::object &py_pub, 
+    const OptPublicKey &py_pub,
     const py::list &py_plain_texts,
     const py::object &py_crt_mod
     ) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+
+    const opt_public_key_t* pub = py_pub.get();
 
     CrtMod* crtmod;
     if (py_crt_mod == py::none()) {
@@ -318,7 +785,7 @@ void opt_paillier_pack_encrypt_warpper(
         data_packing_crt(pack, nums, data_size, crtmod, PYTHON_INPUT_BASE);
         opt_paillier_encrypt(cipher_text, pub, pack);  
 
-        ciphertexts.append(mpz_get_str(nullptr, BASE, cipher_text));
+        ciphertexts.append(mpz_to_str(cipher_text));
 
         for (size_t j = 0; j < data_size; ++j) {
             free(nums[j]);
@@ -333,19 +800,18 @@ void opt_paillier_pack_encrypt_warpper(
 
     mpz_clears(pack, cipher_text, nullptr);
     free_crt(crtmod);
-    opt_paillier_freepubkey(pub);
 }
 
 void opt_paillier_pack_encrypt_crt_warpper(
     const py::object &py_pack_cipher_text,
-    const py::object &py_pub, 
-    const py::object &py_prv,
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
     const py::list &py_plain_texts,
     const py::object &py_crt_mod
     ) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
-    opt_secret_key_t* prv = py_prv_2_cpp_prv(py_prv);
+
+    const opt_public_key_t* pub = py_pub.get();
+    const opt_secret_key_t* prv = py_prv.get();
 
     CrtMod* crtmod;
     if (py_crt_mod == py::none()) {
@@ -373,7 +839,7 @@ void opt_paillier_pack_encrypt_crt_warpper(
         data_packing_crt(pack, nums, data_size, crtmod, PYTHON_INPUT_BASE);
         opt_paillier_encrypt_crt(cipher_text, pub, prv, pack);  
 
-        ciphertexts.append(mpz_get_str(nullptr, BASE, cipher_text));
+        ciphertexts.append(mpz_to_str(cipher_text));
 
         for (size_t j = 0; j < data_size; ++j) {
             free(nums[j]);
@@ -388,17 +854,15 @@ void opt_paillier_pack_encrypt_crt_warpper(
 
     mpz_clears(pack, cipher_text, nullptr);
     free_crt(crtmod);
-    opt_paillier_freepubkey(pub);
-    opt_paillier_freeprvkey(prv);
 }
 
 py::list opt_paillier_pack_decrypt_crt_warpper(
-    const py::object &py_pub, 
-    const py::object &py_prv,
+    const OptPublicKey &py_pub,
+    const OptSecretKey &py_prv,
     const py::object &py_pack_cipher_text) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
-    opt_secret_key_t* prv = py_prv_2_cpp_prv(py_prv);
+
+    const opt_public_key_t* pub = py_pub.get();
+    const opt_secret_key_t* prv = py_prv.get();
 
     py::dict py_pack_cipher_text_dict = py_pack_cipher_text.attr("__dict__");
     py::list py_ciphertexts = py_pack_cipher_text_dict["ciphertexts"];
@@ -433,8 +897,6 @@ py::list opt_paillier_pack_decrypt_crt_warpper(
 
     mpz_clears(cipher_text, decrypt_text, nullptr);
     free_crt(crtmod);
-    opt_paillier_freepubkey(pub);
-    opt_paillier_freeprvkey(prv);
 
     return res;
 }
@@ -443,9 +905,9 @@ void opt_paillier_pack_add_warpper(
     const py::object &py_pack_add_res,
     const py::object &py_pack_op1,
     const py::object &py_pack_op2,
-    const py::object &py_pub) {
-    
-    opt_public_key_t* pub = py_pub_2_cpp_pub(py_pub);
+    const OptPublicKey &py_pub) {
+
+    const opt_public_key_t* pub = py_pub.get();
 
     mpz_t op1;
     mpz_t op2;
@@ -467,7 +929,7 @@ void opt_paillier_pack_add_warpper(
 
         opt_paillier_add(res, op1, op2, pub);
 
-        ciphertexts.append(mpz_get_str(nullptr, BASE, res));
+        ciphertexts.append(mpz_to_str(res));
     }
 
     py::dict py_pack_add_res_dict = py_pack_add_res.attr("__dict__");
@@ -476,12 +938,82 @@ void opt_paillier_pack_add_warpper(
     py_pack_add_res_dict["pack_size"] = py_pack_op1_dict["pack_size"];
 
     mpz_clears(op1, op2, res, nullptr);
-    opt_paillier_freepubkey(pub);
 }
 
 PYBIND11_MODULE(opt_paillier_c2py, m) {
     m.doc() = "opt paillier cpp to python plugin"; // optional module docstring
 
+    py::class_<OptPublicKey, std::shared_ptr<OptPublicKey>>(m, "OptPublicKey")
+        .def_property_readonly("n", &OptPublicKey::n)
+        .def_property_readonly("half_n", &OptPublicKey::half_n)
+        .def("serialize", [](const OptPublicKey &self) {
+            return py::bytes(self.serialize());
+        })
+        .def_static("deserialize", [](const py::bytes &data) {
+            return OptPublicKey::deserialize(data);
+        })
+        .def(py::pickle(
+            [](const OptPublicKey &self) { return py::bytes(self.serialize()); },
+            [](const py::bytes &data) { return OptPublicKey::deserialize(data); }));
+
+    py::class_<OptSecretKey, std::shared_ptr<OptSecretKey>>(m, "OptSecretKey")
+        .def("serialize", [](const OptSecretKey &self) {
+            return py::bytes(self.serialize());
+        })
+        .def_static("deserialize", [](const py::bytes &data) {
+            return OptSecretKey::deserialize(data);
+        })
+        .def(py::pickle(
+            [](const OptSecretKey &self) { return py::bytes(self.serialize()); },
+            [](const py::bytes &data) { return OptSecretKey::deserialize(data); }));
+
+    py::class_<OptCiphertext, std::shared_ptr<OptCiphertext>>(m, "OptCiphertext")
+        .def("serialize", [](const OptCiphertext &self) {
+            return py::bytes(self.serialize());
+        })
+        .def_static("deserialize", [](const py::bytes &data) {
+            return OptCiphertext::deserialize(data);
+        })
+        .def(py::pickle(
+            [](const OptCiphertext &self) { return py::bytes(self.serialize()); },
+            [](const py::bytes &data) { return OptCiphertext::deserialize(data); }));
+
+    py::class_<OptCiphertextVector, std::shared_ptr<OptCiphertextVector>>(m, "OptCiphertextVector")
+        .def("__len__", &OptCiphertextVector::size)
+        .def("__getitem__", &OptCiphertextVector::item)
+        .def("serialize", [](const OptCiphertextVector &self) {
+            return py::bytes(self.serialize());
+        })
+        .def_static("deserialize", [](const py::bytes &data) {
+            return OptCiphertextVector::deserialize(data);
+        })
+        .def(py::pickle(
+            [](const OptCiphertextVector &self) { return py::bytes(self.serialize()); },
+            [](const py::bytes &data) { return OptCiphertextVector::deserialize(data); }));
+
+    py::class_<OptCrtMod, std::shared_ptr<OptCrtMod>>(m, "OptCrtMod")
+        .def(py::init<size_t, size_t>(),
+             "crt_size"_a = CRT_MOD_MAX_DIMENSION, "mod_size"_a = CRT_MOD_SIZE)
+        .def_property_readonly("crt_size", &OptCrtMod::crt_size)
+        .def("__eq__", &OptCrtMod::equals)
+        .def(py::pickle(
+            [](const OptCrtMod &self) { return py::bytes(self.serialize()); },
+            [](const py::bytes &data) { return OptCrtMod::deserialize(data); }));
+
+    py::class_<OptPackedCiphertext, std::shared_ptr<OptPackedCiphertext>>(m, "OptPackedCiphertext")
+        .def("__len__", &OptPackedCiphertext::size)
+        .def_property_readonly("crt_mod", &OptPackedCiphertext::crt_mod)
+        .def_property_readonly("packs", &OptPackedCiphertext::packs)
+        .def("serialize", [](const OptPackedCiphertext &self) {
+            return py::bytes(self.serialize());
+        })
+        .def_static("deserialize", [](const py::bytes &data) {
+            return OptPackedCiphertext::deserialize(data);
+        })
+        .def(py::pickle(
+            [](const OptPackedCiphertext &self) { return py::bytes(self.serialize()); },
+            [](const py::bytes &data) { return OptPackedCiphertext::deserialize(data); }));
+
     m.def("opt_paillier_keygen_warpper",
          &opt_paillier_keygen_warpper, 
          "A function that generate opt paillier publice key and private key");
@@ -506,6 +1038,66 @@ PYBIND11_MODULE(opt_paillier_c2py, m) {
          &opt_paillier_cons_mul_warpper, 
          "A opt paillier constant multiplication function that multify one ciphertext with one constant value");
 
+    m.def("opt_paillier_encrypt_vector_warpper",
+         &opt_paillier_encrypt_vector_warpper,
+         "Encrypt decimal plaintexts over thread_num threads, 0 for one per core",
+         "pub"_a, "plain_texts"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_encrypt_vector_warpper",
+         &opt_paillier_encrypt_int64_vector_warpper,
+         "Encrypt an int64 array over thread_num threads, 0 for one per core",
+         "pub"_a, "plain_texts"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_encrypt_crt_vector_warpper",
+         &opt_paillier_encrypt_crt_vector_warpper,
+         "Encrypt decimal plaintexts with the fixed-base crt path",
+         "pub"_a, "prv"_a, "plain_texts"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_encrypt_crt_vector_warpper",
+         &opt_paillier_encrypt_crt_int64_vector_warpper,
+         "Encrypt an int64 array with the fixed-base crt path",
+         "pub"_a, "prv"_a, "plain_texts"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_decrypt_crt_vector_warpper",
+         &opt_paillier_decrypt_crt_vector_warpper,
+         "Decrypt a cipher text vector into a list of int",
+         "pub"_a, "prv"_a, "cipher_texts"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_add_vector_warpper",
+         &opt_paillier_add_vector_warpper,
+         "Add two cipher text vectors element-wise",
+         "op1"_a, "op2"_a, "pub"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_cons_mul_vector_warpper",
+         &opt_paillier_cons_mul_vector_warpper,
+         "Multiply a cipher text vector with decimal constants element-wise",
+         "cipher_texts"_a, "cons_values"_a, "pub"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_cons_mul_vector_warpper",
+         &opt_paillier_cons_mul_int64_vector_warpper,
+         "Multiply a cipher text vector with an int64 array element-wise",
+         "cipher_texts"_a, "cons_values"_a, "pub"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_packed_encrypt_warpper",
+         &opt_paillier_packed_encrypt_warpper,
+         "Pack an int64 array crt_mod.crt_size values per plaintext and encrypt the packs",
+         "pub"_a, "plain_texts"_a, "crt_mod"_a = py::none(), "thread_num"_a = 0);
+
+    m.def("opt_paillier_packed_encrypt_crt_warpper",
+         &opt_paillier_packed_encrypt_crt_warpper,
+         "Pack an int64 array and encrypt the packs with the fixed-base crt path",
+         "pub"_a, "prv"_a, "plain_texts"_a, "crt_mod"_a = py::none(), "thread_num"_a = 0);
+
+    m.def("opt_paillier_packed_decrypt_crt_warpper",
+         &opt_paillier_packed_decrypt_crt_warpper,
+         "Decrypt and retrieve a packed cipher text into a list of int",
+         "pub"_a, "prv"_a, "packed"_a, "thread_num"_a = 0);
+
+    m.def("opt_paillier_packed_add_warpper",
+         &opt_paillier_packed_add_warpper,
+         "Add two packed cipher texts of the same crt mod",
+         "op1"_a, "op2"_a, "pub"_a, "thread_num"_a = 0);
+
     m.def("opt_paillier_pack_encrypt_warpper",
          &opt_paillier_pack_encrypt_warpper, 
          "A opt paillier encrypt function that pack encrypt plaintext");
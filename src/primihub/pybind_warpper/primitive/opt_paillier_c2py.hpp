@@ -1,10 +1,140 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
 #include <iostream>
+#include <memory>
 #include "paillier.h"
 #include "crt_datapack.h"
 #include <string>
+#include <vector>
 
 #define BASE 10
 #define PYTHON_INPUT_BASE 10
 #define CRT_MOD_MAX_DIMENSION 28
 #define CRT_MOD_SIZE 70
+// smallest number of values worth a thread in the vector functions
+#define VECTOR_MIN_SHARD_SIZE 16
+
+/**
+ * Native handles which own the GMP key material, including the fixed-base
+ * tables, and ciphertexts for the lifetime of the python object. They are
+ * only serialized, in binary form, when pickled to cross the wire.
+ */
+class OptPublicKey {
+public:
+    explicit OptPublicKey(opt_public_key_t* pub) : pub_(pub) {}
+    ~OptPublicKey() { opt_paillier_freepubkey(pub_); }
+    OptPublicKey(const OptPublicKey&) = delete;
+    OptPublicKey& operator=(const OptPublicKey&) = delete;
+
+    const opt_public_key_t* get() const { return pub_; }
+    std::string n() const;
+    std::string half_n() const;
+    std::string serialize() const;
+    static std::shared_ptr<OptPublicKey> deserialize(const std::string& data);
+
+private:
+    opt_public_key_t* pub_;
+};
+
+class OptSecretKey {
+public:
+    explicit OptSecretKey(opt_secret_key_t* prv) : prv_(prv) {}
+    ~OptSecretKey() { opt_paillier_freeprvkey(prv_); }
+    OptSecretKey(const OptSecretKey&) = delete;
+    OptSecretKey& operator=(const OptSecretKey&) = delete;
+
+    const opt_secret_key_t* get() const { return prv_; }
+    std::string serialize() const;
+    static std::shared_ptr<OptSecretKey> deserialize(const std::string& data);
+
+private:
+    opt_secret_key_t* prv_;
+};
+
+class OptCiphertext {
+public:
+    OptCiphertext() { mpz_init(value_); }
+    ~OptCiphertext() { mpz_clear(value_); }
+    OptCiphertext(const OptCiphertext&) = delete;
+    OptCiphertext& operator=(const OptCiphertext&) = delete;
+
+    mpz_ptr get() { return value_; }
+    mpz_srcptr get() const { return value_; }
+    std::string serialize() const;
+    static std::shared_ptr<OptCiphertext> deserialize(const std::string& data);
+
+private:
+    mpz_t value_;
+};
+
+/**
+ * Contiguous ciphertexts produced by the vector functions, which run with
+ * the GIL released over a thread per shard of the input.
+ */
+class OptCiphertextVector {
+public:
+    explicit OptCiphertextVector(size_t size);
+    ~OptCiphertextVector();
+    OptCiphertextVector(const OptCiphertextVector&) = delete;
+    OptCiphertextVector& operator=(const OptCiphertextVector&) = delete;
+
+    size_t size() const { return values_.size(); }
+    mpz_ptr at(size_t i) { return &values_[i]; }
+    mpz_srcptr at(size_t i) const { return &values_[i]; }
+    std::shared_ptr<OptCiphertext> item(size_t i) const;
+    std::string serialize() const;
+    static std::shared_ptr<OptCiphertextVector> deserialize(const std::string& data);
+
+private:
+    std::vector<__mpz_struct> values_;
+};
+
+/**
+ * CRT moduli of the packed api with their precomputed packing basis.
+ */
+class OptCrtMod {
+public:
+    OptCrtMod(size_t crt_size, size_t mod_size);
+    ~OptCrtMod();
+    OptCrtMod(const OptCrtMod&) = delete;
+    OptCrtMod& operator=(const OptCrtMod&) = delete;
+
+    const CrtMod* get() const { return crtmod_; }
+    const CrtBasis* basis() const { return basis_; }
+    size_t crt_size() const { return crtmod_->crt_size; }
+    bool equals(const OptCrtMod& other) const;
+    std::string serialize() const;
+    static std::shared_ptr<OptCrtMod> deserialize(const std::string& data);
+
+private:
+    explicit OptCrtMod(CrtMod* crtmod);
+
+    CrtMod* crtmod_;
+    CrtBasis* basis_;
+};
+
+/**
+ * size values packed crt_size per plaintext under one crt_mod, every pack
+ * is a single ciphertext of packs.
+ */
+class OptPackedCiphertext {
+public:
+    OptPackedCiphertext(std::shared_ptr<OptCrtMod> crt_mod, size_t size,
+                        std::shared_ptr<OptCiphertextVector> packs)
+        : crt_mod_(std::move(crt_mod)), size_(size), packs_(std::move(packs)) {}
+
+    static size_t pack_num(size_t size, size_t crt_size) {
+        return (size + crt_size - 1) / crt_size;
+    }
+    size_t size() const { return size_; }
+    const std::shared_ptr<OptCrtMod>& crt_mod() const { return crt_mod_; }
+    const std::shared_ptr<OptCiphertextVector>& packs() const { return packs_; }
+    std::string serialize() const;
+    static std::shared_ptr<OptPackedCiphertext> deserialize(const std::string& data);
+
+private:
+    std::shared_ptr<OptCrtMod> crt_mod_;
+    size_t size_;
+    std::shared_ptr<OptCiphertextVector> packs_;
+};
@@ -105,6 +105,23 @@ namespace primihub::service {
         VLOG(5) << "data_url: " << this->data_url;
     }
 
+    DatasetMeta::DatasetMeta(const std::shared_ptr<arrow::Schema> &schema,
+                             int64_t num_rows,
+                             const std::shared_ptr<primihub::DataDriver> &driver,
+                             const std::string &description,
+                             const DatasetVisbility &visibility)
+                            : visibility(visibility) {
+        SchemaConstructorParamType arrowSchemaParam = schema;
+        this->data_type = DatasetType::TABLE;   // FIXME only support table now
+        this->schema = NewDatasetSchema(data_type, arrowSchemaParam);
+        this->total_records = num_rows;
+        this->id = DatasetId(description);
+        this->description = description;
+        this->driver_type = driver->getDriverType();
+        this->data_url = driver->getNodeletAddress() + ":" + driver->getDataURL();
+        VLOG(5) << "data_url: " << this->data_url;
+    }
+
     DatasetMeta::DatasetMeta(const std::string& json) {
         fromJSON(json);
     }
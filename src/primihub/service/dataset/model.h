@@ -114,6 +114,12 @@ class DatasetMeta {
     DatasetMeta(const std::shared_ptr<primihub::Dataset> &dataset,
                 const std::string &description,
                 const DatasetVisbility &visibility);
+    // Constructor from the probed schema and row count of a dataset.
+    DatasetMeta(const std::shared_ptr<arrow::Schema> &schema,
+                int64_t num_rows,
+                const std::shared_ptr<primihub::DataDriver> &driver,
+                const std::string &description,
+                const DatasetVisbility &visibility);
     // Constructor from json string.
     explicit DatasetMeta(const std::string &json);
 
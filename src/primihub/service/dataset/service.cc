@@ -16,7 +16,9 @@
 
 #include <glog/logging.h>
 
+#include <cstdlib>
 #include <future>
+#include <sstream>
 #include <thread>
 #include <chrono>
 
@@ -66,6 +68,36 @@ namespace primihub::service {
         return dataset;
     }
 
+    /**
+     * @brief Register a dataset without reading its data
+     * 1. Probe the schema and row count using driver cursor.
+     * 2. Save datameta in local storage & publish it on libp2p network.
+     *
+     * @param driver [input]: Data driver
+     * @param description [input]: Dataset description
+     * @param meta [output]: Dataset meta
+     * @return int 0 on success
+     */
+    int DatasetService::registerDataset(std::shared_ptr<primihub::DataDriver> driver,
+                                        const std::string& description,
+                                        DatasetMeta& meta) {
+        auto& cursor = driver->getCursor();
+        if (cursor == nullptr) {
+            LOG(ERROR) << "No cursor to register dataset: " << description;
+            return -1;
+        }
+        std::shared_ptr<arrow::Schema> schema;
+        int64_t num_rows = 0;
+        if (cursor->readMeta(&schema, &num_rows) != 0) {
+            LOG(ERROR) << "Read meta of dataset " << description << " failed.";
+            return -1;
+        }
+        DatasetMeta _meta(schema, num_rows, driver, description, DatasetVisbility::PUBLIC);  // TODO(chenhongbo) visibility public for test now.
+        meta = _meta;
+        metaService_->putMeta(meta);
+        return 0;
+    }
+
     /**
      * @brief write dataset to local storage
      * @param dataset [input]: Dataset to be written with own driver
@@ -168,7 +200,7 @@ namespace primihub::service {
                 }
                 [[maybe_unused]] auto cursor = driver->read(source);
                 DatasetMeta meta;
-                newDataset(driver, dataset["description"].as<std::string>(), meta);
+                registerDataset(driver, dataset["description"].as<std::string>(), meta);
             }
         }
     }
@@ -358,11 +390,52 @@ namespace primihub::service {
 
 ////////////////Flight Server ///////
 
+arrow::Status ParseFlightTicket(const std::string &ticket,
+                                std::string *dataset_id,
+                                std::vector<std::string> *columns,
+                                int64_t *limit) {
+    auto pos = ticket.find('?');
+    *dataset_id = ticket.substr(0, pos);
+    *limit = -1;
+    if (pos == std::string::npos) {
+        return arrow::Status::OK();
+    }
+    std::stringstream query(ticket.substr(pos + 1));
+    std::string param;
+    while (std::getline(query, param, '&')) {
+        auto eq = param.find('=');
+        std::string key = param.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : param.substr(eq + 1);
+        if (key == "columns") {
+            std::stringstream names(value);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                if (!name.empty()) {
+                    columns->push_back(name);
+                }
+            }
+        } else if (key == "limit") {
+            char *end = nullptr;
+            *limit = std::strtoll(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || *limit < 0) {
+                return arrow::Status::Invalid("Invalid limit in flight ticket: ", ticket);
+            }
+        } else {
+            return arrow::Status::Invalid("Unknown parameter ", key,
+                                          " in flight ticket: ", ticket);
+        }
+    }
+    return arrow::Status::OK();
+}
+
 arrow::Status FlightIntegrationServer::DoGet(const arrow::flight::ServerCallContext &context,
                             const arrow::flight::Ticket &request,
                             std::unique_ptr<FlightDataStream> *data_stream)  {
-            // NOTE fligth ticket format : fligt.{dataset_id_str}
-            DatasetId id(request.ticket);
+            std::string dataset_id;
+            std::vector<std::string> columns;
+            int64_t limit;
+            ARROW_RETURN_NOT_OK(ParseFlightTicket(request.ticket, &dataset_id, &columns, &limit));
+            DatasetId id(dataset_id);
             std::shared_ptr<DatasetMeta> meta = dataset_service_->metaService_->getLocalMeta(id);
             if (meta == nullptr) {
                 LOG(WARNING) << "Could not find flight ticket: " << request.ticket;
@@ -378,24 +451,19 @@ arrow::Status FlightIntegrationServer::DoGet(const arrow::flight::ServerCallCont
             DataURLToDetail(data_url, node_id, node_ip, node_port, dataset_path);
             LOG(INFO) << "DoGet dataset path:" << dataset_path;
             auto cursor = driver->read(dataset_path);  // TODO only support Local file path now.
-            auto dataset = cursor->read();
-            LOG(INFO) << "DoGet dataset read done";
-
-            // NOTE that we can't directly pass TableBatchReader to
-            // RecordBatchStream because TableBatchReader keeps a non-owning
-            // reference to the underlying Table, which would then get freed
-            // when we exit this function
-            auto table = std::get<0>(dataset->data);
-            std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
-            arrow::TableBatchReader batch_reader(*table);
-            // ARROW_ASSIGN_OR_RAISE(batches, batch_reader.ToRecordBatches());
-            batch_reader.ReadAll(&batches);
-
-            ARROW_ASSIGN_OR_RAISE(auto owning_reader, arrow::RecordBatchReader::Make(
-                                                  std::move(batches), table->schema()));
+            if (cursor == nullptr) {
+                return arrow::Status::IOError("Open dataset failed: ", dataset_path);
+            }
+
+            // RecordBatchStream pulls a batch from the reader only when the
+            // previous one is written, so one batch is in memory at a time.
+            ARROW_ASSIGN_OR_RAISE(auto reader, cursor->readStream(columns));
+            if (limit >= 0) {
+                reader = std::make_shared<LimitedBatchReader>(std::move(reader), limit);
+            }
             *data_stream = std::unique_ptr<arrow::flight::FlightDataStream>(
-                     new arrow::flight::RecordBatchStream(owning_reader));
-            LOG(INFO) << "DoGet dataset send to client done";
+                     new arrow::flight::RecordBatchStream(reader));
+            LOG(INFO) << "DoGet dataset stream opened";
             return arrow::Status::OK();
         }
 
@@ -21,6 +21,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <arrow/buffer.h>
 #include <arrow/filesystem/filesystem.h>
@@ -110,6 +111,12 @@ class DatasetService  {
     newDataset(std::shared_ptr<primihub::DataDriver> driver,
                const std::string &description, DatasetMeta &meta /*output*/);
 
+    // register dataset of DataDriver reader from its probed schema and row
+    // count, the data isn't read. return 0 on success.
+    int registerDataset(std::shared_ptr<primihub::DataDriver> driver,
+                        const std::string &description,
+                        DatasetMeta &meta /*output*/);
+
     // create dataset from arrow data and write data using driver
     void writeDataset(const std::shared_ptr<primihub::Dataset> &dataset,
                       const std::string &description,
@@ -147,6 +154,45 @@ class DatasetService  {
 };
 
 /////////////////////////// Arrow Flight Server////////////////////////////////////
+// NOTE flight ticket format: {dataset_id}[?columns=a,b&limit=n], without
+// columns all columns are sent and without limit all rows, limit is -1 then.
+arrow::Status ParseFlightTicket(const std::string &ticket,
+                                std::string *dataset_id,
+                                std::vector<std::string> *columns,
+                                int64_t *limit);
+
+// Stops the stream after limit rows, the last batch is sliced.
+class LimitedBatchReader : public arrow::RecordBatchReader {
+  public:
+    LimitedBatchReader(std::shared_ptr<arrow::RecordBatchReader> reader,
+                       int64_t limit)
+        : reader_(std::move(reader)), remaining_(limit) {}
+
+    std::shared_ptr<arrow::Schema> schema() const override {
+        return reader_->schema();
+    }
+
+    arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch> *batch) override {
+        *batch = nullptr;
+        if (remaining_ == 0) {
+            return arrow::Status::OK();
+        }
+        ARROW_RETURN_NOT_OK(reader_->ReadNext(batch));
+        if (*batch == nullptr) {
+            return arrow::Status::OK();
+        }
+        if ((*batch)->num_rows() > remaining_) {
+            *batch = (*batch)->Slice(0, remaining_);
+        }
+        remaining_ -= (*batch)->num_rows();
+        return arrow::Status::OK();
+    }
+
+  private:
+    std::shared_ptr<arrow::RecordBatchReader> reader_;
+    int64_t remaining_;
+};
+
 struct IntegrationDataset {
     std::shared_ptr<arrow::Schema> schema;
     std::vector<std::shared_ptr<arrow::RecordBatch>> chunks;
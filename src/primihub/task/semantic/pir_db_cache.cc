@@ -0,0 +1,82 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "src/primihub/task/semantic/pir_db_cache.h"
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <glog/logging.h>
+
+namespace primihub::task {
+
+int PIRDatabaseCache::datasetSignature(const std::string& dataset,
+                                       int64_t* size, int64_t* mtime) {
+    struct stat file_stat;
+    if (stat(dataset.c_str(), &file_stat) != 0) {
+        return -1;
+    }
+    *size = file_stat.st_size;
+    *mtime = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 +
+             file_stat.st_mtim.tv_nsec;
+    return 0;
+}
+
+std::shared_ptr<PIRDatabaseEntry>
+PIRDatabaseCache::get(const PIRDatabaseKey& key) {
+    int64_t size = 0;
+    int64_t mtime = 0;
+    int ret = datasetSignature(key.dataset, &size, &mtime);
+    std::lock_guard<std::mutex> lck(mtx_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+    auto& entry = it->second;
+    if (ret != 0 || entry->dataset_size != size ||
+        entry->dataset_mtime != mtime) {
+        LOG(INFO) << "Dataset " << key.dataset
+                  << " changed, drop cached pir database.";
+        lru_.remove_if([&key](const PIRDatabaseKey& k) {
+            return !(k < key) && !(key < k);
+        });
+        entries_.erase(it);
+        return nullptr;
+    }
+    touch(key);
+    return entry;
+}
+
+void PIRDatabaseCache::put(const PIRDatabaseKey& key,
+                           std::shared_ptr<PIRDatabaseEntry> entry) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    entries_[key] = std::move(entry);
+    touch(key);
+    while (entries_.size() > kMaxCachedDatabase) {
+        auto& oldest = lru_.back();
+        VLOG(5) << "evict cached pir database of " << oldest.dataset;
+        entries_.erase(oldest);
+        lru_.pop_back();
+    }
+}
+
+void PIRDatabaseCache::touch(const PIRDatabaseKey& key) {
+    lru_.remove_if([&key](const PIRDatabaseKey& k) {
+        return !(k < key) && !(key < k);
+    });
+    lru_.push_front(key);
+}
+
+} // namespace primihub::task
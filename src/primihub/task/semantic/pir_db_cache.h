@@ -0,0 +1,102 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef SRC_PRIMIHUB_TASK_SEMANTIC_PIR_DB_CACHE_H_
+#define SRC_PRIMIHUB_TASK_SEMANTIC_PIR_DB_CACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "pir/cpp/server.h"
+#include "pir/cpp/database.h"
+
+namespace primihub::task {
+
+// Everything which changes the preprocessed database.
+struct PIRDatabaseKey {
+    std::string dataset;
+    size_t elem_size;
+    size_t dimensions;
+    uint32_t poly_modulus_degree;
+    uint32_t bits_per_coeff;
+    bool use_ciphertext_multiplication;
+
+    bool operator<(const PIRDatabaseKey& other) const {
+        return std::tie(dataset, elem_size, dimensions, poly_modulus_degree,
+                        bits_per_coeff, use_ciphertext_multiplication) <
+               std::tie(other.dataset, other.elem_size, other.dimensions,
+                        other.poly_modulus_degree, other.bits_per_coeff,
+                        other.use_ciphertext_multiplication);
+    }
+};
+
+struct PIRDatabaseEntry {
+    // size and modify time of the dataset when the database was built,
+    // a mismatch means the dataset changed and the entry is stale.
+    int64_t dataset_size{0};
+    int64_t dataset_mtime{0};
+    size_t db_size{0};
+    uint32_t plain_mod_bit_size{0};
+    std::shared_ptr<pir::PIRParameters> pir_params;
+    std::shared_ptr<pir::PIRDatabase> pir_db;
+    std::shared_ptr<pir::PIRServer> pir_server;
+    // tasks run concurrently and share the entry, PIRServer and PIRDatabase
+    // make no thread safety promise, so requests are processed one at a time.
+    std::mutex process_mtx;
+};
+
+// Node level cache of preprocessed PIR databases, so that repeated queries
+// against the same dataset only pay for PIRServer::ProcessRequest.
+// At most kMaxCachedDatabase entries are kept, least recently used first out.
+// The dataset is a file path given by the task, not a registered dataset, an
+// entry is dropped by get() once the file changed or is gone.
+class PIRDatabaseCache {
+public:
+    static constexpr size_t kMaxCachedDatabase = 4;
+
+    PIRDatabaseCache(const PIRDatabaseCache&) = delete;
+    PIRDatabaseCache& operator=(const PIRDatabaseCache&) = delete;
+
+    static PIRDatabaseCache& getInstance() {
+        static PIRDatabaseCache kSingleInstance;
+        return kSingleInstance;
+    }
+
+    // return nullptr if not cached or the dataset changed since it was built.
+    std::shared_ptr<PIRDatabaseEntry> get(const PIRDatabaseKey& key);
+    void put(const PIRDatabaseKey& key, std::shared_ptr<PIRDatabaseEntry> entry);
+
+    // fill size and modify time in nanoseconds of dataset, return -1 if it
+    // can not be accessed.
+    static int datasetSignature(const std::string& dataset,
+                                int64_t* size, int64_t* mtime);
+
+private:
+    PIRDatabaseCache() = default;
+    void touch(const PIRDatabaseKey& key);
+
+    std::mutex mtx_;
+    std::map<PIRDatabaseKey, std::shared_ptr<PIRDatabaseEntry>> entries_;
+    std::list<PIRDatabaseKey> lru_;
+};
+
+} // namespace primihub::task
+
+#endif // SRC_PRIMIHUB_TASK_SEMANTIC_PIR_DB_CACHE_H_
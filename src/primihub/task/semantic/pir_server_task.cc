@@ -139,46 +139,74 @@ int PIRServerTask::execute() {
     }
     LOG(INFO) << "parameters loaded";
 
-    LOG(INFO) << "load dataset";
-    int db_size = loadDataset();
-    if (db_size <= 0) {
-        LOG(ERROR) << "Load dataset for pir server failed.";
-        return -1;
-    }
-    LOG(INFO) << "dataset loaded";
-
     size_t dimensions = 1;
     size_t elem_size = ELEM_SIZE_SVR;
-    uint32_t plain_mod_bit_size = compute_plain_mod_bit_size_server(db_size, elem_size);
     bool use_ciphertext_multiplication = true;
     uint32_t poly_modulus_degree = POLY_MODULUS_DEGREE_SVR;
     uint32_t bits_per_coeff = 0;
 
-    LOG(INFO) << "create database";
-    ret = _SetUpDB(db_size, dimensions, elem_size, poly_modulus_degree,
+    PIRDatabaseKey db_key{dataset_path_, elem_size, dimensions,
+                          poly_modulus_degree, bits_per_coeff,
+                          use_ciphertext_multiplication};
+    auto& db_cache = PIRDatabaseCache::getInstance();
+    auto db_entry = db_cache.get(db_key);
+    if (db_entry != nullptr) {
+        LOG(INFO) << "use cached pir database, db size = " << db_entry->db_size;
+    } else {
+        db_entry = std::make_shared<PIRDatabaseEntry>();
+        // take the signature before loading, a concurrent update of the
+        // dataset then invalidates the entry on next lookup.
+        if (PIRDatabaseCache::datasetSignature(dataset_path_,
+                &db_entry->dataset_size, &db_entry->dataset_mtime)) {
+            LOG(ERROR) << "Can not access pir dataset " << dataset_path_;
+            return -1;
+        }
+
+        LOG(INFO) << "load dataset";
+        int db_size = loadDataset();
+        if (db_size <= 0) {
+            LOG(ERROR) << "Load dataset for pir server failed.";
+            return -1;
+        }
+        LOG(INFO) << "dataset loaded";
+
+        uint32_t plain_mod_bit_size =
+            compute_plain_mod_bit_size_server(db_size, elem_size);
+        LOG(INFO) << "create database";
+        ret = _SetUpDB(db_size, dimensions, elem_size, poly_modulus_degree,
                        plain_mod_bit_size, bits_per_coeff,
                        use_ciphertext_multiplication);
-    if (ret) {
-        LOG(ERROR) << "Create pir db failed.";
-        return -1;
+        if (ret) {
+            LOG(ERROR) << "Create pir db failed.";
+            return -1;
+        }
+        LOG(INFO) << "database created";
+
+        LOG(INFO) << "create server";
+        auto server_status = pir::PIRServer::Create(pir_db_, pir_params_);
+        if (!server_status.ok() || *server_status == nullptr) {
+            LOG(ERROR) << "Failed to create pir server";
+            return -1;
+        }
+        LOG(INFO) << "server created";
+        // the padded dataset is not needed once the database is built
+        std::vector<std::string>().swap(elements_);
+
+        db_entry->db_size = db_size_;
+        db_entry->plain_mod_bit_size = plain_mod_bit_size;
+        db_entry->pir_params = pir_params_;
+        db_entry->pir_db = pir_db_;
+        db_entry->pir_server = std::move(server_status).value();
+        db_cache.put(db_key, db_entry);
     }
-    LOG(INFO) << "database created";
 
     pir::Request pir_request;
     initRequest(request_, pir_request);
 
-    LOG(INFO) << "create server";
-    std::unique_ptr<pir::PIRServer> server = 
-        *(pir::PIRServer::Create(pir_db_, pir_params_));
-
-    if (server == nullptr) {
-        LOG(ERROR) << "Failed to create pir server";
-        return -1;
-    }
-    LOG(INFO) << "server created";
-
     LOG(INFO) << "process request";
-    auto  result_status = server->ProcessRequest(pir_request);
+    std::unique_lock<std::mutex> process_lck(db_entry->process_mtx);
+    auto  result_status = db_entry->pir_server->ProcessRequest(pir_request);
+    process_lck.unlock();
     if (!result_status.ok()) {
         LOG(ERROR) << "Process pir request failed:"
                    << result_status.status();
@@ -31,6 +31,7 @@
 #include "src/primihub/protos/psi.grpc.pb.h"
 #include "src/primihub/protos/worker.grpc.pb.h"
 #include "src/primihub/task/semantic/private_server_base.h"
+#include "src/primihub/task/semantic/pir_db_cache.h"
 
 using std::shared_ptr;
 
@@ -18,6 +18,7 @@
 
 #include "src/primihub/task/semantic/private_server_base.h"
 #include "src/primihub/data_store/factory.h"
+#include "src/primihub/data_store/column_reader.h"
 #include <fstream>
 
 using arrow::Array;
@@ -57,47 +58,22 @@ int ServerTaskBase::loadDatasetFromSQLite(const std::string& conn_str, int data_
         return -1;
     }
     auto table = std::get<std::shared_ptr<Table>>(ds->data);
-    int num_col = table->num_columns();
-    if (num_col < data_col) {
-        LOG(ERROR) << "psi dataset colunum number is smaller than data_col";
+    if (LoadColumnFromTable(table, data_col, &col_array, max_num) < 0) {
         return -1;
     }
-    auto array = std::static_pointer_cast<StringArray>(table->column(data_col)->chunk(0));
-    for (int64_t i = 0; i < array->length(); i++) {
-        if (max_num > 0 && max_num == i) {
-            break;
-        }
-        col_array.push_back(array->GetString(i));
-    }
     VLOG(5) << "psi server loaded data records: " << col_array.size();
-    return array->length();
+    return table->num_rows();
 }
 
 int ServerTaskBase::loadDatasetFromCSV(const std::string& filename, int data_col,
                                        std::vector<std::string> &col_array,
                                        int64_t max_num) {
-    std::string nodeaddr("test address"); // TODO
-    std::shared_ptr<DataDriver> driver =
-        DataDirverFactory::getDriver("CSV", nodeaddr);
-    std::shared_ptr<Cursor> &cursor = driver->read(filename);
-    std::shared_ptr<Dataset> ds = cursor->read();
-    std::shared_ptr<Table> table = std::get<std::shared_ptr<Table>>(ds->data);
-
-    int num_col = table->num_columns();
-    if (num_col < data_col) {
-        LOG(ERROR) << "psi dataset colunum number is smaller than data_col";
+    int64_t ret = LoadColumnFromCSV(filename, data_col, &col_array, max_num);
+    if (ret < 0) {
+        LOG(ERROR) << "Load psi dataset from csv file " << filename << " failed.";
         return -1;
     }
-
-    auto array = std::static_pointer_cast<StringArray>(
-        table->column(data_col)->chunk(0));
-    for (int64_t i = 0; i < array->length(); i++) {
-        if (max_num > 0 && max_num == i) {
-            break;
-        }
-        col_array.push_back(array->GetString(i));
-    }
-    return array->length();
+    return col_array.size();
 }
 
 int ServerTaskBase::loadDatasetFromTXT(std::string &filename,
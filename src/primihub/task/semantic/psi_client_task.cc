@@ -14,11 +14,19 @@
  limitations under the License.
  */
 
+#include <algorithm>
+#include <thread>
+
 #include "private_set_intersection/cpp/psi_client.h"
+#include "absl/types/span.h"
 
 #include "src/primihub/task/semantic/psi_client_task.h"
 #include "src/primihub/data_store/factory.h"
+#include "src/primihub/data_store/column_reader.h"
 #include "src/primihub/util/file_util.h"
+#include "src/primihub/util/parallel.h"
+#include "src/primihub/util/row_select.h"
+#include "src/primihub/task/semantic/result_sync.h"
 
 
 using arrow::Table;
@@ -58,6 +66,20 @@ int PSIClientTask::_LoadParams(Task &task) {
             server_result_path = it->second.value_string();
             VLOG(5) << "server_outputFullFilname: " << server_result_path;
         }
+        // unbalanced psi is decided by the client and forwarded
+        it = param_map.find("psiUnbalanced");
+        if (it != param_map.end()) {
+            server_params_["psiUnbalanced"] = it->second;
+        }
+        it = param_map.find("psiStream");
+        if (it != param_map.end()) {
+            stream_mode_ = it->second.value_int32() > 0;
+        }
+        it = param_map.find("psiThreadNum");
+        if (it != param_map.end()) {
+            thread_num_ = it->second.value_int32();
+            VLOG(5) << "psiThreadNum: " << thread_num_;
+        }
         server_index_ = param_map["serverIndex"];
         server_address_ = param_map["serverAddress"].value_string();
         server_dataset_ = param_map[server_address_].value_string();
@@ -76,17 +98,13 @@ int PSIClientTask::_LoadDatasetFromSQLite(std::string &conn_str, int data_col, s
     auto driver = DataDirverFactory::getDriver("SQLITE", nodeaddr);
     auto& cursor = driver->read(conn_str);
     auto ds = cursor->read();
-    auto table = std::get<std::shared_ptr<Table>>(ds->data);
-    int col_count = table->num_columns();
-    if(col_count < data_col) {
-        LOG(ERROR) << "psi dataset colunum number is smaller than data_col, "
-            << "dataset total colum: " << col_count
-            << "expected col index: " << data_col;
+    if (ds == nullptr) {
         return -1;
     }
-    auto array = std::static_pointer_cast<StringArray>(table->column(data_col)->chunk(0));
-    for (int64_t i = 0; i < array->length(); i++) {
-        col_array.push_back(array->GetString(i));
+    auto table = std::get<std::shared_ptr<Table>>(ds->data);
+    int64_t ret = LoadColumnFromTable(table, data_col, &col_array);
+    if (ret < 0) {
+        return -1;
     }
     VLOG(0) << "loaded records number: " << col_array.size();
     return col_array.size();
@@ -95,25 +113,12 @@ int PSIClientTask::_LoadDatasetFromSQLite(std::string &conn_str, int data_col, s
 int PSIClientTask::_LoadDatasetFromCSV(std::string &filename,
                         int data_col,
                         std::vector <std::string> &col_array) {
-    std::string nodeaddr("test address"); // TODO
-    std::shared_ptr<DataDriver> driver =
-        DataDirverFactory::getDriver("CSV", nodeaddr);
-    std::shared_ptr<Cursor> &cursor = driver->read(filename);
-    std::shared_ptr<Dataset> ds = cursor->read();
-    std::shared_ptr<Table> table = std::get<std::shared_ptr<Table>>(ds->data);
-
-    int num_col = table->num_columns();
-    if (num_col < data_col) {
-        LOG(ERROR) << "psi dataset colunum number is smaller than data_col";
+    int64_t ret = LoadColumnFromCSV(filename, data_col, &col_array);
+    if (ret < 0) {
+        LOG(ERROR) << "Load psi dataset from csv file " << filename << " failed.";
         return -1;
     }
-
-    auto array = std::static_pointer_cast<StringArray>(
-        table->column(data_col)->chunk(0));
-    for (int64_t i = 0; i < array->length(); i++) {
-        col_array.push_back(array->GetString(i));
-    }
-    return array->length();
+    return col_array.size();
 }
 
 int PSIClientTask::_LoadDataset(void) {
@@ -140,182 +145,275 @@ int PSIClientTask::_LoadDataset(void) {
     return 0;
 }
 
-int PSIClientTask::_GetIntsection(const std::unique_ptr<PsiClient> &client,
-                              ExecuteTaskResponse & taskResponse) {
-    psi_proto::Response entrpy_response;
-    const std::int64_t num_response_elements =
-        static_cast<std::int64_t>(taskResponse.psi_response().encrypted_elements().size());
-    for (std::int64_t i = 0; i < num_response_elements; i++) {
-        entrpy_response.add_encrypted_elements(
-            taskResponse.psi_response().encrypted_elements()[i]);
-    }
-
-    psi_proto::ServerSetup server_setup;
-    server_setup.set_bits(taskResponse.psi_response().server_setup().bits());
-    if (taskResponse.psi_response().server_setup().data_structure_case() ==
-        psi_proto::ServerSetup::DataStructureCase::kGcs) {
-        auto *ptr_gcs = server_setup.mutable_gcs();
-        ptr_gcs->set_div(taskResponse.psi_response().server_setup().gcs().div());
-        ptr_gcs->set_hash_range(taskResponse.psi_response().server_setup().gcs().hash_range());
-    } else if (taskResponse.psi_response().server_setup().data_structure_case() ==
-               psi_proto::ServerSetup::DataStructureCase::kBloomFilter) {
-        auto *ptr_bloom_filter = server_setup.mutable_bloom_filter();
+int PSIClientTask::_ToPsiServerSetup(const primihub::rpc::ServerSetup &setup,
+                                     psi_proto::ServerSetup *server_setup) {
+    server_setup->set_bits(setup.bits());
+    if (setup.data_structure_case() ==
+        primihub::rpc::ServerSetup::DataStructureCase::kGcs) {
+        auto *ptr_gcs = server_setup->mutable_gcs();
+        ptr_gcs->set_div(setup.gcs().div());
+        ptr_gcs->set_hash_range(setup.gcs().hash_range());
+    } else if (setup.data_structure_case() ==
+               primihub::rpc::ServerSetup::DataStructureCase::kBloomFilter) {
+        auto *ptr_bloom_filter = server_setup->mutable_bloom_filter();
         ptr_bloom_filter->set_num_hash_functions(
-            taskResponse.psi_response().server_setup().bloom_filter().num_hash_functions()
-        );
+            setup.bloom_filter().num_hash_functions());
     } else {
-        LOG(ERROR) << "Node psi client get intersection error!";
+        LOG(ERROR) << "Unknown data structure of psi server setup.";
         return -1;
     }
+    return 0;
+}
 
+int PSIClientTask::_GetIntsection(const std::unique_ptr<PsiClient> &client,
+                                  const psi_proto::ServerSetup &server_setup,
+                                  const psi_proto::Response &server_response) {
     std::vector <int64_t> intersection =
-        std::move(client->GetIntersection(server_setup, entrpy_response)).value();
+        std::move(client->GetIntersection(server_setup, server_response)).value();
 
-    const std::int64_t num_intersection =
-        static_cast<std::int64_t>(intersection.size());
+    // elements_ is not needed once the result is assembled, so the
+    // selected rows are moved out of it instead of copied.
+    SelectRows(&elements_, intersection,
+               psi_type_ == PsiType::DIFFERENCE, &result_);
+    return 0;
+}
 
-    if (psi_type_ == PsiType::DIFFERENCE) {
-        map<int64_t, int> inter_map;
-        std::int64_t num_elements = static_cast<std::int64_t>(elements_.size());
-        for (std::int64_t i = 0; i < num_intersection; i++) {
-            inter_map[intersection[i]] = 1;
-        }
-        for (std::int64_t i = 0; i < num_elements; i++) {
-            if (inter_map.find(i) == inter_map.end()) {
-                // outFile << i << std::endl;
-                result_.push_back(elements_[i]);
-            }
+int PSIClientTask::_CreateRequest(const std::unique_ptr<PsiClient> &client,
+        absl::Span<const std::string> inputs,
+        google::protobuf::RepeatedPtrField<std::string> *encrypted_elements) {
+    size_t num_shards = ShardNum(inputs.size(),
+        thread_num_ > 0 ? thread_num_ : 0, kMinShardSize);
+    if (num_shards == 1) {
+        psi_proto::Request client_request =
+            std::move(client->CreateRequest(inputs)).value();
+        auto *client_elements = client_request.mutable_encrypted_elements();
+        encrypted_elements->Reserve(encrypted_elements->size() + client_elements->size());
+        for (auto &item : *client_elements) {
+            encrypted_elements->Add(std::move(item));
         }
-    } else {
-        for (std::int64_t i = 0; i < num_intersection; i++) {
-            // outFile << intersection[i] << std::endl;
-            result_.push_back(elements_[intersection[i]]);
+        return 0;
+    }
+
+    // Every shard is encrypted by its own client instance created from
+    // the same key, so each thread owns its EC context, and the shards
+    // are merged in input order which GetIntersection relies on.
+    VLOG(5) << "create psi request with " << num_shards << " shards";
+    std::string key_bytes = client->GetPrivateKeyBytes();
+    std::vector<psi_proto::Request> shard_requests(num_shards);
+    try {
+        ParallelForShards(inputs.size(), num_shards,
+            [&](size_t shard, size_t begin, size_t end) {
+                auto shard_client = std::move(
+                    PsiClient::CreateFromKey(key_bytes, reveal_intersection_)).value();
+                shard_requests[shard] = std::move(
+                    shard_client->CreateRequest(inputs.subspan(begin, end - begin))).value();
+            });
+    } catch (std::exception &e) {
+        LOG(ERROR) << "Create psi request failed: " << e.what();
+        return -1;
+    }
+    encrypted_elements->Reserve(encrypted_elements->size() + inputs.size());
+    for (auto &shard_request : shard_requests) {
+        for (auto &item : *shard_request.mutable_encrypted_elements()) {
+            encrypted_elements->Add(std::move(item));
         }
     }
     return 0;
 }
 
-int PSIClientTask::execute() {
-    int ret = _LoadParams(task_param_);
-    if (ret) {
-        LOG(ERROR) << "Psi client load task params failed.";
-        return ret;
-    }
-
-    ret = _LoadDataset();
-    if (ret) {
-        LOG(ERROR) << "Psi client load dataset failed.";
-        return ret;
+void PSIClientTask::_SetServerParams(Params *params) {
+    auto *ptr_params = params->mutable_param_map();
+    ParamValue pv;
+    pv.set_var_type(VarType::STRING);
+    pv.set_value_string(server_dataset_);
+    (*ptr_params)["serverData"] = pv;
+    (*ptr_params)["serverIndex"] = server_index_;
+    ParamValue pv_thread_num;
+    pv_thread_num.set_var_type(VarType::INT32);
+    pv_thread_num.set_value_int32(thread_num_);
+    (*ptr_params)["psiThreadNum"] = pv_thread_num;
+    for (auto &item : server_params_) {
+        (*ptr_params)[item.first] = item.second;
     }
+}
 
-    std::unique_ptr<PsiClient> client =
-        std::move(PsiClient::CreateWithNewKey(reveal_intersection_)).value();
-    psi_proto::Request client_request =
-        std::move(client->CreateRequest(elements_)).value();
-    psi_proto::Response server_response;
-
+int PSIClientTask::_ExecuteUnary(const std::unique_ptr<PsiClient> &client,
+                                 psi_proto::ServerSetup *server_setup,
+                                 psi_proto::Response *server_response) {
     grpc::ClientContext context;
     ExecuteTaskRequest taskRequest;
     ExecuteTaskResponse taskResponse;
 
     PsiRequest *ptr_request = taskRequest.mutable_psi_request();
-    ptr_request->set_reveal_intersection(client_request.reveal_intersection());
-    size_t num_elements = client_request.encrypted_elements().size();
-    for (size_t i = 0; i < num_elements; i++) {
-        ptr_request->add_encrypted_elements(client_request.encrypted_elements()[i]);
+    ptr_request->set_reveal_intersection(reveal_intersection_);
+    int ret = _CreateRequest(client, elements_,
+                             ptr_request->mutable_encrypted_elements());
+    if (ret) {
+        LOG(ERROR) << "Psi client create request failed.";
+        return ret;
     }
-
-    auto *ptr_params = taskRequest.mutable_params()->mutable_param_map();
-    ParamValue pv;
-    pv.set_var_type(VarType::STRING);
-    pv.set_value_string(server_dataset_);
-    (*ptr_params)["serverData"] = pv;
-    (*ptr_params)["serverIndex"] = server_index_;
+    _SetServerParams(taskRequest.mutable_params());
 
     std::unique_ptr<VMNode::Stub> stub = VMNode::NewStub(grpc::CreateChannel(
         server_address_, grpc::InsecureChannelCredentials()));
 
     Status status = stub->ExecuteTask(&context, taskRequest, &taskResponse);
-    if (status.ok()) {
-        if (taskResponse.psi_response().ret_code()) {
-            LOG(ERROR) << "Node psi server process request error.";
-            return -1;
-        }
-        int ret = _GetIntsection(client, taskResponse);
-        if (ret) {
-            LOG(ERROR) << "Node psi client get insection failed.";
-            return -1;
-        }
-        ret = saveResult();
-        if (ret) {
-            LOG(ERROR) << "Save psi result failed.";
-            return -1;
-        }
-    } else {
+    if (!status.ok()) {
         LOG(ERROR) << "Node push psi server task rpc failed.";
         LOG(ERROR) << status.error_code() << ": " << status.error_message();
         return -1;
     }
-    if (this->reveal_intersection_ && this->sync_result_to_server) {
-        send_result_to_server();
+    auto *psi_response = taskResponse.mutable_psi_response();
+    if (psi_response->ret_code()) {
+        LOG(ERROR) << "Node psi server process request error.";
+        return -1;
     }
-    return 0;
+    for (auto &item : *psi_response->mutable_encrypted_elements()) {
+        server_response->add_encrypted_elements(std::move(item));
+    }
+    return _ToPsiServerSetup(psi_response->server_setup(), server_setup);
 }
 
-int PSIClientTask::send_result_to_server() {
+int PSIClientTask::_ExecuteStream(const std::unique_ptr<PsiClient> &client,
+                                  psi_proto::ServerSetup *server_setup,
+                                  psi_proto::Response *server_response) {
     grpc::ClientContext context;
-    VLOG(5) << "send_result_to_server";
-     // std::unique_ptr<VMNode::Stub>
-    auto channel = grpc::InsecureChannelCredentials();
-    auto stub = VMNode::NewStub(grpc::CreateChannel(server_address_, channel));
-    primihub::rpc::TaskResponse task_response;
-    std::unique_ptr<grpc::ClientWriter<primihub::rpc::TaskRequest>> writer(stub->Send(&context, &task_response));
-    constexpr size_t limited_size = 1 << 22;  // limit data size 4M
-    size_t sended_size = 0;
-    size_t sended_index = 0;
-    bool add_head_flag = false;
-    do {
-        primihub::rpc::TaskRequest task_request;
-        task_request.set_job_id(this->job_id_);
-        task_request.set_task_id(this->task_id_);
-        task_request.set_storage_type(primihub::rpc::TaskRequest::FILE);
-        task_request.set_storage_info(server_result_path);
-        if (!add_head_flag) {
-            task_request.add_data("\"intersection_row\"");
-            add_head_flag = true;
-        }
-        for (size_t i = sended_index; i < this->result_.size(); i++) {
-            auto& data_item = this->result_[i];
-            size_t item_len = data_item.size();
-            if (sended_size + item_len > limited_size) {
+    std::unique_ptr<VMNode::Stub> stub = VMNode::NewStub(grpc::CreateChannel(
+        server_address_, grpc::InsecureChannelCredentials()));
+    std::shared_ptr<grpc::ClientReaderWriter<PsiStreamRequest, PsiStreamResponse>>
+        stream(stub->ExecutePsiStream(&context));
+
+    // The writer encrypts and sends batch N+1 while the server is
+    // processing batch N, responses are collected on this thread.
+    bool write_failed{false};
+    std::thread writer([&]() {
+        auto inputs = absl::MakeConstSpan(elements_);
+        for (size_t begin = 0; begin < inputs.size(); begin += kPsiStreamBatchSize) {
+            PsiStreamRequest request;
+            if (begin == 0) {
+                _SetServerParams(request.mutable_params());
+                request.set_reveal_intersection(reveal_intersection_);
+                request.set_num_client_elements(inputs.size());
+                request.set_job_id(job_id_);
+                request.set_task_id(task_id_);
+            }
+            size_t num = std::min(kPsiStreamBatchSize, inputs.size() - begin);
+            if (_CreateRequest(client, inputs.subspan(begin, num),
+                               request.mutable_encrypted_elements())) {
+                write_failed = true;
+                break;
+            }
+            if (!stream->Write(request)) {
+                write_failed = true;
                 break;
             }
-            task_request.add_data(data_item);
-            sended_size += item_len;
-            sended_index++;
         }
-        writer->Write(task_request);
-        VLOG(5) << "sended_size: " << sended_size << " "
-                << "sended_index: " << sended_index << " "
-                << "result size: " << this->result_.size();
-        if (sended_index >= this->result_.size()) {
+        stream->WritesDone();
+    });
+
+    PsiStreamResponse response;
+    bool setup_received{false};
+    int ret = 0;
+    server_response->mutable_encrypted_elements()->Reserve(elements_.size());
+    while (stream->Read(&response)) {
+        if (response.ret_code()) {
+            LOG(ERROR) << "Node psi server process request error.";
+            ret = -1;
             break;
         }
-    } while(true);
-    writer->WritesDone();
-    Status status = writer->Finish();
-    if (status.ok()) {
-        auto ret_code = task_response.ret_code();
-        if (ret_code) {
-            LOG(ERROR) << "client Node send result data to server return failed error code: " << ret_code;
-            return -1;
+        if (!setup_received) {
+            ret = _ToPsiServerSetup(response.server_setup(), server_setup);
+            if (ret) {
+                break;
+            }
+            setup_received = true;
+        }
+        for (auto &item : *response.mutable_encrypted_elements()) {
+            server_response->add_encrypted_elements(std::move(item));
         }
-    } else {
-        LOG(ERROR) << "client Node send result data to server failed. error_code: "
+    }
+    if (ret) {
+        context.TryCancel();
+    }
+    writer.join();
+    Status status = stream->Finish();
+    if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+        // a server without ExecutePsiStream, nothing was answered yet.
+        LOG(WARNING) << "Psi server " << server_address_
+                     << " has no stream rpc, fall back to unary rpc.";
+        server_setup->Clear();
+        server_response->Clear();
+        return _ExecuteUnary(client, server_setup, server_response);
+    }
+    if (!status.ok()) {
+        LOG(ERROR) << "Node psi stream rpc failed. "
                    << status.error_code() << ": " << status.error_message();
         return -1;
     }
-    VLOG(5) << "send result to server success";
+    if (ret || write_failed || !setup_received) {
+        return -1;
+    }
+    if (server_response->encrypted_elements_size() !=
+        static_cast<int64_t>(elements_.size())) {
+        LOG(ERROR) << "Psi server answered " << server_response->encrypted_elements_size()
+                   << " of " << elements_.size() << " elements.";
+        return -1;
+    }
+    return 0;
+}
+
+int PSIClientTask::execute() {
+    int ret = _LoadParams(task_param_);
+    if (ret) {
+        LOG(ERROR) << "Psi client load task params failed.";
+        return ret;
+    }
+
+    ret = _LoadDataset();
+    if (ret) {
+        LOG(ERROR) << "Psi client load dataset failed.";
+        return ret;
+    }
+
+    std::unique_ptr<PsiClient> client =
+        std::move(PsiClient::CreateWithNewKey(reveal_intersection_)).value();
+
+    psi_proto::ServerSetup server_setup;
+    psi_proto::Response server_response;
+    // when the intersection is not revealed the server answers only once
+    // the whole set is sent, so streaming just splits the request.
+    if (stream_mode_) {
+        ret = _ExecuteStream(client, &server_setup, &server_response);
+    } else {
+        ret = _ExecuteUnary(client, &server_setup, &server_response);
+    }
+    if (ret) {
+        LOG(ERROR) << "Node psi client exchange with server failed.";
+        return -1;
+    }
+    ret = _GetIntsection(client, server_setup, server_response);
+    if (ret) {
+        LOG(ERROR) << "Node psi client get insection failed.";
+        return -1;
+    }
+    ret = saveResult();
+    if (ret) {
+        LOG(ERROR) << "Save psi result failed.";
+        return -1;
+    }
+    if (this->reveal_intersection_ && this->sync_result_to_server) {
+        send_result_to_server();
+    }
+    return 0;
+}
+
+int PSIClientTask::send_result_to_server() {
+    // cause grpc port is alive along with node life duration,
+    // so send result data to server by grpc
+    VLOG(5) << "send_result_to_server";
+    return SendResultToServer(server_address_, this->job_id_, this->task_id_,
+                              server_result_path, "\"intersection_row\"",
+                              this->result_);
 }
 
 int PSIClientTask::saveResult() {
@@ -25,6 +25,7 @@
 #include <string>
 #include <set>
 
+#include "absl/types/span.h"
 #include "private_set_intersection/cpp/psi_client.h"
 
 #include "src/primihub/protos/common.grpc.pb.h"
@@ -43,12 +44,18 @@ using primihub::rpc::ExecuteTaskRequest;
 using primihub::rpc::ExecuteTaskResponse;
 using primihub::rpc::PsiRequest;
 using primihub::rpc::PsiResponse;
+using primihub::rpc::PsiStreamRequest;
+using primihub::rpc::PsiStreamResponse;
+using primihub::rpc::Params;
 using primihub::rpc::VMNode;
 
 using private_set_intersection::PsiClient;
 
 namespace primihub::task {
 
+// number of elements carried by one ExecutePsiStream message
+constexpr size_t kPsiStreamBatchSize = 1 << 16;
+
 class PSIClientTask : public TaskBase {
 public:
     explicit PSIClientTask(const std::string &node_id,
@@ -68,8 +75,21 @@ private:
                             std::vector <std::string> &col_array);
     int _LoadDatasetFromSQLite(std::string &conn_str, int data_col,
                                 std::vector <std::string> &col_array);
+    int _CreateRequest(const std::unique_ptr<PsiClient> &client,
+                       absl::Span<const std::string> inputs,
+                       google::protobuf::RepeatedPtrField<std::string> *encrypted_elements);
+    void _SetServerParams(Params *params);
+    int _ExecuteUnary(const std::unique_ptr<PsiClient> &client,
+                      psi_proto::ServerSetup *server_setup,
+                      psi_proto::Response *server_response);
+    int _ExecuteStream(const std::unique_ptr<PsiClient> &client,
+                       psi_proto::ServerSetup *server_setup,
+                       psi_proto::Response *server_response);
+    int _ToPsiServerSetup(const primihub::rpc::ServerSetup &setup,
+                          psi_proto::ServerSetup *server_setup);
     int _GetIntsection(const std::unique_ptr<PsiClient> &client,
-                       ExecuteTaskResponse & taskResponse);
+                       const psi_proto::ServerSetup &server_setup,
+                       const psi_proto::Response &server_response);
     const std::string node_id_;
     const std::string job_id_;
     const std::string task_id_;
@@ -80,6 +100,12 @@ private:
     bool reveal_intersection_;
     std::vector<std::string> elements_;
     std::vector<std::string> result_;
+    // 0 means one worker per core
+    int thread_num_{0};
+    // exchange encrypted elements in batches over ExecutePsiStream
+    bool stream_mode_{true};
+    // extra params forwarded to the psi server
+    std::map<std::string, ParamValue> server_params_;
 
     std::string server_address_;
     std::string server_dataset_;
@@ -0,0 +1,203 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef __APPLE__
+#include "src/primihub/task/semantic/psi_kkrt_shard.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "cryptoTools/Crypto/PRNG.h"
+#include "libOTe/NChooseOne/Kkrt/KkrtNcoOtReceiver.h"
+#include "libOTe/NChooseOne/Kkrt/KkrtNcoOtSender.h"
+#include "libPSI/PSI/Kkrt/KkrtPsiReceiver.h"
+#include "libPSI/PSI/Kkrt/KkrtPsiSender.h"
+#include "src/primihub/util/parallel.h"
+
+using namespace osuCrypto;
+
+namespace primihub::task {
+
+namespace {
+
+// Elements are distributed into shards by their hash, so equal elements
+// of both parties always meet in the same shard.
+size_t ShardOfBlock(const block &b, size_t num_shards) {
+    u64 v;
+    std::memcpy(&v, &b, sizeof(v));
+    return v % num_shards;
+}
+
+// Shards of a party, padded to the public bound with random blocks.
+// index[s][j] is the position in the set of shards[s][j], padding has none.
+struct KkrtShards {
+    size_t num_shards{1};
+    u64 bound{0};
+    u64 peer_bound{0};
+    std::vector<std::vector<block>> shards;
+    std::vector<std::vector<u64>> index;
+};
+
+// return false if a shard holds more than bound elements.
+bool SplitIntoShards(const std::vector<block> &set, size_t num_shards,
+                     u64 bound, KkrtShards *out) {
+    out->num_shards = num_shards;
+    out->bound = bound;
+    out->shards.assign(num_shards, {});
+    out->index.assign(num_shards, {});
+    for (u64 i = 0; i < set.size(); ++i) {
+        size_t shard = ShardOfBlock(set[i], num_shards);
+        if (out->shards[shard].size() == bound) {
+            return false;
+        }
+        out->shards[shard].push_back(set[i]);
+        out->index[shard].push_back(i);
+    }
+    return true;
+}
+
+KkrtShards PrepareShards(Channel &chl, const std::vector<block> &set,
+                         u64 peer_size, size_t num_shards) {
+    KkrtShards shards;
+    bool fits = SplitIntoShards(set, num_shards,
+                                KkrtShardBound(set.size(), num_shards), &shards);
+    // only whether a shard overflows is exchanged, never the shard sizes.
+    chl.asyncSend(std::vector<u64>{fits ? 1ull : 0ull});
+    std::vector<u64> peer_fits;
+    chl.recv(peer_fits);
+    if (peer_fits.size() != 1) {
+        throw std::runtime_error("kkrt psi shard agreement mismatch");
+    }
+    if (num_shards > 1 && !(fits && peer_fits[0])) {
+        LOG(WARNING) << "kkrt psi shard overflow, run in a single shard.";
+        num_shards = 1;
+        SplitIntoShards(set, 1, set.size(), &shards);
+    }
+    shards.peer_bound = KkrtShardBound(peer_size, num_shards);
+    shards.bound = KkrtShardBound(set.size(), num_shards);
+
+    PRNG prng(sysRandomSeed());
+    for (auto &shard : shards.shards) {
+        while (shard.size() < shards.bound) {
+            shard.push_back(prng.get<block>());
+        }
+    }
+    return shards;
+}
+
+// Channels are created up front so both parties open them in the same
+// order, and the shard seeds are drawn in the same order on both sides.
+void OpenShardChannels(Session &ep, size_t num_shards,
+                       std::vector<Channel> *chls, std::vector<block> *seeds) {
+    PRNG prng(_mm_set_epi32(4253465, 3434565, 234435, 23987045));
+    chls->resize(num_shards);
+    seeds->resize(num_shards);
+    for (size_t s = 0; s < num_shards; ++s) {
+        (*seeds)[s] = prng.get<block>();
+        std::string name = "kkrt_shard_" + std::to_string(s);
+        (*chls)[s] = ep.addChannel(name, name);
+    }
+}
+
+}  // namespace
+
+u64 KkrtShardBound(u64 set_size, size_t num_shards) {
+    if (num_shards <= 1) {
+        return std::max<u64>(1, set_size);
+    }
+    // Bernstein bound with a union over the shards:
+    // P(load > mu + t) <= k * exp(-t^2 / (2 * (mu + t / 3))) <= 2^-40.
+    double mu = static_cast<double>(set_size) / num_shards;
+    double log_fail = std::log(static_cast<double>(num_shards)) +
+                      40 * std::log(2.0);
+    double t = log_fail / 3 +
+               std::sqrt(log_fail * log_fail / 9 + 2 * mu * log_fail);
+    u64 bound = static_cast<u64>(std::ceil(mu + t));
+    return std::max<u64>(1, std::min<u64>(set_size, bound));
+}
+
+std::vector<u64> KkrtShardedRecv(Session &ep, Channel &chl,
+                                 const std::vector<block> &set,
+                                 u64 peer_size, size_t num_shards) {
+    KkrtShards shards = PrepareShards(chl, set, peer_size, num_shards);
+    num_shards = shards.num_shards;
+    std::vector<Channel> shard_chls;
+    std::vector<block> shard_seeds;
+    OpenShardChannels(ep, num_shards, &shard_chls, &shard_seeds);
+
+    std::vector<std::vector<u64>> shard_intersections(num_shards);
+    ParallelForShards(num_shards, num_shards,
+        [&](size_t s, size_t, size_t) {
+            u8 dummy[1];
+            Channel &shard_chl = shard_chls[s];
+            KkrtNcoOtReceiver otRecv;
+            KkrtPsiReceiver recvPSIs;
+            shard_chl.recv(dummy, 1);
+            shard_chl.asyncSend(dummy, 1);
+            recvPSIs.init(shards.peer_bound, shards.bound, 40, shard_chl,
+                          otRecv, shard_seeds[s]);
+            recvPSIs.sendInput(shards.shards[s], shard_chl);
+            const auto &index = shards.index[s];
+            for (auto pos : recvPSIs.mIntersection) {
+                // padding matches only with negligible probability.
+                if (pos < index.size()) {
+                    shard_intersections[s].push_back(index[pos]);
+                }
+            }
+        });
+    for (auto &shard_chl : shard_chls) {
+        shard_chl.close();
+    }
+
+    std::vector<u64> intersection;
+    for (auto &shard_intersection : shard_intersections) {
+        intersection.insert(intersection.end(),
+                            shard_intersection.begin(), shard_intersection.end());
+    }
+    return intersection;
+}
+
+void KkrtShardedSend(Session &ep, Channel &chl, const std::vector<block> &set,
+                     u64 peer_size, size_t num_shards) {
+    KkrtShards shards = PrepareShards(chl, set, peer_size, num_shards);
+    num_shards = shards.num_shards;
+    std::vector<Channel> shard_chls;
+    std::vector<block> shard_seeds;
+    OpenShardChannels(ep, num_shards, &shard_chls, &shard_seeds);
+
+    ParallelForShards(num_shards, num_shards,
+        [&](size_t s, size_t, size_t) {
+            u8 dummy[1];
+            Channel &shard_chl = shard_chls[s];
+            KkrtNcoOtSender otSend;
+            KkrtPsiSender sendPSIs;
+            shard_chl.asyncSend(dummy, 1);
+            shard_chl.recv(dummy, 1);
+            sendPSIs.init(shards.bound, shards.peer_bound, 40, shard_chl,
+                          otSend, shard_seeds[s]);
+            sendPSIs.sendInput(shards.shards[s], shard_chl);
+        });
+    for (auto &shard_chl : shard_chls) {
+        shard_chl.close();
+    }
+}
+
+}  // namespace primihub::task
+#endif
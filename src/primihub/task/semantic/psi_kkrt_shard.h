@@ -0,0 +1,49 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef SRC_PRIMIHUB_TASK_SEMANTIC_PSI_KKRT_SHARD_H_
+#define SRC_PRIMIHUB_TASK_SEMANTIC_PSI_KKRT_SHARD_H_
+
+#ifndef __APPLE__
+#include <vector>
+
+#include "cryptoTools/Common/Defines.h"
+#include "cryptoTools/Network/Channel.h"
+#include "cryptoTools/Network/Session.h"
+
+namespace primihub::task {
+
+// Public bound on the elements of one of num_shards hash shards of a set
+// of set_size elements, exceeded with probability below 2^-40 for distinct
+// elements. Every shard is padded to it, so only the set size is revealed.
+osuCrypto::u64 KkrtShardBound(osuCrypto::u64 set_size, size_t num_shards);
+
+// KKRT PSI over num_shards hash shards, one channel and thread per shard.
+// Both parties pass the same num_shards and the size of the set of the
+// other party. If a shard of either party exceeds its bound, which takes
+// many duplicated elements, both parties run a single shard instead.
+// return the positions in set of the elements in the intersection.
+std::vector<osuCrypto::u64> KkrtShardedRecv(osuCrypto::Session &ep,
+    osuCrypto::Channel &chl, const std::vector<osuCrypto::block> &set,
+    osuCrypto::u64 peer_size, size_t num_shards);
+void KkrtShardedSend(osuCrypto::Session &ep, osuCrypto::Channel &chl,
+    const std::vector<osuCrypto::block> &set,
+    osuCrypto::u64 peer_size, size_t num_shards);
+
+}  // namespace primihub::task
+#endif
+
+#endif  // SRC_PRIMIHUB_TASK_SEMANTIC_PSI_KKRT_SHARD_H_
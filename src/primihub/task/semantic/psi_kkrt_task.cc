@@ -27,9 +27,14 @@
 #endif
 
 #include "src/primihub/task/semantic/psi_kkrt_task.h"
+#include "src/primihub/task/semantic/psi_kkrt_shard.h"
 #include "src/primihub/data_store/factory.h"
+#include "src/primihub/data_store/column_reader.h"
 #include "src/primihub/util/util.h"
 #include "src/primihub/util/file_util.h"
+#include "src/primihub/util/parallel.h"
+#include "src/primihub/util/row_select.h"
+#include "src/primihub/task/semantic/result_sync.h"
 #include <glog/logging.h>
 
 #ifndef __APPLE__
@@ -40,7 +45,9 @@
 #include "libOTe/NChooseOne/NcoOtExt.h"
 #endif
 
+#include <cstring>
 #include <numeric>
+#include <stdexcept>
 
 
 #ifndef __APPLE__
@@ -89,6 +96,10 @@ int PSIKkrtTask::_LoadParams(Task &task) {
             result_file_path_ = param_map["outputFullFilename"].value_string();
             host_address_ = param_map["serverAddress"].value_string();
             VLOG(5) << "serverAddress: " << host_address_;
+            it = param_map.find("psiThreadNum");
+            if (it != param_map.end()) {
+                thread_num_ = it->second.value_int32();
+            }
         } catch (std::exception &e) {
             LOG(ERROR) << "Failed to load params: " << e.what();
             return -1;
@@ -100,6 +111,10 @@ int PSIKkrtTask::_LoadParams(Task &task) {
             data_index_ = param_map["serverIndex"].value_int32();
             dataset_path_ = param_map["serverData"].value_string();
             host_address_ = param_map["clientAddress"].value_string();
+            auto it = param_map.find("psiThreadNum");
+            if (it != param_map.end()) {
+                thread_num_ = it->second.value_int32();
+            }
         } catch (std::exception &e) {
             LOG(ERROR) << "Failed to load params: " << e.what();
             return -1;
@@ -126,39 +141,19 @@ int PSIKkrtTask::_LoadDatasetFromSQLite(std::string& conn_str, int data_col,
         return -1;
     }
     auto table = std::get<std::shared_ptr<Table>>(ds->data);
-    int num_col = table->num_columns();
-    if (num_col < data_col) {
-        LOG(ERROR) << "psi dataset colunum number is smaller than data_col";
+    if (LoadColumnFromTable(table, data_col, &col_array) < 0) {
         return -1;
     }
-
-    auto array = std::static_pointer_cast<StringArray>(table->column(data_col)->chunk(0));
-    for (int64_t i = 0; i < array->length(); i++) {
-        col_array.push_back(array->GetString(i));
-    }
     VLOG(5) << "psi server loaded data records: " << col_array.size();
     return 0;
 }
 
 int PSIKkrtTask::_LoadDatasetFromCSV(std::string &filename, int data_col,
                                      std::vector <std::string> &col_array) {
-    std::string nodeaddr("test address"); // TODO
-    std::shared_ptr<DataDriver> driver =  DataDirverFactory::getDriver("CSV", nodeaddr);
-    std::shared_ptr<Cursor> &cursor = driver->read(filename);
-    std::shared_ptr<Dataset> ds = cursor->read();
-    std::shared_ptr<Table> table = std::get<std::shared_ptr<Table>>(ds->data);
-
-    int num_col = table->num_columns();
-    if (num_col < data_col) {
-        LOG(ERROR) << "psi dataset colunum number is smaller than data_col";
+    if (LoadColumnFromCSV(filename, data_col, &col_array) < 0) {
+        LOG(ERROR) << "Load psi dataset from csv file " << filename << " failed.";
         return -1;
     }
-
-    auto array = std::static_pointer_cast<StringArray>(
-        table->column(data_col)->chunk(0));
-    for (int64_t i = 0; i < array->length(); i++) {
-        col_array.push_back(array->GetString(i));
-    }
     return 0;
 }
 
@@ -186,122 +181,62 @@ int PSIKkrtTask::_LoadDataset(void) {
 }
 
 #ifndef __APPLE__
-void PSIKkrtTask::_kkrtRecv(Channel& chl) {
-    u8 dummy[1];
-    PRNG prng(_mm_set_epi32(4253465, 3434565, 234435, 23987045));
-
-    u64 sendSize;
-    //u64 recvSize = 10;
-    u64 recvSize = elements_.size();
-
-    std::vector<u64> data{recvSize};
-    chl.asyncSend(std::move(data));
-    std::vector<u64> dest;
-    chl.recv(dest);
-
-    //LOG(INFO) << "send size:" << dest[0];
-    sendSize = dest[0];
-    std::vector<block> sendSet(sendSize), recvSet(recvSize);
-
-    u8 block_size = sizeof(block);
-    RandomOracle  sha1(block_size);
-    u8 hash_dest[block_size];
-    for (u64 i = 0; i < recvSize; ++i) {
-        sha1.Update((u8 *)elements_[i].data(), elements_[i].size());
-        sha1.Final((u8 *)hash_dest);
-        recvSet[i] = toBlock(hash_dest);
-        sha1.Reset();
-    }
-    KkrtNcoOtReceiver otRecv;
-    KkrtPsiReceiver recvPSIs;
-    //LOG(INFO) << "client step 1";
-
-    //recvPSIs.setTimer(gTimer);
-    chl.recv(dummy, 1);
-    //LOG(INFO) << "client step 2";
-    //gTimer.reset();
-    chl.asyncSend(dummy, 1);
-    //LOG(INFO) << "client step 3";
-    //Timer timer;
-    //auto start = timer.setTimePoint("start");
-    recvPSIs.init(sendSize, recvSize, 40, chl, otRecv, prng.get<block>());
-    //LOG(INFO) << "client step 4";
-    //auto mid = timer.setTimePoint("init");
-    recvPSIs.sendInput(recvSet, chl);
-    //LOG(INFO) << "client step 5";
-    //auto end = timer.setTimePoint("done");
-
-    _GetIntsection(recvPSIs);
+void PSIKkrtTask::_HashElements(std::vector<block> *blocks) {
+    blocks->resize(elements_.size());
+    size_t num_shards = ShardNum(elements_.size(),
+        thread_num_ > 0 ? thread_num_ : 0, kMinShardSize);
+    ParallelForShards(elements_.size(), num_shards,
+        [&](size_t shard, size_t begin, size_t end) {
+            u8 block_size = sizeof(block);
+            RandomOracle sha1(block_size);
+            u8 hash_dest[sizeof(block)];
+            for (size_t i = begin; i < end; ++i) {
+                sha1.Update((u8 *)elements_[i].data(), elements_[i].size());
+                sha1.Final((u8 *)hash_dest);
+                (*blocks)[i] = toBlock(hash_dest);
+                sha1.Reset();
+            }
+        });
 }
 
-void PSIKkrtTask::_kkrtSend(Channel& chl) {
-    u8 dummy[1];
-    PRNG prng(_mm_set_epi32(4253465, 3434565, 234435, 23987045));
-
-    u64 sendSize = elements_.size();
-    u64 recvSize;
-
-    std::vector<u64> data{sendSize};
+size_t PSIKkrtTask::_ExchangeShardNum(Channel &chl, u64 *peer_size) {
+    // propose a shard number and use the smaller one of both parties
+    size_t proposal = ShardNum(elements_.size(),
+        thread_num_ > 0 ? thread_num_ : 0, kMinShardSize);
+    std::vector<u64> data{elements_.size(), proposal};
     chl.asyncSend(std::move(data));
     std::vector<u64> dest;
     chl.recv(dest);
-
-    //LOG(INFO) << "recv size:" << dest[0];
-    recvSize = dest[0];
-    std::vector<block> set(sendSize);
-    u8 block_size = sizeof(block);
-    RandomOracle  sha1(block_size);
-    u8 hash_dest[block_size];
-    //prng.get(set.data(), set.size());
-    for (u64 i = 0; i < sendSize; ++i) {
-        sha1.Update((u8 *)elements_[i].data(), elements_[i].size());
-        sha1.Final((u8 *)hash_dest);
-        set[i] = toBlock(hash_dest);
-        sha1.Reset();
+    if (dest.size() != 2) {
+        throw std::runtime_error("kkrt psi shard number exchange failed");
     }
+    *peer_size = dest[0];
+    size_t num_shards = std::max<size_t>(1, std::min<size_t>(proposal, dest[1]));
+    VLOG(5) << "kkrt psi local size: " << elements_.size()
+            << " peer size: " << dest[0] << " shards: " << num_shards;
+    return num_shards;
+}
 
-    KkrtNcoOtSender otSend;
-    KkrtPsiSender sendPSIs;
-    //LOG(INFO) << "server step 1";
-
-    sendPSIs.setTimer(gTimer);
-    chl.asyncSend(dummy, 1);
-    //LOG(INFO) << "server step 2";
-    chl.recv(dummy, 1);
-    //LOG(INFO) << "server step 3";
-    sendPSIs.init(sendSize, recvSize, 40, chl, otSend, prng.get<block>());
-    //LOG(INFO) << "server step 4";
-    sendPSIs.sendInput(set, chl);
-    //LOG(INFO) << "server step 5";
-
-    u64 dataSent = chl.getTotalDataSent();
-    //LOG(INFO) << "server step 6";
-
-    chl.resetStats();
-    //LOG(INFO) << "server step 7";
+void PSIKkrtTask::_kkrtRecv(Session &ep, Channel& chl) {
+    std::vector<block> recvSet;
+    _HashElements(&recvSet);
+    u64 peer_size = 0;
+    size_t num_shards = _ExchangeShardNum(chl, &peer_size);
+    auto intersection = KkrtShardedRecv(ep, chl, recvSet, peer_size, num_shards);
+    _GetIntsection(intersection);
 }
 
-int PSIKkrtTask::_GetIntsection(KkrtPsiReceiver &receiver) {
-    /*for (auto pos : receiver.mIntersection) {
-        LOG(INFO) << pos;
-    }*/
+void PSIKkrtTask::_kkrtSend(Session &ep, Channel& chl) {
+    std::vector<block> set;
+    _HashElements(&set);
+    u64 peer_size = 0;
+    size_t num_shards = _ExchangeShardNum(chl, &peer_size);
+    KkrtShardedSend(ep, chl, set, peer_size, num_shards);
+}
 
-    if (psi_type_ == PsiType::DIFFERENCE) {
-        map<u64, int> inter_map;
-        for (auto pos : receiver.mIntersection) {
-            inter_map[pos] = 1;
-        }
-        u64 num_elements = elements_.size();
-        for (u64 i = 0; i < num_elements; i++) {
-            if (inter_map.find(i) == inter_map.end()) {
-                result_.push_back(elements_[i]);
-            }
-        }
-    } else {
-        for (auto pos : receiver.mIntersection) {
-            result_.push_back(elements_[pos]);
-        }
-    }
+int PSIKkrtTask::_GetIntsection(const std::vector<u64> &intersection) {
+    SelectRows(&elements_, intersection,
+               psi_type_ == PsiType::DIFFERENCE, &result_);
     return 0;
 }
 #endif
@@ -311,66 +246,13 @@ int PSIKkrtTask::send_result_to_server() {
 #ifndef __APPLE__
     // cause grpc port is alive along with node life duration,
     // so send result data to server by grpc
-    grpc::ClientContext context;
     VLOG(5) << "send_result_to_server";
-    auto channel = grpc::InsecureChannelCredentials();
-    // std::unique_ptr<VMNode::Stub>
-    auto stub = primihub::rpc::VMNode::NewStub(grpc::CreateChannel(host_address_, channel));
-    primihub::rpc::TaskResponse task_response;
-    std::unique_ptr<grpc::ClientWriter<primihub::rpc::TaskRequest>>
-        writer(stub->Send(&context, &task_response));
-    constexpr size_t limited_size = 1 << 22;  // limit data size 4M
-    size_t sended_size = 0;
-    size_t sended_index = 0;
-    bool add_head_flag = false;
-    do {
-        primihub::rpc::TaskRequest task_request;
-        task_request.set_job_id(this->job_id_);
-        task_request.set_task_id(this->task_id_);
-        task_request.set_storage_type(primihub::rpc::TaskRequest::FILE);
-        task_request.set_storage_info(server_result_path);
-        if (!add_head_flag) {
-            task_request.add_data("\"intersection_row\"");
-            add_head_flag = true;
-        }
-        for (size_t i = sended_index; i < this->result_.size(); i++) {
-            auto& data_item = this->result_[i];
-            size_t item_len = data_item.size();
-            if (sended_size + item_len > limited_size) {
-                break;
-            }
-            task_request.add_data(data_item);
-            sended_size += item_len;
-            sended_index++;
-            VLOG(5) << "sended_size: " << sended_size << " sended_index: " << sended_index;
-        }
-        writer->Write(task_request);
-        VLOG(5) << "sended_size: " << sended_size << " "
-                << "sended_index: " << sended_index << " "
-                << "result size: " << this->result_.size();
-        if (sended_index >= this->result_.size()) {
-            VLOG(5) << " sended_index: " << sended_index
-                    << " result size: " << this->result_.size() << " end of send";
-            break;
-        }
-    } while(true);
-    writer->WritesDone();
-    grpc::Status status = writer->Finish();
-    VLOG(0) << "writer->Finish";
-    if (status.ok()) {
-        auto ret_code = task_response.ret_code();
-        if (ret_code) {
-            LOG(ERROR) << "client Node send result data to server return failed error code: " << ret_code;
-            return -1;
-        }
-    } else {
-        LOG(ERROR) << "client Node send result data to server failed. error_code: "
-                   << status.error_code() << ": " << status.error_message();
-        return -1;
-    }
-    VLOG(0) << "send result to server success";
-#endif
+    return SendResultToServer(host_address_, this->job_id_, this->task_id_,
+                              server_result_path, "\"intersection_row\"",
+                              this->result_);
+#else
     return 0;
+#endif
 }
 
 int PSIKkrtTask::saveResult(void) {
@@ -449,7 +331,7 @@ int PSIKkrtTask::execute() {
     if (mode == EpMode::Client) {
         LOG(INFO) << "start recv.";
         try {
-            _kkrtRecv(chl);
+            _kkrtRecv(ep, chl);
         } catch (std::exception &e) {
             LOG(ERROR) << "Kkrt psi client node task failed:"
 	               << e.what();
@@ -461,7 +343,7 @@ int PSIKkrtTask::execute() {
     } else {
         LOG(INFO) << "start send";
         try {
-            _kkrtSend(chl);
+            _kkrtSend(ep, chl);
         } catch (std::exception &e) {
             LOG(ERROR) << "Kkrt psi server node task failed:"
 		       << e.what();
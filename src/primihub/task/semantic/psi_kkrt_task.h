@@ -19,6 +19,7 @@
 
 #ifndef __APPLE__
 #include "cryptoTools/Network/Channel.h"
+#include "cryptoTools/Network/Session.h"
 #include "cryptoTools/Common/Defines.h"
 #include "libPSI/PSI/Kkrt/KkrtPsiReceiver.h"
 #endif
@@ -72,9 +73,12 @@ private:
     int _LoadDatasetFromSQLite(std::string& conn_str, int data_col,
                                std::vector<std::string>& col_array);
 #ifndef __APPLE__
-    void _kkrtRecv(Channel& chl);
-    void _kkrtSend(Channel& chl);
-    int _GetIntsection(KkrtPsiReceiver &receiver);
+    void _kkrtRecv(Session &ep, Channel& chl);
+    void _kkrtSend(Session &ep, Channel& chl);
+    void _HashElements(std::vector<block> *blocks);
+    // agree on the shard number, and learn the size of the peer set.
+    size_t _ExchangeShardNum(Channel &chl, u64 *peer_size);
+    int _GetIntsection(const std::vector<u64> &intersection);
 #endif
 
     const std::string node_id_;
@@ -87,6 +91,8 @@ private:
     std::string result_file_path_;
     std::vector <std::string> elements_;
     std::vector <std::string> result_;
+    // upper bound of hashing threads and psi shards, 0 means one per core
+    int thread_num_{0};
 
     std::string host_address_;
     bool sync_result_to_server{false};
@@ -14,9 +14,13 @@
  limitations under the License.
  */
 
+#include <algorithm>
+
 #include "private_set_intersection/cpp/psi_server.h"
 
 #include "src/primihub/task/semantic/psi_server_task.h"
+#include "src/primihub/task/semantic/psi_setup_cache.h"
+#include "src/primihub/util/parallel.h"
 
 using psi_proto::Request;
 using private_set_intersection::PsiServer;
@@ -43,12 +47,29 @@ PSIServerTask::PSIServerTask(const std::string &node_id,
     response_ = response->mutable_psi_response();
 }
 
+PSIServerTask::PSIServerTask(const std::string &node_id,
+                             const Params &params,
+                             std::shared_ptr<DatasetService> dataset_service)
+: ServerTaskBase(&params, dataset_service), fpr_(0.0001),
+  request_(nullptr), response_(nullptr) {}
+
 int PSIServerTask::loadParams(Params & params) {
     auto param_map = params.param_map();
 
     try {
         data_index_ = param_map["serverIndex"].value_int32();
         dataset_path_ = param_map["serverData"].value_string();
+        auto it = param_map.find("psiThreadNum");
+        if (it != param_map.end()) {
+            thread_num_ = it->second.value_int32();
+        }
+        it = param_map.find("psiUnbalanced");
+        if (it != param_map.end()) {
+            unbalanced_ = it->second.value_int32() > 0;
+        }
+        // the key epoch and the setup cache dir are node config, the
+        // client must not pick where the server key is stored or reused.
+        key_epoch_ = PsiSetupCache::getInstance().keyEpoch();
     } catch (std::exception &e) {
         LOG(ERROR) << "Failed to load psi server params: " << e.what();
         return -1;
@@ -80,50 +101,264 @@ int PSIServerTask::loadDataset() {
     return 0;
 }
 
+int PSIServerTask::processRequest(const std::unique_ptr<PsiServer> &server,
+        const psi_proto::Request &psi_request,
+        google::protobuf::RepeatedPtrField<std::string> *encrypted_elements) {
+    size_t num_client_elements = psi_request.encrypted_elements().size();
+    size_t num_shards = ShardNum(num_client_elements,
+        thread_num_ > 0 ? thread_num_ : 0, kMinShardSize);
+    encrypted_elements->Reserve(num_client_elements);
+    if (num_shards == 1) {
+        psi_proto::Response server_response =
+            std::move(server->ProcessRequest(psi_request)).value();
+        for (auto &item : *server_response.mutable_encrypted_elements()) {
+            encrypted_elements->Add(std::move(item));
+        }
+        return 0;
+    }
+
+    // Each shard is re-encrypted by a server instance sharing the same key,
+    // results are concatenated in request order.
+    VLOG(5) << "process psi request with " << num_shards << " shards";
+    std::string key_bytes = server->GetPrivateKeyBytes();
+    bool reveal_intersection = psi_request.reveal_intersection();
+    std::vector<psi_proto::Response> shard_responses(num_shards);
+    try {
+        ParallelForShards(num_client_elements, num_shards,
+            [&](size_t shard, size_t begin, size_t end) {
+                auto shard_server = std::move(
+                    PsiServer::CreateFromKey(key_bytes, reveal_intersection)).value();
+                psi_proto::Request shard_request;
+                shard_request.set_reveal_intersection(reveal_intersection);
+                for (size_t i = begin; i < end; i++) {
+                    shard_request.add_encrypted_elements(
+                        psi_request.encrypted_elements(i));
+                }
+                shard_responses[shard] =
+                    std::move(shard_server->ProcessRequest(shard_request)).value();
+            });
+    } catch (std::exception &e) {
+        LOG(ERROR) << "Process psi request failed: " << e.what();
+        return -1;
+    }
+    for (auto &shard_response : shard_responses) {
+        for (auto &item : *shard_response.mutable_encrypted_elements()) {
+            encrypted_elements->Add(std::move(item));
+        }
+    }
+    if (!reveal_intersection) {
+        // ProcessRequest sorts its output to hide the client order, keep
+        // that property for the merged result.
+        std::sort(encrypted_elements->begin(), encrypted_elements->end());
+    }
+    return 0;
+}
+
+void PSIServerTask::fillServerSetup(const psi_proto::ServerSetup &server_setup,
+                                    primihub::rpc::ServerSetup *ptr_server_setup) {
+    ptr_server_setup->set_bits(server_setup.bits());
+    if (server_setup.data_structure_case() ==
+        psi_proto::ServerSetup::DataStructureCase::kGcs) {
+        ptr_server_setup->mutable_gcs()->set_div(server_setup.gcs().div());
+        ptr_server_setup->mutable_gcs()->set_hash_range(server_setup.gcs().hash_range());
+    } else if (server_setup.data_structure_case() ==
+               psi_proto::ServerSetup::DataStructureCase::kBloomFilter) {
+        ptr_server_setup->mutable_bloom_filter()->
+            set_num_hash_functions(server_setup.bloom_filter().num_hash_functions());
+    }
+}
+
+int PSIServerTask::prepareServer(bool reveal_intersection,
+                                 int64_t num_client_elements,
+                                 std::unique_ptr<PsiServer> *server,
+                                 psi_proto::ServerSetup *server_setup) {
+    if (!unbalanced_) {
+        if (loadDataset()) {
+            return -1;
+        }
+        *server = std::move(PsiServer::CreateWithNewKey(reveal_intersection)).value();
+        *server_setup = std::move((*server)->CreateSetupMessage(fpr_,
+            num_client_elements, elements_)).value();
+        return 0;
+    }
+
+    // Unbalanced mode, the encrypted server set is precomputed for a bound
+    // of client elements and reused with its key, so a request only costs
+    // work proportional to the client set.
+    PsiSetupKey key{dataset_path_, data_index_, key_epoch_,
+                    PsiSetupCache::clientBound(num_client_elements),
+                    reveal_intersection};
+    auto &setup_cache = PsiSetupCache::getInstance();
+    auto entry = setup_cache.get(key);
+    if (entry != nullptr) {
+        VLOG(5) << "reuse psi server setup of " << dataset_path_
+                << " epoch " << key_epoch_;
+        *server = std::move(PsiServer::CreateFromKey(entry->key_bytes,
+                                                     reveal_intersection)).value();
+        *server_setup = entry->server_setup;
+        return 0;
+    }
+
+    entry = std::make_shared<PsiSetupEntry>();
+    bool cacheable = PsiSetupCache::datasetSignature(dataset_path_,
+        &entry->dataset_size, &entry->dataset_mtime) == 0;
+    if (loadDataset()) {
+        return -1;
+    }
+    *server = std::move(PsiServer::CreateWithNewKey(reveal_intersection)).value();
+    *server_setup = std::move((*server)->CreateSetupMessage(fpr_,
+        key.client_bound, elements_)).value();
+    if (cacheable) {
+        entry->key_bytes = (*server)->GetPrivateKeyBytes();
+        entry->server_setup = *server_setup;
+        setup_cache.put(key, entry);
+    } else {
+        LOG(WARNING) << "Dataset " << dataset_path_
+                     << " is not a file, psi server setup is not persisted.";
+    }
+    return 0;
+}
+
 int PSIServerTask::execute() {
     int ret = loadParams(params_);
     if (ret) {
         LOG(ERROR) << "Load parameters for psi server fialed.";
         return -1;
     }
-    ret = loadDataset();
-    if (ret) {
-        return -1;
-    }
     Request psi_request;
     initRequest(request_, psi_request);
 
-    std::unique_ptr<PsiServer> server =
-        std::move(PsiServer::CreateWithNewKey(psi_request.reveal_intersection())).value();
-
     std::int64_t num_client_elements =
         static_cast<std::int64_t>(psi_request.encrypted_elements().size());
-    psi_proto::ServerSetup server_setup =
-        std::move(server->CreateSetupMessage(fpr_, num_client_elements, elements_)).value();
+    std::unique_ptr<PsiServer> server;
+    psi_proto::ServerSetup server_setup;
+    ret = prepareServer(psi_request.reveal_intersection(), num_client_elements,
+                        &server, &server_setup);
+    if (ret) {
+        return -1;
+    }
+
+    ret = processRequest(server, psi_request,
+                         response_->mutable_encrypted_elements());
+    if (ret) {
+        LOG(ERROR) << "Psi server process request failed.";
+        return -1;
+    }
 
-    psi_proto::Response server_response = std::move(server->ProcessRequest(psi_request)).value();
+    fillServerSetup(server_setup, response_->mutable_server_setup());
+    return 0;
 
-    std::int64_t num_response_elements =
-        static_cast<std::int64_t>(server_response.encrypted_elements().size());
+}
 
-    for (std::int64_t i = 0; i < num_response_elements; i++) {
-        response_->add_encrypted_elements(server_response.encrypted_elements()[i]);
+int PSIServerTask::executeStream(PsiStream *stream,
+                                 PsiStreamRequest &first_request) {
+    PsiStreamResponse response;
+    int ret = loadParams(params_);
+    if (ret) {
+        LOG(ERROR) << "Load parameters for psi server fialed.";
+        response.set_ret_code(2);
+        stream->Write(response);
+        return -1;
     }
 
-    auto ptr_server_setup = response_->mutable_server_setup();
-    ptr_server_setup->set_bits(server_setup.bits());
-    if (server_setup.data_structure_case() ==
-        psi_proto::ServerSetup::DataStructureCase::kGcs) {
-        ptr_server_setup->mutable_gcs()->set_div(server_setup.gcs().div());
-        ptr_server_setup->mutable_gcs()->set_hash_range(server_setup.gcs().hash_range());
-    } else if (server_setup.data_structure_case() ==
-               psi_proto::ServerSetup::DataStructureCase::kBloomFilter) {
-        ptr_server_setup->mutable_bloom_filter()->
-            set_num_hash_functions(server_setup.bloom_filter().num_hash_functions());
+    // The setup is sized by the total number of client elements, so it is
+    // sent before any batch is answered and the client can start early.
+    bool reveal_intersection = first_request.reveal_intersection();
+    std::unique_ptr<PsiServer> server;
+    psi_proto::ServerSetup server_setup;
+    ret = prepareServer(reveal_intersection, first_request.num_client_elements(),
+                        &server, &server_setup);
+    if (ret) {
+        response.set_ret_code(2);
+        stream->Write(response);
+        return -1;
+    }
+    response.set_ret_code(0);
+    fillServerSetup(server_setup, response.mutable_server_setup());
+    if (!stream->Write(response)) {
+        LOG(ERROR) << "Psi server write setup to stream failed.";
+        return -1;
     }
 
+    PsiStreamRequest request = std::move(first_request);
+    if (!reveal_intersection) {
+        return answerStreamSorted(server, stream, &request);
+    }
+    int64_t num_processed = 0;
+    do {
+        psi_proto::Request psi_request;
+        psi_request.set_reveal_intersection(reveal_intersection);
+        psi_request.mutable_encrypted_elements()->Swap(
+            request.mutable_encrypted_elements());
+
+        PsiStreamResponse batch_response;
+        ret = processRequest(server, psi_request,
+                             batch_response.mutable_encrypted_elements());
+        if (ret) {
+            LOG(ERROR) << "Psi server process request batch failed.";
+            batch_response.Clear();
+            batch_response.set_ret_code(2);
+            stream->Write(batch_response);
+            return -1;
+        }
+        num_processed += psi_request.encrypted_elements_size();
+        batch_response.set_ret_code(0);
+        if (!stream->Write(batch_response)) {
+            LOG(ERROR) << "Psi server write batch to stream failed.";
+            return -1;
+        }
+    } while (stream->Read(&request));
+
+    VLOG(5) << "psi server processed " << num_processed
+            << " client elements in stream.";
     return 0;
+}
 
+int PSIServerTask::answerStreamSorted(const std::unique_ptr<PsiServer> &server,
+                                      PsiStream *stream,
+                                      PsiStreamRequest *request) {
+    // Sorting hides the client order only over the whole answer, a sorted
+    // answer per batch would tell the client which batch each match is in.
+    // So the batches are gathered and answered once, sorted as a whole.
+    psi_proto::Request psi_request;
+    psi_request.set_reveal_intersection(false);
+    auto *all_elements = psi_request.mutable_encrypted_elements();
+    do {
+        for (auto &item : *request->mutable_encrypted_elements()) {
+            all_elements->Add(std::move(item));
+        }
+    } while (stream->Read(request));
+
+    google::protobuf::RepeatedPtrField<std::string> answer;
+    if (processRequest(server, psi_request, &answer)) {
+        LOG(ERROR) << "Psi server process request failed.";
+        PsiStreamResponse error_response;
+        error_response.set_ret_code(2);
+        stream->Write(error_response);
+        return -1;
+    }
+    psi_request.Clear();
+
+    // the sorted answer is only split to fit the message size.
+    int64_t num_answer = answer.size();
+    for (int64_t begin = 0; begin < num_answer;
+         begin += kPsiStreamResponseBatchSize) {
+        int64_t end = std::min(begin + kPsiStreamResponseBatchSize, num_answer);
+        PsiStreamResponse batch_response;
+        batch_response.set_ret_code(0);
+        auto *batch_elements = batch_response.mutable_encrypted_elements();
+        batch_elements->Reserve(end - begin);
+        for (int64_t i = begin; i < end; i++) {
+            batch_elements->Add(std::move(answer[i]));
+        }
+        if (!stream->Write(batch_response)) {
+            LOG(ERROR) << "Psi server write answer to stream failed.";
+            return -1;
+        }
+    }
+    VLOG(5) << "psi server answered " << num_answer
+            << " client elements in stream, sorted as a whole.";
+    return 0;
 }
 
 } //namespace primihub::task
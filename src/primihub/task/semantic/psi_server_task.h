@@ -21,6 +21,8 @@
 #include <memory>
 #include <string>
 
+#include "private_set_intersection/cpp/psi_server.h"
+
 #include "src/primihub/protos/common.grpc.pb.h"
 #include "src/primihub/protos/psi.grpc.pb.h"
 #include "src/primihub/protos/worker.grpc.pb.h"
@@ -31,26 +33,60 @@ using primihub::rpc::PsiRequest;
 using primihub::rpc::PsiResponse;
 using primihub::rpc::ExecuteTaskRequest;
 using primihub::rpc::ExecuteTaskResponse;
+using primihub::rpc::PsiStreamRequest;
+using primihub::rpc::PsiStreamResponse;
 
 namespace primihub::task {
 
+using PsiStream = grpc::ServerReaderWriter<PsiStreamResponse, PsiStreamRequest>;
+
+// number of answered elements carried by one sorted PsiStreamResponse
+constexpr int64_t kPsiStreamResponseBatchSize = 1 << 16;
+
 class PSIServerTask : public ServerTaskBase {
 public:
     explicit PSIServerTask(const std::string &node_id,
                            const ExecuteTaskRequest& request,
                            ExecuteTaskResponse *response,
                            std::shared_ptr<DatasetService> dataset_service);
+    // for the streaming exchange, request and response go through the stream
+    explicit PSIServerTask(const std::string &node_id,
+                           const Params &params,
+                           std::shared_ptr<DatasetService> dataset_service);
     ~PSIServerTask(){}
 
     int loadParams(Params & params) override;
     int loadDataset(void) override;
     int execute() override;
+    // answer the setup and then every batch of first_request and the
+    // following requests read from stream, one response per batch. When the
+    // intersection is not revealed, the whole set is answered at once.
+    int executeStream(PsiStream *stream, PsiStreamRequest &first_request);
 
 private:
+    int processRequest(const std::unique_ptr<private_set_intersection::PsiServer> &server,
+                       const psi_proto::Request &psi_request,
+                       google::protobuf::RepeatedPtrField<std::string> *encrypted_elements);
+    // create the server and its setup, from the precomputed setup of the
+    // dataset when unbalanced mode is on.
+    int prepareServer(bool reveal_intersection, int64_t num_client_elements,
+                      std::unique_ptr<private_set_intersection::PsiServer> *server,
+                      psi_proto::ServerSetup *server_setup);
+    // gather all batches of the stream and answer them sorted as a whole.
+    int answerStreamSorted(const std::unique_ptr<private_set_intersection::PsiServer> &server,
+                           PsiStream *stream, PsiStreamRequest *request);
+    void fillServerSetup(const psi_proto::ServerSetup &server_setup,
+                         primihub::rpc::ServerSetup *ptr_server_setup);
+
     const double fpr_;
     int data_index_;
     std::string dataset_path_;
     std::vector <std::string> elements_;
+    // 0 means one worker per core
+    int thread_num_{0};
+    // reuse a persisted server setup, keyed by dataset and key epoch
+    bool unbalanced_{false};
+    int64_t key_epoch_{0};
     const PsiRequest * request_;
     PsiResponse * response_;
 };
@@ -0,0 +1,246 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "src/primihub/task/semantic/psi_setup_cache.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <glog/logging.h>
+
+#include "src/primihub/util/file_util.h"
+
+namespace primihub::task {
+
+namespace {
+// smallest client bound, tiny clients all share one setup.
+constexpr int64_t kMinClientBound = 1 << 14;
+const char kSetupFileMagic[] = "PHPSISU2";
+
+void appendInt64(std::string* out, int64_t value) {
+    out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string* out, const std::string& str) {
+    uint64_t len = str.size();
+    out->append(reinterpret_cast<const char*>(&len), sizeof(len));
+    out->append(str);
+}
+
+// the length is checked against the bytes left in the file before the
+// string is resized, a corrupt length can't allocate more than the file.
+bool readString(std::ifstream& in, int64_t file_size, std::string* str) {
+    uint64_t len = 0;
+    if (!in.read(reinterpret_cast<char*>(&len), sizeof(len))) {
+        return false;
+    }
+    int64_t pos = in.tellg();
+    if (pos < 0 || len > static_cast<uint64_t>(file_size - pos)) {
+        return false;
+    }
+    str->resize(len);
+    return static_cast<bool>(in.read(&(*str)[0], len));
+}
+}  // namespace
+
+int PsiSetupCache::datasetSignature(const std::string& dataset,
+                                    int64_t* size, int64_t* mtime) {
+    struct stat file_stat;
+    if (stat(dataset.c_str(), &file_stat) != 0) {
+        return -1;
+    }
+    *size = file_stat.st_size;
+    *mtime = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 +
+             file_stat.st_mtim.tv_nsec;
+    return 0;
+}
+
+std::string PsiSetupKey::toString() const {
+    return dataset + "|" + std::to_string(data_index) + "|" +
+           std::to_string(key_epoch) + "|" + std::to_string(client_bound) +
+           "|" + (reveal_intersection ? "1" : "0");
+}
+
+int64_t PsiSetupCache::clientBound(int64_t num_client_elements) {
+    int64_t bound = kMinClientBound;
+    while (bound < num_client_elements) {
+        bound <<= 1;
+    }
+    return bound;
+}
+
+void PsiSetupCache::configure(const std::string& cache_dir,
+                              int64_t key_epoch, size_t max_entries) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    cache_dir_ = cache_dir;
+    key_epoch_ = key_epoch;
+    max_entries_ = std::max<size_t>(max_entries, 1);
+    entries_.clear();
+    lru_.clear();
+}
+
+int64_t PsiSetupCache::keyEpoch() {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return key_epoch_;
+}
+
+std::string PsiSetupCache::entryPath(const PsiSetupKey& key) {
+    size_t digest = std::hash<std::string>{}(key.toString());
+    return cache_dir_ + "/" + std::to_string(digest) + ".setup";
+}
+
+std::shared_ptr<PsiSetupEntry> PsiSetupCache::get(const PsiSetupKey& key) {
+    int64_t size = 0;
+    int64_t mtime = 0;
+    if (datasetSignature(key.dataset, &size, &mtime) != 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lck(mtx_);
+    std::shared_ptr<PsiSetupEntry> entry;
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        entry = it->second;
+    } else {
+        entry = loadFromFile(key);
+    }
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    if (entry->dataset_size != size || entry->dataset_mtime != mtime) {
+        LOG(INFO) << "Dataset " << key.dataset
+                  << " changed, drop precomputed psi server setup.";
+        erase(key);
+        std::remove(entryPath(key).c_str());
+        return nullptr;
+    }
+    entries_[key] = entry;
+    touch(key);
+    return entry;
+}
+
+int PsiSetupCache::put(const PsiSetupKey& key,
+                       std::shared_ptr<PsiSetupEntry> entry) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lck(mtx_);
+        entries_[key] = entry;
+        touch(key);
+        path = entryPath(key);
+    }
+    // written without the lock, lookups of other setups don't wait for it.
+    return saveToFile(path, key, *entry);
+}
+
+void PsiSetupCache::touch(const PsiSetupKey& key) {
+    lru_.remove_if([&key](const PsiSetupKey& k) {
+        return !(k < key) && !(key < k);
+    });
+    lru_.push_front(key);
+    while (entries_.size() > max_entries_) {
+        auto& oldest = lru_.back();
+        VLOG(5) << "evict psi server setup of " << oldest.dataset
+                << " from memory";
+        entries_.erase(oldest);
+        lru_.pop_back();
+    }
+}
+
+void PsiSetupCache::erase(const PsiSetupKey& key) {
+    entries_.erase(key);
+    lru_.remove_if([&key](const PsiSetupKey& k) {
+        return !(k < key) && !(key < k);
+    });
+}
+
+std::shared_ptr<PsiSetupEntry> PsiSetupCache::loadFromFile(
+        const PsiSetupKey& key) {
+    std::ifstream in(entryPath(key), std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return nullptr;
+    }
+    int64_t file_size = in.tellg();
+    if (file_size < 0 || !in.seekg(0)) {
+        return nullptr;
+    }
+    std::string magic(sizeof(kSetupFileMagic) - 1, '\0');
+    std::string key_str;
+    std::string setup_str;
+    auto entry = std::make_shared<PsiSetupEntry>();
+    if (!in.read(&magic[0], magic.size()) || magic != kSetupFileMagic ||
+        !readString(in, file_size, &key_str) || key_str != key.toString() ||
+        !in.read(reinterpret_cast<char*>(&entry->dataset_size),
+                 sizeof(entry->dataset_size)) ||
+        !in.read(reinterpret_cast<char*>(&entry->dataset_mtime),
+                 sizeof(entry->dataset_mtime)) ||
+        !readString(in, file_size, &entry->key_bytes) ||
+        !readString(in, file_size, &setup_str) ||
+        !entry->server_setup.ParseFromString(setup_str)) {
+        LOG(WARNING) << "Ignore invalid psi setup file " << entryPath(key);
+        return nullptr;
+    }
+    VLOG(5) << "load psi server setup of " << key.dataset << " from file";
+    return entry;
+}
+
+int PsiSetupCache::saveToFile(const std::string& path,
+                              const PsiSetupKey& key,
+                              const PsiSetupEntry& entry) {
+    if (ValidateDir(path)) {
+        LOG(ERROR) << "Can't create directory for psi setup file " << path;
+        return -1;
+    }
+    std::string content(kSetupFileMagic, sizeof(kSetupFileMagic) - 1);
+    appendString(&content, key.toString());
+    appendInt64(&content, entry.dataset_size);
+    appendInt64(&content, entry.dataset_mtime);
+    appendString(&content, entry.key_bytes);
+    appendString(&content, entry.server_setup.SerializeAsString());
+
+    // the file holds the private key of the server, mkstemp creates it
+    // 0600 under a name nobody can guess or create first. It is renamed
+    // into place so that a reader never sees a partial setup.
+    std::string tmp_path = path + ".XXXXXX";
+    int fd = mkstemp(&tmp_path[0]);
+    if (fd < 0) {
+        LOG(ERROR) << "Create psi setup file for " << path << " failed.";
+        return -1;
+    }
+    FILE* out = fdopen(fd, "wb");
+    if (out == nullptr) {
+        close(fd);
+        std::remove(tmp_path.c_str());
+        LOG(ERROR) << "Open psi setup file " << tmp_path << " failed.";
+        return -1;
+    }
+    bool ok = fwrite(content.data(), 1, content.size(), out) == content.size();
+    if (fclose(out) != 0 || !ok) {
+        std::remove(tmp_path.c_str());
+        LOG(ERROR) << "Write psi setup file " << tmp_path << " failed.";
+        return -1;
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        LOG(ERROR) << "Rename psi setup file to " << path << " failed.";
+        return -1;
+    }
+    return 0;
+}
+
+} // namespace primihub::task
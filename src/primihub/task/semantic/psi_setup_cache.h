@@ -0,0 +1,109 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef SRC_PRIMIHUB_TASK_SEMANTIC_PSI_SETUP_CACHE_H_
+#define SRC_PRIMIHUB_TASK_SEMANTIC_PSI_SETUP_CACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "private_set_intersection/cpp/psi_server.h"
+
+namespace primihub::task {
+
+// Everything which changes the server setup of unbalanced psi. The setup
+// is built for up to client_bound client elements, so one setup serves
+// every client which is not larger than that.
+struct PsiSetupKey {
+    std::string dataset;
+    int data_index;
+    int64_t key_epoch;
+    int64_t client_bound;
+    bool reveal_intersection;
+
+    std::string toString() const;
+    bool operator<(const PsiSetupKey& other) const {
+        return toString() < other.toString();
+    }
+};
+
+struct PsiSetupEntry {
+    // size and modify time of the dataset when the setup was built,
+    // a mismatch means the dataset changed and the entry is stale.
+    int64_t dataset_size{0};
+    int64_t dataset_mtime{0};
+    // private key of the server, the setup is only valid with this key.
+    std::string key_bytes;
+    psi_proto::ServerSetup server_setup;
+};
+
+// Node level store of precomputed ECDH psi server setups. Entries are kept
+// in memory and persisted under cache_dir, so the encrypted server set and
+// its filter survive node restarts and are only rebuilt when the dataset
+// changes or the key epoch is bumped. At most max_entries setups are kept in
+// memory, least recently used first out, evicted ones are reloaded from file.
+// Cache dir and key epoch belong to the node, they are set once at startup
+// and never taken from task params.
+class PsiSetupCache {
+public:
+    static constexpr size_t kDefaultMaxEntries = 16;
+
+    PsiSetupCache(const PsiSetupCache&) = delete;
+    PsiSetupCache& operator=(const PsiSetupCache&) = delete;
+
+    static PsiSetupCache& getInstance() {
+        static PsiSetupCache kSingleInstance;
+        return kSingleInstance;
+    }
+
+    void configure(const std::string& cache_dir, int64_t key_epoch,
+                   size_t max_entries);
+    int64_t keyEpoch();
+    // return nullptr if not cached or the dataset changed since it was built.
+    std::shared_ptr<PsiSetupEntry> get(const PsiSetupKey& key);
+    // entry must carry the dataset signature taken before it was built.
+    int put(const PsiSetupKey& key, std::shared_ptr<PsiSetupEntry> entry);
+
+    // fill size and modify time in nanoseconds of dataset, return -1 if it
+    // can not be accessed.
+    static int datasetSignature(const std::string& dataset,
+                                int64_t* size, int64_t* mtime);
+    // round num_client_elements up so that similar clients share a setup.
+    static int64_t clientBound(int64_t num_client_elements);
+
+private:
+    PsiSetupCache() = default;
+    std::string entryPath(const PsiSetupKey& key);
+    std::shared_ptr<PsiSetupEntry> loadFromFile(const PsiSetupKey& key);
+    static int saveToFile(const std::string& path, const PsiSetupKey& key,
+                          const PsiSetupEntry& entry);
+    void touch(const PsiSetupKey& key);
+    void erase(const PsiSetupKey& key);
+
+    std::mutex mtx_;
+    std::string cache_dir_{"/tmp/primihub/psi_setup"};
+    int64_t key_epoch_{0};
+    size_t max_entries_{kDefaultMaxEntries};
+    std::map<PsiSetupKey, std::shared_ptr<PsiSetupEntry>> entries_;
+    std::list<PsiSetupKey> lru_;
+};
+
+} // namespace primihub::task
+
+#endif // SRC_PRIMIHUB_TASK_SEMANTIC_PSI_SETUP_CACHE_H_
@@ -0,0 +1,177 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "src/primihub/task/semantic/result_sync.h"
+
+#include <cstdio>
+#include <glog/logging.h>
+#include <grpcpp/channel.h>
+#include <grpcpp/create_channel.h>
+
+#include "src/primihub/util/file_util.h"
+
+namespace primihub::task {
+
+void RowChecksum::update(const std::string &row) {
+    constexpr uint64_t kPrime = 1099511628211ULL;
+    for (unsigned char c : row) {
+        hash_ = (hash_ ^ c) * kPrime;
+    }
+    hash_ = (hash_ ^ static_cast<unsigned char>('\n')) * kPrime;
+}
+
+int SendResultToServer(const std::string &server_address,
+                       const std::string &job_id,
+                       const std::string &task_id,
+                       const std::string &storage_path,
+                       const std::string &header,
+                       const std::vector<std::string> &rows) {
+    grpc::ClientContext context;
+    auto channel = grpc::InsecureChannelCredentials();
+    auto stub = primihub::rpc::VMNode::NewStub(
+        grpc::CreateChannel(server_address, channel));
+    primihub::rpc::TaskResponse task_response;
+    std::unique_ptr<grpc::ClientWriter<primihub::rpc::TaskRequest>>
+        writer(stub->Send(&context, &task_response));
+
+    auto new_request = [&]() {
+        primihub::rpc::TaskRequest task_request;
+        task_request.set_job_id(job_id);
+        task_request.set_task_id(task_id);
+        task_request.set_storage_type(primihub::rpc::TaskRequest::FILE);
+        task_request.set_storage_info(storage_path);
+        return task_request;
+    };
+
+    // Write blocks while the flow control window of the stream is full,
+    // and the server drains a chunk to disk before reading the next one,
+    // so at most a few chunks are in flight.
+    RowChecksum checksum;
+    int64_t num_rows = 0;
+    size_t sended_index = 0;
+    bool write_ok = true;
+    primihub::rpc::TaskRequest task_request = new_request();
+    size_t chunk_size = 0;
+    if (!header.empty()) {
+        task_request.add_data(header);
+        checksum.update(header);
+        chunk_size += header.size();
+        num_rows++;
+    }
+    while (sended_index < rows.size()) {
+        const auto &data_item = rows[sended_index];
+        if (chunk_size > 0 && chunk_size + data_item.size() > kResultChunkSize) {
+            if (!writer->Write(task_request)) {
+                write_ok = false;
+                break;
+            }
+            task_request = new_request();
+            chunk_size = 0;
+        }
+        task_request.add_data(data_item);
+        checksum.update(data_item);
+        chunk_size += data_item.size();
+        num_rows++;
+        sended_index++;
+    }
+    if (write_ok) {
+        task_request.set_finished(true);
+        task_request.set_num_rows(num_rows);
+        task_request.set_checksum(checksum.value());
+        write_ok = writer->Write(task_request);
+    }
+    VLOG(5) << "sended_index: " << sended_index << " "
+            << "result size: " << rows.size();
+    writer->WritesDone();
+    grpc::Status status = writer->Finish();
+    if (!status.ok()) {
+        LOG(ERROR) << "Send result data to server failed. error_code: "
+                   << status.error_code() << ": " << status.error_message();
+        return -1;
+    }
+    auto ret_code = task_response.ret_code();
+    if (ret_code || !write_ok) {
+        LOG(ERROR) << "Send result data to server return failed error code: "
+                   << ret_code;
+        return -1;
+    }
+    VLOG(5) << "send result to server success";
+    return 0;
+}
+
+ResultFileWriter::~ResultFileWriter() {
+    if (out_.is_open()) {
+        abort();
+    }
+}
+
+int ResultFileWriter::open(const std::string &path) {
+    if (ValidateDir(path)) {
+        LOG(ERROR) << "file path is not exist, please check";
+        return -1;
+    }
+    path_ = path;
+    tmp_path_ = path + ".tmp";
+    out_.open(tmp_path_, std::ios::out | std::ios::trunc);
+    if (!out_.is_open()) {
+        LOG(ERROR) << "Open " << tmp_path_ << " for result failed.";
+        return -1;
+    }
+    return 0;
+}
+
+int ResultFileWriter::append(const primihub::rpc::TaskRequest &request) {
+    for (const auto &data_item : request.data()) {
+        out_ << data_item << "\n";
+        checksum_.update(data_item);
+        num_rows_++;
+    }
+    if (!out_.good()) {
+        LOG(ERROR) << "Write result to " << tmp_path_ << " failed.";
+        return -1;
+    }
+    return 0;
+}
+
+int ResultFileWriter::finish(bool finished, int64_t num_rows, uint64_t checksum) {
+    out_.close();
+    // a sender which goes away ends the stream like a normal close, only
+    // the trailer tells a complete result from a truncated one.
+    if (!finished) {
+        LOG(ERROR) << "Result of " << path_ << " ended without the last "
+                   << "message, received " << num_rows_ << " rows.";
+        std::remove(tmp_path_.c_str());
+        return -1;
+    }
+    if (num_rows != num_rows_ || checksum != checksum_.value()) {
+        LOG(ERROR) << "Result of " << path_ << " is incomplete, expect "
+                   << num_rows << " rows, received " << num_rows_ << " rows.";
+        std::remove(tmp_path_.c_str());
+        return -1;
+    }
+    if (std::rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+        LOG(ERROR) << "Rename result file to " << path_ << " failed.";
+        return -1;
+    }
+    return 0;
+}
+
+void ResultFileWriter::abort() {
+    out_.close();
+    std::remove(tmp_path_.c_str());
+}
+
+} // namespace primihub::task
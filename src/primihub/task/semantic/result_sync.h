@@ -0,0 +1,74 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef SRC_PRIMIHUB_TASK_SEMANTIC_RESULT_SYNC_H_
+#define SRC_PRIMIHUB_TASK_SEMANTIC_RESULT_SYNC_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "src/primihub/protos/worker.grpc.pb.h"
+
+namespace primihub::task {
+
+// max bytes of rows carried by one TaskRequest of VMNode.Send
+constexpr size_t kResultChunkSize = 1 << 22;
+
+// FNV-1a over every row followed by '\n', i.e. over the saved file body.
+class RowChecksum {
+public:
+    void update(const std::string &row);
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_{14695981039346656037ULL};
+};
+
+// Stream header and rows to VMNode.Send of server_address in chunks of
+// at most kResultChunkSize bytes. The last message carries the row count
+// and checksum, the server verifies them before the file is published.
+int SendResultToServer(const std::string &server_address,
+                       const std::string &job_id,
+                       const std::string &task_id,
+                       const std::string &storage_path,
+                       const std::string &header,
+                       const std::vector<std::string> &rows);
+
+// Receiver side of SendResultToServer, rows are appended to a temporary
+// file as chunks arrive and the file is renamed to path once complete.
+class ResultFileWriter {
+public:
+    ~ResultFileWriter();
+    int open(const std::string &path);
+    int append(const primihub::rpc::TaskRequest &request);
+    // verify against the trailer of the sender, fails and removes the
+    // temporary file when the stream ended before the trailer arrived.
+    int finish(bool finished, int64_t num_rows, uint64_t checksum);
+
+private:
+    void abort();
+
+    std::string path_;
+    std::string tmp_path_;
+    std::ofstream out_;
+    int64_t num_rows_{0};
+    RowChecksum checksum_;
+};
+
+} // namespace primihub::task
+
+#endif // SRC_PRIMIHUB_TASK_SEMANTIC_RESULT_SYNC_H_
@@ -149,6 +149,37 @@ void Channel::asyncCancel(std::function<void()> completionHandle, bool close) {
   else completionHandle();
 }
 
+void Channel::setCoalescing(bool on) {
+  if (mBase) mBase->setCoalescing(on);
+}
+
+void Channel::flushSends() {
+  if (mBase == nullptr)
+    return;
+  mBase->flushSends();
+
+  std::vector<std::weak_ptr<ChannelBase>> group;
+  {
+    std::lock_guard<std::mutex> lck(mBase->mHeldMtx);
+    group = mBase->mFlushWith;
+  }
+  for (auto& weak : group) {
+    auto base = weak.lock();
+    if (base && base != mBase)
+      base->flushSends();
+  }
+}
+
+void Channel::flushWith(const std::vector<Channel>& group) {
+  if (mBase == nullptr)
+    return;
+  std::lock_guard<std::mutex> lck(mBase->mHeldMtx);
+  mBase->mFlushWith.clear();
+  for (auto& chl : group)
+    if (chl.mBase && chl.mBase != mBase)
+      mBase->mFlushWith.push_back(chl.mBase);
+}
+
 std::string primihub::Channel::commonName() {
   if (mBase)
     return mBase->commonName();
@@ -191,11 +222,41 @@ u64 Channel::getTotalDataRecv() const {
 
 void FixedSendBuff::asyncPerform(ChannelBase * base,
   io_completion_handle&& completionHandle) {
+  if (mBatchWritten) {
+    // the batch counted the bytes.
+    completionHandle(primihub::chl_make_error_code(Errc_Status::success), 0);
+    return;
+  }
+
   base->mSendBuffers = getSendBuffer();
   base->mHandle->async_send(base->mSendBuffers,
     std::forward<io_completion_handle>(completionHandle));
 }
 
+error_code FixedRecvBuff::fitBuffer() {
+  // check that the buffer has enough space. Resize if not.
+  if (getHeaderSize() != getBufferSize()) {
+    resizeBuffer(getHeaderSize());
+
+    // check that the resize was successful.
+    if (getHeaderSize() != getBufferSize()) {
+      std::stringstream ss;
+      ss << "Bad receive buffer size.\n"
+          <<         "  Size transmitted: " << getHeaderSize()
+          << " bytes\n  Size of buffer:   " << getBufferSize() << " bytes\n";
+
+      // give the user a chance to give us another location 
+      // by passing out an exception which they can call.
+      mPromise.set_exception(std::make_exception_ptr(
+          BadReceiveBufferSize(ss.str(), getHeaderSize())));
+
+      return boost::system::errc::make_error_code
+        (boost::system::errc::no_buffer_space);
+    }
+  }
+  return {};
+}
+
 void FixedRecvBuff::asyncPerform(ChannelBase * base,
   io_completion_handle&& completionHandle) {
   mComHandle = std::move(completionHandle);
@@ -204,37 +265,26 @@ void FixedRecvBuff::asyncPerform(ChannelBase * base,
   if (!mComHandle)
     throw std::runtime_error(LOCATION);
 
+  // the frame was already received with an earlier batch.
+  if (base->mRecvFrameSizes.size()) {
+    recvFrame(0);
+    return;
+  }
+
   // first we have to receive the header which tells us how much.
   base->mRecvBuffer = getRecvHeaderBuffer();
   base->mHandle->async_recv({&base->mRecvBuffer, 1},
     [this](const error_code& ec, u64 bt1) {
     if (!ec) {
-      // check that the buffer has enough space. Resize if not.
-      if (getHeaderSize() != getBufferSize()) {
-        resizeBuffer(getHeaderSize());
-
-        // check that the resize was successful.
-        if (getHeaderSize() != getBufferSize()) {
-          std::stringstream ss;
-          ss << "Bad receive buffer size.\n"
-              <<         "  Size transmitted: " << getHeaderSize()
-              << " bytes\n  Size of buffer:   " << getBufferSize() << " bytes\n";
-
-          // make the channel to know that a receive has a partial failure.
-          // The partial error can be cleared if the following lambda is 
-          // called by the user. This will complete the receive operation.
-          //mBase->setBadRecvErrorState(ss.str());
-
-          // give the user a chance to give us another location 
-          // by passing out an exception which they can call.
-          mPromise.set_exception(std::make_exception_ptr(
-              BadReceiveBufferSize(ss.str(), getHeaderSize())));
-
-          auto ec = boost::system::errc::make_error_code
-          (boost::system::errc::no_buffer_space);
-          mComHandle(ec, sizeof(u32));
-          return;
-        }
+      if (getHeaderSize() == kBatchHeaderMarker) {
+        recvBatch(bt1);
+        return;
+      }
+
+      auto sizeEc = fitBuffer();
+      if (sizeEc) {
+        mComHandle(sizeEc, sizeof(u32));
+        return;
       }
 
       // the normal case that the buffer is the right size or was correctly resized.
@@ -273,6 +323,108 @@ void FixedRecvBuff::asyncPerform(ChannelBase * base,
   });
 }
 
+void FixedRecvBuff::recvBatch(u64 bt1) {
+  auto fail = [this](const error_code& ec, u64 bytes) {
+    mPromise.set_exception(
+      std::make_exception_ptr(std::runtime_error(ec.message())));
+    mComHandle(ec, bytes);
+  };
+
+  auto& header = mBase->mRecvBatchHeader;
+  mBase->mRecvBuffer = boost::asio::mutable_buffer(header.data(),
+    sizeof(header));
+  mBase->mHandle->async_recv({ &mBase->mRecvBuffer, 1 },
+    [this, bt1, fail](const error_code& ec, u64 bt2) {
+    if (ec) {
+      fail(ec, bt1 + bt2);
+      return;
+    }
+
+    // frame count, size bytes, payload bytes. They come from the peer, so
+    // they are checked against what a sender ever writes before anything
+    // is allocated.
+    auto& header = mBase->mRecvBatchHeader;
+    if (header[0] == 0 || header[0] > BatchSendBuff::kMaxBatchFrames ||
+        header[1] < header[0] ||
+        header[1] > u64(header[0]) * BatchSendBuff::kMaxSizeBytes ||
+        header[2] > BatchSendBuff::kMaxBatchSize) {
+      fail(boost::system::errc::make_error_code(
+        boost::system::errc::protocol_error), bt1 + bt2);
+      return;
+    }
+    mBase->mRecvBatch.resize(u64(header[1]) + header[2]);
+    mBase->mRecvBuffer = boost::asio::mutable_buffer(
+      mBase->mRecvBatch.data(), mBase->mRecvBatch.size());
+    mBase->mHandle->async_recv({ &mBase->mRecvBuffer, 1 },
+      [this, bt1, bt2, fail](const error_code& ec, u64 bt3) {
+      if (ec) {
+        fail(ec, bt1 + bt2 + bt3);
+        return;
+      }
+
+      auto& header = mBase->mRecvBatchHeader;
+      auto& sizes = mBase->mRecvFrameSizes;
+      auto iter = mBase->mRecvBatch.begin();
+      auto end = iter + header[1];
+      u64 total = 0;
+      bool valid = true;
+      while (valid && iter != end && sizes.size() < header[0]) {
+        // at most kMaxSizeBytes bytes, the last one holds the top 4 bits.
+        u64 size = 0;
+        for (u64 shift = 0;; shift += 7) {
+          if (iter == end || shift >= 7 * BatchSendBuff::kMaxSizeBytes ||
+              (shift == 28 && (*iter & 0x70))) {
+            valid = false;
+            break;
+          }
+          size |= u64(*iter & 0x7f) << shift;
+          if ((*iter++ & 0x80) == 0)
+            break;
+        }
+        if (size > BatchSendBuff::kMaxFrameSize)
+          valid = false;
+        sizes.push_back(size_header_type(size));
+        total += size;
+      }
+
+      if (!valid || sizes.size() != header[0] || iter != end ||
+          total != header[2]) {
+        sizes.clear();
+        fail(boost::system::errc::make_error_code(
+          boost::system::errc::protocol_error), bt1 + bt2 + bt3);
+        return;
+      }
+
+      mBase->mRecvFrameOffset = header[1];
+      recvFrame(bt1 + bt2 + bt3);
+    });
+  });
+}
+
+void FixedRecvBuff::recvFrame(u64 bytesTransferred) {
+  auto& sizes = mBase->mRecvFrameSizes;
+  mHeaderSize = sizes.front();
+  sizes.pop_front();
+
+  auto ec = fitBuffer();
+  if (!ec) {
+    if (mHeaderSize)
+      memcpy(getBufferData(),
+        mBase->mRecvBatch.data() + mBase->mRecvFrameOffset, mHeaderSize);
+    mPromise.set_value();
+  }
+  mBase->mRecvFrameOffset += mHeaderSize;
+  if (sizes.empty())
+    mBase->mRecvBatch.clear();
+
+  // This may run inside asyncPerform, completing the operation pops it
+  // from the queue so the handle is called once the strand is free.
+  boost::asio::post(mBase->mStrand,
+    [ch = std::move(mComHandle), ec, bytesTransferred]() {
+      ch(ec, bytesTransferred);
+  });
+}
+
 std::string FixedSendBuff::toString() const {
   return std::string("FixedSendBuff #")
 #ifdef ENABLE_NET_LOG
@@ -289,6 +441,70 @@ std::string FixedRecvBuff::toString() const {
     + " ~ " + std::to_string(getBufferSize()) + " bytes";
 }
 
+BatchSendBuff::BatchSendBuff(std::vector<SBO_ptr<SendOperation>>&& ops)
+  : mOps(std::move(ops)) {
+  u64 payload = 0;
+  for (auto& op : mOps) {
+    u64 size = op->batchFrame()->getBufferSize();
+    payload += size;
+    do {
+      mSizes.push_back(u8(size & 0x7f) | (size > 0x7f ? 0x80 : 0));
+      size >>= 7;
+    } while (size);
+  }
+  Expects(payload <= kMaxBatchSize && mOps.size() <= kMaxBatchFrames);
+
+  mHeader = { { kBatchHeaderMarker, size_header_type(mOps.size()),
+    size_header_type(mSizes.size()), size_header_type(payload) } };
+}
+
+void BatchSendBuff::asyncPerform(ChannelBase* base,
+  io_completion_handle&& completionHandle) {
+  mComHandle = std::move(completionHandle);
+
+  mBuffers.clear();
+  mBuffers.reserve(mOps.size() + 2);
+  mBuffers.emplace_back(mHeader.data(), sizeof(mHeader));
+  mBuffers.emplace_back(mSizes.data(), mSizes.size());
+  for (auto& op : mOps) {
+    auto frame = op->batchFrame();
+    mBuffers.emplace_back(frame->getBufferData(), frame->getBufferSize());
+  }
+
+  base->mHandle->async_send(mBuffers,
+    [this, base](const error_code& ec, u64 bytesTransferred) {
+      // complete every send as if it was written on its own.
+      for (auto& op : mOps) {
+        if (!ec) {
+          op->batchFrame()->mBatchWritten = true;
+          op->asyncPerform(base, [](const error_code&, u64) {});
+        } else {
+          op->asyncCancel(base, ec, [](const error_code&, u64) {});
+        }
+      }
+
+      // the handle pops this operation from the queue.
+      auto ch = std::move(mComHandle);
+      ch(ec, bytesTransferred);
+  });
+}
+
+void BatchSendBuff::asyncCancel(ChannelBase* base, const error_code& ec,
+  io_completion_handle&& completionHandle) {
+  for (auto& op : mOps)
+    op->asyncCancel(base, ec, [](const error_code&, u64) {});
+  completionHandle(ec, 0);
+}
+
+std::string BatchSendBuff::toString() const {
+  return std::string("BatchSendBuff #")
+#ifdef ENABLE_NET_LOG
+    + std::to_string(mIdx)
+#endif
+    + " ~ " + std::to_string(mOps.size()) + " frames, "
+    + std::to_string(mHeader[3]) + " bytes";
+}
+
 boost::asio::io_context& getIOService(ChannelBase* base) {
   return base->mIos.mIoService;
 }
@@ -760,6 +976,63 @@ void ChannelBase::recvEnque(SBO_ptr<RecvOperation>&& op) {
 }
 
 void ChannelBase::sendEnque(SBO_ptr<SendOperation>&& op) {
+  {
+    std::lock_guard<std::mutex> lck(mHeldMtx);
+    if (mCoalescing) {
+      mHeldSends.push_back(std::move(op));
+      return;
+    }
+  }
+  pushSend(std::move(op));
+}
+
+void ChannelBase::setCoalescing(bool on) {
+  if (on == false)
+    flushSends();
+
+  std::lock_guard<std::mutex> lck(mHeldMtx);
+  mCoalescing = on;
+}
+
+void ChannelBase::flushSends() {
+  std::vector<SBO_ptr<SendOperation>> held;
+  {
+    std::lock_guard<std::mutex> lck(mHeldMtx);
+    std::swap(held, mHeldSends);
+  }
+
+  // Consecutive small sends become one batch, anything else is queued on
+  // its own between the batches so the order on the wire is unchanged.
+  std::vector<SBO_ptr<SendOperation>> batch;
+  u64 batchSize = 0;
+  auto pushBatch = [&]() {
+    if (batch.size() == 1)
+      pushSend(std::move(batch[0]));
+    else if (batch.size())
+      pushSend(make_SBO_ptr<SendOperation, BatchSendBuff>(std::move(batch)));
+    batch.clear();
+    batchSize = 0;
+  };
+
+  for (auto& op : held) {
+    auto frame = op->batchFrame();
+    if (frame == nullptr ||
+        frame->getBufferSize() > BatchSendBuff::kMaxFrameSize) {
+      pushBatch();
+      pushSend(std::move(op));
+      continue;
+    }
+
+    if (batchSize + frame->getBufferSize() > BatchSendBuff::kMaxBatchSize ||
+        batch.size() == BatchSendBuff::kMaxBatchFrames)
+      pushBatch();
+    batchSize += frame->getBufferSize();
+    batch.push_back(std::move(op));
+  }
+  pushBatch();
+}
+
+void ChannelBase::pushSend(SBO_ptr<SendOperation>&& op) {
 #ifdef ENABLE_NET_LOG
   op->mIdx = mSendIdx++;
   auto str = op->toString();
@@ -893,6 +1166,9 @@ void ChannelBase::asyncCancel(std::function<void()> completionHandle,
   bool close) {
   LOG_MSG("cancel()");
 
+  // the held sends are canceled with the rest of the queue.
+  setCoalescing(false);
+
   if (stopped() == false) {
     struct CancelState {
       std::atomic<u32> mCount;
@@ -971,6 +1247,7 @@ void ChannelBase::close() {
 
 void ChannelBase::asyncClose(std::function<void()> completionHandle) {
   LOG_MSG("Closing...");
+  setCoalescing(false);
 
   if (stopped() == false) {
     mStatus = Channel_Status::Closing;
@@ -8,6 +8,8 @@
 #include <ostream>
 #include <list>
 #include <deque>
+#include <mutex>
+#include <vector>
 
 #include "src/primihub/common/defines.h"
 #include "src/primihub/common/type/type.h"
@@ -159,6 +161,7 @@ public:
 
     T* mData;
     u64 mMaxReceiveSize, mTrueReceiveSize;
+    bool mReceived = false;
 
 
     // A constructor that takes the loction to be written to and 
@@ -173,7 +176,7 @@ public:
 
     u64 size() const
     {
-        if (mTrueReceiveSize)
+        if (mReceived)
             return mTrueReceiveSize;
         else
             return mMaxReceiveSize;
@@ -186,6 +189,7 @@ public:
     {
         if (size > mMaxReceiveSize) throw std::runtime_error(LOCATION);
         mTrueReceiveSize = size;
+        mReceived = true;
     }
 
     u64 receivedSize() const
@@ -343,6 +347,7 @@ class Channel {
             has_resize<Container, void(typename Container::size_type)>::value, void>::type
             recv(Container& c)
         {
+            flushSends();
             asyncRecv(c).get();
         }
 
@@ -354,6 +359,7 @@ class Channel {
             !has_resize<Container, void(typename Container::size_type)>::value, void>::type
             recv(Container& c)
         {
+            flushSends();
             asyncRecv(c).get();
         }
 
@@ -476,6 +482,22 @@ class Channel {
 
   std::string commonName();
 
+  // Hold the sends queued from now on, flushSends() writes all of them
+  // with one write and the peer splits them back into its receives.
+  // Turning it off writes the held sends. The blocking send() and recv()
+  // write the held sends first, a future of an async receive which waits
+  // for a reply to a held send never completes.
+  void setCoalescing(bool on);
+
+  // Write the sends held while coalescing, with those of the channels
+  // passed to flushWith().
+  void flushSends();
+
+  // Channels whose held sends are written whenever this one's are. A
+  // round which sends on one channel and blocks on a receive from another
+  // waits for a peer that needs the send first.
+  void flushWith(const std::vector<Channel>& group);
+
   std::shared_ptr<ChannelBase> mBase;
 
   operator bool() const {
@@ -552,8 +574,15 @@ class ChlOperation {
 #endif
 };
 
+class FixedSendBuff;
+
 class RecvOperation : public ChlOperation { };
-class SendOperation : public ChlOperation { };
+class SendOperation : public ChlOperation {
+ public:
+  // The buffer of a send that can be written as one frame of a batch,
+  // nullptr if the operation has to be performed on its own.
+  virtual FixedSendBuff* batchFrame() { return nullptr; }
+};
 
 template<typename Base>
 struct BaseCallbackOp : public Base {
@@ -592,6 +621,10 @@ using SendCallbackOp = BaseCallbackOp<SendOperation>;
 
 using size_header_type = u32;
 
+// Sent in place of a size header to start a batch of frames, a frame is
+// never this large.
+constexpr size_header_type kBatchHeaderMarker = size_header_type(-1);
+
 // A class for sending or receiving data over a channel. 
 // Datam sent/received with this type sent over the network 
 // with a header denoting its size in bytes.
@@ -621,7 +654,6 @@ class BasicSizedBuff {
   inline u8* getBufferData() { return mBuff.data(); }
 
   inline std::array<boost::asio::mutable_buffer, 2> getSendBuffer() {
-    Expects(mBuff.size());
     mHeaderSize = size_header_type(mBuff.size());
     return { { getRecvHeaderBuffer(), getRecvBuffer() } };
   }
@@ -651,6 +683,12 @@ class FixedSendBuff : public BasicSizedBuff, public SendOperation {
   void asyncPerform(ChannelBase* base,
     io_completion_handle && completionHandle) override;
 
+  FixedSendBuff* batchFrame() override { return this; }
+
+  // Set once the data went out as part of a batch, asyncPerform then
+  // only completes the operation.
+  bool mBatchWritten = false;
+
   void asyncCancelPending(ChannelBase* base, const error_code& ec) override {}
 
   void asyncCancel(ChannelBase* base, const error_code&,
@@ -716,6 +754,40 @@ class  RefSendBuff :public FixedSendBuff {
     :RefSendBuff(v.obj) {}
 };
 
+// Several sends written with one scatter-gather write. The batch header
+// is the marker, the frame count, the byte count of the frame sizes and
+// of the payload, followed by the sizes as LEB128 varints and the frames.
+// The peer splits the payload back into the receives it has queued.
+class BatchSendBuff : public SendOperation {
+ public:
+  // Frames of at most this many bytes are batched, larger sends gain
+  // nothing from it and would cost the peer a copy.
+  static constexpr u64 kMaxFrameSize = 1 << 16;
+  static constexpr u64 kMaxBatchSize = 1 << 24;
+  // Empty frames add nothing to the payload, so the count is bounded too.
+  static constexpr u64 kMaxBatchFrames = 1 << 16;
+  // LEB128 bytes of one u32 frame size.
+  static constexpr u64 kMaxSizeBytes = 5;
+
+  explicit BatchSendBuff(std::vector<SBO_ptr<SendOperation>>&& ops);
+
+  void asyncPerform(ChannelBase* base,
+    io_completion_handle&& completionHandle) override;
+
+  void asyncCancelPending(ChannelBase* base, const error_code& ec) override {}
+
+  void asyncCancel(ChannelBase* base, const error_code& ec,
+    io_completion_handle&& completionHandle) override;
+
+  std::string toString() const override;
+
+  std::vector<SBO_ptr<SendOperation>> mOps;
+  std::array<size_header_type, 4> mHeader;
+  std::vector<u8> mSizes;
+  std::vector<boost::asio::mutable_buffer> mBuffers;
+  io_completion_handle mComHandle;
+};
+
 class FixedRecvBuff : public BasicSizedBuff, public RecvOperation {
  public:
   io_completion_handle mComHandle;
@@ -753,6 +825,14 @@ class FixedRecvBuff : public BasicSizedBuff, public RecvOperation {
   std::string toString() const override;
 
   virtual void resizeBuffer(u64) {}
+
+ private:
+  // Resize the buffer to the header size if it differs, on failure the
+  // promise is set to the error which is returned.
+  error_code fitBuffer();
+  void recvBatch(u64 bytesTransferred);
+  // Take the next frame of a batch the channel already received.
+  void recvFrame(u64 bytesTransferred);
 };
 
 template <typename F>
@@ -1057,6 +1137,21 @@ class ChannelBase : public    std::enable_shared_from_this<ChannelBase> {
   void recvEnque(SBO_ptr<RecvOperation>&& op);
   void sendEnque(SBO_ptr<SendOperation>&& op);
 
+  // While coalescing, sends are held here until flushSends() writes them.
+  std::mutex mHeldMtx;
+  bool mCoalescing = false;
+  std::vector<SBO_ptr<SendOperation>> mHeldSends;
+  std::vector<std::weak_ptr<ChannelBase>> mFlushWith;
+  void setCoalescing(bool on);
+  void flushSends();
+  void pushSend(SBO_ptr<SendOperation>&& op);
+
+  // The frames of a received batch which no receive has taken yet.
+  std::array<size_header_type, 3> mRecvBatchHeader;
+  std::vector<u8> mRecvBatch;
+  std::deque<size_header_type> mRecvFrameSizes;
+  u64 mRecvFrameOffset = 0;
+
   void asyncPerformRecv();
   void asyncPerformSend();
 
@@ -1081,8 +1176,8 @@ struct SessionBase;
     template<class Container>
     typename std::enable_if<is_container<Container>::value, void>::type Channel::asyncSend(std::unique_ptr<Container> c)
     {
-        // not zero and less that 32 bits
-        Expects(channelBuffSize(*c) - 1 < u32(-2));
+        // less than 32 bits, empty messages are allowed
+        Expects(channelBuffSize(*c) < u32(-1));
 
         auto op = make_SBO_ptr<
             SendOperation,
@@ -1096,8 +1191,8 @@ struct SessionBase;
     template<class Container>
     typename std::enable_if<is_container<Container>::value, void>::type Channel::asyncSend(std::shared_ptr<Container> c)
     {
-        // not zero and less that 32 bits
-        Expects(channelBuffSize(*c) - 1 < u32(-2));
+        // less than 32 bits, empty messages are allowed
+        Expects(channelBuffSize(*c) < u32(-1));
 
 
         auto op = make_SBO_ptr<
@@ -1113,8 +1208,8 @@ struct SessionBase;
     template<class Container>
     typename std::enable_if<is_container<Container>::value, void>::type Channel::asyncSend(const Container& c)
     {
-        // not zero and less that 32 bits
-        Expects(channelBuffSize(c) - 1 < u32(-2));
+        // less than 32 bits, empty messages are allowed
+        Expects(channelBuffSize(c) < u32(-1));
 
         auto* buff = (u8*)c.data();
         auto size = c.size() * sizeof(typename Container::value_type);
@@ -1129,8 +1224,8 @@ struct SessionBase;
     template<class Container>
     typename std::enable_if<is_container<Container>::value, void>::type Channel::asyncSend(Container&& c)
     {
-        // not zero and less that 32 bits
-        Expects(channelBuffSize(c) - 1 < u32(-2));
+        // less than 32 bits, empty messages are allowed
+        Expects(channelBuffSize(c) < u32(-1));
 
         auto op = make_SBO_ptr<
             SendOperation, 
@@ -1232,7 +1327,9 @@ struct SessionBase;
     typename std::enable_if<std::is_pod<T>::value, void>::type
         Channel::send(const T* buffT, u64 sizeT)
     {
-        asyncSendFuture(buffT, sizeT).get();
+        auto fu = asyncSendFuture(buffT, sizeT);
+        flushSends();
+        fu.get();
     }
 
 
@@ -1243,8 +1340,8 @@ struct SessionBase;
         u8* buff = (u8*)buffT;
         auto size = sizeT * sizeof(T);
 
-        // not zero and less that 32 bits
-        Expects(size - 1 < u32(-2));
+        // less than 32 bits, empty messages are allowed
+        Expects(size < u32(-1));
 
         std::future<void> future;
         auto op = make_SBO_ptr<
@@ -1313,8 +1410,8 @@ struct SessionBase;
         u8* buff = (u8*)buffT;
         auto size = sizeT * sizeof(T);
 
-        // not zero and less that 32 bits
-        Expects(size - 1 < u32(-2));
+        // less than 32 bits, empty messages are allowed
+        Expects(size < u32(-1));
 
         auto op = make_SBO_ptr<
             SendOperation, 
@@ -1339,8 +1436,8 @@ struct SessionBase;
     typename std::enable_if<is_container<Container>::value, void>::type
         Channel::asyncSend(Container&& c, std::function<void()> callback)
     {
-        // not zero and less that 32 bits
-        Expects(channelBuffSize(c) - 1 < u32(-2));
+        // less than 32 bits, empty messages are allowed
+        Expects(channelBuffSize(c) < u32(-1));
 
         auto op = make_SBO_ptr<
             SendOperation,
@@ -1357,8 +1454,8 @@ struct SessionBase;
     typename std::enable_if<is_container<Container>::value, void>::type
         Channel::asyncSend(Container&& c, std::function<void(const error_code&)> callback)
     {
-        // not zero and less that 32 bits
-        Expects(channelBuffSize(c) - 1 < u32(-2));
+        // less than 32 bits, empty messages are allowed
+        Expects(channelBuffSize(c) < u32(-1));
 
         auto op = make_SBO_ptr<
             SendOperation,
@@ -1376,6 +1473,7 @@ struct SessionBase;
     typename std::enable_if<std::is_pod<T>::value, void>::type
         Channel::recv(T* buff, u64 size)
     {
+        flushSends();
         asyncRecv(buff, size).get();
     }
 
@@ -102,6 +102,18 @@ Session::Session(const std::shared_ptr<SessionBase> &c) : mBase(c) {
   ++mBase->mRealRefCount;
 }
 
+Session &Session::operator=(const Session &v) {
+  if (v.mBase)
+    ++v.mBase->mRealRefCount;
+  if (mBase) {
+    --mBase->mRealRefCount;
+    if (mBase->mRealRefCount == 0)
+      mBase->stop();
+  }
+  mBase = v.mBase;
+  return *this;
+}
+
 Session::~Session() {
   if (mBase) {
     --mBase->mRealRefCount;
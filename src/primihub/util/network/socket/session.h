@@ -87,6 +87,7 @@ public:
 
   Session(const Session &);
   Session(Session &&) = default;
+  Session &operator=(const Session &);
 
   Session(const std::shared_ptr<SessionBase> &c);
 
@@ -0,0 +1,65 @@
+// Copyright [2022] <primihub.com>
+#include "src/primihub/util/network/socket/session_pool.h"
+
+#include <unistd.h>
+
+#include <glog/logging.h>
+
+namespace primihub {
+
+SessionPool::SessionPool() : ios_(new IOService()) {}
+
+SessionPool::~SessionPool() { clear(); }
+
+SessionPool &SessionPool::getInstance() {
+  static std::mutex mtx;
+  static SessionPool *pool = nullptr;
+  static pid_t owner = 0;
+
+  std::lock_guard<std::mutex> lck(mtx);
+  if (pool == nullptr || owner != getpid()) {
+    // The pool inherited from the parent is left as it is, stopping it
+    // would wait for threads which only run in the parent.
+    pool = new SessionPool();
+    owner = getpid();
+  }
+  return *pool;
+}
+
+Session SessionPool::getSession(const std::string &ip, u32 port,
+                                SessionMode mode,
+                                const std::string &session_name) {
+  std::lock_guard<std::mutex> lck(mtx_);
+  Key key(ip, port, mode, session_name);
+  auto iter = sessions_.find(key);
+  if (iter != sessions_.end() && !iter->second.stopped())
+    return iter->second;
+
+  Session session(*ios_, ip, port, mode, session_name);
+  VLOG(3) << "Start pooled " << (mode == SessionMode::Server ? "server" : "client")
+          << " session " << session_name << ", " << ip << ":" << port << ".";
+  sessions_[key] = session;
+  return session;
+}
+
+Channel SessionPool::addChannel(const std::string &ip, u32 port,
+                                SessionMode mode,
+                                const std::string &session_name,
+                                const std::string &channel_name) {
+  Session session = getSession(ip, port, mode, session_name);
+  return session.addChannel(channel_name, channel_name);
+}
+
+u64 SessionPool::size() {
+  std::lock_guard<std::mutex> lck(mtx_);
+  return sessions_.size();
+}
+
+void SessionPool::clear() {
+  std::lock_guard<std::mutex> lck(mtx_);
+  for (auto &item : sessions_)
+    item.second.stop();
+  sessions_.clear();
+}
+
+}  // namespace primihub
@@ -0,0 +1,63 @@
+// Copyright [2022] <primihub.com>
+#ifndef SRC_PRIMIHUB_UTIL_NETWORK_SOCKET_SESSION_POOL_H_
+#define SRC_PRIMIHUB_UTIL_NETWORK_SOCKET_SESSION_POOL_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "src/primihub/common/defines.h"
+#include "src/primihub/util/network/socket/channel.h"
+#include "src/primihub/util/network/socket/ioservice.h"
+#include "src/primihub/util/network/socket/session.h"
+
+namespace primihub {
+
+// Sessions of this node which stay open across tasks. A session is keyed by
+// the peer address, the mode and the session name, it's started the first
+// time a task asks for it and reused by the tasks after it. All sessions run
+// on one IOService, so tasks listening on the same port share its acceptor
+// instead of fighting over the port.
+//
+// Tasks take their own channels from a pooled session. A named channel only
+// pairs with the channel of the same name on the peer, so tasks which use
+// their task id in the name can run at the same time over one session.
+class SessionPool {
+ public:
+  SessionPool();
+  ~SessionPool();
+  SessionPool(const SessionPool &) = delete;
+  SessionPool &operator=(const SessionPool &) = delete;
+
+  // The pool shared by all tasks of this node. A process forked from one
+  // which used the pool gets a new pool, the threads of the IOService don't
+  // survive fork().
+  static SessionPool &getInstance();
+
+  Session getSession(const std::string &ip, u32 port, SessionMode mode,
+                     const std::string &session_name);
+
+  // Adds the channel channel_name to the pooled session, both ends use the
+  // same name.
+  Channel addChannel(const std::string &ip, u32 port, SessionMode mode,
+                     const std::string &session_name,
+                     const std::string &channel_name);
+
+  u64 size();
+
+  // Stops all sessions, channels still open on them are closed too.
+  void clear();
+
+ private:
+  using Key = std::tuple<std::string, u32, SessionMode, std::string>;
+
+  std::mutex mtx_;
+  std::unique_ptr<IOService> ios_;
+  std::map<Key, Session> sessions_;
+};
+
+}  // namespace primihub
+
+#endif  // SRC_PRIMIHUB_UTIL_NETWORK_SOCKET_SESSION_POOL_H_
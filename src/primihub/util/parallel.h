@@ -0,0 +1,72 @@
+// Copyright [2022] <primihub.com>
+#ifndef SRC_PRIMIHUB_UTIL_PARALLEL_H_
+#define SRC_PRIMIHUB_UTIL_PARALLEL_H_
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace primihub {
+
+// smallest shard worth a thread of its own for per-item crypto work.
+constexpr size_t kMinShardSize = 4096;
+
+// number of workers used when the task does not configure one.
+inline size_t DefaultWorkerNum() {
+  size_t num = std::thread::hardware_concurrency();
+  return num == 0 ? 1 : num;
+}
+
+// number of shards for total items, so that every shard holds at least
+// min_shard_size items and no more than max_workers shards are used.
+inline size_t ShardNum(size_t total, size_t max_workers,
+                       size_t min_shard_size) {
+  if (max_workers == 0) {
+    max_workers = DefaultWorkerNum();
+  }
+  size_t num = min_shard_size == 0 ? total : total / min_shard_size;
+  return std::max<size_t>(1, std::min(num, max_workers));
+}
+
+// Split [0, total) into num_shards contiguous ranges and call
+// func(shard_index, begin, end) for every range, one thread per shard.
+// The first exception thrown by any shard is rethrown after all joined.
+template <typename Func>
+void ParallelForShards(size_t total, size_t num_shards, Func&& func) {
+  if (num_shards <= 1 || total <= 1) {
+    func(0, 0, total);
+    return;
+  }
+  num_shards = std::min(num_shards, total);
+  std::vector<std::exception_ptr> errors(num_shards);
+  std::vector<std::thread> thrds;
+  thrds.reserve(num_shards);
+  size_t shard_size = total / num_shards;
+  size_t remainder = total % num_shards;
+  size_t begin = 0;
+  for (size_t i = 0; i < num_shards; i++) {
+    size_t end = begin + shard_size + (i < remainder ? 1 : 0);
+    thrds.emplace_back([&func, &errors, i, begin, end]() {
+      try {
+        func(i, begin, end);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+    begin = end;
+  }
+  for (auto& t : thrds) {
+    t.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+}  // namespace primihub
+
+#endif  // SRC_PRIMIHUB_UTIL_PARALLEL_H_
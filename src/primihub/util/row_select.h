@@ -0,0 +1,48 @@
+// Copyright [2022] <primihub.com>
+#ifndef SRC_PRIMIHUB_UTIL_ROW_SELECT_H_
+#define SRC_PRIMIHUB_UTIL_ROW_SELECT_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace primihub {
+
+// Move the rows of elements whose index is in indices into result, or the
+// rows whose index is not in indices when complement is true. Rows are
+// emitted once each in row order, indices out of range are ignored.
+// A dense bitmap over row indices is used, so it is one linear pass over
+// elements without per index allocation. The selected rows are left
+// empty in elements. Return the number of rows appended to result.
+template <typename Index>
+size_t SelectRows(std::vector<std::string>* elements,
+                  const std::vector<Index>& indices, bool complement,
+                  std::vector<std::string>* result) {
+  size_t num_rows = elements->size();
+  std::vector<bool> marked(num_rows, false);
+  size_t num_marked = 0;
+  for (const auto& index : indices) {
+    if (static_cast<int64_t>(index) < 0 ||
+        static_cast<uint64_t>(index) >= num_rows) {
+      continue;
+    }
+    if (!marked[index]) {
+      marked[index] = true;
+      num_marked++;
+    }
+  }
+
+  size_t num_selected = complement ? num_rows - num_marked : num_marked;
+  result->reserve(result->size() + num_selected);
+  for (size_t i = 0; i < num_rows; i++) {
+    if (marked[i] != complement) {
+      result->push_back(std::move((*elements)[i]));
+    }
+  }
+  return num_selected;
+}
+
+}  // namespace primihub
+
+#endif  // SRC_PRIMIHUB_UTIL_ROW_SELECT_H_
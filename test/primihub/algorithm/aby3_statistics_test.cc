@@ -0,0 +1,183 @@
+// Copyright [2022] <primihub.com>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/primihub/operator/aby3_operator.h"
+#include "src/primihub/operator/aby3_statistics.h"
+
+using namespace primihub;
+
+namespace {
+// Rows of the three parties, column 2 has no value in party 1 and column 3
+// none at all.
+std::vector<std::vector<double>> partyColumns(u64 pIdx) {
+  switch (pIdx) {
+  case 0:
+    return {{1, 2, 3}, {0, 4.5}, {-1.5, 2.25}, {}};
+  case 1:
+    return {{4, 5}, {5, 9.5, 10, 10}, {}, {}};
+  default:
+    return {{6}, {12, 7, -2}, {10.75, -3}, {}};
+  }
+}
+
+void runParty(u64 pIdx, MPCOperator &mpc) {
+  std::vector<std::vector<double>> edges = {{}, {0, 5, 10}, {}, {0, 1}};
+  MPCStatistics statistics(mpc);
+  std::vector<ColumnStatistics> stats =
+      statistics.compute(partyColumns(pIdx), edges);
+  mpc.fini();
+
+  ASSERT_EQ(stats.size(), 4);
+  for (u64 i = 0; i < stats.size(); ++i) {
+    std::vector<double> all;
+    for (u64 p = 0; p < 3; ++p) {
+      auto col = partyColumns(p)[i];
+      all.insert(all.end(), col.begin(), col.end());
+    }
+
+    EXPECT_EQ(stats[i].count, all.size());
+    if (all.empty()) {
+      EXPECT_EQ(stats[i].sum, 0);
+      EXPECT_EQ(stats[i].min, 0);
+      EXPECT_EQ(stats[i].max, 0);
+      continue;
+    }
+
+    double sum = 0, deviation = 0;
+    for (double v : all)
+      sum += v;
+    double mean = sum / all.size();
+    for (double v : all)
+      deviation += (v - mean) * (v - mean);
+
+    EXPECT_NEAR(stats[i].sum, sum, 1e-3);
+    EXPECT_NEAR(stats[i].mean, mean, 1e-3);
+    EXPECT_NEAR(stats[i].variance, deviation / all.size(), 1e-3);
+    EXPECT_NEAR(stats[i].min, *std::min_element(all.begin(), all.end()), 1e-3);
+    EXPECT_NEAR(stats[i].max, *std::max_element(all.begin(), all.end()), 1e-3);
+  }
+
+  // 12 and -2 are out of range, 10 goes into the last bin.
+  EXPECT_EQ(stats[1].histogram, std::vector<u64>({2, 5}));
+  EXPECT_TRUE(stats[0].histogram.empty());
+  EXPECT_EQ(stats[3].histogram, std::vector<u64>({0}));
+}
+
+// Column 0 has values near 1e6 in 1e4 rows a party, so the total of the
+// squared deviations is near 1e16, column 1 has a sum near 2e15. Both are
+// far beyond the 2^47 that D16 holds in i64.
+std::vector<std::vector<double>> largePartyColumns(u64 pIdx) {
+  std::vector<std::vector<double>> columns(2);
+  for (u64 k = 0; k < 10000; ++k)
+    columns[0].push_back(((k * 7919 + pIdx * 13) % 2000) * 1000.25);
+  for (u64 k = 0; k < 20; ++k)
+    columns[1].push_back(3e13 + pIdx * 1e12 + k * 0.5);
+  return columns;
+}
+
+void runLargeParty(u64 pIdx, MPCOperator &mpc) {
+  MPCStatistics statistics(mpc);
+  std::vector<ColumnStatistics> stats =
+      statistics.compute(largePartyColumns(pIdx));
+
+  // A value beyond 2^46 is rejected on all parties.
+  std::vector<std::vector<double>> out_of_range = {{1.0}, {2.0}};
+  if (pIdx == 1)
+    out_of_range[1].push_back(1e15);
+  EXPECT_THROW(statistics.compute(out_of_range), std::runtime_error);
+  mpc.fini();
+
+  ASSERT_EQ(stats.size(), 2);
+  for (u64 i = 0; i < stats.size(); ++i) {
+    std::vector<double> all;
+    for (u64 p = 0; p < 3; ++p) {
+      auto col = largePartyColumns(p)[i];
+      all.insert(all.end(), col.begin(), col.end());
+    }
+    double sum = 0, deviation = 0;
+    for (double v : all)
+      sum += v;
+    double mean = sum / all.size();
+    for (double v : all)
+      deviation += (v - mean) * (v - mean);
+
+    EXPECT_EQ(stats[i].count, all.size());
+    EXPECT_NEAR(stats[i].sum, sum, 1e-9 * std::fabs(sum));
+    EXPECT_NEAR(stats[i].mean, mean, 1e-9 * std::fabs(mean));
+    EXPECT_NEAR(stats[i].variance, deviation / all.size(),
+                1e-6 * deviation / all.size());
+    EXPECT_NEAR(stats[i].min, *std::min_element(all.begin(), all.end()), 1e-3);
+    EXPECT_NEAR(stats[i].max, *std::max_element(all.begin(), all.end()), 1e-3);
+  }
+}
+}  // namespace
+
+TEST(aby3_statistics_test, aby3_3pc_large_values_test) {
+  pid_t pid = fork();
+  if (pid != 0) {
+    // Parent process as party 0.
+    MPCOperator mpc(0, "01", "02");
+    mpc.setup("127.0.0.1", "127.0.0.1", (u32)1919, (u32)2020);
+    runLargeParty(0, mpc);
+    int status;
+    waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    return;
+  }
+
+  pid = fork();
+  if (pid != 0) {
+    // Child process as party 1.
+    sleep(1);
+    MPCOperator mpc(1, "12", "01");
+    mpc.setup("127.0.0.1", "127.0.0.1", (u32)2121, (u32)1919);
+    runLargeParty(1, mpc);
+    int status;
+    waitpid(pid, &status, 0);
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    exit(ok && !::testing::Test::HasFailure() ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  // Grandchild process as party 2.
+  sleep(2);
+  MPCOperator mpc(2, "02", "12");
+  mpc.setup("127.0.0.1", "127.0.0.1", (u32)2020, (u32)2121);
+  runLargeParty(2, mpc);
+  exit(::testing::Test::HasFailure() ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+TEST(aby3_statistics_test, aby3_3pc_test) {
+  pid_t pid = fork();
+  if (pid != 0) {
+    // Parent process as party 0.
+    MPCOperator mpc(0, "01", "02");
+    mpc.setup("127.0.0.1", "127.0.0.1", (u32)1313, (u32)1414);
+    runParty(0, mpc);
+    return;
+  }
+
+  pid = fork();
+  if (pid != 0) {
+    // Child process as party 1.
+    sleep(1);
+    MPCOperator mpc(1, "12", "01");
+    mpc.setup("127.0.0.1", "127.0.0.1", (u32)1515, (u32)1313);
+    runParty(1, mpc);
+    return;
+  }
+
+  // Grandchild process as party 2.
+  sleep(2);
+  MPCOperator mpc(2, "02", "12");
+  mpc.setup("127.0.0.1", "127.0.0.1", (u32)1414, (u32)1515);
+  runParty(2, mpc);
+}
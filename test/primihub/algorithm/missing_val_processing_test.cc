@@ -0,0 +1,137 @@
+// Copyright [2022] <primihub.com>
+#include <unistd.h>
+
+#include <arrow/api.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/primihub/algorithm/missing_val_processing.h"
+
+using namespace primihub;
+
+namespace {
+// NAN marks a null. Party 1 has no column "c", and the sum of column "d"
+// is far beyond the 2^47 that D16 fixed point holds in i64.
+std::map<std::string, std::vector<double>> partyColumns(u64 pIdx) {
+  switch (pIdx) {
+  case 0:
+    return {{"a", {1.5, NAN, -2.25}},
+            {"b", {4, NAN, 7}},
+            {"c", {NAN, 3.5}},
+            {"d", {4e14, NAN}}};
+  case 1:
+    return {{"a", {NAN, 10}}, {"b", {NAN, -3, 1}}, {"d", {5e14, 6e14}}};
+  default:
+    return {{"a", {0.125}},
+            {"b", {NAN}},
+            {"c", {-1.25, 6, NAN}},
+            {"d", {NAN, 7e14}}};
+  }
+}
+
+const std::map<std::string, uint32_t> kColAndDtype = {
+    {"a", 2}, {"b", 1}, {"c", 2}, {"d", 2}};
+
+std::shared_ptr<arrow::Table>
+makeTable(const std::map<std::string, std::vector<double>> &columns) {
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::Array>> arrays;
+  for (auto &column : columns) {
+    std::shared_ptr<arrow::Array> array;
+    if (kColAndDtype.at(column.first) == 1) {
+      arrow::Int64Builder builder;
+      for (double v : column.second)
+        EXPECT_TRUE((std::isnan(v) ? builder.AppendNull()
+                                   : builder.Append(static_cast<int64_t>(v)))
+                        .ok());
+      EXPECT_TRUE(builder.Finish(&array).ok());
+      fields.push_back(arrow::field(column.first, arrow::int64()));
+    } else {
+      arrow::DoubleBuilder builder;
+      for (double v : column.second)
+        EXPECT_TRUE(
+            (std::isnan(v) ? builder.AppendNull() : builder.Append(v)).ok());
+      EXPECT_TRUE(builder.Finish(&array).ok());
+      fields.push_back(arrow::field(column.first, arrow::float64()));
+    }
+    arrays.push_back(array);
+  }
+  return arrow::Table::Make(arrow::schema(fields), arrays);
+}
+
+void runParty(u64 pIdx, MPCOperator &mpc) {
+  auto columns = partyColumns(pIdx);
+  std::shared_ptr<arrow::Table> table = makeTable(columns);
+  ASSERT_EQ(fillNullWithMean(&mpc, kColAndDtype, &table), 0);
+  mpc.fini();
+
+  EXPECT_EQ(table->num_columns(), columns.size());
+  for (auto &column : columns) {
+    double sum = 0;
+    int64_t count = 0;
+    for (u64 p = 0; p < 3; ++p) {
+      auto all = partyColumns(p);
+      if (all.count(column.first) == 0)
+        continue;
+      for (double v : all[column.first]) {
+        if (!std::isnan(v)) {
+          sum += v;
+          count++;
+        }
+      }
+    }
+
+    bool is_int = kColAndDtype.at(column.first) == 1;
+    double mean = is_int ? static_cast<double>(static_cast<int64_t>(sum) /
+                                               count)
+                         : sum / count;
+    auto filled = table->GetColumnByName(column.first);
+    ASSERT_NE(filled, nullptr);
+    ASSERT_EQ(filled->num_chunks(), 1);
+    EXPECT_EQ(filled->null_count(), 0);
+    std::shared_ptr<arrow::Array> chunk = filled->chunk(0);
+    for (u64 i = 0; i < column.second.size(); ++i) {
+      double expect = std::isnan(column.second[i]) ? mean : column.second[i];
+      double value =
+          is_int
+              ? std::static_pointer_cast<arrow::Int64Array>(chunk)->Value(i)
+              : std::static_pointer_cast<arrow::DoubleArray>(chunk)->Value(i);
+      EXPECT_NEAR(value, expect, 1e-3 * std::max(1.0, std::fabs(expect)))
+          << "party " << pIdx << " column " << column.first << " row " << i;
+    }
+  }
+}
+}  // namespace
+
+TEST(missing_val_processing_test, pooled_mean_3pc_test) {
+  pid_t pid = fork();
+  if (pid != 0) {
+    // Parent process as party 0.
+    MPCOperator mpc(0, "01", "02");
+    mpc.setup("127.0.0.1", "127.0.0.1", (u32)1616, (u32)1717);
+    runParty(0, mpc);
+    return;
+  }
+
+  pid = fork();
+  if (pid != 0) {
+    // Child process as party 1.
+    sleep(1);
+    MPCOperator mpc(1, "12", "01");
+    mpc.setup("127.0.0.1", "127.0.0.1", (u32)1818, (u32)1616);
+    runParty(1, mpc);
+    return;
+  }
+
+  // Grandchild process as party 2.
+  sleep(2);
+  MPCOperator mpc(2, "02", "12");
+  mpc.setup("127.0.0.1", "127.0.0.1", (u32)1717, (u32)1818);
+  runParty(2, mpc);
+}
@@ -0,0 +1,67 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/primihub/data_store/column_reader.h"
+
+namespace primihub {
+
+// Enough rows to span several 1MB csv blocks.
+constexpr int64_t kNumRows = 300000;
+
+std::string WriteTestCSV() {
+  std::string file_path = "/tmp/column_reader_test.csv";
+  std::ofstream out(file_path);
+  out << "id,name\n";
+  for (int64_t i = 0; i < kNumRows; i++) {
+    out << i << ",name_" << i << "\n";
+  }
+  out.close();
+  return file_path;
+}
+
+TEST(ColumnReaderTest, csv_read_all_chunks) {
+  auto file_path = WriteTestCSV();
+  std::vector<std::string> col_array;
+  int64_t ret = LoadColumnFromCSV(file_path, 1, &col_array);
+  EXPECT_EQ(ret, kNumRows);
+  ASSERT_EQ(col_array.size(), kNumRows);
+  EXPECT_EQ(col_array[0], "name_0");
+  EXPECT_EQ(col_array[kNumRows - 1], "name_" + std::to_string(kNumRows - 1));
+
+  // numeric column is loaded as string
+  std::vector<std::string> id_array;
+  ret = LoadColumnFromCSV(file_path, 0, &id_array, 10);
+  EXPECT_EQ(ret, 10);
+  ASSERT_EQ(id_array.size(), 10);
+  EXPECT_EQ(id_array[9], "9");
+  std::remove(file_path.c_str());
+}
+
+TEST(ColumnReaderTest, csv_invalid_column) {
+  auto file_path = WriteTestCSV();
+  std::vector<std::string> col_array;
+  EXPECT_EQ(LoadColumnFromCSV(file_path, 2, &col_array), -1);
+  EXPECT_TRUE(col_array.empty());
+  std::remove(file_path.c_str());
+}
+
+}  // namespace primihub
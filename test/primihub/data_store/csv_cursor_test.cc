@@ -0,0 +1,333 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "src/primihub/data_store/csv/csv_driver.h"
+#include "src/primihub/data_store/csv/csv_row_index.h"
+#include "src/primihub/data_store/factory.h"
+
+namespace primihub {
+
+constexpr int64_t kCursorTestRows = 5000;
+
+std::string WriteCursorTestCSV(bool trailing_line_break) {
+  std::string file_path = "/tmp/csv_cursor_test.csv";
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::ofstream out(file_path);
+  out << "id,value\n";
+  for (int64_t i = 0; i < kCursorTestRows; i++) {
+    out << i << "," << i * 2;
+    if (i + 1 < kCursorTestRows || trailing_line_break) {
+      out << "\n";
+    }
+  }
+  out.close();
+  return file_path;
+}
+
+TEST(CSVRowIndexTest, locate_rows) {
+  auto file_path = WriteCursorTestCSV(false);
+  CSVRowIndex index(file_path);
+  ASSERT_EQ(index.load(), 0);
+  EXPECT_EQ(index.numRows(), kCursorTestRows);
+  EXPECT_EQ(index.headerSize(), std::string("id,value\n").size());
+
+  std::ifstream in(file_path);
+  std::string content((std::istreambuf_iterator<char>(in)),
+                      std::istreambuf_iterator<char>());
+  int64_t begin = 0;
+  int64_t end = 0;
+  ASSERT_EQ(index.locateRows(2047, 3, &begin, &end), 0);
+  EXPECT_EQ(content.substr(begin, end - begin), "2047,4094\n2048,4096\n2049,4098\n");
+  ASSERT_EQ(index.locateRows(kCursorTestRows - 1, 10, &begin, &end), 0);
+  EXPECT_EQ(content.substr(begin, end - begin), "4999,9998");
+
+  // the sidecar index is reused by a new instance
+  CSVRowIndex reloaded(file_path);
+  ASSERT_EQ(reloaded.load(), 0);
+  EXPECT_EQ(reloaded.numRows(), kCursorTestRows);
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+TEST(CSVRowIndexTest, skip_blank_lines) {
+  std::string file_path = "/tmp/csv_cursor_blank_test.csv";
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  {
+    std::ofstream out(file_path);
+    out << "id,value\r\n0,0\r\n\r\n1,2\n\n2,4\r\n\r\n";
+  }
+  CSVRowIndex index(file_path);
+  ASSERT_EQ(index.load(), 0);
+  EXPECT_EQ(index.numRows(), 3);
+
+  std::ifstream in(file_path);
+  std::string content((std::istreambuf_iterator<char>(in)),
+                      std::istreambuf_iterator<char>());
+  int64_t begin = 0;
+  int64_t end = 0;
+  ASSERT_EQ(index.locateRows(2, 1, &begin, &end), 0);
+  EXPECT_EQ(content.substr(begin, end - begin), "\n2,4\r\n\r\n");
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+TEST(CSVCursorTest, read_range) {
+  auto file_path = WriteCursorTestCSV(true);
+  auto driver = DataDirverFactory::getDriver("CSV", "test address");
+  auto& cursor = driver->read(file_path);
+  auto ds = cursor->read(1500, 100);
+  ASSERT_NE(ds, nullptr);
+  auto table = std::get<std::shared_ptr<arrow::Table>>(ds->data);
+  ASSERT_EQ(table->num_rows(), 100);
+  ASSERT_EQ(table->num_columns(), 2);
+  auto ids = std::static_pointer_cast<arrow::Int64Array>(
+      table->column(0)->chunk(0));
+  EXPECT_EQ(ids->Value(0), 1500);
+  EXPECT_EQ(ids->Value(99), 1599);
+
+  ds = cursor->read(kCursorTestRows - 10, 100);
+  ASSERT_NE(ds, nullptr);
+  table = std::get<std::shared_ptr<arrow::Table>>(ds->data);
+  EXPECT_EQ(table->num_rows(), 10);
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+TEST(CSVCursorTest, read_range_file_schema) {
+  // the column holds integers in the first rows only and is empty in the
+  // first rows of another.
+  std::string file_path = "/tmp/csv_cursor_schema_test.csv";
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  {
+    std::ofstream out(file_path);
+    out << "id,value,note\n";
+    for (int64_t i = 0; i < kCursorTestRows; i++) {
+      out << i << ",";
+      if (i < kCursorTestRows - 1) {
+        out << i;
+      } else {
+        out << "0.5";
+      }
+      out << "," << (i < 100 ? "" : "x") << "\n";
+    }
+  }
+  auto driver = DataDirverFactory::getDriver("CSV", "test address");
+  auto& cursor = driver->read(file_path);
+  for (int64_t offset : {0L, kCursorTestRows - 1}) {
+    auto ds = cursor->read(offset, 1);
+    ASSERT_NE(ds, nullptr);
+    auto table = std::get<std::shared_ptr<arrow::Table>>(ds->data);
+    EXPECT_EQ(table->schema()->field(1)->type()->id(), arrow::Type::DOUBLE);
+    EXPECT_EQ(table->schema()->field(2)->type()->id(), arrow::Type::STRING);
+  }
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+TEST(CSVCursorTest, read_stream) {
+  auto file_path = WriteCursorTestCSV(true);
+  auto driver = DataDirverFactory::getDriver("CSV", "test address");
+  auto& cursor = driver->read(file_path);
+  auto maybe_reader = cursor->readStream({"value"});
+  ASSERT_TRUE(maybe_reader.ok());
+  auto reader = *maybe_reader;
+  ASSERT_EQ(reader->schema()->num_fields(), 1);
+  EXPECT_EQ(reader->schema()->field(0)->name(), "value");
+
+  int64_t num_rows = 0;
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (true) {
+    ASSERT_TRUE(reader->ReadNext(&batch).ok());
+    if (batch == nullptr) {
+      break;
+    }
+    auto values = std::static_pointer_cast<arrow::Int64Array>(batch->column(0));
+    EXPECT_EQ(values->Value(0), num_rows * 2);
+    num_rows += batch->num_rows();
+  }
+  EXPECT_EQ(num_rows, kCursorTestRows);
+
+  EXPECT_FALSE(cursor->readStream({"missing"}).ok());
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+TEST(CSVCursorTest, read_stream_file_schema) {
+  // the value column holds integers up to the last row of a file of
+  // several blocks within the sampled ones, the first block alone would
+  // make it int64.
+  std::string file_path = "/tmp/csv_cursor_stream_schema_test.csv";
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  constexpr int64_t kRows = 300000;
+  {
+    std::ofstream out(file_path);
+    out << "id,value\n";
+    for (int64_t i = 0; i < kRows; i++) {
+      out << i << "," << (i + 1 < kRows ? std::to_string(i) : "0.5") << "\n";
+    }
+  }
+  auto driver = DataDirverFactory::getDriver("CSV", "test address");
+  auto& cursor = driver->read(file_path);
+  auto maybe_reader = cursor->readStream({"value"});
+  ASSERT_TRUE(maybe_reader.ok());
+  auto reader = *maybe_reader;
+  EXPECT_EQ(reader->schema()->field(0)->type()->id(), arrow::Type::DOUBLE);
+
+  int64_t num_rows = 0;
+  int64_t num_batches = 0;
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (true) {
+    auto status = reader->ReadNext(&batch);
+    ASSERT_TRUE(status.ok()) << status.ToString();
+    if (batch == nullptr) {
+      break;
+    }
+    EXPECT_EQ(batch->schema()->field(0)->type()->id(), arrow::Type::DOUBLE);
+    num_rows += batch->num_rows();
+    num_batches++;
+  }
+  EXPECT_EQ(num_rows, kRows);
+  EXPECT_GT(num_batches, 1);
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+TEST(CSVCursorTest, read_paths_same_schema) {
+  // a date column and an integer column which turns double past the first
+  // block, every read of the file converts to the same types.
+  std::string file_path = "/tmp/csv_cursor_same_schema_test.csv";
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  constexpr int64_t kRows = 200000;
+  {
+    std::ofstream out(file_path);
+    out << "day,value\n";
+    for (int64_t i = 0; i < kRows; i++) {
+      out << "2022-0" << 1 + i % 9 << "-1" << i % 10 << ","
+          << (i + 1 < kRows ? std::to_string(i) : "0.5") << "\n";
+    }
+  }
+  auto driver = DataDirverFactory::getDriver("CSV", "test address");
+  auto& cursor = driver->read(file_path);
+  auto expect_types = [](const std::shared_ptr<arrow::Schema>& schema) {
+    ASSERT_EQ(schema->num_fields(), 2);
+    EXPECT_EQ(schema->field(0)->type()->id(), arrow::Type::TIMESTAMP);
+    EXPECT_EQ(schema->field(1)->type()->id(), arrow::Type::DOUBLE);
+  };
+
+  auto ds = cursor->read();
+  ASSERT_NE(ds, nullptr);
+  auto table = std::get<std::shared_ptr<arrow::Table>>(ds->data);
+  EXPECT_EQ(table->num_rows(), kRows);
+  expect_types(table->schema());
+
+  ds = cursor->read(10, 5);
+  ASSERT_NE(ds, nullptr);
+  expect_types(std::get<std::shared_ptr<arrow::Table>>(ds->data)->schema());
+
+  auto maybe_reader = cursor->readStream({});
+  ASSERT_TRUE(maybe_reader.ok());
+  expect_types((*maybe_reader)->schema());
+
+  std::shared_ptr<arrow::Schema> schema;
+  int64_t num_rows = 0;
+  ASSERT_EQ(cursor->readMeta(&schema, &num_rows), 0);
+  EXPECT_EQ(num_rows, kRows);
+  expect_types(schema);
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+TEST(CSVCursorTest, read_meta) {
+  auto file_path = WriteCursorTestCSV(false);
+  auto driver = DataDirverFactory::getDriver("CSV", "test address");
+  auto& cursor = driver->read(file_path);
+  std::shared_ptr<arrow::Schema> schema;
+  int64_t num_rows = 0;
+  ASSERT_EQ(cursor->readMeta(&schema, &num_rows), 0);
+  EXPECT_EQ(num_rows, kCursorTestRows);
+  ASSERT_EQ(schema->num_fields(), 2);
+  EXPECT_EQ(schema->field(0)->name(), "id");
+  EXPECT_EQ(schema->field(1)->type()->id(), arrow::Type::INT64);
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+TEST(CSVCursorTest, read_meta_file_schema) {
+  // blank lines are not rows, and the value column only turns double in
+  // the last row, past the first block but within the sampled ones.
+  std::string file_path = "/tmp/csv_cursor_meta_schema_test.csv";
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  constexpr int64_t kRows = 300000;
+  {
+    std::ofstream out(file_path);
+    out << "id,value\r\n\r\n";
+    for (int64_t i = 0; i < kRows; i++) {
+      out << i << "," << (i + 1 < kRows ? std::to_string(i) : "0.5") << "\n";
+      if (i % 1000 == 0) {
+        out << "\n";
+      }
+    }
+    out << "\r\n";
+  }
+  auto driver = DataDirverFactory::getDriver("CSV", "test address");
+  auto& cursor = driver->read(file_path);
+  std::shared_ptr<arrow::Schema> schema;
+  int64_t num_rows = 0;
+  ASSERT_EQ(cursor->readMeta(&schema, &num_rows), 0);
+  EXPECT_EQ(num_rows, kRows);
+  ASSERT_EQ(schema->num_fields(), 2);
+  EXPECT_EQ(schema->field(0)->type()->id(), arrow::Type::INT64);
+  EXPECT_EQ(schema->field(1)->type()->id(), arrow::Type::DOUBLE);
+
+  // a new cursor reuses both sidecar files.
+  EXPECT_TRUE(std::ifstream(CSVCursor::schemaPath(file_path)).good());
+  EXPECT_TRUE(std::ifstream(CSVRowIndex::indexPath(file_path)).good());
+  auto& reopened = driver->read(file_path);
+  std::shared_ptr<arrow::Schema> cached_schema;
+  ASSERT_EQ(reopened->readMeta(&cached_schema, &num_rows), 0);
+  EXPECT_EQ(num_rows, kRows);
+  EXPECT_TRUE(cached_schema->Equals(*schema));
+
+  // the cached schema is stale once the file changes.
+  {
+    std::ofstream out(file_path, std::ios::app);
+    out << "x,y\n";
+  }
+  auto& changed = driver->read(file_path);
+  ASSERT_EQ(changed->readMeta(&schema, &num_rows), 0);
+  EXPECT_EQ(num_rows, kRows + 1);
+  EXPECT_EQ(schema->field(0)->type()->id(), arrow::Type::STRING);
+  std::remove(CSVRowIndex::indexPath(file_path).c_str());
+  std::remove(CSVCursor::schemaPath(file_path).c_str());
+  std::remove(file_path.c_str());
+}
+
+}  // namespace primihub
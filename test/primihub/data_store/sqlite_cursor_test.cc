@@ -0,0 +1,169 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "SQLiteCpp/SQLiteCpp.h"
+#include "src/primihub/data_store/factory.h"
+
+namespace primihub {
+
+// more than the 64K rows of one batch of the sqlite reader.
+constexpr int64_t kSQLiteTestRows = 70000;
+
+// Rows i of table "t" hold (i, "n<i>", i / 2.0), the score of every 1000th
+// row is null.
+std::string WriteSQLiteTestDB() {
+  std::string db_path = "/tmp/sqlite_cursor_test.db";
+  std::remove(db_path.c_str());
+  SQLite::Database db(db_path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  db.exec("create table t (id INTEGER, name TEXT, score DOUBLE)");
+  db.exec("insert into t with recursive c(x) as (select 0 union all "
+          "select x + 1 from c where x < " +
+          std::to_string(kSQLiteTestRows - 1) +
+          ") select x, 'n' || x, case when x % 1000 = 0 then null "
+          "else x / 2.0 end from c");
+  return db_path;
+}
+
+TEST(SQLiteCursorTest, read_stream) {
+  auto db_path = WriteSQLiteTestDB();
+  auto driver = DataDirverFactory::getDriver("SQLITE", "test address");
+  auto& cursor = driver->read("SQLITE#" + db_path + "#t#");
+  ASSERT_NE(cursor, nullptr);
+
+  auto maybe_reader = cursor->readStream({"score", "id"});
+  ASSERT_TRUE(maybe_reader.ok());
+  auto reader = *maybe_reader;
+  ASSERT_EQ(reader->schema()->num_fields(), 2);
+  EXPECT_EQ(reader->schema()->field(0)->type()->id(), arrow::Type::DOUBLE);
+  EXPECT_EQ(reader->schema()->field(1)->type()->id(), arrow::Type::INT64);
+
+  int64_t num_rows = 0;
+  int64_t num_batches = 0;
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (true) {
+    ASSERT_TRUE(reader->ReadNext(&batch).ok());
+    if (batch == nullptr) {
+      break;
+    }
+    auto scores = std::static_pointer_cast<arrow::DoubleArray>(batch->column(0));
+    auto ids = std::static_pointer_cast<arrow::Int64Array>(batch->column(1));
+    for (int64_t i = 0; i < batch->num_rows(); i++) {
+      int64_t id = num_rows + i;
+      ASSERT_EQ(ids->Value(i), id);
+      ASSERT_EQ(scores->IsNull(i), id % 1000 == 0);
+      if (!scores->IsNull(i)) {
+        ASSERT_EQ(scores->Value(i), id / 2.0);
+      }
+    }
+    num_rows += batch->num_rows();
+    num_batches++;
+  }
+  EXPECT_EQ(num_rows, kSQLiteTestRows);
+  EXPECT_EQ(num_batches, 2);
+  // the reader stays at the end.
+  ASSERT_TRUE(reader->ReadNext(&batch).ok());
+  EXPECT_EQ(batch, nullptr);
+
+  maybe_reader = cursor->readStream({});
+  ASSERT_TRUE(maybe_reader.ok());
+  ASSERT_EQ((*maybe_reader)->schema()->num_fields(), 3);
+  EXPECT_EQ((*maybe_reader)->schema()->field(1)->type()->id(),
+            arrow::Type::STRING);
+  ASSERT_TRUE((*maybe_reader)->ReadNext(&batch).ok());
+  ASSERT_NE(batch, nullptr);
+  auto names = std::static_pointer_cast<arrow::StringArray>(batch->column(1));
+  EXPECT_EQ(names->GetString(7), "n7");
+
+  EXPECT_FALSE(cursor->readStream({"missing"}).ok());
+  std::remove(db_path.c_str());
+}
+
+TEST(SQLiteCursorTest, read_expression_columns) {
+  // the first row of "half" is null, of "label" text and of "next" an
+  // integer, none of them has a declared type.
+  auto db_path = WriteSQLiteTestDB();
+  auto driver = DataDirverFactory::getDriver("SQLITE", "test address");
+  auto& cursor = driver->read(
+      "SQLITE#" + db_path + "#t#id + 1 as next, score / 2 as half, "
+      "'r' || id as label, name");
+  ASSERT_NE(cursor, nullptr);
+
+  auto maybe_reader = cursor->readStream({});
+  ASSERT_TRUE(maybe_reader.ok());
+  auto stream_schema = (*maybe_reader)->schema();
+  ASSERT_EQ(stream_schema->num_fields(), 4);
+  EXPECT_EQ(stream_schema->field(0)->type()->id(), arrow::Type::INT64);
+  EXPECT_EQ(stream_schema->field(1)->type()->id(), arrow::Type::STRING);
+  EXPECT_EQ(stream_schema->field(2)->type()->id(), arrow::Type::STRING);
+  EXPECT_EQ(stream_schema->field(3)->type()->id(), arrow::Type::STRING);
+  // the row stepped for the types is the first of the stream.
+  std::shared_ptr<arrow::RecordBatch> batch;
+  ASSERT_TRUE((*maybe_reader)->ReadNext(&batch).ok());
+  ASSERT_NE(batch, nullptr);
+  auto next = std::static_pointer_cast<arrow::Int64Array>(batch->column(0));
+  EXPECT_EQ(next->Value(0), 1);
+  EXPECT_TRUE(batch->column(1)->IsNull(0));
+
+  // read, readStream and readMeta share the names and types.
+  auto ds = cursor->read();
+  ASSERT_NE(ds, nullptr);
+  auto table = std::get<std::shared_ptr<arrow::Table>>(ds->data);
+  EXPECT_EQ(table->num_rows(), kSQLiteTestRows);
+  EXPECT_TRUE(table->schema()->Equals(*stream_schema));
+  std::shared_ptr<arrow::Schema> meta_schema;
+  int64_t num_rows = 0;
+  ASSERT_EQ(cursor->readMeta(&meta_schema, &num_rows), 0);
+  EXPECT_TRUE(meta_schema->Equals(*stream_schema));
+  std::remove(db_path.c_str());
+}
+
+TEST(SQLiteCursorTest, read_meta) {
+  auto db_path = WriteSQLiteTestDB();
+  auto driver = DataDirverFactory::getDriver("SQLITE", "test address");
+  auto& cursor = driver->read("SQLITE#" + db_path + "#t#");
+  ASSERT_NE(cursor, nullptr);
+  std::shared_ptr<arrow::Schema> schema;
+  int64_t num_rows = 0;
+  ASSERT_EQ(cursor->readMeta(&schema, &num_rows), 0);
+  EXPECT_EQ(num_rows, kSQLiteTestRows);
+  ASSERT_EQ(schema->num_fields(), 3);
+  EXPECT_EQ(schema->field(0)->name(), "id");
+  EXPECT_EQ(schema->field(0)->type()->id(), arrow::Type::INT64);
+  EXPECT_EQ(schema->field(1)->type()->id(), arrow::Type::STRING);
+  EXPECT_EQ(schema->field(2)->type()->id(), arrow::Type::DOUBLE);
+
+  // the count wraps the query, a column subset counts the same rows and an
+  // expression without a declared type takes the type of its first value.
+  auto& subset = driver->read("SQLITE#" + db_path + "#t#score, id + 1 as next");
+  ASSERT_NE(subset, nullptr);
+  ASSERT_EQ(subset->readMeta(&schema, &num_rows), 0);
+  EXPECT_EQ(num_rows, kSQLiteTestRows);
+  ASSERT_EQ(schema->num_fields(), 2);
+  EXPECT_EQ(schema->field(0)->name(), "score");
+  EXPECT_EQ(schema->field(1)->name(), "next");
+  EXPECT_EQ(schema->field(1)->type()->id(), arrow::Type::INT64);
+
+  auto& missing = driver->read("SQLITE#" + db_path + "#no_table#");
+  ASSERT_NE(missing, nullptr);
+  EXPECT_NE(missing->readMeta(&schema, &num_rows), 0);
+  std::remove(db_path.c_str());
+}
+
+}  // namespace primihub
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <ctime>
 #include <exception>
@@ -282,3 +284,202 @@ TEST(mpc_express_executor, i64_executor_test) {
     }
   }
 }
+
+// Evaluate expr over local columns, every column belongs to party 0.
+template <typename T>
+static int runLocalExpress(const std::string &express,
+                           std::map<std::string, bool> col_and_dtype,
+                           std::map<std::string, std::vector<T>> col_and_val,
+                           std::vector<T> &final_val, bool *fp64_run) {
+  MPCExpressExecutor mpc_exec;
+  mpc_exec.initColumnConfig(0);
+  for (auto &pair : col_and_dtype) {
+    mpc_exec.importColumnOwner(pair.first, 0);
+    mpc_exec.importColumnDtype(pair.first, pair.second);
+  }
+  if (mpc_exec.importExpress(express) || mpc_exec.resolveRunMode())
+    return -1;
+  *fp64_run = mpc_exec.isFP64RunMode();
+
+  LocalExpressExecutor local_exec(&mpc_exec);
+  local_exec.init(col_and_val);
+  int ret = local_exec.runLocalEvaluate();
+  local_exec.getFinalVal(final_val);
+  return ret;
+}
+
+TEST(local_express_executor, constant_folding) {
+  std::vector<int64_t> col_a = {3, -7, 0, 11};
+  std::vector<int64_t> col_b = {2, 5, -4, 1};
+  std::vector<int64_t> i64_val;
+  bool fp64_run = true;
+  ASSERT_EQ(runLocalExpress<int64_t>("(2+3)*A-B*(4-1)+2*3",
+                                     {{"A", false}, {"B", false}},
+                                     {{"A", col_a}, {"B", col_b}}, i64_val,
+                                     &fp64_run),
+            0);
+  EXPECT_FALSE(fp64_run);
+  ASSERT_EQ(i64_val.size(), col_a.size());
+  for (size_t i = 0; i < col_a.size(); i++)
+    EXPECT_EQ(i64_val[i], (2 + 3) * col_a[i] - col_b[i] * (4 - 1) + 2 * 3);
+
+  // A '/' between constants is folded in FP64.
+  std::vector<double> col_c = {1.5, -2.25, 8.0, 0.0};
+  std::vector<double> fp64_val;
+  ASSERT_EQ(runLocalExpress<double>("A*(2.5-1)-9/4", {{"A", true}},
+                                    {{"A", col_c}}, fp64_val, &fp64_run),
+            0);
+  EXPECT_TRUE(fp64_run);
+  ASSERT_EQ(fp64_val.size(), col_c.size());
+  for (size_t i = 0; i < col_c.size(); i++)
+    EXPECT_DOUBLE_EQ(fp64_val[i], col_c[i] * (2.5 - 1) - 9.0 / 4);
+
+  // Nothing is left to evaluate per row.
+  fp64_val.clear();
+  EXPECT_NE(runLocalExpress<double>("2*3+1.5", {{"A", true}},
+                                    {{"A", col_c}}, fp64_val, &fp64_run),
+            0);
+}
+
+TEST(local_express_executor, mixed_dtype_columns) {
+  // A is an I64 column, B a FP64 one, so the express runs in FP64 and the
+  // values of A are fed as double.
+  std::vector<double> col_a = {4, -3, 10, 0, 7};
+  std::vector<double> col_b = {0.5, 1.25, -2.0, 3.75, -0.125};
+  std::vector<double> final_val;
+  bool fp64_run = false;
+  ASSERT_EQ(runLocalExpress<double>("A*B+A-B*B-2",
+                                    {{"A", false}, {"B", true}},
+                                    {{"A", col_a}, {"B", col_b}}, final_val,
+                                    &fp64_run),
+            0);
+  EXPECT_TRUE(fp64_run);
+  ASSERT_EQ(final_val.size(), col_a.size());
+  for (size_t i = 0; i < col_a.size(); i++)
+    EXPECT_DOUBLE_EQ(final_val[i],
+                     col_a[i] * col_b[i] + col_a[i] - col_b[i] * col_b[i] - 2);
+}
+
+TEST(local_express_executor, no_i64_division) {
+  // Integer division is never evaluated, a '/' over I64 columns switches
+  // the run mode to FP64.
+  std::vector<double> col_a = {7, -9, 1};
+  std::vector<double> col_b = {2, 4, -8};
+  std::vector<double> final_val;
+  bool fp64_run = false;
+  ASSERT_EQ(runLocalExpress<double>("A/B", {{"A", false}, {"B", false}},
+                                    {{"A", col_a}, {"B", col_b}}, final_val,
+                                    &fp64_run),
+            0);
+  EXPECT_TRUE(fp64_run);
+  ASSERT_EQ(final_val.size(), col_a.size());
+  EXPECT_DOUBLE_EQ(final_val[0], 3.5);
+  EXPECT_DOUBLE_EQ(final_val[1], -2.25);
+  EXPECT_DOUBLE_EQ(final_val[2], -0.125);
+}
+
+TEST(local_express_executor, block_boundary) {
+  // Row counts around the block size of the local program.
+  for (size_t count : {2047, 2048, 2049, 4097}) {
+    std::vector<int64_t> col_a(count);
+    std::vector<int64_t> col_b(count);
+    std::vector<int64_t> col_c(count);
+    for (size_t i = 0; i < count; i++) {
+      col_a[i] = static_cast<int64_t>(i) - 1000;
+      col_b[i] = static_cast<int64_t>(i % 97) * 3 - 50;
+      col_c[i] = static_cast<int64_t>(i % 13);
+    }
+
+    std::vector<int64_t> final_val;
+    bool fp64_run = true;
+    ASSERT_EQ(runLocalExpress<int64_t>(
+                  "A*B-C*(A+B)+A*2-C",
+                  {{"A", false}, {"B", false}, {"C", false}},
+                  {{"A", col_a}, {"B", col_b}, {"C", col_c}}, final_val,
+                  &fp64_run),
+              0);
+    EXPECT_FALSE(fp64_run);
+    ASSERT_EQ(final_val.size(), count);
+    for (size_t i = 0; i < count; i++) {
+      int64_t a = col_a[i], b = col_b[i], c = col_c[i];
+      ASSERT_EQ(final_val[i], a * b - c * (a + b) + a * 2 - c)
+          << "row " << i << " of " << count;
+    }
+  }
+}
+
+namespace {
+// A*B appears three times, once with commuted operands, and both the
+// division and the last multiplication run at depth 2.
+const char kSharedExpress[] = "A*B+B*A-(A*B)/C+(B*A)*C";
+const std::vector<double> kSharedA = {1.5, -2.0, 3.25, 0.5, 4.0};
+const std::vector<double> kSharedB = {2.0, 1.5, -0.75, -3.0, 0.25};
+const std::vector<double> kSharedC = {1.0, 2.5, -4.0, 0.5, 3.0};
+
+void runSharedExpressParty(u32 party_id, uint16_t next_port,
+                           uint16_t prev_port) {
+  std::map<std::string, u32> col_and_owner = {{"A", 0}, {"B", 1}, {"C", 2}};
+  std::map<std::string, bool> col_and_dtype = {
+      {"A", true}, {"B", true}, {"C", true}};
+  std::map<std::string, std::vector<double>> col_and_val;
+  if (party_id == 0)
+    col_and_val["A"] = kSharedA;
+  else if (party_id == 1)
+    col_and_val["B"] = kSharedB;
+  else
+    col_and_val["C"] = kSharedC;
+
+  MPCExpressExecutor mpc_exec;
+  mpc_exec.initColumnConfig(party_id);
+  importColumnOwner(&mpc_exec, col_and_owner);
+  importColumnDtype(&mpc_exec, col_and_dtype);
+  ASSERT_EQ(mpc_exec.importExpress(kSharedExpress), 0);
+  ASSERT_EQ(mpc_exec.resolveRunMode(), 0);
+  mpc_exec.InitFeedDict();
+  importColumnValues(&mpc_exec, col_and_val);
+
+  mpc_exec.initMPCRuntime(party_id, "127.0.0.1", "127.0.0.1", next_port,
+                          prev_port);
+  ASSERT_EQ(mpc_exec.runMPCEvaluate(), 0);
+  std::vector<uint32_t> parties = {0, 1, 2};
+  std::vector<double> final_val;
+  mpc_exec.revealMPCResult(parties, final_val);
+
+  ASSERT_EQ(final_val.size(), kSharedA.size());
+  for (size_t i = 0; i < final_val.size(); i++) {
+    double a = kSharedA[i], b = kSharedB[i], c = kSharedC[i];
+    double expect = a * b + b * a - (a * b) / c + (b * a) * c;
+    // the division is an approximation in fixed point.
+    EXPECT_NEAR(final_val[i], expect, 1e-2 * std::max(1.0, std::fabs(expect)))
+        << "row " << i;
+  }
+}
+}  // namespace
+
+TEST(mpc_express_executor, shared_subexpress_test) {
+  pid_t pid = fork();
+  if (pid != 0) {
+    // Parent process as party 0.
+    runSharedExpressParty(0, 10110, 10120);
+    int status;
+    waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    return;
+  }
+
+  pid = fork();
+  if (pid != 0) {
+    // Child process as party 1.
+    sleep(1);
+    runSharedExpressParty(1, 10130, 10110);
+    int status;
+    waitpid(pid, &status, 0);
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    exit(ok && !::testing::Test::HasFailure() ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  // Grandchild process as party 2.
+  sleep(2);
+  runSharedExpressParty(2, 10120, 10130);
+  exit(::testing::Test::HasFailure() ? EXIT_FAILURE : EXIT_SUCCESS);
+}
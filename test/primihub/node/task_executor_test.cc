@@ -0,0 +1,93 @@
+// Copyright [2022] <primihub.com>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/primihub/node/task_executor.h"
+
+using primihub::TaskClass;
+using primihub::TaskExecutor;
+using primihub::TaskExecutorOptions;
+
+TEST(TaskExecutorTest, RejectDuplicate) {
+  TaskExecutor executor;
+  std::unique_ptr<TaskExecutor::Slot> slot;
+  EXPECT_EQ(executor.admit("job0task0", TaskClass::PSI_SERVER, 0, &slot),
+            TaskExecutor::Admission::ADMITTED);
+  EXPECT_TRUE(executor.isRunning("job0task0"));
+  std::unique_ptr<TaskExecutor::Slot> dup_slot;
+  EXPECT_EQ(executor.admit("job0task0", TaskClass::PSI_SERVER, 0, &dup_slot),
+            TaskExecutor::Admission::DUPLICATE);
+  slot.reset();
+  EXPECT_FALSE(executor.isRunning("job0task0"));
+}
+
+TEST(TaskExecutorTest, LimitPerClass) {
+  TaskExecutorOptions options;
+  options.class_limits = {{1, 1, 2, 1}};
+  options.max_wait = std::chrono::milliseconds(50);
+  TaskExecutor executor(options);
+
+  std::unique_ptr<TaskExecutor::Slot> a, b, c, d;
+  EXPECT_EQ(executor.admit("a", TaskClass::PSI_SERVER, 0, &a),
+            TaskExecutor::Admission::ADMITTED);
+  EXPECT_EQ(executor.admit("b", TaskClass::PSI_SERVER, 0, &b),
+            TaskExecutor::Admission::ADMITTED);
+  // the limit of psi is reached, other classes are not affected
+  EXPECT_EQ(executor.admit("c", TaskClass::PSI_SERVER, 0, &c),
+            TaskExecutor::Admission::BUSY);
+  EXPECT_EQ(executor.admit("d", TaskClass::PIR_SERVER, 0, &d),
+            TaskExecutor::Admission::ADMITTED);
+  EXPECT_EQ(executor.numRunning(TaskClass::PSI_SERVER), 2u);
+}
+
+TEST(TaskExecutorTest, QueueByPriority) {
+  TaskExecutorOptions options;
+  options.class_limits = {{1, 1, 1, 1}};
+  TaskExecutor executor(options);
+
+  auto running = std::make_unique<std::unique_ptr<TaskExecutor::Slot>>();
+  ASSERT_EQ(executor.admit("first", TaskClass::WORKER, 0, running.get()),
+            TaskExecutor::Admission::ADMITTED);
+
+  std::vector<std::string> order;
+  std::mutex order_mtx;
+  auto run = [&](const std::string& name, int priority) {
+    std::unique_ptr<TaskExecutor::Slot> slot;
+    if (executor.admit(name, TaskClass::WORKER, priority, &slot) ==
+        TaskExecutor::Admission::ADMITTED) {
+      std::lock_guard<std::mutex> lck(order_mtx);
+      order.push_back(name);
+    }
+  };
+  std::thread low(run, "low", 0);
+  while (executor.numQueued() < 1) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::thread high(run, "high", 10);
+  while (executor.numQueued() < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  running.reset();
+  low.join();
+  high.join();
+  ASSERT_EQ(order.size(), 2u);
+  EXPECT_EQ(order[0], "high");
+  EXPECT_EQ(order[1], "low");
+}
+
+TEST(TaskExecutorTest, RejectWhenQueueFull) {
+  TaskExecutorOptions options;
+  options.class_limits = {{1, 1, 1, 1}};
+  options.max_queued = 0;
+  TaskExecutor executor(options);
+  std::unique_ptr<TaskExecutor::Slot> a, b;
+  EXPECT_EQ(executor.admit("a", TaskClass::WORKER, 0, &a),
+            TaskExecutor::Admission::ADMITTED);
+  EXPECT_EQ(executor.admit("b", TaskClass::WORKER, 0, &b),
+            TaskExecutor::Admission::BUSY);
+}
@@ -35,6 +35,9 @@ int main() {
 
   CrtMod* crtmod;
   init_crt(&crtmod, max_dimension, 70);
+  CrtBasis* basis;
+  init_crt_basis(&basis, crtmod);
+  ll* vals1 = (ll*)malloc(sizeof(ll) * max_dimension);
   char** nums1;
   char** nums2;
   char** test;
@@ -53,6 +56,7 @@ int main() {
         nums1[j] = (char*)malloc(sizeof(char) * 32);
         long long cur1 = u(e);
         sprintf(nums1[j], "%lld", cur1);
+        vals1[j] = cur1;
         // std::cout << nums1[j] << std::endl;
 
         nums2[j] = (char*)malloc(sizeof(char) * 32);
@@ -67,6 +71,19 @@ int main() {
       mpz_init(pack);
       data_packing_crt(pack, nums1, data_size, crtmod);
 
+      mpz_t pack_ll;
+      mpz_init(pack_ll);
+      data_packing_crt_ll(pack_ll, vals1, data_size, crtmod, basis);
+      data_retrieve_crt(test, pack_ll, crtmod, data_size);
+      for (size_t j = 0; j < data_size; ++j) {
+        if (strcmp(test[j], nums1[j])) {
+          std::cout << "error" << std::endl;
+        }
+        free(test[j]);
+      }
+      free(test);
+      mpz_clear(pack_ll);
+
       auto e_st = std::chrono::high_resolution_clock::now();
       opt_paillier_encrypt_crt_fb(cipher_test, pub, prv, pack);
       auto e_ed = std::chrono::high_resolution_clock::now();
@@ -136,6 +153,9 @@ int main() {
   }
 
 
+  free(vals1);
+  free_crt_basis(basis);
+  free_crt(crtmod);
   opt_paillier_freepubkey(pub);
   opt_paillier_freeprvkey(prv);
 
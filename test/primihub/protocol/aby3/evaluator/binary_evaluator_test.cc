@@ -50,7 +50,7 @@ std::array<Matrix<i64>, 3> getShares(sbMatrix &S, Sh3Runtime &rt,
 void Sh3_BinaryEngine_test(
     BetaCircuit *cir,
     std::function<fp<i64, D8>(fp<i64, D8>, fp<i64, D8>)> binOp, bool debug,
-    std::string opName, u64 valMask = ~0ull) {
+    std::string opName, u64 valMask = ~0ull, double bValue = -10.5) {
   IOService ios;
   Session s01(ios, "127.0.0.1", SessionMode::Server, "01");
   Session s10(ios, "127.0.0.1", SessionMode::Client, "01");
@@ -121,7 +121,7 @@ void Sh3_BinaryEngine_test(
     f64Matrix<D8> aa(width, 1), bb(width, 1);
     for (u64 i = 0; i < a.size(); ++i) {
       a(i) = 2.1 + 10 * i;
-      b(i) = -10.5;
+      b(i) = bValue;
     }
     ar(0) = prng.get<i64>();
     LOG(INFO) << "partyID: " << pIdx << "============> a: " << a << a.i64Cast();
@@ -311,4 +311,32 @@ TEST(BinaryEvaluatorTest, Sh3_BinaryEngine_add_msb_test) {
   Sh3_BinaryEngine_test(cir, func, true, "msb", mask);
   //   Sh3_BinaryEngine_test(cir, func, false, "msb", mask);
 }
+
+// int_int_lt_build borrows through Or gates, which came out as !a & b.
+TEST(BinaryEvaluatorTest, Sh3_BinaryEngine_lt_test) {
+  BetaLibrary lib;
+  u64 size = 64;
+  std::function<i64(fp<i64, D8>, fp<i64, D8>)> func =
+      [](fp<i64, D8> a, fp<i64, D8> b) { return a.mValue < b.mValue; };
+  BetaCircuit *cir = lib.int_int_lt(size, size);
+
+  // a is 2.1 and 12.1, so b = 7 takes both sides.
+  Sh3_BinaryEngine_test(cir, func, true, "lt", ~0ull, -10.5);
+  Sh3_BinaryEngine_test(cir, func, true, "lt", ~0ull, 7);
+}
+
+TEST(BinaryEvaluatorTest, Sh3_BinaryEngine_or_test) {
+  u64 size = 64;
+  BetaCircuit cir;
+  BetaBundle a(size), b(size), c(1);
+  cir.addInputBundle(a);
+  cir.addInputBundle(b);
+  cir.addOutputBundle(c);
+  // The low bit is set in a and clear in b.
+  cir.addGate(a.mWires[0], b.mWires[0], GateType::Or, c.mWires[0]);
+
+  std::function<i64(fp<i64, D8>, fp<i64, D8>)> func =
+      [](fp<i64, D8> a, fp<i64, D8> b) { return (a.mValue | b.mValue) & 1; };
+  Sh3_BinaryEngine_test(&cir, func, true, "or");
+}
 } // namespace primihub
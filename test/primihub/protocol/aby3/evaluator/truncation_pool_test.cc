@@ -0,0 +1,64 @@
+// Copyright [2022] <primihub.com>
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/primihub/protocol/aby3/evaluator/truncation_pool.h"
+
+namespace primihub {
+
+namespace {
+// Take values in batches of uneven sizes, some of them cross chunks.
+void takeValues(Sh3TruncationPool& pool, u64 total, std::vector<i64>& next,
+                std::vector<i64>& prev) {
+  next.resize(total);
+  prev.resize(total);
+  u64 offset = 0, batch = 1;
+  while (offset < total) {
+    u64 n = std::min(batch, total - offset);
+    pool.get(next.data() + offset, prev.data() + offset, n);
+    offset += n;
+    batch = batch * 3 + 7;
+  }
+}
+}  // namespace
+
+// Values of a pool don't depend on whether they were preprocessed, made in
+// background or made on the online path, the two parties sharing a key
+// get the same stream.
+TEST(Sh3TruncationPool, same_stream_offline_and_online) {
+  block prevKey = toBlock(1, 2), nextKey = toBlock(3, 4);
+  const u64 total = 5 * Sh3TruncationPool::kChunkSize + 123;
+
+  Sh3TruncationPool online;
+  online.init(prevKey, nextKey);
+  std::vector<i64> next0, prev0;
+  takeValues(online, total, next0, prev0);
+  auto stats = online.getStats();
+  EXPECT_EQ(stats.mPooled, 0);
+  EXPECT_EQ(stats.mInline, 6 * Sh3TruncationPool::kChunkSize);
+
+  Sh3TruncationPool offline;
+  offline.init(prevKey, nextKey, 2 * Sh3TruncationPool::kChunkSize);
+  offline.fill(total);
+  offline.start();
+  std::vector<i64> next1, prev1;
+  takeValues(offline, total, next1, prev1);
+  offline.stop();
+  EXPECT_GE(offline.getStats().mPooled, 2 * Sh3TruncationPool::kChunkSize);
+
+  EXPECT_EQ(next0, next1);
+  EXPECT_EQ(prev0, prev1);
+
+  // The next party uses nextKey as its prevKey.
+  Sh3TruncationPool peer;
+  peer.init(nextKey, toBlock(5, 6));
+  peer.start();
+  std::vector<i64> next2, prev2;
+  takeValues(peer, total, next2, prev2);
+  EXPECT_EQ(next0, prev2);
+  EXPECT_NE(prev0, prev2);
+}
+
+}  // namespace primihub
@@ -0,0 +1,114 @@
+// Copyright [2022] <primihub.com>
+#include <climits>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/primihub/protocol/falcon-public/RSSPlanes.h"
+
+namespace primihub {
+namespace falcon {
+
+namespace {
+
+RSSVectorMyType randomShares(size_t size, std::mt19937* gen) {
+  RSSVectorMyType vec(size);
+  for (auto& v : vec)
+    v = std::make_pair((myType)(*gen)(), (myType)(*gen)());
+  return vec;
+}
+
+}  // namespace
+
+// Sizes around the 8 lane width of the vector loops.
+const size_t kPlaneSizes[] = {0, 1, 7, 8, 9, 16, 33};
+
+TEST(RSSPlanes, dot_product_matches_scalar) {
+  std::mt19937 gen(1);
+  for (size_t size : kPlaneSizes) {
+    RSSVectorMyType a = randomShares(size, &gen);
+    RSSVectorMyType b = randomShares(size, &gen);
+    RSSPlanes planes_a, planes_b;
+    planes_a.fromVector(a);
+    planes_b.fromVector(b);
+
+    std::vector<myType> c(size);
+    dotProductPlanes(planes_a, planes_b, c.data());
+    for (size_t i = 0; i < size; ++i) {
+      myType expect = a[i].first * b[i].first + a[i].first * b[i].second +
+                      a[i].second * b[i].first;
+      EXPECT_EQ(c[i], expect) << "size " << size << " index " << i;
+    }
+  }
+}
+
+TEST(RSSPlanes, mat_mul_matches_scalar) {
+  // MATMUL_BLOCK_K is 128 and MATMUL_BLOCK_N is 256, the shapes below
+  // end inside a block, on a block edge and one past it.
+  const size_t shapes[][3] = {
+      {1, 1, 1}, {3, 5, 7}, {5, 1, 9}, {2, 128, 256},
+      {3, 130, 257}, {4, 129, 17}, {7, 9, 263},
+  };
+  std::mt19937 gen(2);
+  for (const auto& shape : shapes) {
+    size_t rows = shape[0], common_dim = shape[1], columns = shape[2];
+    for (size_t transpose = 0; transpose < 2; ++transpose) {
+      RSSVectorMyType a = randomShares(rows * common_dim, &gen);
+      RSSVectorMyType b = randomShares(common_dim * columns, &gen);
+      RSSPlanes planes_a, planes_b;
+      planes_a.fromMatrix(a, rows, common_dim, transpose);
+      planes_b.fromMatrix(b, common_dim, columns, transpose);
+
+      std::vector<myType> c(rows * columns);
+      matMulPlanes(planes_a, planes_b, c.data(), rows, common_dim, columns);
+      for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < columns; ++j) {
+          myType expect = 0;
+          for (size_t k = 0; k < common_dim; ++k) {
+            const RSSMyType& x = transpose ? a[k * rows + i]
+                                           : a[i * common_dim + k];
+            const RSSMyType& y = transpose ? b[j * common_dim + k]
+                                           : b[k * columns + j];
+            expect += x.first * y.first + x.first * y.second +
+                      x.second * y.first;
+          }
+          ASSERT_EQ(c[i * columns + j], expect)
+              << rows << "x" << common_dim << "x" << columns
+              << " transpose " << transpose << " at " << i << "," << j;
+        }
+      }
+    }
+  }
+}
+
+TEST(RSSPlanes, divide_pow2_matches_signed_division) {
+  std::mt19937 gen(3);
+  for (size_t size : kPlaneSizes) {
+    for (size_t power : {0, 1, 13, 30}) {
+      std::vector<myType> vec(size);
+      for (auto& v : vec)
+        v = (myType)gen();
+      // Fixed-point values that are exact multiples, one off a multiple
+      // and the extremes of the signed range.
+      const int32_t edges[] = {-1, 1, INT32_MIN, INT32_MAX,
+                               -(1 << 13), -(1 << 13) - 1, -(1 << 13) + 1};
+      for (size_t i = 0; i < size && i < sizeof(edges) / sizeof(edges[0]); ++i)
+        vec[size - 1 - i] = (myType)edges[i];
+
+      std::vector<myType> expect(vec);
+      for (auto& v : expect)
+        v = (myType)((int32_t)v / ((int32_t)1 << power));
+
+      dividePlainPow2(vec.data(), size, power);
+      for (size_t i = 0; i < size; ++i)
+        EXPECT_EQ((int32_t)vec[i], (int32_t)expect[i])
+            << "size " << size << " power " << power << " index " << i;
+    }
+  }
+}
+
+}  // namespace falcon
+}  // namespace primihub
@@ -0,0 +1,96 @@
+// Copyright [2022] <primihub.com>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/primihub/protocol/runtime.h"
+#include "src/primihub/protocol/work_stealing_pool.h"
+
+namespace primihub {
+
+TEST(WorkStealingPool, run_all_jobs) {
+  WorkStealingPool pool(3);
+  for (u64 n : {0, 1, 5, 1000}) {
+    std::vector<std::atomic<int>> counts(n);
+    for (auto& c : counts)
+      c = 0;
+    pool.run(n, [&](u64 i) { counts[i]++; });
+    for (auto& c : counts)
+      EXPECT_EQ(c, 1);
+  }
+
+  EXPECT_THROW(pool.run(10, [](u64 i) {
+    if (i == 7)
+      throw std::runtime_error("job failed");
+  }), std::runtime_error);
+}
+
+namespace {
+// Every branch is a local task followed by a round task, the order the
+// round tasks run in is what the peers see on the wire.
+std::vector<std::string> runBranches(u64 numWorkers, u64 numBranches) {
+  Runtime rt(0, nullptr);
+  rt.setWorkerNum(numWorkers);
+
+  std::vector<std::string> order;
+  std::vector<u64> values(numBranches, 0);
+  std::vector<ShTask> tasks;
+  ShTask dep = rt.noDependencies();
+  for (u64 b = 0; b < numBranches; ++b) {
+    tasks.push_back(dep
+        .thenLocal([&values, b]() {
+          for (u64 i = 0; i < 1000 * (b % 7 + 1); ++i)
+            values[b] += i * b;
+        })
+        .then([&order, &values, b](CommPkgBase*, ShTask& self) {
+          order.push_back("io" + std::to_string(b) + ":" +
+                          std::to_string(values[b]));
+          self.then([&order, b](ShTask&) {
+            order.push_back("done" + std::to_string(b));
+          });
+        })
+        .getClosure());
+  }
+  for (auto& t : tasks)
+    t.get();
+  EXPECT_EQ(rt.mTasks.size(), 0);
+  EXPECT_EQ(rt.mSched.mTasks.size(), 0);
+  return order;
+}
+}  // namespace
+
+TEST(Runtime, local_tasks_keep_round_order) {
+  auto serial = runBranches(0, 33);
+  ASSERT_EQ(serial.size(), 66);
+  EXPECT_EQ(runBranches(1, 33), serial);
+  EXPECT_EQ(runBranches(4, 33), serial);
+}
+
+TEST(Runtime, local_task_adds_no_round) {
+  Runtime rt(0, nullptr);
+  std::vector<std::string> order;
+  ShTask dep = rt.noDependencies();
+  auto first = dep.then([&order](CommPkgBase*, ShTask&) {
+    order.push_back("first");
+  });
+  auto direct = first.then([&order](CommPkgBase*, ShTask&) {
+    order.push_back("direct");
+  });
+  auto local = first
+      .thenLocal([&order]() { order.push_back("local"); })
+      .then([&order](CommPkgBase*, ShTask&) { order.push_back("after"); });
+
+  // The local task runs in the round of its dependency, so the round task
+  // after it is in the same round as one which depends on first directly.
+  rt.runOneRound();
+  EXPECT_EQ(order, std::vector<std::string>({"first", "local"}));
+  rt.runOneRound();
+  EXPECT_EQ(order,
+            std::vector<std::string>({"first", "local", "direct", "after"}));
+  EXPECT_TRUE(direct.isCompleted());
+  EXPECT_TRUE(local.isCompleted());
+}
+
+}  // namespace primihub
@@ -0,0 +1,126 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <arrow/api.h>
+
+#include "src/primihub/service/dataset/service.h"
+
+namespace primihub::service {
+
+TEST(FlightTicketTest, parse_ticket) {
+    std::string dataset_id;
+    std::vector<std::string> columns;
+    int64_t limit = 0;
+    ASSERT_TRUE(ParseFlightTicket("train", &dataset_id, &columns, &limit).ok());
+    EXPECT_EQ(dataset_id, "train");
+    EXPECT_TRUE(columns.empty());
+    EXPECT_EQ(limit, -1);
+
+    ASSERT_TRUE(ParseFlightTicket("train?columns=a,,b&limit=10", &dataset_id,
+                                  &columns, &limit).ok());
+    EXPECT_EQ(dataset_id, "train");
+    EXPECT_EQ(columns, std::vector<std::string>({"a", "b"}));
+    EXPECT_EQ(limit, 10);
+
+    columns.clear();
+    ASSERT_TRUE(ParseFlightTicket("train?limit=0", &dataset_id, &columns,
+                                  &limit).ok());
+    EXPECT_EQ(limit, 0);
+}
+
+TEST(FlightTicketTest, reject_bad_ticket) {
+    std::string dataset_id;
+    std::vector<std::string> columns;
+    int64_t limit = 0;
+    for (const std::string ticket :
+         {"train?limit=", "train?limit", "train?limit=-1", "train?limit=1x",
+          "train?limit=abc"}) {
+        auto status = ParseFlightTicket(ticket, &dataset_id, &columns, &limit);
+        EXPECT_TRUE(status.IsInvalid()) << ticket;
+    }
+    EXPECT_TRUE(ParseFlightTicket("train?rows=5", &dataset_id, &columns, &limit)
+                    .IsInvalid());
+    EXPECT_TRUE(ParseFlightTicket("train?columns=a&offset=5", &dataset_id,
+                                  &columns, &limit).IsInvalid());
+}
+
+namespace {
+// Batches of 10, 10 and 5 rows with the values 0 to 24.
+std::shared_ptr<arrow::RecordBatchReader> MakeTestBatchReader() {
+    auto schema = arrow::schema({arrow::field("id", arrow::int64())});
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    int64_t value = 0;
+    for (int64_t size : {10, 10, 5}) {
+        arrow::Int64Builder builder;
+        for (int64_t i = 0; i < size; i++) {
+            EXPECT_TRUE(builder.Append(value++).ok());
+        }
+        std::shared_ptr<arrow::Array> array;
+        EXPECT_TRUE(builder.Finish(&array).ok());
+        batches.push_back(arrow::RecordBatch::Make(schema, size, {array}));
+    }
+    auto maybe_table = arrow::Table::FromRecordBatches(batches);
+    EXPECT_TRUE(maybe_table.ok());
+    std::shared_ptr<arrow::Table> table = *maybe_table;
+    // keeps the table alive with the reader.
+    struct TableReader : public arrow::TableBatchReader {
+        explicit TableReader(std::shared_ptr<arrow::Table> table)
+            : arrow::TableBatchReader(*table), table_(std::move(table)) {}
+        std::shared_ptr<arrow::Table> table_;
+    };
+    return std::make_shared<TableReader>(table);
+}
+
+std::vector<int64_t> ReadLimited(int64_t limit) {
+    LimitedBatchReader reader(MakeTestBatchReader(), limit);
+    EXPECT_EQ(reader.schema()->field(0)->name(), "id");
+    std::vector<int64_t> values;
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (true) {
+        EXPECT_TRUE(reader.ReadNext(&batch).ok());
+        if (batch == nullptr) {
+            break;
+        }
+        auto ids = std::static_pointer_cast<arrow::Int64Array>(batch->column(0));
+        for (int64_t i = 0; i < ids->length(); i++) {
+            values.push_back(ids->Value(i));
+        }
+    }
+    return values;
+}
+}  // namespace
+
+TEST(LimitedBatchReaderTest, limit_rows) {
+    EXPECT_TRUE(ReadLimited(0).empty());
+
+    // ends inside the second batch.
+    std::vector<int64_t> values = ReadLimited(13);
+    ASSERT_EQ(values.size(), 13);
+    for (int64_t i = 0; i < 13; i++) {
+        EXPECT_EQ(values[i], i);
+    }
+
+    EXPECT_EQ(ReadLimited(10).size(), 10);
+    EXPECT_EQ(ReadLimited(25).size(), 25);
+    EXPECT_EQ(ReadLimited(100).size(), 25);
+}
+
+}  // namespace primihub::service
@@ -0,0 +1,103 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "src/primihub/task/semantic/pir_db_cache.h"
+
+namespace primihub::task {
+
+std::string WritePirCacheTestFile(int i, const std::string& content) {
+  std::string file_path = "/tmp/pir_db_cache_test_" + std::to_string(i) + ".csv";
+  std::ofstream out(file_path, std::ios::trunc);
+  out << content;
+  return file_path;
+}
+
+PIRDatabaseKey PirCacheTestKey(const std::string& dataset, size_t elem_size = 64) {
+  return PIRDatabaseKey{dataset, elem_size, 1, 4096, 0, true};
+}
+
+std::shared_ptr<PIRDatabaseEntry> PirCacheTestEntry(const std::string& dataset,
+                                                    size_t db_size) {
+  auto entry = std::make_shared<PIRDatabaseEntry>();
+  EXPECT_EQ(PIRDatabaseCache::datasetSignature(dataset,
+      &entry->dataset_size, &entry->dataset_mtime), 0);
+  entry->db_size = db_size;
+  return entry;
+}
+
+// remove the dataset, its cached databases are dropped on lookup.
+void RemovePirCacheTestFile(const std::string& dataset) {
+  std::remove(dataset.c_str());
+  EXPECT_EQ(PIRDatabaseCache::getInstance().get(PirCacheTestKey(dataset)),
+            nullptr);
+}
+
+TEST(PIRDatabaseCacheTest, key) {
+  auto& cache = PIRDatabaseCache::getInstance();
+  auto dataset = WritePirCacheTestFile(0, "a\n1\n");
+  cache.put(PirCacheTestKey(dataset), PirCacheTestEntry(dataset, 1));
+
+  auto entry = cache.get(PirCacheTestKey(dataset));
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->db_size, 1);
+  // a different element size needs another database.
+  EXPECT_EQ(cache.get(PirCacheTestKey(dataset, 128)), nullptr);
+  RemovePirCacheTestFile(dataset);
+}
+
+TEST(PIRDatabaseCacheTest, evict_least_recently_used) {
+  auto& cache = PIRDatabaseCache::getInstance();
+  std::vector<std::string> datasets;
+  for (size_t i = 0; i <= PIRDatabaseCache::kMaxCachedDatabase; i++) {
+    datasets.push_back(WritePirCacheTestFile(i, "a\n1\n"));
+  }
+  for (size_t i = 0; i < PIRDatabaseCache::kMaxCachedDatabase; i++) {
+    cache.put(PirCacheTestKey(datasets[i]), PirCacheTestEntry(datasets[i], i));
+  }
+  // dataset 0 is used again, dataset 1 is now the oldest.
+  ASSERT_NE(cache.get(PirCacheTestKey(datasets[0])), nullptr);
+  auto& last = datasets.back();
+  cache.put(PirCacheTestKey(last), PirCacheTestEntry(last, datasets.size()));
+
+  EXPECT_EQ(cache.get(PirCacheTestKey(datasets[1])), nullptr);
+  EXPECT_NE(cache.get(PirCacheTestKey(datasets[0])), nullptr);
+  EXPECT_NE(cache.get(PirCacheTestKey(last)), nullptr);
+  for (auto& dataset : datasets) {
+    RemovePirCacheTestFile(dataset);
+  }
+}
+
+TEST(PIRDatabaseCacheTest, drop_stale) {
+  auto& cache = PIRDatabaseCache::getInstance();
+  auto dataset = WritePirCacheTestFile(0, "a\n1\n");
+  // a changed dataset drops the entries of every key on lookup.
+  cache.put(PirCacheTestKey(dataset), PirCacheTestEntry(dataset, 1));
+  cache.put(PirCacheTestKey(dataset, 128), PirCacheTestEntry(dataset, 1));
+  WritePirCacheTestFile(0, "a\n1\n2\n");
+  EXPECT_EQ(cache.get(PirCacheTestKey(dataset)), nullptr);
+  EXPECT_EQ(cache.get(PirCacheTestKey(dataset, 128)), nullptr);
+  // and so does a removed one.
+  cache.put(PirCacheTestKey(dataset), PirCacheTestEntry(dataset, 1));
+  std::remove(dataset.c_str());
+  EXPECT_EQ(cache.get(PirCacheTestKey(dataset)), nullptr);
+}
+
+}  // namespace primihub::task
@@ -0,0 +1,79 @@
+/*
+ Copyright 2022 Primihub
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+      https://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "cryptoTools/Network/IOService.h"
+#include "cryptoTools/Network/Session.h"
+#include "src/primihub/task/semantic/psi_kkrt_shard.h"
+
+using namespace osuCrypto;
+
+namespace primihub::task {
+
+// receiver holds 0..999, sender every even number of 0..2999.
+std::vector<u64> RunKkrtSharded(size_t num_shards) {
+  std::vector<block> recv_set, send_set;
+  for (u64 i = 0; i < 1000; i++) {
+    recv_set.push_back(toBlock(i * 7919 + 17, i));
+  }
+  for (u64 i = 0; i < 3000; i += 2) {
+    send_set.push_back(toBlock(i * 7919 + 17, i));
+  }
+
+  IOService ios;
+  Session send_ep(ios, "127.0.0.1:1299", SessionMode::Server);
+  Session recv_ep(ios, "127.0.0.1:1299", SessionMode::Client);
+  Channel send_chl = send_ep.addChannel();
+  Channel recv_chl = recv_ep.addChannel();
+
+  std::thread sender([&]() {
+    KkrtShardedSend(send_ep, send_chl, send_set, recv_set.size(), num_shards);
+  });
+  auto intersection = KkrtShardedRecv(recv_ep, recv_chl, recv_set,
+                                      send_set.size(), num_shards);
+  sender.join();
+  send_chl.close();
+  recv_chl.close();
+  send_ep.stop();
+  recv_ep.stop();
+  ios.stop();
+  std::sort(intersection.begin(), intersection.end());
+  return intersection;
+}
+
+TEST(KkrtShardTest, shard_bound) {
+  EXPECT_EQ(KkrtShardBound(1000, 1), 1000);
+  EXPECT_EQ(KkrtShardBound(0, 4), 1);
+  // above the mean, but never above the whole set
+  EXPECT_GT(KkrtShardBound(1000000, 8), 1000000 / 8);
+  EXPECT_LT(KkrtShardBound(1000000, 8), 1000000 / 8 * 11 / 10);
+  EXPECT_EQ(KkrtShardBound(10, 4), 10);
+}
+
+TEST(KkrtShardTest, sharded_matches_unsharded) {
+  std::vector<u64> expected;
+  for (u64 i = 0; i < 1000; i += 2) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(RunKkrtSharded(1), expected);
+  EXPECT_EQ(RunKkrtSharded(4), expected);
+}
+
+}  // namespace primihub::task
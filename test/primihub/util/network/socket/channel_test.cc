@@ -7,6 +7,7 @@
 #include <memory>
 
 #include <stdlib.h>
+#include <cstring>
 
 #include "gtest/gtest.h"
 
@@ -18,6 +19,7 @@
 #include "src/primihub/util/network/socket/ioservice.h"
 #include "src/primihub/util/network/socket/session_base.h"
 #include "src/primihub/util/network/socket/session.h"
+#include "src/primihub/util/network/socket/session_pool.h"
 #include "src/primihub/util/network/socket/channel_base.h"
 #include "src/primihub/util/network/socket/channel.h"
 #include "test/primihub/util/util_test.h"
@@ -807,6 +809,285 @@ TEST(BtNetwork_std_Containers_Test, std_containers) {
   if (hello != "hello world") UnitTestFail("std::string move");
 }
 
+TEST(BtNetwork_Coalescing_Test, coalescing) {
+  setThreadName("Test_Host");
+  std::string channelName{ "TestChannel" };
+  auto tls = getIfTLS(false);
+  IOService ioService;
+
+  Session ep1(ioService, "127.0.0.1", 1212, SessionMode::Client, tls,
+    "endpoint");
+  Session ep2(ioService, "127.0.0.1", 1212, SessionMode::Server, tls,
+    "endpoint");
+
+  auto chl1 = ep1.addChannel(channelName, channelName);
+  auto chl2 = ep2.addChannel(channelName, channelName);
+
+  Finally cleanup([&]() {
+    chl1.close();
+    chl2.close();
+    ep1.stop();
+    ep2.stop();
+    ioService.stop();
+  });
+
+  chl1.waitForConnection();
+  chl1.resetStats();
+  chl1.setCoalescing(true);
+
+  std::array<u64, 2> shape{ 3, 200 };
+  std::vector<u64> small(shape[0] * shape[1]);
+  for (u64 i = 0; i < small.size(); ++i)
+    small[i] = i * 7;
+  // Larger than a batch frame, it is written on its own.
+  std::vector<u8> large(BatchSendBuff::kMaxFrameSize + 1, 9);
+  std::string hello{ "hello world" };
+
+  chl1.asyncSendCopy(shape);
+  chl1.asyncSend(small);
+  auto sent = chl1.asyncSendFuture(small.data(), 1);
+  chl1.asyncSend(std::move(large));
+  chl1.asyncSendCopy(hello);
+  chl1.asyncSendCopy(shape);
+
+  // Nothing is written until the held sends are flushed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(chl1.getTotalDataSent(), 0);
+  chl1.flushSends();
+  sent.get();
+
+  std::array<u64, 2> shape2;
+  std::vector<u64> small2;
+  u64 first = 1;
+  std::vector<u8> large2;
+  std::string hello2;
+  chl2.recv(shape2);
+  EXPECT_EQ(shape2, shape);
+  chl2.recv(small2);
+  EXPECT_EQ(small2, small);
+  chl2.recv(first);
+  EXPECT_EQ(first, 0);
+  chl2.recv(large2);
+  EXPECT_EQ(large2.size(), BatchSendBuff::kMaxFrameSize + 1);
+  chl2.recv(hello2);
+  EXPECT_EQ(hello2, hello);
+  shape2 = {};
+  auto fu = chl2.asyncRecv(shape2);
+
+  // The remaining frame of the last batch is mixed with plain sends.
+  chl1.setCoalescing(false);
+  chl1.asyncSendCopy(hello);
+  fu.get();
+  EXPECT_EQ(shape2, shape);
+  chl2.recv(hello2);
+  EXPECT_EQ(hello2, hello);
+
+  // A blocking send writes what is held before it.
+  chl1.setCoalescing(true);
+  chl1.asyncSendCopy(shape);
+  chl1.send(small);
+  chl2.recv(shape2);
+  chl2.recv(small2);
+  EXPECT_EQ(small2, small);
+
+  // A blocking receive also writes what the channels of its group hold.
+  auto chl3 = ep1.addChannel("Other", "Other");
+  auto chl4 = ep2.addChannel("Other", "Other");
+  chl3.setCoalescing(true);
+  chl1.flushWith({ chl1, chl3 });
+  chl3.asyncSendCopy(shape);
+  chl2.asyncSendCopy(hello);
+  chl1.recv(hello2);
+  EXPECT_EQ(hello2, hello);
+  shape2 = {};
+  chl4.recv(shape2);
+  EXPECT_EQ(shape2, shape);
+  chl3.close();
+  chl4.close();
+}
+
+TEST(BtNetwork_emptyMessage_Test, empty_message) {
+  setThreadName("Test_Host");
+  std::string channelName{ "TestChannel" };
+  auto tls = getIfTLS(false);
+  IOService ioService;
+
+  Session ep1(ioService, "127.0.0.1", 1212, SessionMode::Client, tls,
+    "endpoint");
+  Session ep2(ioService, "127.0.0.1", 1212, SessionMode::Server, tls,
+    "endpoint");
+
+  auto chl1 = ep1.addChannel(channelName, channelName);
+  auto chl2 = ep2.addChannel(channelName, channelName);
+
+  Finally cleanup([&]() {
+    chl1.close();
+    chl2.close();
+    ep1.stop();
+    ep2.stop();
+    ioService.stop();
+  });
+
+  std::string empty, hello{ "hello world" };
+  std::string recv_str{ "not empty" };
+  chl1.send(empty);
+  chl2.recv(recv_str);
+  EXPECT_TRUE(recv_str.empty());
+
+  std::array<u8, 16> dest;
+  ReceiveAtMost<u8> at_most(dest.data(), dest.size());
+  chl1.asyncSend(std::vector<u8>{});
+  chl2.recv(at_most);
+  EXPECT_EQ(at_most.receivedSize(), 0);
+  EXPECT_EQ(at_most.size(), 0);
+
+  // An empty frame inside a batch.
+  chl1.setCoalescing(true);
+  chl1.asyncSendCopy(hello);
+  chl1.asyncSendCopy(empty);
+  chl1.asyncSendCopy(hello);
+  chl1.flushSends();
+  std::vector<u8> recv_vec{ 1 };
+  chl2.recv(recv_str);
+  EXPECT_EQ(recv_str, hello);
+  chl2.recv(recv_vec);
+  EXPECT_TRUE(recv_vec.empty());
+  chl2.recv(recv_str);
+  EXPECT_EQ(recv_str, hello);
+}
+
+namespace {
+// Replays fixed bytes to the channel, as a peer which writes anything.
+class ScriptedSocket : public SocketInterface {
+ public:
+  explicit ScriptedSocket(std::vector<u8> script)
+    : mScript(std::move(script)) {}
+
+  void setIOService(IOService& ios) override { mIos = &ios; }
+
+  void async_recv(span<boost::asio::mutable_buffer> buffers,
+    io_completion_handle&& fn) override {
+    error_code ec;
+    u64 size = 0;
+    for (auto& buffer : buffers) {
+      auto n = boost::asio::buffer_size(buffer);
+      if (mPos + n > mScript.size()) {
+        ec = boost::system::errc::make_error_code(
+          boost::system::errc::io_error);
+        break;
+      }
+      memcpy(boost::asio::buffer_cast<u8*>(buffer), mScript.data() + mPos, n);
+      mPos += n;
+      size += n;
+    }
+    post(mIos, [fn = std::move(fn), ec, size]() { fn(ec, size); });
+  }
+
+  void async_send(span<boost::asio::mutable_buffer> buffers,
+    io_completion_handle&& fn) override {
+    u64 size = 0;
+    for (auto& buffer : buffers)
+      size += boost::asio::buffer_size(buffer);
+    post(mIos, [fn = std::move(fn), size]() { fn({}, size); });
+  }
+
+  void cancel() override {}
+
+ private:
+  IOService* mIos = nullptr;
+  std::vector<u8> mScript;
+  u64 mPos = 0;
+};
+
+// Receive one message from a peer which sends a batch header followed by
+// body, return false if the channel rejected it.
+bool recvScriptedBatch(std::array<u32, 3> header, std::vector<u8> body,
+  std::vector<u8>& dest) {
+  std::vector<u8> script(sizeof(u32) * 4);
+  u32 marker = kBatchHeaderMarker;
+  memcpy(script.data(), &marker, sizeof(u32));
+  memcpy(script.data() + sizeof(u32), header.data(), sizeof(u32) * 3);
+  script.insert(script.end(), body.begin(), body.end());
+
+  IOService ios(1);
+  Channel chl(ios, new ScriptedSocket(std::move(script)));
+  bool ok = true;
+  try {
+    chl.recv(dest);
+  } catch (std::exception&) {
+    ok = false;
+  }
+  chl.close();
+  return ok;
+}
+}  // namespace
+
+TEST(BtNetwork_batchHeader_Test, reject_malformed_batch) {
+  std::vector<u8> dest;
+  ASSERT_TRUE(recvScriptedBatch({ 1, 1, 3 }, { 3, 'a', 'b', 'c' }, dest));
+  EXPECT_EQ(dest, std::vector<u8>({ 'a', 'b', 'c' }));
+
+  // A frame size which does not end within five bytes.
+  EXPECT_FALSE(recvScriptedBatch({ 1, 5, 0 },
+    { 0x80, 0x80, 0x80, 0x80, 0x80 }, dest));
+  // A frame size with bits above 32.
+  EXPECT_FALSE(recvScriptedBatch({ 1, 5, 0 },
+    { 0x80, 0x80, 0x80, 0x80, 0x10 }, dest));
+  // A frame larger than a sender ever batches.
+  std::vector<u8> large{ 0x80, 0x80, 0x40 };
+  large.resize(large.size() + (1 << 20));
+  EXPECT_FALSE(recvScriptedBatch({ 1, 3, 1 << 20 }, large, dest));
+  // Header sizes which would only fail after a large allocation.
+  EXPECT_FALSE(recvScriptedBatch({ 1, 6, 0 }, {}, dest));
+  EXPECT_FALSE(recvScriptedBatch({ 1, 1, 0xffffff00 }, {}, dest));
+  EXPECT_FALSE(recvScriptedBatch({ 0xffffffff, 1, 0 }, {}, dest));
+  EXPECT_FALSE(recvScriptedBatch({ 0, 0, 0 }, {}, dest));
+}
+
+TEST(BtNetwork_SessionPool_Test, session_pool) {
+  SessionPool pool;
+  auto exchange = [&pool](const std::string &session_name,
+                          const std::string &name, u64 val) {
+    auto server = pool.addChannel("127.0.0.1", 1212, SessionMode::Server,
+                                  session_name, name);
+    auto client = pool.addChannel("127.0.0.1", 1212, SessionMode::Client,
+                                  session_name, name);
+    std::string msg;
+    client.send(name);
+    server.recv(msg);
+    EXPECT_EQ(msg, name);
+
+    u64 back = 0;
+    server.send(val);
+    client.recv(back);
+    EXPECT_EQ(back, val);
+    client.close();
+    server.close();
+  };
+
+  // Tasks running at the same time only see their own channels.
+  std::vector<std::thread> tasks;
+  for (u64 t = 0; t < 4; ++t)
+    tasks.emplace_back(
+        [&exchange, t]() { exchange("pool", "task_" + std::to_string(t), t); });
+  for (auto &task : tasks)
+    task.join();
+  EXPECT_EQ(pool.size(), 2);
+
+  // Later tasks reuse the sessions, other sessions share the port.
+  auto session = pool.getSession("127.0.0.1", 1212, SessionMode::Server, "pool");
+  exchange("pool", "task_4", 4);
+  EXPECT_EQ(session.mBase,
+            pool.getSession("127.0.0.1", 1212, SessionMode::Server, "pool")
+                .mBase);
+  exchange("other", "task_5", 5);
+  EXPECT_EQ(pool.size(), 4);
+
+  pool.clear();
+  EXPECT_EQ(pool.size(), 0);
+  EXPECT_TRUE(session.stopped());
+}
+
 TEST(BtNetwork_bitVector_Test, bit_vector) {
   setThreadName("Test_Host");
   std::string channelName{ "TestChannel" }, msg{ "This is the message" };
@@ -0,0 +1,45 @@
+// Copyright [2022] <primihub.com>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/primihub/util/row_select.h"
+
+using primihub::SelectRows;
+
+static std::vector<std::string> makeRows(size_t num) {
+  std::vector<std::string> rows;
+  for (size_t i = 0; i < num; i++) {
+    rows.push_back("row_" + std::to_string(i));
+  }
+  return rows;
+}
+
+TEST(RowSelectTest, Intersection) {
+  auto rows = makeRows(10);
+  std::vector<int64_t> indices{7, 2, 2, 5, 42};
+  std::vector<std::string> result;
+  EXPECT_EQ(SelectRows(&rows, indices, false, &result), 3u);
+  std::vector<std::string> expected{"row_2", "row_5", "row_7"};
+  EXPECT_EQ(result, expected);
+}
+
+TEST(RowSelectTest, Difference) {
+  auto rows = makeRows(6);
+  std::vector<uint64_t> indices{0, 3, 5};
+  std::vector<std::string> result;
+  EXPECT_EQ(SelectRows(&rows, indices, true, &result), 3u);
+  std::vector<std::string> expected{"row_1", "row_2", "row_4"};
+  EXPECT_EQ(result, expected);
+}
+
+TEST(RowSelectTest, EmptyIndices) {
+  auto rows = makeRows(4);
+  std::vector<int64_t> indices;
+  std::vector<std::string> result;
+  EXPECT_EQ(SelectRows(&rows, indices, false, &result), 0u);
+  EXPECT_TRUE(result.empty());
+  EXPECT_EQ(SelectRows(&rows, indices, true, &result), 4u);
+  EXPECT_EQ(result, makeRows(4));
+}